@@ -0,0 +1,2300 @@
+// Microbenchmarks for the core pipeline on the host ([env:native]).
+//
+//   pio run -e native && .pio/build/native/program [label]
+//
+// Set MQTT_BENCH=host[:port] to also measure publishing against a real broker.
+// SERIES_POINTS=N sets the size of the series file test (default 5000000, 0 = off).
+//
+// Prints ns/op and heap allocations/op, writes bench/results/<label>.csv
+// and compares against bench/results/baseline.csv. Run with the label
+// "baseline" to record a new baseline. Allocation counts are exact and
+// host-independent; an increase fails the run (exit code 1). Timings are
+// host-dependent, so a slowdown is only reported.
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SensorManager.h"
+#include "WeatherManager.h"
+#include "HistoryJson.h"
+#include "Config.h"
+#include "HampelFilter.h"
+#include "ClimateKalman.h"
+#include "MoldIndex.h"
+#include "SensorHealth.h"
+#include "LockStats.h"
+#include "HeapTags.h"
+#include "StreamPool.h"
+#include "MqttManager.h"
+#include "SeriesFile.h"
+#include "HttpsManager.h"
+#include "ChartRenderer.h"
+#include "PngEncoder.h"
+#include "FrameDiff.h"
+#include "ForecastParser.h"
+#include "VentilationPlanner.h"
+#include "Scheduler.h"
+#include "Trace.h"
+#include "BootManager.h"
+#include "Sparkline.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// -------------------------------------------------------------------------
+// Allocation counting (every operator new, incl. std::string inside String)
+// and the heap tag hooks (same accounting as the allocator wrappers on the ESP32)
+// -------------------------------------------------------------------------
+static std::atomic<uint64_t> allocCount{0};
+
+void* operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    HeapTags::onAlloc(p, size);
+    return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+// Out of line: inlined into a delete next to its new, GCC flags the free() as mismatched
+__attribute__((noinline)) static void release(void* p) noexcept {
+    HeapTags::onFree(p);
+    free(p);
+}
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+
+// -------------------------------------------------------------------------
+// Access to the private pipeline steps (friend of SensorManager)
+// -------------------------------------------------------------------------
+struct SensorBench {
+    static void processReading(SensorManager& sm, float t, float h) { sm.processReading(t, h, sm.readOutdoor()); }
+    static void updateAdvice(SensorManager& sm) { sm.updateAdvice(sm.readOutdoor()); }
+    static void addHistoryPoint(SensorManager& sm, float t, float h) { sm.addHistoryPoint(t, h); }
+    static void appendHistory(SensorManager& sm, const Record& r) { sm.appendHistory(r); }
+    // Reference for queryHistory(): every record of the ring, under the mutex
+    static void scanHistory(SensorManager& sm, uint32_t from, uint32_t to, HistoryStats& t, HistoryStats& h) {
+        t = HistoryStats();
+        h = HistoryStats();
+        ScopedLock lock(sm.dataMutex, sm.lockStats, SensorManager::LOCK_HISTORY_QUERY);
+        for (size_t i = 0; i < sm.historyCount; i++) {
+            const Record& r = sm.history[i];
+            if (r.ts < from || r.ts > to) continue;
+            t.add(r.t);
+            h.add(r.h);
+        }
+    }
+};
+
+// -------------------------------------------------------------------------
+// Runner
+// -------------------------------------------------------------------------
+struct Result {
+    std::string name;
+    double nsPerOp;
+    double allocsPerOp;
+    uint64_t ops;
+};
+
+static const double MIN_RUN_NS = 2e8; // Grow the batch until one run takes >= 200 ms
+static const int REPEATS = 3;          // Best of N runs (filters scheduler noise)
+
+template <typename Fn>
+static Result measure(const std::string& name, Fn&& op) {
+    op(); // Warm-up (first-touch allocations are not counted)
+    uint64_t n = 1;
+    Result best = {name, 0, 0, 0};
+    int runs = 0;
+    while (runs < REPEATS) {
+        uint64_t allocs0 = allocCount.load(std::memory_order_relaxed);
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < n; i++) op();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        uint64_t allocs = allocCount.load(std::memory_order_relaxed) - allocs0;
+        if (ns < MIN_RUN_NS && n < (1ULL << 32)) {
+            n = (ns < 1e6) ? n * 10 : (uint64_t)(n * MIN_RUN_NS / ns) + 1;
+            continue; // Still calibrating
+        }
+        if (runs == 0 || ns / n < best.nsPerOp) best = {name, ns / n, (double)allocs / n, n};
+        runs++;
+    }
+    return best;
+}
+
+// -------------------------------------------------------------------------
+// Fixtures
+// -------------------------------------------------------------------------
+
+// One airing cycle at the sensor rate (6 s): humid and stable, window open
+// (temperature and humidity fall), window closed (rebound), stable again.
+static std::vector<std::pair<float, float>> makeAiringCycle() {
+    std::vector<std::pair<float, float>> r;
+    for (int i = 0; i < 100; i++) r.push_back({23.0f + 0.05f * sinf(i * 0.3f), 62.0f + 0.2f * sinf(i * 0.7f)});
+    for (int i = 0; i < 150; i++) r.push_back({23.0f - i * 0.03f, 62.0f - i * 0.12f});
+    for (int i = 0; i < 100; i++) r.push_back({18.5f + i * 0.04f, 44.0f + i * 0.1f});
+    for (int i = 0; i < 250; i++) r.push_back({22.5f + 0.05f * sinf(i * 0.3f), 54.0f + 0.2f * sinf(i * 0.7f)});
+    return r;
+}
+
+static void fillHistory(SensorManager& sm) {
+    for (size_t i = 0; i < HISTORY_SIZE; i++) {
+        SensorBench::addHistoryPoint(sm, 21.0f + (i % 40) * 0.1f, 45.0f + (i % 25) * 0.5f);
+    }
+}
+
+static WeatherSnapshot makeWeather() {
+    WeatherSnapshot w = {};
+    uint32_t now = time(NULL);
+    w.outTemp = 26.0f;
+    w.outHum = 40.0f;
+    w.outAbsHum = 9.7f;
+    w.fetchTs = now;
+    w.valid = true;
+    w.forecast.begin(now - now % 3600);
+    for (size_t i = 0; i < HourlyForecast::HOURS; i++) {
+        w.forecast.append(20.0f + 6.0f * sinf(i * 0.26f), 55.0f - 15.0f * sinf(i * 0.26f));
+    }
+    return w;
+}
+
+// Stable room at the sensor rate with DHT noise and single-frame glitches
+// (a humidity frame 15% low every 40 readings, a temperature frame 3 °C low
+// every 70). The state estimator absorbs small glitches (a 6% frame no longer
+// starts a session); a 15% frame still drags the estimate far enough to fake
+// a window opening unless the outlier filter replaces it.
+static std::vector<std::pair<float, float>> makeGlitchTrace() {
+    std::vector<std::pair<float, float>> r;
+    uint32_t lcg = 12345;
+    auto noise = [&lcg]() { lcg = lcg * 1664525u + 1013904223u; return ((lcg >> 8) & 0xFFFF) / 65535.0f - 0.5f; };
+    for (int i = 0; i < 3000; i++) {
+        float t = 22.5f + 0.2f * noise();
+        float h = 55.0f + 0.8f * noise();
+        if (i % 40 == 39) h -= 15.0f;
+        if (i % 70 == 69) t -= 3.0f;
+        r.push_back({t, h});
+    }
+    return r;
+}
+
+// The same trace with DHT22-like noise (approx. Gaussian, 0.1 °C / 0.5 % RH)
+static std::vector<std::pair<float, float>> addNoise(const std::vector<std::pair<float, float>>& clean) {
+    std::vector<std::pair<float, float>> r;
+    uint32_t lcg = 777;
+    auto uniform = [&lcg]() { lcg = lcg * 1664525u + 1013904223u; return ((lcg >> 8) & 0xFFFF) / 65535.0f - 0.5f; };
+    auto gauss = [&uniform]() { return (uniform() + uniform() + uniform()) * 2.0f; }; // std ~1
+    for (const auto& s : clean) r.push_back({s.first + 0.1f * gauss(), s.second + 0.5f * gauss()});
+    return r;
+}
+
+struct ReplayResult {
+    int sessions;       // STABLE -> VENTILATING transitions
+    int firstVent;      // Reading index of the first one (-1 = none)
+    uint32_t outliers;  // Readings replaced by the filter (t + h)
+    size_t journaled;   // Finished sessions in the journal
+    VentSession last;   // Newest of them
+};
+
+// Full pipeline (processReading + update) with the given Hampel k (0 = off)
+static ReplayResult replay(const std::vector<std::pair<float, float>>& trace, float hampelK,
+                           std::vector<std::pair<float, float>>* estimates = nullptr) {
+    ClimateConfig cfg = Config::defaults();
+    cfg.hampelK = hampelK;
+    cfg.tempOffset = 0; // Estimates are compared with the trace itself
+    cfg.humOffset = 0;
+    char error[64];
+    Config::apply(cfg, error, sizeof(error));
+
+    SensorManager sm;
+    ReplayResult res = {0, -1, 0, 0, {}};
+    SensorManager::ClimateState prev = sm.getClimateState();
+    for (size_t i = 0; i < trace.size(); i++) {
+        SensorBench::processReading(sm, trace[i].first, trace[i].second);
+        sm.update();
+        if (estimates) estimates->push_back({sm.getTemp(), sm.getHum()});
+        SensorManager::ClimateState st = sm.getClimateState();
+        if (prev == SensorManager::ClimateState::STABLE && st == SensorManager::ClimateState::VENTILATING) {
+            if (res.firstVent < 0) res.firstVent = (int)i;
+            res.sessions++;
+        }
+        prev = st;
+        NativeClock::advance(6000);
+    }
+    res.outliers = sm.getTempFilterStats().outliers + sm.getHumFilterStats().outliers;
+    res.journaled = sm.getSessionCount();
+    if (res.journaled > 0) sm.copySessions(res.journaled - 1, 1, &res.last);
+    Config::apply(Config::defaults(), error, sizeof(error));
+    return res;
+}
+
+// RMS error of estimate (or raw reading) against the clean trace over [from, to)
+static void rmsError(const std::vector<std::pair<float, float>>& values, const std::vector<std::pair<float, float>>& truth,
+                     size_t from, size_t to, float& tRms, float& hRms) {
+    double t = 0, h = 0;
+    for (size_t i = from; i < to; i++) {
+        t += (values[i].first - truth[i].first) * (values[i].first - truth[i].first);
+        h += (values[i].second - truth[i].second) * (values[i].second - truth[i].second);
+    }
+    tRms = (float)sqrt(t / (to - from));
+    hRms = (float)sqrt(h / (to - from));
+}
+
+// -------------------------------------------------------------------------
+// MQTT transports: in-memory sink (CPU cost only) and a real TCP socket
+// -------------------------------------------------------------------------
+struct SinkTransport : MqttTransport {
+    bool opened = false;
+    bool connackPending = false;
+    uint64_t bytes = 0;
+    bool open(const char*, uint16_t) override { return opened = connackPending = true; }
+    void close() override { opened = false; }
+    bool isOpen() override { return opened; }
+    int write(const uint8_t*, size_t len) override {
+        bytes += len;
+        return (int)len;
+    }
+    int read(uint8_t* data, size_t len) override {
+        if (!connackPending || len < 4) return 0;
+        const uint8_t connack[4] = {0x20, 2, 0, 0};
+        memcpy(data, connack, 4);
+        connackPending = false;
+        return 4;
+    }
+};
+
+struct SocketTransport : MqttTransport {
+    int fd = -1;
+    uint32_t writes = 0; // send() calls = upper bound on TCP segments
+    bool open(const char* host, uint16_t port) override {
+        char service[8];
+        snprintf(service, sizeof(service), "%u", port);
+        addrinfo hints = {};
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* res = nullptr;
+        if (getaddrinfo(host, service, &hints, &res) != 0) return false;
+        fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        bool ok = fd >= 0 && ::connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+        freeaddrinfo(res);
+        if (!ok) {
+            close();
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Like WiFiClient::setNoDelay
+        return true;
+    }
+    void close() override {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    bool isOpen() override { return fd >= 0; }
+    int write(const uint8_t* data, size_t len) override {
+        writes++;
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        return n < 0 ? -1 : (int)n;
+    }
+    int read(uint8_t* data, size_t len) override {
+        ssize_t n = recv(fd, data, len, MSG_DONTWAIT);
+        if (n == 0) return -1; // Closed by the broker
+        if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        return (int)n;
+    }
+};
+
+// Broker that is unreachable until `offline` is cleared, then drops the
+// connection on the first write carrying a readings batch (mid-drain).
+// Keeps the PUBLISH packets of every write that went through.
+struct FlakyTransport : SinkTransport {
+    bool offline = true;
+    bool dropped = false;
+    std::vector<std::pair<std::string, std::string>> received; // topic, payload
+    bool open(const char* host, uint16_t port) override { return !offline && SinkTransport::open(host, port); }
+    int write(const uint8_t* data, size_t len) override {
+        if (!dropped && memmem(data, len, "/readings", 9)) {
+            dropped = true;
+            return -1;
+        }
+        for (size_t i = 0; i < len;) { // Whole packets: flush() writes the buffer in one piece
+            uint8_t type = data[i++];
+            size_t remaining = 0;
+            for (int shift = 0;; shift += 7) {
+                uint8_t digit = data[i++];
+                remaining |= (size_t)(digit & 0x7F) << shift;
+                if (!(digit & 0x80)) break;
+            }
+            if ((type & 0xF0) == 0x30) {
+                size_t topicLen = (data[i] << 8) | data[i + 1];
+                received.push_back({std::string((const char*)data + i + 2, topicLen),
+                                    std::string((const char*)data + i + 2 + topicLen, remaining - 2 - topicLen)});
+            }
+            i += remaining;
+        }
+        return SinkTransport::write(data, len);
+    }
+};
+
+// Offline backlog (RAM queue + spill file), then a broker that drops the
+// connection in the middle of the drain. false if a message counted as
+// published never reached the broker, or a reading was lost or sent twice.
+static bool mqttDropRun() {
+    const int READINGS = 60 * 6; // 1 h of airing readings, one per 10 s
+    SensorManager sm;
+    FlakyTransport broker;
+    MqttManager mqtt(&sm, &broker);
+    const char* spillPath = "/tmp/acm1_mqtt_drop.q";
+    remove(spillPath);
+    mqtt.setBroker("broker", 1883, "", "");
+    mqtt.begin("acm1_bench");
+    mqtt.setSpillFile(spillPath, 65536);
+    for (int i = 0; i < READINGS; i++) {
+        mqtt.onReading(21.0f - i * 0.01f, 60.0f - i * 0.05f, 11.0f - i * 0.005f, 1);
+        NativeClock::advance(10000);
+        mqtt.update();
+    }
+    mqtt.onReading(21.0f - READINGS * 0.01f, 42.0f, 8.0f, 0); // Session over: last batch goes out
+    mqtt.update();
+    size_t backlog = mqtt.getBacklog();
+    uint32_t spilled = mqtt.getStats().spilled;
+
+    broker.offline = false;
+    NativeClock::advance(120000); // Past the reconnect backoff
+    for (int i = 0; i < 100 && mqtt.getBacklog() > 0; i++) mqtt.update();
+    remove(spillPath);
+
+    // Queued messages the broker got (the backlog plus a state message on reconnect),
+    // and the readings in them in order
+    size_t delivered = 0;
+    std::vector<int> readings;
+    for (const auto& p : broker.received) {
+        const std::string& topic = p.first;
+        if (topic.compare(0, 5, "acm1/") != 0 || (topic.size() >= 7 && topic.compare(topic.size() - 7, 7, "/status") == 0)) continue;
+        delivered++;
+        if (topic.size() < 9 || topic.compare(topic.size() - 9, 9, "/readings") != 0) continue;
+        for (size_t at = p.second.find("[["); at != std::string::npos; at = p.second.find(",[", at + 1)) {
+            unsigned long ts;
+            float t;
+            if (sscanf(p.second.c_str() + at + 1, "[%lu,%f", &ts, &t) == 2) readings.push_back((int)lroundf(t * 100));
+        }
+    }
+    bool inOrder = readings.size() == (size_t)READINGS;
+    for (size_t i = 0; inOrder && i < readings.size(); i++) inOrder = readings[i] == 2100 - (int)i;
+
+    const MqttManager::Stats& st = mqtt.getStats();
+    printf("\nMQTT broker drop mid-drain: backlog %zu (%u spilled), %zu delivered, %u counted published, %zu/%d readings in order%s\n",
+           backlog, (unsigned)spilled, delivered, (unsigned)st.published, inOrder ? readings.size() : 0, READINGS,
+           broker.dropped ? "" : " (no drop)");
+    return broker.dropped && st.connects == 2 && st.dropped == 0 && spilled > 0 && mqtt.getBacklog() == 0 &&
+           delivered >= backlog && st.published == delivered && inOrder;
+}
+
+// Against a real broker (e.g. mosquitto): QoS 0 throughput, then the drain
+// time of an offline backlog (RAM queue + spill file) after reconnecting.
+static void mqttBrokerRun(const char* host, uint16_t port) {
+    const char payload[] = "{\"t\":21.53,\"h\":48.2,\"dp\":10.1,\"ah\":9.12,\"state\":\"stable\",\"advice\":3}";
+    const int N = 20000;
+    printf("\nMQTT broker %s:%u\n", host, port);
+
+    for (int batched = 0; batched <= 1; batched++) {
+        SocketTransport sock;
+        MqttClient client(&sock);
+        MqttClient::Will will = {"acm1/bench/status", "offline", true};
+        if (!client.connect(host, port, "acm1_bench", will)) {
+            printf("  connect failed - skipped\n");
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < N; i++) {
+            client.publish("acm1/bench/state", payload, sizeof(payload) - 1, false);
+            if (!batched) client.flush(); // One write per message
+        }
+        client.flush();
+        bool synced = client.sync(10000); // PINGRESP: the broker has read everything before it
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("  publish %-9s %8.0f msg/s   %6u writes%s\n", batched ? "batched" : "unbatched",
+               N / sec, (unsigned)sock.writes, synced ? "" : "   (no PINGRESP)");
+        client.disconnect();
+    }
+
+    // Offline backlog: 10 min of airing readings (one per 10 s) with the broker unreachable
+    SensorManager sm;
+    SocketTransport sock;
+    MqttManager mqtt(&sm, &sock);
+    const char* spillPath = "/tmp/acm1_mqtt_bench.q";
+    remove(spillPath);
+    mqtt.setBroker("127.0.0.1", 1, "", ""); // Refused
+    mqtt.begin("acm1_bench");
+    mqtt.setSpillFile(spillPath, 65536);
+    for (int i = 0; i < 60 * 6; i++) {
+        mqtt.onReading(21.0f - i * 0.01f, 60.0f - i * 0.05f, 11.0f - i * 0.005f, 1);
+        if (i % 60 == 59) mqtt.onStateChange(1, 1);
+        NativeClock::advance(10000);
+        mqtt.update();
+    }
+    size_t backlog = mqtt.getBacklog();
+    uint32_t spilled = mqtt.getStats().spilled;
+
+    mqtt.setBroker(host, port, "", "");
+    NativeClock::advance(120000); // Past the reconnect backoff
+    auto start = std::chrono::steady_clock::now();
+    while (mqtt.getBacklog() > 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) mqtt.update();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const MqttManager::Stats& st = mqtt.getStats();
+    printf("  offline backlog %zu msgs (%u spilled to flash, %u dropped)\n", backlog, (unsigned)spilled, (unsigned)st.dropped);
+    printf("  drained in %.1f ms (%u published, %u writes)\n", ms, (unsigned)st.published, (unsigned)sock.writes);
+    remove(spillPath);
+}
+
+// -------------------------------------------------------------------------
+// Mold index: incremental model vs a straight transcription of the paper
+// -------------------------------------------------------------------------
+
+// Hukka & Viitanen (1999), pine sapwood, sawn (W = 0, SQ = 0). Explicit
+// Euler in the chosen precision, decline rate picked at the step start,
+// no compensation: the textbook hourly loop.
+template <typename Real>
+static void moldReference(Real& m, Real& dry, Real t, Real rh, Real hours) {
+    Real rhCrit = t <= 20 ? (Real)(-0.00267 * t * t * t + 0.160 * t * t - 3.13 * t + 100.0) : (Real)80.0;
+    if (t > 0 && t < 50 && rh >= rhCrit) {
+        Real tm = exp(-0.68 * log(t) - 13.9 * log(rh) + 66.02);
+        Real tv = exp(-0.74 * log(t) - 12.72 * log(rh) + 61.50);
+        Real k1 = m < 1 ? (Real)1.0 : (Real)(2.0 / (tv / tm - 1.0));
+        Real x = (rhCrit - rh) / (rhCrit - 100);
+        Real mMax = 1 + 7 * x - 2 * x * x;
+        Real k2 = std::max((Real)(1.0 - exp(2.3 * (m - mMax))), (Real)0.0);
+        m += hours * k1 * k2 / (7 * tm * 24);
+        dry = 0;
+    } else {
+        if (dry < 6) m -= (Real)0.00133 * hours;
+        else if (dry >= 24) m -= (Real)0.000667 * hours;
+        dry += hours;
+    }
+    m = std::min(std::max(m, (Real)0.0), (Real)6.0);
+}
+
+// Coldest wall spot over 140 days (hourly values): damp for 60 days, dry for
+// 20, then around the critical humidity (alternating growth and decline)
+static void moldClimate(size_t hour, float& t, float& rh) {
+    float day = hour / 24.0f;
+    float wave = sinf(2.0f * (float)M_PI * (hour % 24) / 24.0f);
+    t = 15.0f + 2.0f * wave;
+    if (day < 60) rh = 91.0f + 4.0f * wave;
+    else if (day < 80) rh = 65.0f;
+    else rh = 85.0f + 8.0f * wave;
+}
+
+// false if the model drifts from the double-precision reference
+static bool moldRun() {
+    const size_t HOURS = 140 * 24;
+    const int READINGS = 600; // Per hour (6 s)
+    const float step = 1.0f / READINGS;
+    MoldIndex model;
+    double fine = 0, fineDry = 0, hourly = 0, hourlyDry = 0;
+    float naive = 0, naiveDry = 0;
+    double maxFine = 0, maxHourly = 0, maxNaive = 0;
+    double at[3] = {0, 0, 0};
+    double firstUnit = -1;
+    for (size_t hour = 0; hour < HOURS; hour++) {
+        float t, rh;
+        moldClimate(hour, t, rh);
+        for (int r = 0; r < READINGS; r++) {
+            model.update(t, rh, step);
+            moldReference<double>(fine, fineDry, t, rh, 1.0 / READINGS);
+            moldReference<float>(naive, naiveDry, t, rh, step);
+        }
+        moldReference<double>(hourly, hourlyDry, t, rh, 1.0);
+        double m = model.getIndex();
+        maxFine = std::max(maxFine, fabs(m - fine));
+        maxHourly = std::max(maxHourly, fabs(m - hourly));
+        maxNaive = std::max(maxNaive, fabs((double)naive - fine));
+        if (firstUnit < 0 && m >= 1.0) firstUnit = (hour + 1) / 24.0;
+        if (hour + 1 == 60 * 24) at[0] = m;
+        if (hour + 1 == 80 * 24) at[1] = m;
+    }
+    at[2] = model.getIndex();
+    printf("\nMold index (140 days of a cold wall spot, one update per 6 s reading):\n");
+    printf("  index @60d/@80d/@140d   %.3f / %.3f / %.3f   (index 1 after %.1f days)\n",
+           at[0], at[1], at[2], firstUnit);
+    printf("  max |diff| vs reference double 6 s %.5f   double 1 h %.4f   (float 6 s, uncompensated: %.4f)\n",
+           maxFine, maxHourly, maxNaive);
+    return maxFine < 0.01;
+}
+
+// -------------------------------------------------------------------------
+// DHT health: retries, failure classes, stuck and implausible frames
+// -------------------------------------------------------------------------
+// One 6 s slot as in SensorManager::sensorTask: attempts fail with
+// probability 'failRate' (half checksum at 6 ms, half timeout at 3 ms) and
+// are retried on SensorHealth's schedule. Returns true if a frame arrived.
+struct HealthSim {
+    SensorHealth health;
+    uint32_t rng = 4242; // xorshift32: an LCG's correlated low bits make runs of repeats too long
+    uint32_t nowMs = 0;
+    uint32_t injected = 0;
+
+    float uniform() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return (rng >> 8) / 16777216.0f;
+    }
+    float gauss() { return (uniform() + uniform() + uniform() - 1.5f) * 2.0f; }
+
+    bool slot(float t, float h, float failRate) {
+        uint32_t elapsed = 0;
+        uint8_t attempts = 0;
+        bool valid = false;
+        for (;;) {
+            attempts++;
+            if (uniform() >= failRate) {
+                health.onFrame(t, h, 5200 + (rng & 1023), nowMs + elapsed);
+                valid = true;
+                break;
+            }
+            injected++;
+            health.onFailure((rng & 1) ? 6100 : 3100);
+            uint32_t wait = SensorHealth::retryDelayMs(attempts, elapsed + 8, 6000);
+            if (wait == 0) break;
+            elapsed += 8 + wait;
+        }
+        health.endSlot(valid, attempts);
+        nowMs += 6000;
+        return valid;
+    }
+    // DHT22 output: quantized to 0.1
+    static float q(float v) { return roundf(v * 10.0f) / 10.0f; }
+};
+
+// false if a healthy sensor is flagged or a fault goes undetected
+static bool healthRun() {
+    const int DAY = 14400; // Slots
+    bool ok = SensorHealth::retryDelayMs(1, 10, 6000) == 1000 && SensorHealth::retryDelayMs(2, 1020, 6000) == 2000
+           && SensorHealth::retryDelayMs(3, 3030, 6000) == 0 && SensorHealth::retryDelayMs(1, 3500, 6000) == 0;
+    printf("\nDHT health (retry schedule 0 / 1 / 3 s in a 6 s slot):\n");
+
+    // 1. One day, normal noise, 2 % failed attempts: all recovered, never flagged
+    HealthSim a;
+    int flagged = 0;
+    for (int i = 0; i < DAY; i++) {
+        float drift = 0.5f * sinf(i * 6.283f / DAY);
+        a.slot(HealthSim::q(21.3f + drift + 0.05f * a.gauss()), HealthSim::q(48.0f + drift + 0.3f * a.gauss()), 0.02f);
+        flagged += a.health.getStatus() != SensorHealth::Status::OK;
+    }
+    SensorHealth::Stats s = a.health.getStats();
+    printf("  healthy day     %lu frames, %lu checksum + %lu timeout, %lu retries, %lu recovered, %lu lost, "
+           "repeat rate %.2f -> stuck limit %lu, flagged %d slots\n",
+           (unsigned long)s.frames, (unsigned long)s.checksums, (unsigned long)s.timeouts, (unsigned long)s.retries,
+           (unsigned long)s.recovered, (unsigned long)s.lost, s.repeatRate, (unsigned long)s.stuckLimit, flagged);
+    ok = ok && flagged == 0 && s.checksums + s.timeouts == a.injected && s.stuckEvents == 0 && s.implausible == 0
+            && s.frames + s.lost == (uint32_t)DAY && s.maxReadUs >= 5200 && s.maxReadUs < 6300;
+
+    // 2. Very quiet room (many repeated frames): no false stuck, then a real freeze
+    HealthSim b;
+    for (int i = 0; i < DAY; i++) {
+        b.slot(HealthSim::q(21.3f + 0.02f * b.gauss()), HealthSim::q(48.0f + 0.03f * b.gauss()), 0.0f);
+    }
+    uint32_t limit = b.health.getStats().stuckLimit;
+    bool quietOk = b.health.getStats().stuckEvents == 0;
+    int stuckAfter = -1;
+    for (int i = 0; i < 800 && stuckAfter < 0; i++) {
+        b.slot(21.4f, 48.1f, 0.0f);
+        if (b.health.getStatus() == SensorHealth::Status::STUCK) stuckAfter = i + 1;
+    }
+    uint32_t limitNow = b.health.getStats().stuckLimit; // May grow during the first repeats
+    b.slot(21.5f, 48.3f, 0.0f);
+    printf("  quiet room      repeat rate %.2f -> stuck limit %lu (%.1f min), false stuck %lu; frozen frame flagged after %d readings\n",
+           b.health.getStats().repeatRate, (unsigned long)limit, limit / 10.0f,
+           (unsigned long)b.health.getStats().stuckEvents - (stuckAfter > 0), stuckAfter);
+    ok = ok && quietOk && stuckAfter > 0 && stuckAfter == (int)limitNow + 1
+            && b.health.getStatus() == SensorHealth::Status::OK;
+
+    // 3. Dying sensor (40 % failed attempts), then a dead one
+    HealthSim c;
+    int lostDying = 0;
+    for (int i = 0; i < 600; i++) lostDying += !c.slot(21.0f + 0.1f * (i % 3), 50.0f, 0.4f);
+    SensorHealth::Status dying = c.health.getStatus();
+    float dyingRate = c.health.getStats().errorRate;
+    int noData = -1;
+    for (int i = 0; i < 30 && noData < 0; i++) {
+        c.slot(21.0f, 50.0f, 1.0f);
+        if (c.health.getStatus() == SensorHealth::Status::NO_READINGS) noData = i + 1;
+    }
+    printf("  dying sensor    %s, %d of 600 slots lost (%.1f %% of attempts failed); dead sensor %s after %d slots\n",
+           SensorHealth::getName(dying), lostDying, 100.0f * dyingRate,
+           SensorHealth::getName(c.health.getStatus()), noData);
+    ok = ok && dying == SensorHealth::Status::ERRORS && noData == SensorHealth::NO_READING_SLOTS;
+
+    // 4. One corrupted frame (+8 °C) that still passed the checksum
+    HealthSim d;
+    for (int i = 0; i < 100; i++) d.slot(21.0f, 50.0f + 0.1f * (i % 4), 0.0f);
+    d.slot(29.0f, 50.0f, 0.0f);
+    d.slot(21.0f, 50.1f, 0.0f);
+    printf("  glitch          %lu implausible frames (jump and return), status %s\n",
+           (unsigned long)d.health.getStats().implausible, SensorHealth::getName(d.health.getStatus()));
+    ok = ok && d.health.getStats().implausible == 2 && d.health.getStatus() == SensorHealth::Status::OK;
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Lock statistics under real contention (two threads, one mutex)
+// -------------------------------------------------------------------------
+// false if the counters disagree (lost or double-counted acquisitions)
+static bool lockRun() {
+    static const LockStats::SiteInfo sites[] = {{"slow_holder", 1000}, {"impatient", 5}};
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    LockStats stats(sites, 2);
+    const int HOLDS = 20;
+    std::atomic<bool> done{false};
+    std::thread holder([&]() {
+        for (int i = 0; i < HOLDS; i++) {
+            ScopedLock lock(mutex, stats, 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(12));
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        done = true;
+    });
+    uint32_t tries = 0;
+    while (!done) {
+        ScopedLock lock(mutex, stats, 1);
+        tries++;
+    }
+    holder.join();
+
+    printf("\nLock statistics (12 ms holder vs. 5 ms timeout, %d holds):\n", HOLDS);
+    bool ok = stats.getSite(0).acquired == (uint32_t)HOLDS;
+    for (uint8_t i = 0; i < 2; i++) {
+        const LockStats::Site& s = stats.getSite(i);
+        uint32_t waits = 0, holds = 0;
+        for (size_t b = 0; b < LockStats::BUCKETS; b++) {
+            waits += s.wait[b];
+            holds += s.hold[b];
+        }
+        ok = ok && waits == s.acquired && holds == s.acquired;
+        printf("  %-12s acquired %6lu  timeouts %4lu  max wait %6lu us  max hold %6lu us  wait hist",
+               sites[i].name, (unsigned long)s.acquired, (unsigned long)s.timeouts,
+               (unsigned long)s.maxWaitUs, (unsigned long)s.maxHoldUs);
+        for (size_t b = 0; b < LockStats::BUCKETS; b++) printf(" %lu", (unsigned long)s.wait[b]);
+        printf("\n");
+    }
+    ok = ok && stats.getSite(0).acquired + stats.getSite(1).acquired + stats.getSite(1).timeouts == HOLDS + tries
+            && stats.getSite(1).timeouts > 0 && stats.getMaxHoldSite() == 0 && stats.getMaxHoldUs() >= 12000;
+    printf("  longest hold            %lu us at %s\n", (unsigned long)stats.getMaxHoldUs(),
+           stats.getMaxHoldSite() >= 0 ? sites[stats.getMaxHoldSite()].name : "-");
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Trace rings: two threads pinned to the two cores record at once
+// -------------------------------------------------------------------------
+// false if an event is lost or miscounted, a ring does not hold the newest
+// EVENTS_PER_CORE events in order, or a frozen/disabled trace still records
+static bool traceRun() {
+    const int32_t PER_CORE = 1000;
+    Trace::setEnabled(true);
+    Trace::begin();
+    bool ok = Trace::getStats().recorded == 0;
+
+    std::vector<std::thread> cores;
+    for (int core = 0; core < (int)Trace::CORES; core++) {
+        cores.emplace_back([core, PER_CORE]() {
+            NativeCore::pin(core);
+            for (int32_t i = 0; i < PER_CORE; i++) Trace::record(Trace::COUNTER, "trace_check", i);
+        });
+    }
+    for (std::thread& t : cores) t.join();
+
+    Trace::Stats stats = Trace::getStats();
+    ok = ok && stats.recorded == PER_CORE * Trace::CORES
+            && stats.dropped == (PER_CORE - Trace::EVENTS_PER_CORE) * Trace::CORES;
+    Trace::freeze();
+    Trace::record(Trace::COUNTER, "trace_check", -1); // Paused while exporting
+    uint32_t base = Trace::getBaseTs();
+    for (size_t core = 0; core < Trace::CORES; core++) {
+        ok = ok && Trace::getEventCount(core) == Trace::EVENTS_PER_CORE;
+        Trace::Event prev = {0, nullptr, 0, 0}, e;
+        for (size_t i = 0; Trace::getEvent(core, i, e); i++) {
+            ok = ok && e.value == PER_CORE - (int32_t)Trace::EVENTS_PER_CORE + (int32_t)i
+                    && e.phase == Trace::COUNTER && (i == 0 || e.ts >= prev.ts) && e.ts >= base;
+            prev = e;
+        }
+    }
+    Trace::thaw();
+    ok = ok && Trace::getStats().recorded == stats.recorded;
+
+    Trace::setEnabled(false);
+    Trace::record(Trace::COUNTER, "trace_check", 0);
+    ok = ok && Trace::getStats().recorded == stats.recorded;
+
+    printf("\nTrace (%zu events per core, %d per thread on each core):\n", Trace::EVENTS_PER_CORE, PER_CORE);
+    printf("  recorded %lu, dropped %lu, calibrated %lu ns/event\n", (unsigned long)stats.recorded,
+           (unsigned long)stats.dropped, (unsigned long)stats.overheadNs);
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Loop scheduler: one simulated day of the main loop
+// -------------------------------------------------------------------------
+// The loop sleeps exactly as long as runDue() says, plus 0..4 ms of job
+// work per wake-up. Jobs: the firmware's loop jobs (boot polling until 5 s,
+// sensor with one hour of rapid mode, conn, https, telegram, mqtt, heap,
+// clock), then the same with 8 more timers up to MAX_JOBS (50 ms .. 5 h,
+// beyond the wheel range too). Fixed-period jobs must run day/period times
+// and never drift more than a tick plus the job work from their period.
+static const uint32_t SIM_DAY_MS = 24UL * 3600 * 1000;
+static const uint32_t SIM_PERIODS[Scheduler::MAX_JOBS] = {
+    20, 120000, 30000, 1000, 3000, 1000, 30 * 60 * 1000, 10 * 60 * 1000,
+    50, 250, 7000, 45000, 90000, 15 * 60 * 1000, 3600UL * 1000, 5 * 3600UL * 1000};
+static uint32_t simNow;
+static uint32_t simLast[Scheduler::MAX_JOBS];
+static uint32_t simMaxJitter[Scheduler::MAX_JOBS];
+
+template <int I>
+static uint32_t simJob() {
+    if (simLast[I] != 0) {
+        uint32_t interval = simNow - simLast[I];
+        uint32_t jitter = interval > SIM_PERIODS[I] ? interval - SIM_PERIODS[I] : SIM_PERIODS[I] - interval;
+        if (I > 1 && jitter > simMaxJitter[I]) simMaxJitter[I] = jitter;
+    }
+    simLast[I] = simNow;
+    if (I == 0) return simNow < 5000 ? SIM_PERIODS[0] : Scheduler::STOP;           // boot
+    if (I == 1 && simNow >= 6 * 3600000UL && simNow < 7 * 3600000UL) return 10000; // sensor, rapid mode
+    return SIM_PERIODS[I];
+}
+
+static const Scheduler::JobFn SIM_JOBS[Scheduler::MAX_JOBS] = {
+    simJob<0>, simJob<1>, simJob<2>, simJob<3>, simJob<4>, simJob<5>, simJob<6>, simJob<7>,
+    simJob<8>, simJob<9>, simJob<10>, simJob<11>, simJob<12>, simJob<13>, simJob<14>, simJob<15>};
+
+// false if a job ran too often, too rarely or drifted from its period
+static bool schedulerDay(size_t jobs) {
+    Scheduler s;
+    const uint32_t start = 1000; // millis() at registerLoopJobs()
+    for (size_t i = 0; i < jobs; i++) {
+        s.add("sim", SIM_JOBS[i], i < 8 ? 1 : 0);
+        simLast[i] = 0;
+        simMaxJitter[i] = 0;
+    }
+    for (size_t i = 0; i < jobs; i++) s.schedule((int)i, i == 0 ? 0 : SIM_PERIODS[i], start);
+
+    uint32_t seed = 12345, maxSleep = 0;
+    simNow = start;
+    while (simNow - start < SIM_DAY_MS) {
+        uint32_t sleepMs = s.runDue(simNow);
+        if (sleepMs == Scheduler::NEVER) sleepMs = 1000; // As loop()
+        if (sleepMs > maxSleep) maxSleep = sleepMs;
+        seed = seed * 1103515245 + 12345;
+        simNow += sleepMs + (seed >> 16) % 5;
+    }
+
+    const Scheduler::Stats& st = s.getStats();
+    bool ok = s.getRuns(0) >= 200 && s.getRuns(0) <= 202 && !s.isPending(0); // 20 ms until millis() 5000
+    uint32_t sensorRuns = 23 * 30 + 360; // 2 min, one hour at 10 s
+    ok = ok && s.getRuns(1) + 2 >= sensorRuns && s.getRuns(1) <= sensorRuns + 2;
+    uint32_t worst = 0, runs = 0;
+    for (size_t i = 0; i < jobs; i++) {
+        runs += s.getRuns((int)i);
+        if (i < 2) continue;
+        uint32_t expected = SIM_DAY_MS / SIM_PERIODS[i];
+        ok = ok && s.getRuns((int)i) + 1 >= expected && s.getRuns((int)i) <= expected;
+        if (simMaxJitter[i] > worst) worst = simMaxJitter[i];
+    }
+    ok = ok && runs == st.dispatched && worst < Scheduler::TICK_MS + 5 && st.idleWakeups * 10 < st.wakeups;
+    printf("  %2zu jobs   wake-ups %7lu (idle %4lu)   runs %7lu   cascades %6lu   longest sleep %6lu ms   worst jitter %2lu ms\n",
+           jobs, (unsigned long)st.wakeups, (unsigned long)st.idleWakeups, (unsigned long)st.dispatched,
+           (unsigned long)st.cascades, (unsigned long)maxSleep, (unsigned long)worst);
+    return ok;
+}
+
+static bool schedulerRun() {
+    printf("\nLoop scheduler, one simulated day (1 ms polling: %lu wake-ups):\n", (unsigned long)SIM_DAY_MS);
+    bool ok = schedulerDay(8);
+    ok = schedulerDay(Scheduler::MAX_JOBS) && ok;
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Boot orchestration: the firmware's job graph with simulated durations
+// -------------------------------------------------------------------------
+// WiFi takes 12 s (budget 10 s); the jobs behind it must still come up.
+typedef BootManager::Job BootJob;
+static const uint32_t BOOT_TAKES_MS[(size_t)BootJob::COUNT] = {1500, 0, 12000, 0, 800, 3000, 0};
+static uint32_t bootStartedAt[(size_t)BootJob::COUNT];
+
+template <int J>
+static void bootStart() { bootStartedAt[J] = millis(); }
+template <int J>
+static bool bootPoll() { return millis() - bootStartedAt[J] >= BOOT_TAKES_MS[J]; }
+
+// false if a job starts before its dependencies are done, the slow job is
+// not flagged or blocks more than its dependents, or boot never completes
+static bool bootRun() {
+    using B = BootManager;
+    B boot;
+    boot.add(BootJob::SENSOR, "sensor", 0, bootStart<0>, bootPoll<0>, 2000);
+    boot.add(BootJob::FIRST_SCREEN, "first_screen", B::bit(BootJob::SENSOR), bootStart<1>, nullptr, 2000);
+    boot.add(BootJob::WIFI, "wifi", 0, bootStart<2>, bootPoll<2>, 10000);
+    boot.add(BootJob::WEB, "web", B::bit(BootJob::WIFI), bootStart<3>, nullptr, 1000);
+    boot.add(BootJob::NTP, "ntp", B::bit(BootJob::WIFI), bootStart<4>, bootPoll<4>, 10000);
+    boot.add(BootJob::WEATHER, "weather", B::bit(BootJob::WIFI), bootStart<5>, bootPoll<5>, 10000);
+    boot.add(BootJob::TELEGRAM, "telegram", B::bit(BootJob::WIFI) | B::bit(BootJob::NTP), bootStart<6>, nullptr, 5000);
+
+    const uint32_t t0 = millis();
+    uint32_t polls = 0;
+    while (!boot.isComplete() && millis() - t0 < 60000) {
+        boot.poll(); // The boot job runs every 20 ms
+        NativeClock::advance(20);
+        polls++;
+    }
+    boot.poll(); // Prints the timeline
+
+    auto at = [&](BootJob j) { return boot.getDoneMs(j) - (int32_t)t0; };
+    bool ok = boot.isComplete() && boot.isLate(BootJob::WIFI);
+    for (size_t j = 0; j < (size_t)BootJob::COUNT; j++) {
+        ok = ok && (j == (size_t)BootJob::WIFI || !boot.isLate((BootJob)j));
+    }
+    // Independent jobs run side by side; dependents start within one poll of their last dependency
+    ok = ok && at(BootJob::SENSOR) <= 1520 && at(BootJob::FIRST_SCREEN) <= at(BootJob::SENSOR) + 20;
+    ok = ok && at(BootJob::WIFI) >= 12000 && at(BootJob::WIFI) <= 12020 && at(BootJob::WEB) <= at(BootJob::WIFI) + 20;
+    ok = ok && at(BootJob::NTP) >= at(BootJob::WIFI) + 800 && at(BootJob::NTP) <= at(BootJob::WIFI) + 840;
+    ok = ok && at(BootJob::TELEGRAM) >= at(BootJob::NTP) && at(BootJob::TELEGRAM) <= at(BootJob::NTP) + 20;
+    ok = ok && at(BootJob::WEATHER) <= at(BootJob::WIFI) + 3040;
+    printf("\nBoot (WiFi 12 s against a 10 s budget, %lu polls):\n", (unsigned long)polls);
+    for (size_t j = 0; j < (size_t)BootJob::COUNT; j++) {
+        printf("  %-12s done at %6ld ms%s\n", boot.getName((BootJob)j), (long)at((BootJob)j),
+               boot.isLate((BootJob)j) ? "  (late)" : "");
+    }
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Shared TLS client: request task vs idle reaper (stand-in client)
+// -------------------------------------------------------------------------
+// The weather task makes back-to-back requests on the keep-alive client.
+// The loop task runs the idle reaper with the clock advanced past the
+// timeout on every 4th pass, so it tries to close the connection very
+// often, and the web task reads the connection state for /api/status.
+// false if two tasks ever used the client at once, a request ran on a
+// connection closed under it, or a request went uncounted.
+static bool tlsRun() {
+    const int REQUESTS = 2000;
+    HttpsManager https;
+    WiFiClientSecure& client = https.client(HttpsManager::Host::WEATHER);
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> lost{0};
+    std::thread weather([&]() {
+        for (int i = 0; i < REQUESTS; i++) {
+            if (!https.ensureConnected(HttpsManager::Host::WEATHER)) continue;
+            if (!client.request(30)) lost++;
+            https.touch(HttpsManager::Host::WEATHER);
+            std::this_thread::sleep_for(std::chrono::microseconds(50)); // Idle window for the reaper
+        }
+        done = true;
+    });
+    std::thread web([&]() {
+        while (!done) https.isConnected(HttpsManager::Host::WEATHER);
+    });
+    uint32_t passes = 0;
+    while (!done) {
+        if (passes % 4 == 0) NativeClock::advance(16000); // Past the 15 s weather idle timeout
+        https.update();
+        passes++;
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    weather.join();
+    web.join();
+
+    const HttpsManager::Stats& s = https.getStats(HttpsManager::Host::WEATHER);
+    uint32_t overlaps = WiFiClientSecure::overlaps, closed = WiFiClientSecure::closedRequests;
+    printf("\nShared TLS client (weather requests vs idle reaper vs status reads, stand-in client):\n");
+    printf("  %lu requests: %lu reused, %lu handshakes, %lu idle closes in %lu reaper passes; "
+           "overlapping calls %lu, requests on a closed connection %lu\n",
+           (unsigned long)s.requests, (unsigned long)s.reused, (unsigned long)s.handshakes,
+           (unsigned long)s.idleCloses, (unsigned long)passes, (unsigned long)overlaps, (unsigned long)closed);
+    return overlaps == 0 && closed == 0 && lost == 0 && s.requests == (uint32_t)REQUESTS && s.failures == 0
+        && s.reused + s.handshakes == s.requests && s.idleCloses > 0 && s.reused > 0;
+}
+
+// -------------------------------------------------------------------------
+// Streaming admission: 20 clients against a 4-slot /api/history pool
+// -------------------------------------------------------------------------
+// Each client makes 5 requests. A request either gets a slot and streams the
+// full ring in TCP-sized chunks (1 ms yield per chunk, as vTaskDelay(1) on
+// the device), or is turned away and retries after Retry-After (scaled to
+// 20 ms). Every 7th stream is dropped after two chunks (client went away).
+// Allocations per request are checked by the stream_pool/lease row.
+// false if a body is truncated, the pool overbooks or a slot leaks.
+static bool streamLoadRun(SensorManager& sm) {
+    const int CLIENTS = 20, REQUESTS = 5;
+    static StreamPool<HistoryJsonWriter, 4> pool("history");
+    std::atomic<uint32_t> bad{0}, retries{0}, full{0};
+    std::atomic<uint64_t> waitMs{0};
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int c = 0; c < CLIENTS; c++) {
+        clients.emplace_back([&, c]() {
+            std::string body;
+            uint8_t buffer[1436];
+            for (int r = 0; r < REQUESTS; r++) {
+                auto asked = std::chrono::steady_clock::now();
+                std::function<size_t(uint8_t*, size_t)> response;
+                for (;;) {
+                    auto writer = pool.acquire(&sm, (uint32_t)0);
+                    if (writer) {
+                        response = [writer](uint8_t* buf, size_t maxLen) -> size_t {
+                            if (writer->isDone()) return 0;
+                            return writer->fill(buf, maxLen);
+                        };
+                        break;
+                    }
+                    retries++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Retry-After
+                }
+                waitMs += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - asked).count();
+                bool drop = (c * REQUESTS + r) % 7 == 0;
+                body.clear();
+                for (int chunk = 0;; chunk++) {
+                    if (drop && chunk == 2) break;
+                    size_t n = response(buffer, sizeof(buffer));
+                    if (n == 0) break;
+                    body.append((const char*)buffer, n);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                response = nullptr; // Response deleted: lease released
+                if (drop) continue;
+                size_t records = 0;
+                for (char ch : body) records += ch == '{';
+                if (body.empty() || body.front() != '[' || body.back() != ']' || records != HISTORY_SIZE) bad++;
+                else full++;
+            }
+        });
+    }
+    for (std::thread& t : clients) t.join();
+    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    StreamSlots::Stats s = pool.getStats();
+    uint32_t streams = CLIENTS * REQUESTS;
+    printf("\nStreaming admission (%d clients x %d requests, %lu-slot pool, 1436-byte chunks):\n",
+           CLIENTS, REQUESTS, (unsigned long)s.capacity);
+    printf("  served %lu  completed %lu  aborted %lu  rejected (503) %lu  peak %lu  bad bodies %lu\n",
+           (unsigned long)s.served, (unsigned long)s.completed, (unsigned long)s.aborted,
+           (unsigned long)s.rejected, (unsigned long)s.peak, (unsigned long)bad.load());
+    printf("  %.0f ms total, avg wait for a slot %.1f ms, longest stream %lu ms\n",
+           wall, (double)waitMs / streams, (unsigned long)s.maxDurationMs);
+    return bad == 0 && s.served == streams && s.completed == full && s.completed + s.aborted == streams
+        && s.inUse == 0 && s.peak == s.capacity && s.rejected == retries && s.rejected > 0;
+}
+
+// -------------------------------------------------------------------------
+// Weather fetch state machine: scripted transport (delays, errors, bodies)
+// -------------------------------------------------------------------------
+struct WeatherBench {
+    static uint32_t step(WeatherManager& w) { bool fetched; return w.step(fetched); }
+    static uint8_t failures(const WeatherManager& w) { return w.consecutiveFailures; }
+};
+
+// open-meteo response for 'now': current block + 48 h from the current hour
+static std::string openMeteoBody(uint32_t now) {
+    char buf[128];
+    uint32_t hour = now - now % 3600;
+    std::string s = "{\"latitude\":55.75,\"longitude\":37.625,\"utc_offset_seconds\":0,\"timezone\":\"GMT\",";
+    snprintf(buf, sizeof(buf), "\"current\":{\"time\":%u,\"interval\":900,\"temperature_2m\":8.4,\"relative_humidity_2m\":77},",
+             now - now % 900);
+    s += buf;
+    const char* series[3] = {"time", "temperature_2m", "relative_humidity_2m"};
+    s += "\"hourly\":{";
+    for (int k = 0; k < 3; k++) {
+        s += k ? "],\"" : "\"";
+        s += series[k];
+        s += "\":[";
+        for (size_t i = 0; i < HourlyForecast::HOURS; i++) {
+            if (k == 0) snprintf(buf, sizeof(buf), "%s%u", i ? "," : "", hour + (uint32_t)i * 3600);
+            else if (k == 1) snprintf(buf, sizeof(buf), "%s%.1f", i ? "," : "", 8.0 + 0.1 * i);
+            else snprintf(buf, sizeof(buf), "%s%d", i ? "," : "", 70 + (int)(i % 10));
+            s += buf;
+        }
+    }
+    return s + "]}}";
+}
+
+// Response body as an ArduinoJson input (read()/readBytes(), like the HTTP
+// stream): handed out in pieces of at most `piece` bytes, with a pause before
+// each piece (a slow server).
+struct PieceReader {
+    const std::string& body;
+    size_t piece;
+    uint32_t pauseUs;
+    size_t pos;
+
+    PieceReader(const std::string& body, size_t piece, uint32_t pauseUs = 0)
+        : body(body), piece(piece), pauseUs(pauseUs), pos(0) {}
+    int read() {
+        char c;
+        return readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+    }
+    size_t readBytes(char* out, size_t len) {
+        if (pos >= body.size()) return 0;
+        if (pos % piece == 0 && pauseUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(pauseUs));
+        size_t n = min(len, min(body.size() - pos, piece - pos % piece));
+        memcpy(out, body.data() + pos, n);
+        pos += n;
+        return n;
+    }
+};
+
+// Replays one scripted reply per attempt. The body is read in 256-byte pieces
+// with the reply's delay spread over them (a slow server), outside any lock.
+struct ScriptedWeather : WeatherTransport {
+    struct Reply {
+        bool online;
+        int status;             // 200, an HTTP error, or < 0 = no response
+        std::string body;
+        uint32_t delayMs;
+    };
+    std::vector<Reply> script;
+    size_t next = 0;
+
+    bool isOnline() override {
+        if (next < script.size() && !script[next].online) {
+            next++;
+            return false;
+        }
+        return next < script.size();
+    }
+    bool get(const char*, ForecastParser& parser, char* error, size_t errorLen) override {
+        const Reply& r = script[next++];
+        if (r.status != 200) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(r.delayMs));
+            if (r.status > 0) snprintf(error, errorLen, "HTTP %d", r.status);
+            else strlcpy(error, "Timeout/Conn Error", errorLen);
+            return false;
+        }
+        size_t pieces = (r.body.size() + 255) / 256;
+        PieceReader body(r.body, 256, pieces ? r.delayMs * 1000 / pieces : 0);
+        return parser.parse(body, error, errorLen);
+    }
+};
+
+// false if the retry delays leave the backoff window, or a slow fetch blocks a reader
+static bool weatherRun() {
+    const uint32_t RETRY_BASE_MS = 5000, UPDATE_MS = 600000, OFFLINE_MS = 2000;
+    uint32_t now = time(NULL);
+    std::string good = openMeteoBody(now);
+    bool ok = true;
+
+    // Backoff: ten failures of every kind, offline, success, one more failure
+    {
+        ScriptedWeather net;
+        net.script = {
+            {true, 500, "", 0}, {true, -1, "", 0}, {true, 200, good.substr(0, 300), 0},
+            {true, 200, "{\"current\":{\"time\";1}}", 0},
+            {true, 200, "{\"reason\":\"Parameter 'hourly' is invalid\",\"error\":true}", 0},
+            {true, 503, "", 0}, {true, 500, "", 0}, {true, 500, "", 0}, {true, -1, "", 0}, {true, 500, "", 0},
+            {false, 0, "", 0}, {true, 200, good, 0}, {true, 500, "", 0},
+        };
+        WeatherManager weather(&net);
+        printf("\nWeather fetch (scripted transport):\n  retry delays (s):");
+        char status[64];
+        for (uint32_t k = 1; k <= 10; k++) {
+            uint32_t delay = WeatherBench::step(weather);
+            uint32_t ceiling = min(RETRY_BASE_MS << min(k - 1, (uint32_t)7), UPDATE_MS);
+            printf(" %.1f", delay / 1000.0);
+            if (delay < ceiling / 2 || delay > ceiling || WeatherBench::failures(weather) != k) ok = false;
+            if (k == 3 || k == 4 || k == 5) {
+                weather.getStatus(status, sizeof(status));
+                if (strncmp(status, k == 5 ? "API Error" : "JSON Error", k == 5 ? 9 : 10) != 0) ok = false;
+            }
+        }
+        uint32_t offline = WeatherBench::step(weather);
+        uint8_t failuresOffline = WeatherBench::failures(weather);
+        uint32_t fetched = WeatherBench::step(weather);
+        weather.getStatus(status, sizeof(status));
+        bool updated = strcmp(status, "OK (Updated)") == 0;
+        HourlyForecast f;
+        weather.copyForecast(f);
+        uint32_t retry = WeatherBench::step(weather);
+        weather.getStatus(status, sizeof(status));
+        bool keepsForecast = weather.isDataValid() && strncmp(status, "Forecast / HTTP 500", 19) == 0;
+        printf("\n  offline %.1f s (failures kept at %u), success %.0f s (%zu h from %u), then retry %.1f s: \"%s\"\n",
+               offline / 1000.0, failuresOffline, fetched / 1000.0, f.size(), f.getStartTime(), retry / 1000.0, status);
+        ok = ok && offline == OFFLINE_MS && failuresOffline == 10 && fetched == UPDATE_MS && updated &&
+             f.size() == HourlyForecast::HOURS && f.getStartTime() == now - now % 3600 &&
+             retry >= RETRY_BASE_MS / 2 && retry <= RETRY_BASE_MS && keepsForecast;
+    }
+
+    // Readers during slow fetches (400 ms body, 400 ms timeout): the loop and the
+    // sensor task keep their pace and see the previous result until the new one lands
+    {
+        ScriptedWeather net;
+        net.script = {{true, 200, good, 0}, {true, 200, good, 400}, {true, -1, "", 400}};
+        WeatherManager weather(&net);
+        WeatherBench::step(weather); // Something to read
+        SensorManager sm;
+        sm.setWeatherManager(&weather);
+        for (int attempt = 0; attempt < 2; attempt++) {
+            uint32_t version = weather.getForecastVersion();
+            std::atomic<bool> done{false};
+            std::thread task([&]() {
+                WeatherBench::step(weather);
+                done = true;
+            });
+            double maxUs = 0;
+            uint32_t reads = 0;
+            bool stale = true;
+            char status[64];
+            HourlyForecast f;
+            while (!done) {
+                auto t0 = std::chrono::steady_clock::now();
+                SensorBench::processReading(sm, 21.0f, 50.0f); // Sensor task: outdoor values for the mold model
+                sm.update();                                   // Loop: advice + plan
+                weather.getStatus(status, sizeof(status));     // /api/status
+                weather.copyForecast(f);
+                double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+                maxUs = max(maxUs, us);
+                stale = stale && (done || weather.getForecastVersion() == version);
+                reads++;
+                NativeClock::advance(2100); // Advice due on every update()
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            task.join();
+            bool landed = weather.getForecastVersion() == version + (attempt == 0 ? 1 : 0);
+            printf("  %s fetch: %u reader passes meanwhile, slowest %.0f us, %s\n",
+                   attempt == 0 ? "slow (400 ms body)" : "timeout (400 ms)  ", reads, maxUs,
+                   landed ? (attempt == 0 ? "new forecast published after it" : "previous forecast kept") : "WRONG RESULT");
+            ok = ok && landed && stale && reads > 100 && maxUs < 20000;
+        }
+    }
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Heap tags: attribution across tasks, nested scopes, table overflow
+// -------------------------------------------------------------------------
+// false if a tag does not return to its starting point or misattributes
+static bool heapTagRun() {
+    using namespace HeapTags;
+    static char* blocks[700];
+    const Stats mqtt0 = getStats(MQTT), tg0 = getStats(TELEGRAM), tls0 = getStats(TLS);
+    const size_t tracked0 = getTracked();
+    bool ok = true;
+
+    // A task-wide tag: blocks allocated by one thread, half freed by another
+    std::thread producer([]() {
+        setTaskTag(MQTT);
+        for (int i = 0; i < 100; i++) blocks[i] = new char[100 + i];
+    });
+    producer.join();
+    Stats s = getStats(MQTT);
+    ok = ok && s.current - mqtt0.current == 100 * 100 + 4950 && s.blocks - mqtt0.blocks == 100;
+    for (int i = 0; i < 100; i += 2) delete[] blocks[i]; // This thread is untagged
+    s = getStats(MQTT);
+    ok = ok && s.frees - mqtt0.frees == 50 && s.blocks - mqtt0.blocks == 50;
+    uint32_t halfPeak = s.peak;
+
+    // Nested scopes: the inner tag wins, the outer one is restored
+    {
+        Scope outer(TELEGRAM);
+        blocks[200] = new char[1000];
+        {
+            Scope inner(TLS);
+            blocks[201] = new char[16384];
+        }
+        blocks[202] = new char[24];
+    }
+    blocks[203] = new char[64]; // Untagged again
+    ok = ok && getStats(TELEGRAM).current - tg0.current == 1024 && getStats(TLS).current - tls0.current == 16384;
+    for (int i = 200; i < 204; i++) delete[] blocks[i];
+
+    // Overflow: blocks beyond the table limit are counted, not tracked
+    uint32_t untracked0 = getUntracked();
+    {
+        Scope tag(MQTT);
+        for (int i = 300; i < 700; i++) blocks[i] = new char[8];
+    }
+    size_t room = TABLE_LIMIT - tracked0 - 50;
+    ok = ok && getUntracked() - untracked0 == (400 > room ? 400 - room : 0);
+    for (int i = 300; i < 700; i++) delete[] blocks[i];
+    for (int i = 1; i < 100; i += 2) delete[] blocks[i];
+
+    printf("\nHeap tags (100 blocks from a tagged thread, half freed elsewhere; nested scopes; %u blocks over the table):\n",
+           (unsigned)(getUntracked() - untracked0));
+    for (uint8_t i = 0; i < TAG_COUNT; i++) {
+        Stats t = getStats((Tag)i);
+        if (t.allocs == 0) continue;
+        printf("  %-12s current %6lu  peak %7lu  blocks %4lu  allocs %9lu  frees %9lu\n", getName((Tag)i),
+               (unsigned long)t.current, (unsigned long)t.peak, (unsigned long)t.blocks,
+               (unsigned long)t.allocs, (unsigned long)t.frees);
+    }
+    ok = ok && getTracked() == tracked0 && getStats(MQTT).current == mqtt0.current
+            && getStats(TELEGRAM).current == tg0.current && getStats(TLS).current == tls0.current
+            && halfPeak >= mqtt0.current + 14950 && getStats(OTHER).current == 0;
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Series file: write, mmap and query a multi-million-point file
+// -------------------------------------------------------------------------
+static double elapsedMs(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void seriesFileRun(size_t points) {
+    const char* path = "/tmp/acm1_series_bench.ams";
+    const uint32_t start = 1700000000;
+    const uint32_t step = 30; // One point per 30 s (airing rate)
+    printf("\nSeries file (%zu points, one per %u s, %.1f years):\n", points, step, points * step / 3.15e7);
+
+    auto t0 = std::chrono::steady_clock::now();
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        printf("  cannot write %s\n", path);
+        return;
+    }
+    SeriesWriter writer(SeriesFormat::COL_T | SeriesFormat::COL_H, start);
+    for (size_t i = 0; i < points; i++) {
+        uint32_t ts = start + i * step;
+        float day = (ts % 86400) / 86400.0f * 6.2832f;
+        float t = 21.0f + 2.0f * sinf(day) + (i % 7) * 0.01f;
+        float h = 50.0f - 8.0f * sinf(day) + (i % 11) * 0.05f;
+        while (!writer.append(ts, t, h)) writer.writeTo(f);
+    }
+    writer.finish();
+    writer.writeTo(f);
+    fclose(f);
+    double writeMs = elapsedMs(t0);
+
+    MappedFile file;
+    t0 = std::chrono::steady_clock::now();
+    SeriesReader reader;
+    if (!file.open(path) || !reader.open(file.data(), file.size())) {
+        printf("  cannot open %s\n", path);
+        return;
+    }
+    double openUs = elapsedMs(t0) * 1000;
+    t0 = std::chrono::steady_clock::now();
+    bool ok = reader.verify();
+    double verifyMs = elapsedMs(t0);
+    printf("  size                    %.1f MB (%.2f B/point; /api/history JSON ~38 B/point)\n",
+           file.size() / 1e6, (double)file.size() / points);
+    printf("  write                   %.0f ms (%.1f M points/s), verify %.0f ms (%s), open %.1f us\n",
+           writeMs, points / writeMs / 1000, verifyMs, ok ? "ok" : "FAILED", openUs);
+
+    uint32_t end = start + (points - 1) * step;
+    t0 = std::chrono::steady_clock::now();
+    SeriesReader::Stats all = reader.aggregate(0, UINT32_MAX, SeriesFormat::COL_T);
+    double scanMs = elapsedMs(t0);
+    printf("  full scan (avg t)       %.1f ms (%.2f ns/point, %llu points, avg %.2f)\n",
+           scanMs, scanMs * 1e6 / points, (unsigned long long)all.count, all.sum / all.count);
+
+    // Random ranges: binary search in the index, then scan only the covered blocks
+    const uint32_t spans[] = {3600, 86400, 30 * 86400};
+    const char* names[] = {"1 h", "1 day", "30 days"};
+    uint32_t seed = 12345;
+    volatile double sink = 0;
+    (void)sink;
+    for (size_t k = 0; k < 3; k++) {
+        const int queries = 1000;
+        t0 = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; q++) {
+            seed = seed * 1103515245 + 12345;
+            uint32_t from = start + (uint32_t)((uint64_t)(seed >> 8) * (end - start - spans[k]) >> 24);
+            sink = reader.aggregate(from, from + spans[k], SeriesFormat::COL_H).sum;
+        }
+        printf("  range avg h %-11s %8.2f us/query\n", names[k], elapsedMs(t0) * 1000 / queries);
+    }
+
+    // Max over a year: scanning every point vs block headers for the inner blocks
+    uint32_t yearFrom = start + (end - start) / 3;
+    t0 = std::chrono::steady_clock::now();
+    SeriesReader::Stats scan = reader.aggregate(yearFrom, yearFrom + 365 * 86400, SeriesFormat::COL_T);
+    double scanYearUs = elapsedMs(t0) * 1000;
+    t0 = std::chrono::steady_clock::now();
+    SeriesReader::Stats headers = reader.aggregate(yearFrom, yearFrom + 365 * 86400, SeriesFormat::COL_T, true);
+    double headerYearUs = elapsedMs(t0) * 1000;
+    printf("  max t over 1 year       scan %.0f us, block headers %.1f us (%.2f / %.2f)\n",
+           scanYearUs, headerYearUs, scan.max, headers.max);
+    file.close();
+    remove(path);
+}
+
+// -------------------------------------------------------------------------
+// Forecast parser: open-meteo responses from bench/fixtures, fed in pieces
+// -------------------------------------------------------------------------
+static std::string readFixture(const char* path) {
+    std::string out;
+    if (FILE* f = fopen(path, "rb")) {
+        char buf[1024];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+        fclose(f);
+    }
+    return out;
+}
+
+static bool parseForecast(ForecastParser& parser, const std::string& body, size_t chunk, char* error, size_t errorLen) {
+    PieceReader reader(body, chunk);
+    return parser.parse(reader, error, errorLen);
+}
+
+// false if a response parses differently from what it contains, or depends on how it is split
+static bool forecastRun() {
+    struct Case {
+        const char* name;
+        std::string body;
+        const char* error;      // Expected prefix, nullptr = parses
+        uint32_t start;         // hourly.time[0]
+        size_t points;
+        float tAt1500;          // Forecast at 15:00 (the hour of current.time)
+    };
+    std::string full = readFixture("bench/fixtures/openmeteo_48h.json");
+    std::string broken = full;
+    broken[broken.find("\"hourly\":") + 8] = ';';
+    std::vector<Case> cases = {
+        {"48h", full, nullptr, 1729263600, 48, 10.5f},
+        {"days", readFixture("bench/fixtures/openmeteo_days.json"), nullptr, 1729209600, 48, 10.8f},
+        {"nulls", readFixture("bench/fixtures/openmeteo_nulls.json"), nullptr, 1729263600, 40, 10.5f},
+        {"error", readFixture("bench/fixtures/openmeteo_error.json"), "API Error: Cannot initialize", 0, 0, NAN},
+        {"truncated", full.substr(0, full.size() / 2), "JSON Error: IncompleteInput", 0, 0, NAN},
+        {"malformed", broken, "JSON Error: InvalidInput", 0, 0, NAN},
+    };
+
+    bool ok = true;
+    ForecastParser parser;
+    printf("\nForecast parser (open-meteo fixtures, fed in 1 / 7 / 256 / all bytes):\n");
+    for (const Case& c : cases) {
+        if (c.body.empty()) {
+            printf("  %-10s fixture missing\n", c.name);
+            ok = false;
+            continue;
+        }
+        const size_t chunks[] = {1, 7, 256, c.body.size()};
+        char first[64] = "";
+        HourlyForecast ref;
+        bool same = true, parsed = false;
+        for (size_t chunk : chunks) {
+            char error[64] = "";
+            HourlyForecast f;
+            parsed = parseForecast(parser, c.body, chunk, error, sizeof(error));
+            if (parsed) parser.copyForecast(f);
+            if (chunk == 1) {
+                strlcpy(first, error, sizeof(first));
+                ref = f;
+            } else if (strcmp(first, error) != 0 || f.size() != ref.size() || f.getStartTime() != ref.getStartTime()) {
+                same = false;
+            } else {
+                for (size_t i = 0; i < f.size(); i++) {
+                    HourlyForecast::Point a = f.at(i), b = ref.at(i);
+                    if (memcmp(&a, &b, sizeof(a)) != 0) same = false;
+                }
+            }
+        }
+
+        bool pass = same;
+        if (c.error) {
+            pass = pass && !parsed && strncmp(first, c.error, strlen(c.error)) == 0;
+            printf("  %-10s %5zu bytes  rejected: %s\n", c.name, c.body.size(), first);
+        } else {
+            float t = NAN, rh, ah;
+            ref.sample(1729263600, t, rh, ah);
+            pass = pass && parsed && parser.getTime() == 1729264500 && fabsf(parser.getTemp() - 10.8f) < 0.01f &&
+                   parser.getHum() == 66.0f && ref.getStartTime() == c.start && ref.size() == c.points &&
+                   fabsf(t - c.tAt1500) < 0.01f;
+            printf("  %-10s %5zu bytes  start %u, %zu h, 15:00 forecast %.1f C (expected %.1f)\n",
+                   c.name, c.body.size(), ref.getStartTime(), ref.size(), t, c.tAt1500);
+        }
+        if (!same) printf("  %-10s result depends on how the body is split\n", c.name);
+        ok = ok && pass;
+    }
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Chart + PNG: the encoder output is decoded with zlib and compared with
+// the rendered bitmap and with a golden image (CHART_GOLDEN=write records it)
+// -------------------------------------------------------------------------
+static const char* CHART_GOLDEN = "bench/fixtures/chart_24h.png";
+
+// 25 h of 3-minute records: daily temperature swing, two airings, a 1 h gap
+static uint32_t fillChartHistory(SensorManager& sm) {
+    const uint32_t start = 1700000000;
+    const size_t points = 25 * 20;
+    for (size_t i = 0; i < points; i++) {
+        if (i >= 300 && i < 320) continue; // Sensor offline: the line breaks
+        float t = 21.5f + 1.2f * sinf(i * 2 * (float)M_PI / 480);
+        float h = 52.0f - 4.0f * sinf(i * 2 * (float)M_PI / 480);
+        if ((i >= 120 && i < 127) || (i >= 400 && i < 405)) { // Window open
+            t -= 0.4f * (i % 10);
+            h -= 3.0f * (i % 10);
+        }
+        SensorBench::appendHistory(sm, {start + (uint32_t)i * 180, t, h});
+    }
+    return start + (uint32_t)(points - 1) * 180;
+}
+
+static std::vector<uint8_t> encodePng(const uint8_t* bitmap, uint16_t width, uint16_t height) {
+    PngEncoder png(bitmap, width, height);
+    std::vector<uint8_t> out(png.totalSize());
+    size_t n = 0;
+    while (png.available()) n += png.read(out.data() + n, out.size() - n);
+    out.resize(n);
+    return out;
+}
+
+static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Independent decoder for the subset the encoder emits (1-bit grayscale, no
+// interlace, filter None); checks every chunk CRC and the zlib stream.
+// Fills packed rows in the encoder's bitmap layout. Returns nullptr or an error.
+static const char* decodePng(const std::vector<uint8_t>& png, uint16_t& width, uint16_t& height,
+                             std::vector<uint8_t>& pixels) {
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (png.size() < 8 || memcmp(png.data(), SIGNATURE, 8) != 0) return "bad signature";
+    std::vector<uint8_t> idat;
+    bool ihdr = false, iend = false;
+    for (size_t pos = 8; pos < png.size() && !iend;) {
+        if (pos + 12 > png.size()) return "truncated chunk";
+        uint32_t len = readU32(&png[pos]);
+        if (pos + 12 + len > png.size()) return "truncated chunk";
+        const uint8_t* type = &png[pos + 4];
+        const uint8_t* data = type + 4;
+        if (crc32(0, type, len + 4) != readU32(data + len)) return "chunk CRC mismatch";
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (len != 13 || data[8] != 1 || data[9] != 0 || data[12] != 0) return "unexpected IHDR";
+            width = (uint16_t)readU32(data);
+            height = (uint16_t)readU32(data + 4);
+            ihdr = true;
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            idat.insert(idat.end(), data, data + len);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            iend = true;
+        }
+        pos += 12 + len;
+    }
+    if (!ihdr || !iend) return "missing IHDR or IEND";
+
+    const size_t rowBytes = (width + 7) / 8;
+    std::vector<uint8_t> raw((rowBytes + 1) * height);
+    uLongf rawLen = raw.size();
+    if (uncompress(raw.data(), &rawLen, idat.data(), idat.size()) != Z_OK) return "inflate failed";
+    if (rawLen != raw.size()) return "wrong image data size";
+    pixels.clear();
+    for (size_t r = 0; r < height; r++) {
+        const uint8_t* line = &raw[r * (rowBytes + 1)];
+        if (line[0] != 0) return "unexpected filter type";
+        pixels.insert(pixels.end(), line + 1, line + 1 + rowBytes);
+    }
+    return nullptr;
+}
+
+// Decoded pixels equal the source (padding bits past the width are ignored)
+static bool samePixels(const std::vector<uint8_t>& pixels, const uint8_t* bitmap, uint16_t width, uint16_t height) {
+    const size_t rowBytes = (width + 7) / 8;
+    const uint8_t lastMask = (uint8_t)(0xFF00 >> (width - (rowBytes - 1) * 8));
+    if (pixels.size() != rowBytes * height) return false;
+    for (size_t i = 0; i < pixels.size(); i++) {
+        uint8_t mask = (i % rowBytes == rowBytes - 1) ? lastMask : 0xFF;
+        if ((pixels[i] ^ bitmap[i]) & mask) return false;
+    }
+    return true;
+}
+
+// false if a PNG does not decode to its source bitmap or the chart drifts from the golden image
+static bool pngRun() {
+    SensorManager sm;
+    uint32_t now = fillChartHistory(sm);
+    static uint8_t chart[ChartRenderer::BITMAP_SIZE];
+    ChartRenderer renderer(&sm);
+    if (!renderer.render(chart, now)) {
+        printf("\nChart: nothing rendered\n");
+        return false;
+    }
+    size_t black = 0;
+    for (uint8_t b : chart) black += 8 - __builtin_popcount(b);
+
+    // Encoder round trips: the chart, blank and full images, noise, odd sizes
+    struct Image {
+        const char* name;
+        uint16_t width, height;
+        std::vector<uint8_t> bits;
+    };
+    std::vector<Image> images;
+    images.push_back({"chart", ChartRenderer::WIDTH, ChartRenderer::HEIGHT,
+                      std::vector<uint8_t>(chart, chart + sizeof(chart))});
+    images.push_back({"white", 256, 128, std::vector<uint8_t>(4096, 0xFF)});
+    images.push_back({"black", 256, 128, std::vector<uint8_t>(4096, 0x00)});
+    std::vector<uint8_t> noise(4096);
+    uint32_t seed = 1;
+    for (uint8_t& b : noise) b = (uint8_t)((seed = seed * 1103515245 + 12345) >> 16);
+    images.push_back({"noise", 256, 128, noise});
+    images.push_back({"noise 100x37", 100, 37, std::vector<uint8_t>(noise.begin(), noise.begin() + 13 * 37)});
+    images.push_back({"1x1", 1, 1, std::vector<uint8_t>(1, 0x7F)});
+
+    bool ok = true;
+    printf("\nChart + PNG (24 h, %ux%u, %zu black pixels):\n", ChartRenderer::WIDTH, ChartRenderer::HEIGHT, black);
+    for (const Image& img : images) {
+        std::vector<uint8_t> png = encodePng(img.bits.data(), img.width, img.height);
+        std::vector<uint8_t> pixels;
+        uint16_t w = 0, h = 0;
+        const char* error = decodePng(png, w, h, pixels);
+        if (!error && (w != img.width || h != img.height)) error = "wrong size";
+        if (!error && !samePixels(pixels, img.bits.data(), img.width, img.height)) error = "pixels differ";
+        printf("  %-14s %6zu bytes (raw %5zu)  %s\n", img.name, png.size(), img.bits.size(), error ? error : "decodes to source");
+        ok = ok && !error;
+    }
+
+    // Golden image: catches renderer changes (layout, font, scaling)
+    std::vector<uint8_t> png = encodePng(chart, ChartRenderer::WIDTH, ChartRenderer::HEIGHT);
+    const char* mode = getenv("CHART_GOLDEN");
+    if (mode && strcmp(mode, "write") == 0) {
+        FILE* f = fopen(CHART_GOLDEN, "wb");
+        bool written = f && fwrite(png.data(), 1, png.size(), f) == png.size();
+        if (f) fclose(f);
+        printf("  golden %s %s\n", CHART_GOLDEN, written ? "written" : "NOT written");
+        return ok && written;
+    }
+    std::string file = readFixture(CHART_GOLDEN);
+    std::vector<uint8_t> golden(file.begin(), file.end());
+    std::vector<uint8_t> pixels;
+    uint16_t w = 0, h = 0;
+    const char* error = golden.empty() ? "missing" : decodePng(golden, w, h, pixels);
+    if (!error && (w != ChartRenderer::WIDTH || h != ChartRenderer::HEIGHT)) error = "wrong size";
+    if (!error && !samePixels(pixels, chart, w, h)) error = "pixels differ from the rendered chart";
+    printf("  golden %s  %s\n", CHART_GOLDEN, error ? error : "matches");
+    return ok && !error;
+}
+
+// -------------------------------------------------------------------------
+// OLED partial refresh: frame diff on frames laid out like the SSD1306
+// -------------------------------------------------------------------------
+// Digits, '.' and ':' of the 5x7 Adafruit GFX font (columns, bit 0 = top row)
+static const uint8_t OLED_GLYPHS[12][5] = {
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x72, 0x49, 0x49, 0x49, 0x46},
+    {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},
+    {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07}, {0x36, 0x49, 0x49, 0x49, 0x36},
+    {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x60, 0x60, 0x00, 0x00}, {0x00, 0x36, 0x36, 0x00, 0x00}};
+
+// print() at (x, y) with setTextSize(size), into an SSD1306 page buffer
+static void oledPrint(uint8_t* frame, int x, int y, const char* text, int size) {
+    for (; *text; text++, x += 6 * size) {
+        int g = *text == '.' ? 10 : *text == ':' ? 11 : *text - '0';
+        for (int c = 0; c < 5; c++) {
+            for (int r = 0; r < 7; r++) {
+                if (!(OLED_GLYPHS[g][c] >> r & 1)) continue;
+                for (int dx = 0; dx < size; dx++) {
+                    for (int dy = 0; dy < size; dy++) {
+                        int px = x + c * size + dx, py = y + r * size + dy;
+                        frame[(py / 8) * FrameDiff::WIDTH + px] |= 1 << (py % 8);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Values of the live page (DisplayManager::renderLive(), labels left out)
+static void oledLive(uint8_t* frame, const char* t, const char* h, const char* dp, const char* mold) {
+    memset(frame, 0, FrameDiff::FRAME_SIZE);
+    oledPrint(frame, 0, 16, t, 2);
+    oledPrint(frame, 70, 16, h, 2);
+    oledPrint(frame, 18, 44, dp, 1);
+    oledPrint(frame, 100, 44, mold, 1);
+}
+
+// Drains every dirty page like DisplayManager::flush(); returns the I2C bytes
+// (window commands, 64-byte data transactions, address + control byte each).
+// false in 'ok' if a segment is not exactly the changed columns of 'frame'.
+static uint32_t oledFlush(FrameDiff& diff, const uint8_t* frame, const uint8_t* before, bool& ok) {
+    uint32_t bytes = 0;
+    uint8_t segment[FrameDiff::WIDTH];
+    for (uint8_t page = 0; page < FrameDiff::PAGES; page++) {
+        const uint8_t* now = frame + page * FrameDiff::WIDTH;
+        int first = -1, last = -1;
+        for (int c = 0; c < FrameDiff::WIDTH; c++) {
+            if (before && now[c] == before[page * FrameDiff::WIDTH + c]) continue;
+            if (first < 0) first = c;
+            last = c;
+        }
+        uint8_t lo, hi;
+        if (!diff.takePage(page, lo, hi, segment)) {
+            ok = ok && first < 0;
+            continue;
+        }
+        ok = ok && lo == first && hi == last && memcmp(segment, now + lo, hi - lo + 1) == 0
+                && !diff.isPageDirty(page);
+        bytes += 6 + 2;
+        for (size_t len = hi - lo + 1, off = 0; off < len; off += 64) bytes += (len - off < 64 ? len - off : 64) + 2;
+    }
+    return bytes;
+}
+
+static size_t countDiff(const uint8_t* a, const uint8_t* b) {
+    size_t n = 0;
+    for (size_t i = 0; i < FrameDiff::FRAME_SIZE; i++) n += a[i] != b[i];
+    return n;
+}
+
+// false if a commit miscounts, a dirty range is not the changed columns,
+// taking a page leaves it dirty or an identical frame is not a no-op
+static bool frameDiffRun() {
+    static uint8_t blank[FrameDiff::FRAME_SIZE], a[FrameDiff::FRAME_SIZE], b[FrameDiff::FRAME_SIZE];
+    FrameDiff diff;
+    bool ok = diff.commit(blank) == 0 && !diff.isDirty();
+
+    // First frame on a cleared panel, then the same frame again
+    oledLive(a, "21.4", "55", "11.9", "0.4");
+    ok = ok && diff.commit(a) == countDiff(a, blank) && diff.isDirty();
+    oledFlush(diff, a, blank, ok);
+    ok = ok && !diff.isDirty() && memcmp(diff.getShadow(), a, sizeof(a)) == 0;
+    ok = ok && diff.commit(a) == 0 && !diff.isDirty();
+
+    printf("\nOLED partial refresh (I2C bytes per flush):\n");
+    diff.markAllDirty();
+    for (uint8_t p = 0; p < FrameDiff::PAGES; p++) ok = ok && diff.isPageDirty(p);
+    uint32_t full = oledFlush(diff, a, nullptr, ok);
+    printf("  full refresh (live)     %4lu bytes\n", (unsigned long)full);
+
+    // New reading: last digit of the temperature and the humidity (two ranges on the same pages)
+    oledLive(b, "21.5", "54", "11.9", "0.4");
+    size_t changed = diff.commit(b);
+    ok = ok && changed == countDiff(a, b);
+    uint32_t reading = oledFlush(diff, b, a, ok);
+    printf("  new reading             %4lu bytes (%zu changed)\n", (unsigned long)reading, changed);
+
+    // Session page timer: one digit per second
+    oledLive(a, "3:07", "", "", "");
+    ok = ok && diff.commit(a) == countDiff(a, b);
+    oledFlush(diff, a, b, ok);
+    oledLive(b, "3:08", "", "", "");
+    changed = diff.commit(b);
+    ok = ok && changed == countDiff(a, b);
+    uint32_t tick = oledFlush(diff, b, a, ok);
+    printf("  session timer tick      %4lu bytes (%zu changed)\n", (unsigned long)tick, changed);
+    ok = ok && diff.commit(b) == 0 && !diff.isDirty() && tick < reading && reading < full / 4;
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// OLED sparkline: incremental drawing against a full redraw
+// -------------------------------------------------------------------------
+static const uint32_t SPARK_START = 1700000000;
+
+static Record sparkRecord(size_t i) {
+    float t = 21.5f + 1.5f * sinf(i * 2 * (float)M_PI / 480) + 0.3f * sinf(i * 0.7f);
+    float h = 50.0f - 6.0f * sinf(i * 2 * (float)M_PI / 480) + 1.0f * sinf(i * 0.9f);
+    return {SPARK_START + (uint32_t)i * 180, t, h};
+}
+
+// false if the incrementally drawn sparkline ever differs from a fresh one
+// built from the same history (shifts, open columns, rescales, gaps)
+static bool sparklineRun() {
+    SensorManager sm;
+    Sparkline live;
+    GFXcanvas1 shown(128, 64), fresh(128, 64);
+    size_t compared = 0, mismatches = 0;
+    for (size_t i = 0; i < 36 * 20; i++) {
+        if (i >= 400 && i < 440) continue; // Sensor offline for 2 h
+        Record r = sparkRecord(i);
+        if (i >= 600 && i < 610) { // 30 min spike: both panels rescale
+            r.t = 15.0f;
+            r.h = 80.0f;
+        }
+        SensorBench::appendHistory(sm, r);
+        shown.fillScreen(0); // As the display task: cleared, then drawn
+        live.sync(&sm);
+        live.draw(shown, 0, 8);
+        if (i % 7 != 0 && i < 700) continue;
+
+        Sparkline ref;
+        fresh.fillScreen(0);
+        ref.sync(&sm);
+        ref.draw(fresh, 0, 8);
+        int16_t a[2], b[2];
+        uint8_t c[2], d[2];
+        live.getRange(a[0], a[1], c[0], c[1]);
+        ref.getRange(b[0], b[1], d[0], d[1]);
+        compared++;
+        if (memcmp(shown.getBuffer(), fresh.getBuffer(), 16 * 64) != 0 || memcmp(a, b, sizeof(a)) != 0
+            || memcmp(c, d, sizeof(c)) != 0) mismatches++;
+    }
+    printf("\nOLED sparkline (36 h at 3 min, 2 h gap, 30 min spike):\n");
+    printf("  incremental vs full redraw   %zu frames compared, %zu differ\n", compared, mismatches);
+    return compared > 100 && mismatches == 0;
+}
+
+// -------------------------------------------------------------------------
+// Results file + baseline comparison
+// -------------------------------------------------------------------------
+static const char* RESULTS_DIR = "bench/results";
+
+static std::map<std::string, Result> loadResults(const std::string& path) {
+    std::map<std::string, Result> out;
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return out;
+    char line[256];
+    if (!fgets(line, sizeof(line), f)) { fclose(f); return out; } // Header
+    while (fgets(line, sizeof(line), f)) {
+        char name[128];
+        Result r;
+        unsigned long long ops;
+        if (sscanf(line, "%127[^,],%lf,%lf,%llu", name, &r.nsPerOp, &r.allocsPerOp, &ops) == 4) {
+            r.name = name;
+            r.ops = ops;
+            out[r.name] = r;
+        }
+    }
+    fclose(f);
+    return out;
+}
+
+static bool saveResults(const std::string& path, const std::vector<Result>& results) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "name,ns_per_op,allocs_per_op,ops\n");
+    for (const Result& r : results) {
+        fprintf(f, "%s,%.1f,%.3f,%llu\n", r.name.c_str(), r.nsPerOp, r.allocsPerOp, (unsigned long long)r.ops);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string label = argc > 1 ? argv[1] : "latest";
+    std::vector<Result> results;
+
+    // --- processReading(): filter + physics + state machine, one sensor sample
+    {
+        SensorManager sm;
+        auto cycle = makeAiringCycle();
+        size_t i = 0;
+        results.push_back(measure("process_reading", [&]() {
+            const auto& s = cycle[i];
+            SensorBench::processReading(sm, s.first, s.second);
+            NativeClock::advance(6000);
+            i = (i + 1) % cycle.size();
+        }));
+    }
+
+    // --- updateAdvice(): without and with weather data
+    {
+        SensorManager sm;
+        SensorBench::processReading(sm, 24.0f, 58.0f);
+        results.push_back(measure("update_advice/no_weather", [&]() { SensorBench::updateAdvice(sm); }));
+
+        WeatherManager weather(nullptr);
+        weather.restore(makeWeather());
+        sm.setWeatherManager(&weather);
+        results.push_back(measure("update_advice/weather", [&]() { SensorBench::updateAdvice(sm); }));
+        sm.setWeatherManager(nullptr);
+    }
+
+    // --- Ventilation planner on a 48 h forecast: full replan (new forecast version) and unchanged inputs
+    {
+        WeatherSnapshot w = makeWeather();
+        VentilationPlanner planner;
+        uint32_t now = w.fetchTs;
+        uint32_t version = 1;
+        results.push_back(measure("planner/plan", [&]() { planner.update(w.forecast, version++, now, 22.0f, 9.5f); }));
+        results.push_back(measure("planner/unchanged", [&]() { planner.update(w.forecast, version, now, 22.0f, 9.5f); }));
+        if (planner.getSlotCount() == 0) {
+            printf("planner found no airing window in the bench forecast\n");
+            return 1;
+        }
+    }
+
+    // --- Config snapshots: hot-path read (sensor task) and writer swap (/api/config)
+    {
+        volatile float sink = 0;
+        results.push_back(measure("config/read", [&]() {
+            Config::Snapshot cfg;
+            sink = cfg->ventHumDrop;
+        }));
+
+        ClimateConfig a = Config::defaults();
+        ClimateConfig b = a;
+        b.ventHumDrop += 1.0f;
+        bool flip = false;
+        char error[64];
+        results.push_back(measure("config/swap", [&]() {
+            Config::apply(flip ? a : b, error, sizeof(error));
+            flip = !flip;
+        }));
+        Config::apply(a, error, sizeof(error));
+    }
+
+    // --- Hampel filter step (default window 7, k = 3) on a noisy signal with glitches
+    {
+        HampelFilter filter(0.5f);
+        auto trace = makeGlitchTrace();
+        size_t i = 0;
+        volatile float sink = 0;
+        results.push_back(measure("hampel/update", [&]() {
+            sink = filter.update(trace[i].second, 7, 3.0f);
+            i = (i + 1) % trace.size();
+        }));
+    }
+
+    // --- Kalman state estimator step (both channels, constant time)
+    {
+        ClimateKalman kf(0.1f, 0.1f);
+        auto trace = addNoise(makeAiringCycle());
+        size_t i = 0;
+        volatile float sink = 0;
+        results.push_back(measure("kalman/update", [&]() {
+            kf.update(trace[i].first, trace[i].second * 0.2f, 0.1f, 0.02f, 3.0f);
+            sink = kf.getAbsHumRate();
+            i = (i + 1) % trace.size();
+        }));
+    }
+
+    // --- Mold index step (growth branch: 2 exp + 2 log, the decline branch is cheaper)
+    {
+        MoldIndex mold;
+        size_t i = 0;
+        volatile float sink = 0;
+        results.push_back(measure("mold/update", [&]() {
+            mold.update(14.0f + (i % 64) * 0.05f, 88.0f + (i % 16) * 0.5f, 1.0f / 600);
+            sink = mold.getIndex();
+            i++;
+        }));
+    }
+
+    // --- DHT health bookkeeping per reading (frame + slot end)
+    {
+        SensorHealth health;
+        uint32_t i = 0;
+        results.push_back(measure("sensor_health/frame", [&]() {
+            health.onFrame(21.0f + (i % 7) * 0.1f, 50.0f + (i % 5) * 0.1f, 5400, i * 6000);
+            health.endSlot(true, 1);
+            i++;
+        }));
+    }
+
+    // --- MQTT: one airing reading in, batch/state messages out (in-memory transport)
+    {
+        SensorManager msm;
+        SinkTransport sink;
+        MqttManager mqtt(&msm, &sink);
+        mqtt.setBroker("sink", 1883, "", "");
+        mqtt.begin("acm1_bench");
+        mqtt.update(); // Connect + discovery
+        size_t i = 0;
+        results.push_back(measure("mqtt/reading", [&]() {
+            mqtt.onReading(21.0f + (i % 50) * 0.01f, 55.0f - (i % 50) * 0.1f, 10.2f, 1);
+            NativeClock::advance(3000);
+            mqtt.update();
+            i++;
+        }));
+    }
+
+    // --- dataMutex guard (uncontended): raw take/give vs. ScopedLock with statistics
+    {
+        static const LockStats::SiteInfo site[] = {{"bench", 100}};
+        SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+        LockStats stats(site, 1);
+        results.push_back(measure("lock/raw", [&]() {
+            if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) xSemaphoreGive(mutex);
+        }));
+        results.push_back(measure("lock/scoped", [&]() { ScopedLock lock(mutex, stats, 0); }));
+    }
+
+    // --- Heap tag hooks per malloc + free (fake addresses, the hooks never touch the block)
+    {
+        static char block[64];
+        uint32_t i = 0;
+        results.push_back(measure("heap_tags/untagged", [&]() {
+            void* p = block + (i++ & 63);
+            HeapTags::onAlloc(p, 32);
+            HeapTags::onFree(p);
+        }));
+        // From a task with a task-wide tag (as the weather task); only the numbers leave the
+        // thread, so the result's own name string is not charged to the tag
+        Result tagged = {"heap_tags/tagged", 0, 0, 0};
+        std::thread task([&]() {
+            HeapTags::setTaskTag(HeapTags::MQTT);
+            Result r = measure(tagged.name, [&]() {
+                void* p = block + (i++ & 63);
+                HeapTags::onAlloc(p, 32);
+                HeapTags::onFree(p);
+            });
+            tagged.nsPerOp = r.nsPerOp;
+            tagged.allocsPerOp = r.allocsPerOp;
+            tagged.ops = r.ops;
+        });
+        task.join();
+        results.push_back(tagged);
+    }
+
+    // --- Trace events (the modules are built with TRACE_ENABLED=0, so only these calls record)
+    {
+        Trace::setEnabled(true);
+        int32_t i = 0;
+        results.push_back(measure("trace/counter", [&]() { Trace::record(Trace::COUNTER, "bench", i++); }));
+        results.push_back(measure("trace/scope", [&]() { Trace::Scope scope("bench"); }));
+        Trace::setEnabled(false);
+        results.push_back(measure("trace/disabled", [&]() { Trace::record(Trace::COUNTER, "bench", i++); }));
+    }
+
+    // --- Loop scheduler: one loop pass (run due jobs, sleep to the next deadline) with 15 jobs
+    //     pending on all wheel levels; re-arming a pending job
+    {
+        Scheduler s;
+        for (size_t i = 0; i < Scheduler::MAX_JOBS; i++) s.add("sim", SIM_JOBS[i]);
+        uint32_t now = 1000;
+        simNow = now;
+        for (size_t i = 1; i < Scheduler::MAX_JOBS; i++) s.schedule((int)i, SIM_PERIODS[i], now);
+        results.push_back(measure("scheduler/wakeup", [&]() {
+            now += s.runDue(now);
+            simNow = now;
+        }));
+        uint32_t delay = 0;
+        results.push_back(measure("scheduler/rearm", [&]() {
+            delay = delay * 1103515245 + 12345;
+            s.schedule(12, (delay >> 8) % 3600000, now);
+        }));
+    }
+
+    // --- History access (full ring)
+    SensorManager sm;
+    fillHistory(sm);
+    {
+        Record batch[HistoryJsonWriter::BATCH];
+        size_t offset = 0;
+        results.push_back(measure("copy_history/32", [&]() {
+            if (sm.copyHistory(offset, HistoryJsonWriter::BATCH, batch) == 0) offset = 0;
+            else offset += HistoryJsonWriter::BATCH;
+        }));
+
+        std::vector<Record> copy;
+        results.push_back(measure("get_history_copy/reused", [&]() { sm.getHistoryCopy(copy); }));
+        results.push_back(measure("get_history_copy/fresh", [&]() {
+            std::vector<Record> fresh;
+            sm.getHistoryCopy(fresh);
+        }));
+    }
+
+    // --- /api/history serializer: one full stream per op at various chunk sizes
+    {
+        static uint8_t buffer[4096];
+        const size_t sizes[] = {256, 536, 1460, 4096};
+        for (size_t maxLen : sizes) {
+            results.push_back(measure("history_json/" + std::to_string(maxLen), [&]() {
+                HistoryJsonWriter writer(&sm);
+                while (!writer.isDone()) writer.fill(buffer, maxLen);
+            }));
+        }
+
+        // Slot claim + context construction + release, as per /api/history request
+        static StreamPool<HistoryJsonWriter, 4> pool("bench");
+        results.push_back(measure("stream_pool/lease", [&]() {
+            auto writer = pool.acquire(&sm, (uint32_t)0);
+            auto copy = writer; // Captured by the response callback
+        }));
+    }
+
+    // --- Aggregate queries over the ring (3-minute records, ~25 h): block summaries vs full scan
+    {
+        SensorManager qsm;
+        const uint32_t start = 1700000000;
+        for (size_t i = 0; i < HISTORY_SIZE + 77; i++) { // Wrapped ring, oldest block partly evicted
+            SensorBench::appendHistory(qsm, {start + (uint32_t)i * 180, 21.0f + (i % 40) * 0.1f, 45.0f + (i % 25) * 0.5f});
+        }
+        uint32_t last = start + (HISTORY_SIZE + 76) * 180;
+        HistoryStats t, h, rt, rh;
+        size_t k = 0;
+        results.push_back(measure("history_query/1h", [&]() {
+            uint32_t from = last - 3600 - (k++ % 100) * 180;
+            qsm.queryHistory(from, from + 3600, t, h);
+        }));
+        results.push_back(measure("history_query/24h", [&]() {
+            uint32_t from = last - 86400 + (k++ % 7) * 60;
+            qsm.queryHistory(from, from + 86400, t, h);
+        }));
+        results.push_back(measure("history_scan/24h", [&]() {
+            uint32_t from = last - 86400 + (k++ % 7) * 60;
+            SensorBench::scanHistory(qsm, from, from + 86400, t, h);
+        }));
+        // Same answer as the scan (checked once, a mismatch fails the run), windows across
+        // the ring plus the edges of the timestamp range (/api/query?from=0&to=4294967295)
+        std::vector<std::pair<uint32_t, uint32_t>> ranges = {{0, UINT32_MAX}, {0, start + 20000}, {last - 5000, UINT32_MAX}};
+        for (uint32_t from = start; from < last; from += 7777) ranges.push_back({from, from + 20000});
+        for (const auto& range : ranges) {
+            uint32_t from = range.first;
+            qsm.queryHistory(from, range.second, t, h);
+            SensorBench::scanHistory(qsm, from, range.second, rt, rh);
+            if (t.count != rt.count || h.count != rh.count || t.min != rt.min || h.max != rh.max ||
+                fabs(t.sum - rt.sum) > 1e-6 * fabs(rt.sum) + 1e-9) {
+                printf("history_query mismatch at %u: n %u/%u\n", from, t.count, rt.count);
+                return 1;
+            }
+        }
+    }
+
+    // --- Series encoder: one record in (blocks drained to memory), and the whole ring as /api/history.bin
+    {
+        static uint8_t drain[4096];
+        SeriesWriter writer;
+        uint32_t ts = 1700000000;
+        results.push_back(measure("series/append", [&]() {
+            while (!writer.append(ts, 21.5f, 48.0f)) writer.read(drain, sizeof(drain));
+            ts += 30;
+        }));
+
+        static uint8_t buffer[4096];
+        results.push_back(measure("history_series/4096", [&]() {
+            HistorySeriesWriter stream(&sm, 0, SeriesFormat::COL_T | SeriesFormat::COL_H, 0);
+            while (!stream.isDone()) stream.fill(buffer, sizeof(buffer));
+        }));
+    }
+
+    // --- open-meteo response (48 h) through the filtered parse, in 256-byte pieces as from the socket
+    {
+        std::string body = readFixture("bench/fixtures/openmeteo_48h.json");
+        ForecastParser parser;
+        HourlyForecast forecast;
+        char error[64];
+        results.push_back(measure("forecast_parse/48h", [&]() {
+            parseForecast(parser, body, 256, error, sizeof(error));
+            parser.copyForecast(forecast);
+        }));
+    }
+
+    // --- Chart image: render the 24 h history, encode it as PNG (size pass + upload pass)
+    {
+        SensorManager csm;
+        uint32_t now = fillChartHistory(csm);
+        static uint8_t chart[ChartRenderer::BITMAP_SIZE];
+        ChartRenderer renderer(&csm);
+        results.push_back(measure("chart/render", [&]() { renderer.render(chart, now); }));
+
+        static uint8_t out[PngEncoder::SEGMENT_SIZE];
+        results.push_back(measure("png/encode", [&]() {
+            PngEncoder png(chart, ChartRenderer::WIDTH, ChartRenderer::HEIGHT);
+            png.totalSize();
+            while (png.available()) png.read(out, sizeof(out));
+        }));
+    }
+
+    // --- OLED frame: diff of an unchanged frame (skipped) and of a new reading (then drained)
+    {
+        static uint8_t a[FrameDiff::FRAME_SIZE], b[FrameDiff::FRAME_SIZE], segment[FrameDiff::WIDTH];
+        oledLive(a, "21.4", "55", "11.9", "0.4");
+        oledLive(b, "21.5", "54", "11.9", "0.4");
+        FrameDiff diff;
+        diff.commit(a);
+        results.push_back(measure("frame_diff/unchanged", [&]() { diff.commit(a); }));
+        bool flip = false;
+        results.push_back(measure("frame_diff/reading", [&]() {
+            diff.commit((flip = !flip) ? b : a);
+            uint8_t lo, hi;
+            for (uint8_t page = 0; page < FrameDiff::PAGES; page++) diff.takePage(page, lo, hi, segment);
+        }));
+    }
+
+    // --- OLED sparkline page: one new history record, then sync + draw (full 24 h shown)
+    {
+        SensorManager ssm;
+        Sparkline spark;
+        GFXcanvas1 frame(128, 64);
+        size_t i = 0;
+        for (; i < 480; i++) SensorBench::appendHistory(ssm, sparkRecord(i));
+        spark.sync(&ssm);
+        spark.draw(frame, 0, 8);
+        results.push_back(measure("sparkline/record", [&]() {
+            SensorBench::appendHistory(ssm, sparkRecord(i++));
+            spark.sync(&ssm);
+            spark.draw(frame, 0, 8);
+        }));
+    }
+
+    // --- Report
+    auto baseline = loadResults(std::string(RESULTS_DIR) + "/baseline.csv");
+    bool allocRegression = false;
+
+    printf("%-28s %12s %10s %10s\n", "benchmark", "ns/op", "allocs/op", "vs base");
+    for (const Result& r : results) {
+        char delta[32] = "-";
+        const char* flag = "";
+        auto it = baseline.find(r.name);
+        if (label != "baseline" && it != baseline.end()) {
+            const Result& b = it->second;
+            snprintf(delta, sizeof(delta), "%+.1f%%", b.nsPerOp > 0 ? (r.nsPerOp / b.nsPerOp - 1.0) * 100.0 : 0.0);
+            if (r.allocsPerOp > b.allocsPerOp + 0.001) {
+                flag = "  ALLOC REGRESSION";
+                allocRegression = true;
+            } else if (r.nsPerOp > b.nsPerOp * 1.2) {
+                flag = "  slower";
+            }
+        }
+        printf("%-28s %12.1f %10.3f %10s%s\n", r.name.c_str(), r.nsPerOp, r.allocsPerOp, delta, flag);
+    }
+
+    // --- Replay: effect of the outlier filter on the state machine
+    {
+        auto glitches = makeGlitchTrace();
+        ReplayResult off = replay(glitches, 0.0f);
+        ReplayResult on = replay(glitches, Config::defaults().hampelK);
+        printf("\nReplay (%zu readings, glitches every 40/70):\n", glitches.size());
+        printf("  false airing sessions   hampel off %4d   on %4d   (%u readings replaced)\n",
+               off.sessions, on.sessions, (unsigned)on.outliers);
+        if (off.sessions == 0 || on.sessions != 0) {
+            printf("glitch replay: the outlier filter makes no difference\n");
+            return 1;
+        }
+
+        auto cycle = makeAiringCycle();
+        ReplayResult cycleOff = replay(cycle, 0.0f);
+        ReplayResult cycleOn = replay(cycle, Config::defaults().hampelK);
+        printf("  airing cycle detected   hampel off @%d   on @%d   (window opens @100)\n",
+               cycleOff.firstVent, cycleOn.firstVent);
+        if (cycleOn.journaled != 1) {
+            printf("session journal: %zu entries for one airing cycle\n", cycleOn.journaled);
+            return 1;
+        }
+        const VentSession& s = cycleOn.last;
+        printf("  session journal         %.1f min, drying %.1f min (%s), -%.2f g/m3 at %.3f g/m3/min (peak %.3f), closed by %s\n",
+               s.durationSec / 60.0f, s.dryingSec / 60.0f, sessionExitName(s.dryingExit), s.removed(),
+               s.dryingRate(), s.peakRate, sessionExitName(s.exit));
+
+        // State estimator: noise at rest and lag while airing on a noisy cycle
+        auto noisy = addNoise(cycle);
+        std::vector<std::pair<float, float>> est;
+        ReplayResult kf = replay(noisy, Config::defaults().hampelK, &est);
+        float rawT, rawH, estT, estH;
+        rmsError(noisy, cycle, 20, 100, rawT, rawH);
+        rmsError(est, cycle, 20, 100, estT, estH);
+        float restT = estT, restH = estH;
+        rmsError(noisy, cycle, 380, cycle.size(), rawT, rawH);
+        rmsError(est, cycle, 380, cycle.size(), estT, estH);
+        double lag = 0; // Temperature falls 0.03 °C per reading while the window is open
+        for (size_t i = 130; i < 250; i++) lag += (est[i].first - cycle[i].first) / 0.03f;
+        printf("  noise at rest (RMS)     raw %.3f C %.2f %%   estimate %.3f C %.2f %% / %.3f C %.2f %%\n",
+               rawT, rawH, restT, restH, estT, estH);
+        printf("  while airing            estimate lags %.1f readings   noisy cycle detected @%d\n",
+               lag / 120.0, kf.firstVent);
+    }
+
+    // --- Mold index: agreement with the reference (a drift fails the run)
+    if (!moldRun()) {
+        printf("mold index drifts from the reference\n");
+        return 1;
+    }
+
+    // --- DHT health: healthy sensors are not flagged, faults are
+    if (!healthRun()) {
+        printf("sensor health checks failed\n");
+        return 1;
+    }
+
+    // --- Lock statistics: counters consistent under contention
+    if (!lockRun()) {
+        printf("lock statistics are inconsistent\n");
+        return 1;
+    }
+
+    // --- Trace: per-core rings keep the newest events in order, counts add up
+    if (!traceRun()) {
+        printf("trace rings lost or reordered events\n");
+        return 1;
+    }
+
+    // --- Loop scheduler: a simulated day runs every job on time with few wake-ups
+    if (!schedulerRun()) {
+        printf("loop scheduler missed or drifted a job\n");
+        return 1;
+    }
+
+    // --- Boot: jobs start as their dependencies finish, a slow one does not block the rest
+    if (!bootRun()) {
+        printf("boot jobs started out of order or never completed\n");
+        return 1;
+    }
+
+    // --- Heap tags: every tagged byte is given back to its tag
+    if (!heapTagRun()) {
+        printf("heap tag accounting is inconsistent\n");
+        return 1;
+    }
+
+    // --- Forecast parser: fixtures parse to their contents, however the body is split
+    if (!forecastRun()) {
+        printf("forecast parser results are wrong\n");
+        return 1;
+    }
+
+    // --- Chart PNG: decodes to the rendered bitmap, matches the golden image
+    if (!pngRun()) {
+        printf("chart PNG does not decode to its bitmap\n");
+        return 1;
+    }
+
+    // --- OLED frame diff: only changed columns are flushed, identical frames are skipped
+    if (!frameDiffRun()) {
+        printf("OLED frame diff flushed the wrong segments\n");
+        return 1;
+    }
+
+    // --- OLED sparkline: incremental drawing matches a full redraw
+    if (!sparklineRun()) {
+        printf("sparkline drawn incrementally differs from a full redraw\n");
+        return 1;
+    }
+
+    // --- Weather task: backoff on every kind of failure; slow fetches never block readers
+    if (!weatherRun()) {
+        printf("weather fetch state machine misbehaved\n");
+        return 1;
+    }
+
+    // --- Shared TLS client: the idle reaper never touches a client in use
+    if (!mqttDropRun()) {
+        printf("MQTT backlog lost or counted messages the broker never got\n");
+        return 1;
+    }
+
+    if (!tlsRun()) {
+        printf("shared TLS client used by two tasks at once\n");
+        return 1;
+    }
+
+    // --- Streaming admission: 20 concurrent /api/history clients, 4 slots
+    if (!streamLoadRun(sm)) {
+        printf("stream pool lost or overbooked a slot\n");
+        return 1;
+    }
+
+    // --- Series file (multi-million points, mmap + range queries)
+    {
+        const char* n = getenv("SERIES_POINTS");
+        size_t points = n ? strtoul(n, nullptr, 10) : 5000000;
+        if (points > 0) seriesFileRun(points);
+    }
+
+    // --- Optional: real broker (MQTT_BENCH=host[:port], e.g. a local mosquitto)
+    if (const char* broker = getenv("MQTT_BENCH")) {
+        std::string host = broker;
+        uint16_t port = 1883;
+        size_t colon = host.find(':');
+        if (colon != std::string::npos) {
+            port = (uint16_t)atoi(host.c_str() + colon + 1);
+            host.resize(colon);
+        }
+        mqttBrokerRun(host.c_str(), port);
+    }
+
+    std::string path = std::string(RESULTS_DIR) + "/" + label + ".csv";
+    if (saveResults(path, results)) printf("\nSaved %s\n", path.c_str());
+    else printf("\nCould not write %s (run from the project root)\n", path.c_str());
+
+    return allocRegression ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+// Host stand-in for the Adafruit GFX subset used by Sparkline: pixel
+// primitives, drawBitmap() and a 1-bit canvas with the GFXcanvas1 layout
+// (row-major, MSB = leftmost pixel).
+#include <Arduino.h>
+
+class Adafruit_GFX {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+    virtual ~Adafruit_GFX() {}
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+        for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+    }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        for (int16_t i = 0; i < w; i++) drawFastVLine(x + i, y, h, color);
+    }
+    void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+    // Sets the pixels of the 1 bits, leaves the rest (no background color)
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color) {
+        int16_t stride = (w + 7) / 8;
+        for (int16_t j = 0; j < h; j++) {
+            for (int16_t i = 0; i < w; i++) {
+                if (bitmap[j * stride + i / 8] & (0x80 >> (i & 7))) drawPixel(x + i, y + j, color);
+            }
+        }
+    }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    int16_t _width;
+    int16_t _height;
+};
+
+class GFXcanvas1 : public Adafruit_GFX {
+public:
+    GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h), buffer(new uint8_t[(w + 7) / 8 * h]()) {}
+    ~GFXcanvas1() { delete[] buffer; }
+    GFXcanvas1(const GFXcanvas1&) = delete;
+    GFXcanvas1& operator=(const GFXcanvas1&) = delete;
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+        uint8_t& b = buffer[y * ((_width + 7) / 8) + x / 8];
+        if (color) b |= 0x80 >> (x & 7);
+        else b &= ~(0x80 >> (x & 7));
+    }
+    uint8_t* getBuffer() const { return buffer; }
+
+private:
+    uint8_t* buffer;
+};
@@ -0,0 +1,42 @@
+#include "Arduino.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+NativeSerial Serial;
+
+static const auto clockStart = std::chrono::steady_clock::now();
+static std::atomic<uint64_t> clockOffsetUs{0}; // Advanced while other threads read the clock
+
+static uint64_t nowUs() {
+    auto elapsed = std::chrono::steady_clock::now() - clockStart;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + clockOffsetUs;
+}
+
+uint32_t millis() { return (uint32_t)(nowUs() / 1000); }
+uint32_t micros() { return (uint32_t)nowUs(); }
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void NativeClock::advance(uint32_t ms) { clockOffsetUs += (uint64_t)ms * 1000; }
+
+static std::atomic<uint32_t> randomState{12345};
+uint32_t esp_random() {
+    uint32_t x = randomState.fetch_add(0x9E3779B9, std::memory_order_relaxed) + 0x9E3779B9;
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    return x ^ (x >> 16);
+}
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
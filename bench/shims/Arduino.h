@@ -0,0 +1,89 @@
+#pragma once
+// Host stand-in for the parts of the Arduino core used by the
+// platform-independent modules ([env:native] benchmark build only).
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include "freertos/FreeRTOS.h" // The ESP32 core pulls in FreeRTOS too (xPortGetCoreID)
+#include "freertos/task.h"
+
+using std::min;
+using std::max;
+using std::abs;
+using std::isnan;
+
+#define PROGMEM
+#define F(s) (s)
+
+template <typename T, typename L, typename H>
+inline T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+// Clock: real monotonic time plus an offset the benchmark can advance,
+// so millis()-driven state machines see minutes pass in microseconds.
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+namespace NativeClock {
+    void advance(uint32_t ms);
+}
+
+// Hardware RNG stand-in (deterministic sequence, thread-safe)
+uint32_t esp_random();
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+// Minimal String (std::string underneath, so its heap use is counted too)
+class String {
+public:
+    String() {}
+    String(const char* s) : str(s ? s : "") {}
+    String(const std::string& s) : str(s) {}
+    String(int v) : str(std::to_string(v)) {}
+    String(unsigned int v) : str(std::to_string(v)) {}
+    String(long v) : str(std::to_string(v)) {}
+    String(unsigned long v) : str(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) { format((double)v, decimals); }
+    String(double v, unsigned int decimals = 2) { format(v, decimals); }
+
+    const char* c_str() const { return str.c_str(); }
+    size_t length() const { return str.length(); }
+    void reserve(size_t n) { str.reserve(n); }
+    long toInt() const { return atol(str.c_str()); }
+    float toFloat() const { return (float)atof(str.c_str()); }
+
+    String& operator+=(const String& o) { str += o.str; return *this; }
+    String& operator+=(const char* s) { str += s; return *this; }
+    String& operator+=(char c) { str += c; return *this; }
+    friend String operator+(String a, const String& b) { a += b; return a; }
+    bool operator==(const String& o) const { return str == o.str; }
+    bool operator!=(const String& o) const { return str != o.str; }
+
+private:
+    std::string str;
+    void format(double v, unsigned int decimals) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        str = buf;
+    }
+};
+
+// Serial output is discarded (state machine logs would swamp the results)
+class NativeSerial {
+public:
+    void begin(unsigned long) {}
+    template <typename T> size_t print(const T&) { return 0; }
+    template <typename T> size_t print(const T&, int) { return 0; }
+    template <typename T> size_t println(const T&) { return 0; }
+    template <typename T> size_t println(const T&, int) { return 0; }
+    size_t println() { return 0; }
+    size_t printf(const char*, ...) { return 0; }
+};
+extern NativeSerial Serial;
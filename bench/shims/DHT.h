@@ -0,0 +1,16 @@
+#pragma once
+// Host stand-in for the Adafruit DHT driver: no sensor, readings are fed
+// to SensorManager directly by the benchmark.
+#include <Arduino.h>
+
+#define DHT11 11
+#define DHT22 22
+
+class DHT {
+public:
+    DHT(uint8_t, uint8_t) {}
+    void begin() {}
+    bool read(bool force = false) { return false; }
+    float readTemperature() { return NAN; }
+    float readHumidity() { return NAN; }
+};
@@ -0,0 +1,46 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+struct NativeMutex {
+    std::timed_mutex m;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeMutex(); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks) {
+    if (!mutex) return pdFALSE;
+    if (ticks == portMAX_DELAY) {
+        mutex->m.lock();
+        return pdTRUE;
+    }
+    return mutex->m.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) {
+    if (!mutex) return pdFALSE;
+    mutex->m.unlock();
+    return pdTRUE;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = nullptr;
+    return pdPASS;
+}
+
+TickType_t xTaskGetTickCount() { return millis(); }
+void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+    *previousWake += increment;
+    int32_t wait = (int32_t)(*previousWake - xTaskGetTickCount());
+    if (wait > 0) vTaskDelay(wait);
+}
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+void xTaskNotifyGive(TaskHandle_t) {}
+static thread_local BaseType_t threadCore = 0;
+BaseType_t xPortGetCoreID() { return threadCore; }
+void NativeCore::pin(BaseType_t core) { threadCore = core; }
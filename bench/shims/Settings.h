@@ -0,0 +1,3 @@
+#pragma once
+// Native build without private credentials: hardware/tuning values from the template
+#include "SettingsTemplate.h"
@@ -0,0 +1,3 @@
+#pragma once
+// Host stand-in: only the root certificate HttpsManager pins for Telegram
+static const char TELEGRAM_CERTIFICATE_ROOT[] = "";
@@ -0,0 +1,51 @@
+#include "WiFi.h"
+#include "WiFiClientSecure.h"
+#include <chrono>
+
+NativeWiFi WiFi;
+
+uint32_t WiFiClientSecure::handshakeUs = 200;
+std::atomic<uint32_t> WiFiClientSecure::overlaps{0};
+std::atomic<uint32_t> WiFiClientSecure::closedRequests{0};
+
+// Busy-wait: sleeps are too coarse to hold a call open for a few µs
+static void spin(uint32_t us) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+void WiFiClientSecure::enter() {
+    if (callers++ != 0) overlaps++;
+}
+
+int WiFiClientSecure::connect(const char*, uint16_t) {
+    enter();
+    spin(handshakeUs);
+    open = true;
+    leave();
+    return 1;
+}
+
+uint8_t WiFiClientSecure::connected() {
+    enter();
+    spin(5); // Socket state + pending TLS alerts
+    bool o = open;
+    leave();
+    return o;
+}
+
+void WiFiClientSecure::stop() {
+    enter();
+    spin(20); // close_notify + free of the mbedTLS context
+    open = false;
+    leave();
+}
+
+bool WiFiClientSecure::request(uint32_t us) {
+    enter();
+    bool o = open;
+    if (!o) closedRequests++;
+    spin(us);
+    leave();
+    return o;
+}
@@ -0,0 +1,11 @@
+#pragma once
+// Host stand-in: the network is always up
+#include <Arduino.h>
+
+typedef enum { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_DISCONNECTED = 6 } wl_status_t;
+
+class NativeWiFi {
+public:
+    wl_status_t status() { return WL_CONNECTED; }
+};
+extern NativeWiFi WiFi;
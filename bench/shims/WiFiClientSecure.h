@@ -0,0 +1,29 @@
+#pragma once
+// Host stand-in for the TLS client used by HttpsManager. No network: a
+// connect() takes a fixed handshake time, request() stands for one
+// request/response on the open connection. Like the real client it must
+// not be used by two tasks at once, so overlapping calls on one client and
+// requests on a connection that was closed under the caller are counted
+// (checked by the TLS test in bench/).
+#include <Arduino.h>
+#include <atomic>
+
+class WiFiClientSecure {
+public:
+    static uint32_t handshakeUs;                   // Time per connect()
+    static std::atomic<uint32_t> overlaps;         // Calls that overlapped another call
+    static std::atomic<uint32_t> closedRequests;   // request() on a closed connection
+
+    void setCACert(const char*) {}
+    void setHandshakeTimeout(unsigned long) {}
+    int connect(const char* host, uint16_t port);
+    uint8_t connected();
+    void stop();
+    bool request(uint32_t us);
+
+private:
+    std::atomic<int> callers{0};
+    bool open = false;
+    void enter();
+    void leave() { callers--; }
+};
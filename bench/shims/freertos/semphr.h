@@ -0,0 +1,10 @@
+#pragma once
+#include "FreeRTOS.h"
+
+struct NativeMutex;
+typedef NativeMutex* SemaphoreHandle_t;
+
+// Real (timed) mutex, so lock costs are part of the measurements
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
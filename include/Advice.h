@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+
+// Advice as an id + constant RU/EN message tables (flash, no heap).
+// The sensor path only stores an AdviceState; text is formatted on demand
+// into a caller-provided buffer.
+
+enum class AdviceId : uint8_t {
+    LOADING,
+    ANALYZING,
+    INEFFICIENT,
+    TARGET_MET,
+    DRYING,
+    WINTER_CRITICAL,
+    WINTER_HUMID,
+    WINTER_NORMAL,
+    SUMMER_KEEP_CLOSED,
+    HUMID_VENTILATE,
+    SUMMER_NORMAL,
+    CRITICAL_OPEN,
+    HUMID_RECOMMEND,
+    DRY_AIR,
+    NORMAL,
+    COUNT
+};
+
+enum class Lang : uint8_t { RU, EN };
+
+// Current advice + optional forecast plan hint (plain struct, copied under the mutex)
+struct AdviceState {
+    AdviceId id;
+    uint16_t hintMinutes;  // Suggested airing duration, 0 = no hint
+    uint32_t hintStartTs;  // Best slot start, 0 = "now"
+};
+
+namespace Advice {
+
+    const char* text(AdviceId id, Lang lang);
+    // 0=Safe/Gray, 1=Vent/Yellow, 2=Crit/Red, 3=Safe/Green
+    uint8_t code(AdviceId id);
+    // Message + plan hint, always NUL-terminated. Returns length written.
+    size_t format(const AdviceState& advice, Lang lang, char* buf, size_t len);
+
+}
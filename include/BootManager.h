@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+
+// Dependency-driven boot orchestration
+//
+// Each job is a pair of non-blocking callbacks: start() kicks the work off,
+// poll() returns true once it is done. poll() of the manager is called from
+// loop(); a job starts as soon as all jobs in its dependency mask are done,
+// so independent jobs (sensor, WiFi, weather) progress concurrently.
+// A job that exceeds its budget is flagged as late but keeps running, so
+// e.g. Telegram still comes up when WiFi connects after a minute.
+class BootManager {
+public:
+    enum class Job : uint8_t { SENSOR, FIRST_SCREEN, WIFI, WEB, NTP, WEATHER, TELEGRAM, COUNT };
+    typedef void (*StartFn)();
+    typedef bool (*PollFn)();
+
+    static constexpr uint32_t bit(Job j) { return 1UL << (uint8_t)j; }
+
+    BootManager();
+
+    void add(Job job, const char* name, uint32_t deps, StartFn start, PollFn poll, uint32_t budgetMs);
+    void poll();
+
+    bool isDone(Job job) const;
+    bool isComplete() const;           // All jobs done
+    int32_t getDoneMs(Job job) const;  // ms since boot, -1 while pending
+    bool isLate(Job job) const;
+    const char* getName(Job job) const;
+
+    void printTimeline() const;
+
+private:
+    enum class State : uint8_t { UNUSED, PENDING, RUNNING, DONE };
+
+    struct Entry {
+        const char* name;
+        uint32_t deps;
+        StartFn start;
+        PollFn poll;
+        uint32_t budgetMs;
+        State state;
+        bool late;
+        uint32_t startMs;
+        uint32_t doneMs;
+    };
+
+    static const size_t JOB_COUNT = (size_t)Job::COUNT;
+    Entry jobs[JOB_COUNT];
+    uint32_t doneMask;
+    bool timelinePrinted;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "SensorManager.h"
+
+// Renders the temperature / humidity history into a 1-bit bitmap
+// (white background, black lines) for sending as an image.
+// Reads history in small batches via copyHistory() - no full copy in RAM.
+//
+// Bitmap layout is the one PngEncoder takes: row-major, MSB first,
+// WIDTH / 8 bytes per row, bit 1 = white. Drawing primitives and the
+// 5x7 label font are built in, so the renderer also runs on the host.
+class ChartRenderer {
+public:
+    static const uint16_t WIDTH = 256;
+    static const uint16_t HEIGHT = 128;
+    static const size_t BITMAP_SIZE = WIDTH / 8 * HEIGHT; // 4 KB
+
+    ChartRenderer(SensorManager* sm);
+
+    // Draws [now - spanSec, now] into bitmap (BITMAP_SIZE bytes).
+    // Returns false if there is no data.
+    bool render(uint8_t* bitmap, uint32_t now, uint32_t spanSec = 24 * 3600);
+
+private:
+    SensorManager* sensorManager;
+    uint8_t* canvas;    // Target of the primitives during render()
+
+    struct Panel {
+        int16_t top;
+        int16_t height;
+        float minV;
+        float maxV;
+        uint8_t decimals;   // Label precision
+    };
+
+    bool scanRange(uint32_t from, Panel& tPanel, Panel& hPanel);
+    void drawPanel(const Panel& p, const char* title, uint32_t from, uint32_t spanSec);
+    void plot(const Panel& tPanel, const Panel& hPanel, uint32_t from, uint32_t spanSec);
+    int16_t mapY(const Panel& p, float v) const;
+    int16_t mapX(uint32_t ts, uint32_t from, uint32_t spanSec) const;
+
+    // Primitives (black on the white background, clipped to the bitmap)
+    void drawPixel(int16_t x, int16_t y);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h);
+    void drawText(int16_t x, int16_t y, const char* text);
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+// Kalman state estimator for the room: [T, AH, dT/dt, dAH/dt].
+//
+// Temperature and absolute humidity are modelled as two independent
+// constant-velocity channels (white acceleration noise), so the 4x4 filter
+// splits into two closed-form 2x2 filters: a fixed number of float
+// operations per update, no matrices, no allocations. Humidity is tracked
+// as absolute humidity because airing removes water at a roughly steady
+// rate while RH also follows the temperature; RH is derived from T and AH.
+//
+// Process noise is chosen by the caller (per climate state). In addition,
+// an innovation outside the gate (in standard deviations of the predicted
+// measurement) inflates the process noise for that step, so the estimate
+// follows a real change (window opened) within a few readings while
+// staying smooth at rest.
+//
+// Rates are per minute. No Arduino dependencies, so it runs in the native
+// benchmark as well.
+class ClimateKalman {
+public:
+    struct Stats {
+        uint32_t updates;
+        uint32_t boosts;      // Steps with inflated process noise (innovation outside the gate)
+        uint32_t skipped;     // Temperature measurements rejected by the caller (predict only)
+        float tInnovation;    // Last innovation, °C
+        float absHumInnovation; // Last innovation, g/m³
+    };
+
+    // Measurement noise (standard deviation) of the sensor in °C and g/m³
+    ClimateKalman(float tNoise, float absHumNoise);
+
+    // One reading dtMin minutes after the previous one. q: process noise
+    // (acceleration std, units/min²); gate: innovation gate in sigmas
+    // (0 = no boost). tValid = false: temperature is predicted only.
+    void update(float t, float absHum, float dtMin, float q, float gate, bool tValid = true);
+    void reset();
+
+    bool isReady() const { return ready; }
+    float getTemp() const { return temp.x; }
+    float getAbsHum() const { return absHum.x; }
+    float getTempRate() const { return temp.v; }     // °C/min
+    float getAbsHumRate() const { return absHum.v; } // g/m³/min
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Channel {
+        float x;              // Level
+        float v;              // Rate per minute
+        float p00, p01, p11;  // Covariance (symmetric)
+    };
+
+    Channel temp;
+    Channel absHum;
+    float tNoise;
+    float absHumNoise;
+    bool ready;
+    Stats stats;
+
+    static void init(Channel& c, float z, float r);
+    static void predict(Channel& c, float dt, float qd);
+    bool correct(Channel& c, float z, float dt, float q, float r, float gate, float& innovation);
+};
@@ -1,5 +1,5 @@
 #pragma once
-#include <Arduino.h>
+#include <math.h>
 
 // Shared Math Functions for Climate Analysis
 namespace ClimateMath {
@@ -16,6 +16,13 @@ namespace ClimateMath {
         return absoluteHumidity;
     }
 
+    // Inverse of calculateAbsHumidity(): RH in % for temperature t and abs. humidity absHum
+    inline float calculateRelHumidity(float t, float absHum) {
+        if(isnan(t) || isnan(absHum)) return NAN;
+        float saturationPressure = 6.112f * exp((17.67f * t) / (t + 243.5f));
+        return absHum * (273.15f + t) / (saturationPressure * 2.1674f);
+    }
+
     inline float calculateDewPoint(float t, float h) {
         if (isnan(t) || isnan(h)) return NAN;
         float a = 17.27f;
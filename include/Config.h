@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+
+// Runtime-tunable thresholds (calibration, filter, advice bands, airing
+// detection). Defaults come from Settings.h; overrides are kept in NVS and
+// edited through /api/config, so a unit can be recalibrated without reflashing.
+struct ClimateConfig {
+    // Sensor calibration
+    float tempOffset;        // °C added to the raw reading
+    float humOffset;         // % RH added to the raw reading
+    // Filter
+    float maxTempJump;       // °C; larger jumps between readings are rejected
+    float hampelK;           // Outlier if further than k * MAD from the median (0 = off)
+    uint16_t hampelWindow;   // Readings in the sliding median window (odd, 3..15)
+    float kalmanQRest;       // Process noise at rest (°C or g/m³ per min², STABLE)
+    float kalmanQActive;     // Process noise while airing (other states)
+    float kalmanGate;        // Innovation gate in sigmas; outside -> follow faster (0 = off)
+    // Advice bands (% RH)
+    float humHigh;           // Above: ventilation recommended
+    float humLow;            // Below: air too dry
+    float humWinterHigh;     // Above (cold outside): winter humid advice
+    // Airing detection
+    float ventHumDrop;       // % RH drop vs. last history point -> window open
+    float ventTempDrop;      // °C drop vs. baseline -> window open
+    float ventAbsHumRate;    // g/m³ per min fall of the estimate -> window open (0 = off)
+    float targetDrop;        // % RH below the start humidity -> target met
+    float targetFloor;       // Target never below this % RH
+    float plateauSlope;      // g/m³ over the slope window; flatter = plateau
+    uint16_t plateauReadings;// Consecutive flat readings to confirm a plateau
+    float reboundTempRise;   // °C rise over 2 min -> window closed
+    float reboundAbsHum;     // g/m³ rise -> window closed
+};
+
+// Read side is lock-free (RCU style): two immutable slots, an atomically
+// swapped active index and per-slot reader counts. A writer fills the idle
+// slot only after its last reader has left (grace period), then publishes
+// it with a single store. Readers never block and never see a torn config.
+namespace Config {
+
+    struct Stats {
+        uint32_t swaps;
+        uint32_t lastSwapUs;     // apply(): validation + grace period + publish
+        uint32_t maxGraceUs;     // Longest wait for readers of the old slot
+        uint32_t readRetries;    // Reader raced a swap and re-read the index
+    };
+
+    // Read-side critical section: holds the active snapshot for its lifetime
+    class Snapshot {
+    public:
+        Snapshot();
+        ~Snapshot();
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        const ClimateConfig& operator*() const { return *cfg; }
+        const ClimateConfig* operator->() const { return cfg; }
+
+    private:
+        const ClimateConfig* cfg;
+        uint8_t slot;
+    };
+
+    // Loads the NVS override (falls back to defaults). Call once in setup().
+    void begin();
+
+    const ClimateConfig& defaults();
+    ClimateConfig get(); // Copy of the active snapshot
+
+    // Validates and publishes cfg. Returns false (with reason) if a value is
+    // out of range. Writers are serialized; readers are never blocked.
+    bool apply(const ClimateConfig& cfg, char* error, size_t errorLen);
+    // Persists the active snapshot (call after apply, outside hot paths)
+    bool save();
+    // Drops the NVS override and publishes the defaults
+    void reset();
+
+    // Key/value access for /api/config (keys as in documentation)
+    size_t getFieldCount();
+    const char* getFieldKey(size_t index);
+    float getField(const ClimateConfig& cfg, size_t index);
+    // Sets field 'key' in cfg; false if the key is unknown
+    bool setField(ClimateConfig& cfg, const char* key, float value);
+
+    const Stats& getStats();
+
+}
@@ -3,15 +3,85 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
 #include "Settings.h"
+#include "FrameDiff.h"
+#include "Sparkline.h"
 
+class SensorManager; // Forward Declaration
+
+// Values shown on the OLED (published by the main loop, copied by the task)
+struct DisplaySnapshot {
+    float t;
+    float h;
+    float dp;
+    float inAbsHum;
+    float outAbsHum;           // NAN if no weather
+    float outTemp;             // NAN if no weather
+    int adviceCode;            // 0=Safe/Gray, 1=Vent/Yellow, 2=Crit/Red, 3=Safe/Green
+    int state;                 // SensorManager::ClimateState
+    uint32_t stateEnterMs;     // millis() when the current state was entered
+    float sessionStartAbsHum;  // Abs. humidity when airing started
+    float moldIndex;           // VTT mold index (0..6)
+    char ip[16];
+};
+
+// Own low-priority task (Core 1): renders a page carousel from the latest
+// snapshot, diffs the frame against a shadow copy and pushes only the
+// changed page segments over I2C. publish() never waits for rendering or I2C.
 class DisplayManager {
 public:
-    DisplayManager();
+    enum Page : uint8_t { PAGE_LIVE, PAGE_SPARKLINE, PAGE_ABS_HUM, PAGE_SESSION, PAGE_COUNT };
+
+    struct Stats {
+        uint32_t frames;        // Rendered frames
+        uint32_t skipped;       // Frames identical to the last one (no flush)
+        uint32_t lastBusBytes;  // I2C bytes of the last flush (incl. addressing)
+        uint32_t totalBusBytes;
+        uint32_t lastFlushUs;
+        uint32_t renderUs[PAGE_COUNT]; // Last render time per page
+    };
+
+    static const uint32_t PAGE_DWELL_MS = 5000;  // Carousel step
+    static const uint32_t MIN_FRAME_MS = 200;    // Frame rate cap (5 fps)
+
+    DisplayManager(SensorManager* sm);
     void begin();
-    void update(float t, float h, float dp, bool win, String advice, int adviceCode, int rawState, String ip);
+    void publish(const DisplaySnapshot& snapshot); // Wakes the task
+    Stats getStats() const { return stats; }
+
+    // Task wrapper
+    static void displayTask(void* parameter);
 
 private:
     Adafruit_SSD1306 display;
+    SensorManager* sensorManager;
+    FrameDiff diff;                 // Display task only
+    Sparkline sparkline;            // Display task only
+    TaskHandle_t taskHandle;
+
+    SemaphoreHandle_t snapshotMutex;
+    DisplaySnapshot pending;        // Latest published (guarded)
+    DisplaySnapshot current;        // Task-local copy
+
+    uint8_t page;
+    uint32_t pageSinceMs;
+    uint32_t lastFrameMs;
+    bool panelOn;
+    Stats stats;
+
+    long nightCheckMinute;          // Local hour is re-read once per minute
+    bool nightCached;
+
     bool isNightMode();
+    bool isPageActive(uint8_t p) const;
+    void renderFrame();
+    void renderLive();
+    void renderSparkline();
+    void renderAbsHum();
+    void renderSession();
+    void flush();
+    uint32_t sendCommands(const uint8_t* cmds, size_t count);
 };
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <ArduinoJson.h>
+#include "HourlyForecast.h"
+
+// open-meteo forecast response, read with ArduinoJson straight from the body
+// stream through a filter. Only these fields are kept, in a fixed-size
+// document (no heap, the body itself is never buffered):
+//   current.time / temperature_2m / relative_humidity_2m
+//   hourly.time[] / temperature_2m[] / relative_humidity_2m[]
+//   reason (API error: "error": true, "reason": "...")
+// The forecast starts at hourly.time[0] (unix time, timeformat=unixtime),
+// which is not always the hour of current.time (past_hours, forecast_days,
+// a cached response).
+class ForecastParser {
+public:
+    // Hourly values the document has room for (48 are requested; a 3-day
+    // response still fits, a longer one fails with NoMemory)
+    static const size_t MAX_HOURS = 72;
+
+    ForecastParser();
+
+    // Parses the body from any ArduinoJson input: the HTTP stream on the
+    // device, a reader with read()/readBytes() in the native benchmark.
+    // False unless it is a complete document with a 'current' block;
+    // writes the reason.
+    template <typename Input>
+    bool parse(Input& body, char* error, size_t errorLen) {
+        DeserializationError result = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+        return finish(result, error, errorLen);
+    }
+
+    uint32_t getTime() const { return curTime; }
+    float getTemp() const { return curTemp; }
+    float getHum() const { return curHum; }
+    // Hourly series up to the first missing value; empty if absent or not hourly
+    void copyForecast(HourlyForecast& target) const;
+
+private:
+    static const size_t CAPACITY = 3 * JSON_OBJECT_SIZE(3) + 3 * JSON_ARRAY_SIZE(MAX_HOURS) + 64; // + reason
+
+    StaticJsonDocument<3 * JSON_OBJECT_SIZE(3)> filter;
+    StaticJsonDocument<CAPACITY> doc;   // Last response (filtered)
+
+    uint32_t curTime;
+    float curTemp;
+    float curHum;
+
+    bool finish(DeserializationError result, char* error, size_t errorLen);
+};
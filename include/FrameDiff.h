@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Shadow framebuffer with per-page dirty column ranges (SSD1306 layout:
+// 8 pages x 128 columns, one byte = 8 vertical pixels).
+//
+// commit() diffs a freshly rendered frame against the shadow, copies the
+// changed bytes in and widens each page's dirty range; takePage() hands a
+// dirty segment to the flusher and marks it clean. An unchanged frame
+// produces no dirty pages at all.
+//
+// No Arduino dependencies, so diffing can be tested on the host.
+class FrameDiff {
+public:
+    static const uint8_t WIDTH = 128;
+    static const uint8_t PAGES = 8;
+    static const size_t FRAME_SIZE = (size_t)WIDTH * PAGES;
+
+    FrameDiff();
+
+    // Returns the number of bytes that differ from the shadow (0 = unchanged)
+    size_t commit(const uint8_t* frame);
+    // Forces a full flush (e.g. after panel reset)
+    void markAllDirty();
+
+    bool isDirty() const;
+    bool isPageDirty(uint8_t page) const;
+    // Copies the dirty segment of 'page' to 'out' (>= WIDTH bytes) and clears it.
+    // Returns false if the page is clean.
+    bool takePage(uint8_t page, uint8_t& colStart, uint8_t& colEnd, uint8_t* out);
+
+    const uint8_t* getShadow() const { return shadow; }
+
+private:
+    uint8_t shadow[FRAME_SIZE];
+    uint8_t dirtyLo[PAGES]; // Inclusive column range; lo > hi = clean
+    uint8_t dirtyHi[PAGES];
+};
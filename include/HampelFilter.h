@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Sliding-window Hampel outlier filter: a sample further than
+// k * 1.4826 * MAD from the window median is replaced by the median.
+//
+// The window is kept twice: in arrival order (ring) and sorted. An update
+// binary-searches the slot of the expired and the new sample (O(log n)) and
+// shifts at most a few floats; the median is read directly and the MAD is
+// the k-th smallest of two sorted deviation runs around the median, found
+// by binary search (O(log n)). For the small fixed windows used here this
+// beats heaps or a skip list, which would need pointer chasing per step.
+//
+// No Arduino dependencies, so it runs in the native benchmark as well.
+class HampelFilter {
+public:
+    static const uint8_t MAX_WINDOW = 15;
+
+    struct Stats {
+        uint32_t samples;   // Valid samples seen
+        uint32_t outliers;  // Samples replaced by the median
+    };
+
+    // madFloor: smallest MAD used (a perfectly flat window would flag any change)
+    explicit HampelFilter(float madFloor);
+
+    // Returns x, or the window median if x is an outlier. window is rounded
+    // up to an odd size (3..MAX_WINDOW); k <= 0 disables replacement but keeps
+    // the window up to date. Until the window is full, x passes unchanged.
+    float update(float x, uint8_t window, float k);
+    void reset();
+
+    bool lastWasOutlier() const { return lastOutlier; }
+    float getMedian() const;
+    float getMad() const; // Scaled (1.4826 * MAD), without the floor
+    const Stats& getStats() const { return stats; }
+
+private:
+    float ring[MAX_WINDOW];    // Arrival order, oldest at 'head' when full
+    float sorted[MAX_WINDOW];
+    uint8_t head;
+    uint8_t count;
+    uint8_t window;
+    float madFloor;
+    bool lastOutlier;
+    Stats stats;
+
+    uint8_t lowerBound(float v) const;
+    float deviationRank(uint8_t rank, float median) const;
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-subsystem heap accounting
+//
+// Every allocation is charged to the tag of the calling task: a task-wide
+// default (setTaskTag(), e.g. the weather task) or the innermost Scope
+// (e.g. around a Telegram poll). Tagged blocks are remembered in a fixed
+// pointer table (open addressing, 512 entries), so a free is charged back to
+// the tag that allocated the block, whichever task frees it. Untagged (OTHER)
+// allocations are only counted (allocs, bytes). Tagged blocks beyond the
+// table limit are counted as untracked.
+//
+// The hooks are fed by wrapped malloc/calloc/realloc/free and
+// heap_caps_malloc/calloc/realloc/free on the ESP32 (linker --wrap, see
+// platformio.ini) and by operator new/delete in the native benchmark, so
+// soak tests on the host see the same numbers. Not seen: the heap_caps
+// *_prefer and aligned variants, and calls inside the heap component itself
+// (--wrap only redirects calls between object files). Their blocks are not
+// charged, and their frees are ignored as unknown.
+//
+// Cost: the calling task's tag is looked up without a lock (append-only
+// slots, each written by its own task), so untagged allocations only bump
+// two counters. Tagged allocations and frees take the spinlock for the
+// pointer table (bench rows heap_tags/untagged, heap_tags/tagged).
+//
+// Heap samples (free, minimum free, largest block) go into a small ring for
+// fragmentation over time. Everything is static (~5 KB), no allocation.
+namespace HeapTags {
+
+    enum Tag : uint8_t {
+        OTHER,        // Untagged: system, loop, libraries outside a scope
+        WEB,          // async_tcp task: requests, responses, chunk buffers
+        TLS,          // WiFiClientSecure handshake (mbedTLS buffers)
+        TELEGRAM,     // UniversalTelegramBot poll + messages
+        WEATHER,      // Weather task: HTTP client, snapshot
+        MQTT,
+        SENSOR,       // DHT task
+        DISPLAY,      // OLED task
+        TAG_COUNT
+    };
+
+    static const size_t TABLE_SIZE = 512;   // Power of two
+    static const size_t TABLE_LIMIT = 384;  // Max live tagged blocks (75% load)
+    static const size_t SAMPLES = 48;       // 24 h at one sample per 30 min
+
+    struct Stats {
+        uint32_t current;   // Live bytes (requested sizes; 0 for OTHER)
+        uint32_t peak;
+        uint32_t blocks;    // Live blocks
+        uint32_t allocs;    // Since boot
+        uint32_t frees;     // Since boot (0 for OTHER)
+        uint32_t bytes;     // Allocated since boot (wraps)
+    };
+
+    struct Sample {
+        uint32_t uptimeS;
+        uint32_t freeBytes;
+        uint32_t minFree;   // Since boot
+        uint32_t largest;   // Largest free block
+    };
+
+    const char* getName(Tag tag);
+
+    // Tag of the calling task while no Scope is active
+    void setTaskTag(Tag tag);
+    Tag currentTag();
+
+    // RAII: charges allocations of this task to 'tag' until the scope ends
+    class Scope {
+    public:
+        explicit Scope(Tag tag);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        uint8_t saved;
+    };
+
+    // Allocator hooks (must not allocate)
+    void onAlloc(void* p, size_t size);
+    void onFree(void* p);
+
+    Stats getStats(Tag tag);
+    uint32_t getUntracked();   // Tagged blocks that did not fit into the table
+    size_t getTracked();       // Live tagged blocks in the table
+
+    // Fragmentation history
+    void addSample(const Sample& s);
+    size_t getSampleCount();
+    bool getSample(size_t i, Sample& out); // i = 0 is the oldest
+    // Lowest largest-free-block seen by observe() and when (uptime s)
+    void observe(uint32_t largest, uint32_t uptimeS);
+    uint32_t getMinLargest();
+    uint32_t getMinLargestAt();
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <Arduino.h>
+#include "SeriesFile.h"
+
+class SensorManager; // Forward Declaration
+
+// Streams the history ring as a JSON array into chunked-response buffers:
+// [{"t":22.5,"h":45.0,"time":1700000000},...]
+// With 'since', only records newer than that timestamp are written
+// (incremental polling, e.g. by the fleet collector).
+//
+// Records are pulled from SensorManager in batches of up to 32 (thread-safe
+// copy), so neither the array nor a JSON document is ever held in RAM.
+// No web server dependencies: the same writer backs /api/history and the
+// native benchmark.
+class HistoryJsonWriter {
+public:
+    static const size_t BATCH = 32;      // Records per copyHistory() call
+    static const size_t MAX_RECORD = 64; // Conservative size of one object
+
+    explicit HistoryJsonWriter(SensorManager* sm, uint32_t since = 0);
+
+    // Fills up to maxLen bytes with the next part of the array.
+    // May return 0 before the end if maxLen is too small for one record;
+    // check isDone() to tell the end of the stream apart.
+    size_t fill(uint8_t* buffer, size_t maxLen);
+    bool isDone() const { return finalized; }
+
+private:
+    SensorManager* sensorManager;
+    size_t offset;
+    uint32_t since;
+    bool started;   // '[' written (offset may not start at 0)
+    bool first;     // No record written yet (no comma)
+    bool finalized;
+};
+
+// Same stream in the binary series format (SeriesFile.h) for
+// /api/history.bin: fixed 4 KB blocks with min/max headers and an index, so
+// exports can be mmapped and range-searched by tools without parsing.
+// Holds one block (~4.2 KB) per response.
+class HistorySeriesWriter {
+public:
+    HistorySeriesWriter(SensorManager* sm, uint32_t since, uint8_t columns, uint32_t created);
+
+    // Fills up to maxLen bytes; returns 0 only at the end of the stream
+    size_t fill(uint8_t* buffer, size_t maxLen);
+    bool isDone() const { return writer.isDone(); }
+
+private:
+    SensorManager* sensorManager;
+    size_t offset;
+    uint32_t since;
+    bool started;
+    SeriesWriter writer;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+
+// Compact hourly outdoor forecast (open-meteo hourly data)
+//
+// Fixed-size, quantized storage (6 bytes/hour, 288 bytes for 48h):
+//   temperature 0.1 °C, relative humidity 1 %, absolute humidity 0.01 g/m3
+// Absolute humidity is precomputed once per fetch so readers never call exp().
+class HourlyForecast {
+public:
+    static const size_t HOURS = 48;
+
+    struct Point {
+        int16_t t10;    // °C * 10
+        uint16_t ah100; // g/m3 * 100
+        uint8_t rh;     // %
+    } __attribute__((packed));
+
+    HourlyForecast();
+
+    void clear();
+    // Starts a new forecast at startTs (unix time of hour 0)
+    void begin(uint32_t startTs);
+    // Appends the next hour. Returns false when full or values are invalid.
+    bool append(float t, float rh);
+
+    size_t size() const { return count; }
+    uint32_t getStartTime() const { return startTs; }
+    uint32_t getEndTime() const;
+    bool covers(uint32_t ts) const;
+
+    // Linear interpolation between hourly points. Returns false outside range.
+    bool sample(uint32_t ts, float& t, float& rh, float& ah) const;
+    // Raw access (index 0 = startTs)
+    Point at(size_t index) const { return points[index]; }
+
+    static float toTemp(const Point& p) { return p.t10 / 10.0f; }
+    static float toAbsHum(const Point& p) { return p.ah100 / 100.0f; }
+
+private:
+    uint32_t startTs;
+    uint8_t count;
+    Point points[HOURS];
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Shared HTTPS connections (one persistent TLS client per remote host)
+//
+// - Root CA pinned per host (no setInsecure())
+// - Connection kept alive between requests; a TLS handshake is only paid
+//   when the server closed the socket or the idle timeout released it
+// - Idle connections are closed to give the ~40 KB TLS buffers back to the heap
+//
+// Note: the Arduino core does not expose mbedTLS session tickets, so
+// "resumption" here means keep-alive reuse of the established session.
+//
+// A WiFiClientSecure is not thread-safe. Each host has a mutex that the
+// task making a request holds from ensureConnected() to touch(); the idle
+// reaper (update(), loop task) only try-locks it, so it never calls
+// connected()/stop() on a client another task is using.
+class HttpsManager {
+public:
+    enum class Host { TELEGRAM, WEATHER, COUNT };
+
+    struct Stats {
+        uint32_t requests;        // ensureConnected() calls
+        uint32_t reused;          // Served by an already open connection
+        uint32_t handshakes;      // Successful TLS handshakes
+        uint32_t failures;        // Failed connects
+        uint32_t idleCloses;      // Closed by idle timeout
+        uint32_t lastHandshakeMs;
+        uint32_t maxHandshakeMs;
+        uint32_t totalHandshakeMs;
+    };
+
+    HttpsManager();
+    void update(); // Closes idle connections (call from loop)
+
+    // Returns the client for host (connect state is managed by ensureConnected)
+    WiFiClientSecure& client(Host host);
+
+    // Opens (or reuses) the TLS connection. Call right before a request.
+    // true: the caller holds the host until touch() (not reentrant).
+    bool ensureConnected(Host host);
+
+    // Ends the request: restarts the idle timer and releases the host
+    // (call after a successful ensureConnected(), from the same task).
+    void touch(Host host);
+
+    void close(Host host); // Between requests only
+
+    const Stats& getStats(Host host) const;
+    const char* getHostName(Host host) const;
+    bool isConnected(Host host);
+
+private:
+    struct Endpoint {
+        const char* host;
+        uint16_t port;
+        const char* rootCA;
+        unsigned long idleTimeoutMs;
+    };
+
+    static const size_t HOST_COUNT = (size_t)Host::COUNT;
+    static const Endpoint ENDPOINTS[HOST_COUNT];
+
+    WiFiClientSecure clients[HOST_COUNT];
+    Stats stats[HOST_COUNT];
+    unsigned long lastActivity[HOST_COUNT];
+    SemaphoreHandle_t locks[HOST_COUNT]; // Held while a request uses the client
+};
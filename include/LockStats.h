@@ -0,0 +1,90 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Contention statistics of one mutex, per call site
+//
+// Each call site has a name and its own acquisition timeout. Every
+// acquisition records its wait time, every release its hold time, into
+// decade histograms; a failed acquisition counts as a timeout. Updates are
+// made while the mutex is held, so they need no locking of their own (only
+// the timeout counter, bumped without the mutex, is atomic). Counters never
+// reset; rates come from two reads. About 90 bytes per site, no heap.
+class LockStats {
+public:
+    static const size_t BUCKETS = 6; // < 10 µs, < 100 µs, < 1 ms, < 10 ms, < 100 ms, >= 100 ms
+    static const size_t MAX_SITES = 12;
+
+    struct SiteInfo {
+        const char* name;    // String literal (shown in diagnostics)
+        uint32_t timeoutMs;  // Wait limit before the caller skips its work
+    };
+
+    struct Site {
+        uint32_t acquired;
+        uint32_t timeouts;
+        uint32_t wait[BUCKETS];  // Successful acquisitions by wait time
+        uint32_t hold[BUCKETS];  // Releases by hold time
+        uint32_t maxWaitUs;
+        uint32_t maxHoldUs;
+        uint64_t totalWaitUs;
+        uint64_t totalHoldUs;
+    };
+
+    // 'table' must outlive the object (static); sites beyond MAX_SITES are ignored
+    LockStats(const SiteInfo* table, size_t n);
+
+    size_t getSiteCount() const { return count; }
+    const SiteInfo& getInfo(uint8_t site) const { return info[site]; }
+    // Plain copy: take the mutex first for a consistent snapshot
+    // (SensorManager::copyLockStats)
+    const Site& getSite(uint8_t site) const { return sites[site]; }
+
+    // Longest hold so far and where it happened (-1 before the first release)
+    uint32_t getMaxHoldUs() const { return maxHoldUs; }
+    int getMaxHoldSite() const { return maxHoldSite; }
+    // Current owner (-1 if free) and how long it has held the mutex. Lock-free:
+    // meant for finding a stuck holder from another task.
+    int getHolder(uint32_t& heldUs) const;
+
+    static uint8_t bucket(uint32_t us);
+
+private:
+    friend class ScopedLock;
+    void acquired(uint8_t site, uint32_t waitUs, uint32_t now);
+    void released(uint8_t site, uint32_t now);
+    void timedOut(uint8_t site);
+
+    const SiteInfo* info;
+    size_t count;
+    Site sites[MAX_SITES];
+    uint32_t maxHoldUs;
+    int8_t maxHoldSite;
+    volatile int8_t holder;
+    volatile uint32_t holdStart; // micros() at acquisition
+};
+
+// RAII guard: takes the mutex with the timeout of its call site and gives it
+// back when the scope ends. Acquisition can fail: test the guard before
+// touching shared state, otherwise the work must be skipped.
+//
+//   ScopedLock lock(dataMutex, lockStats, LOCK_PLAN);
+//   if (!lock) return 0;
+class ScopedLock {
+public:
+    ScopedLock(SemaphoreHandle_t mutex, LockStats& stats, uint8_t site);
+    ~ScopedLock() { unlock(); }
+    ScopedLock(const ScopedLock&) = delete;
+    ScopedLock& operator=(const ScopedLock&) = delete;
+
+    explicit operator bool() const { return owned; }
+    bool owns() const { return owned; }
+    void unlock(); // Early release (no-op if not owned)
+
+private:
+    SemaphoreHandle_t mutex;
+    LockStats& stats;
+    uint8_t site;
+    bool owned;
+};
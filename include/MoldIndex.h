@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+
+// Surface model (Settings.h)
+#ifndef MOLD_FRSI
+#define MOLD_FRSI 0.75f // Temperature factor of the coldest wall spot (ISO 13788: mold-safe >= 0.75)
+#endif
+#ifndef MOLD_ALERT_INDEX
+#define MOLD_ALERT_INDEX 1.0f // First alert / critical advice (1 = microscopic initial growth)
+#endif
+
+// VTT mold growth index (Hukka & Viitanen 1999, sensitive material: pine
+// sapwood, sawn surface), integrated reading by reading.
+//
+// Scale: 0 no growth, 1 microscopic initial growth, 2 moderate microscopic,
+// 3 visible initial growth, 4 visible < 10% coverage, 5 > 50%, 6 full.
+// The index grows while the surface is above the critical humidity (~80%
+// at 20 °C, higher when cold) and declines slowly once it is dry again, so
+// a single humid hour barely moves it while weeks of damp walls do.
+//
+// State is two floats (index + hours since the surface dried out): constant
+// memory, a few exp/log per update, and a plain struct for NVS. No Arduino
+// dependencies, so it runs in the native benchmark as well.
+class MoldIndex {
+public:
+    struct State {
+        float index;
+        float dryHours; // Time since growth conditions ended, saturates at 24 h
+    };
+
+    MoldIndex();
+
+    // Surface conditions over the last 'hours'. Out of the model range
+    // (T <= 0 or >= 50 °C, NAN) counts as unfavourable.
+    void update(float surfaceTemp, float surfaceRh, float hours);
+
+    void restore(const State& s);
+    State getState() const { return state; }
+    float getIndex() const { return state.index; }
+    uint8_t getLevel() const { return (uint8_t)state.index; }
+    float getRate() const { return rate; }        // Index per day over the last update
+    bool isGrowing() const { return rate > 0; }
+
+    // Critical relative humidity for growth at temperature t (%)
+    static float criticalRh(float t);
+    // Coldest wall spot: outdoor + fRsi * (indoor - outdoor); indoor if no
+    // outdoor temperature or if it is warmer outside
+    static float surfaceTemp(float indoor, float outdoor, float fRsi);
+
+private:
+    State state;
+    float rate;
+    float carry; // Rounding compensation of the index sum
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Byte stream under the MQTT client (WiFiClient on the device, a POSIX
+// socket in the native benchmark). read()/write() must not block for long.
+class MqttTransport {
+public:
+    virtual ~MqttTransport() {}
+    virtual bool open(const char* host, uint16_t port) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() = 0;
+    virtual int write(const uint8_t* data, size_t len) = 0; // Bytes written, < 0 on error
+    virtual int read(uint8_t* data, size_t len) = 0;        // 0 if nothing pending, < 0 on error
+};
+
+// Minimal MQTT 3.1.1 publisher: CONNECT (clean session, last will,
+// optional user/password), QoS 0 PUBLISH, keep-alive PINGREQ, DISCONNECT.
+// Nothing is subscribed, so the broker only ever sends CONNACK and PINGRESP.
+//
+// publish() appends to a segment-sized transmit buffer; flush() hands it to
+// the transport in one write, so a backlog drains in few TCP segments.
+class MqttClient {
+public:
+    static const size_t TX_SIZE = 1460;        // One TCP segment on WiFi
+    static const uint16_t KEEP_ALIVE_SEC = 60;
+
+    struct Will {
+        const char* topic;
+        const char* payload;
+        bool retain;
+    };
+
+    explicit MqttClient(MqttTransport* transport);
+
+    // Opens the transport and waits up to timeoutMs for CONNACK
+    bool connect(const char* host, uint16_t port, const char* clientId, const Will& will,
+                 const char* user = nullptr, const char* pass = nullptr, uint32_t timeoutMs = 3000);
+    void disconnect();
+    bool isConnected();
+
+    // Queues one QoS 0 PUBLISH; false if the packet is larger than TX_SIZE or the write failed
+    bool publish(const char* topic, const char* payload, size_t len, bool retain);
+    bool flush();
+    // Packets handed to the transport by successful flushes (ever). A failed
+    // flush drops the buffer, so the packets in it are never counted.
+    uint32_t getSentPackets() const { return sentPackets; }
+
+    // Keep-alive and inbound bytes; call regularly (at least every KEEP_ALIVE_SEC / 2)
+    void loop();
+
+    // Sends PINGREQ and waits for PINGRESP: every earlier publish has been read by the broker
+    bool sync(uint32_t timeoutMs);
+
+private:
+    MqttTransport* transport;
+    bool connected;
+    uint8_t tx[TX_SIZE];
+    size_t txLen;
+    uint32_t txPackets;        // Packets in tx
+    uint32_t sentPackets;
+    uint32_t lastTxMs;
+    uint32_t pingSentMs;       // 0 = no ping outstanding
+    uint32_t pongs;            // PINGRESP count (sync() waits for the next one)
+
+    bool append(const uint8_t* data, size_t len);
+    bool appendPacket(uint8_t header, const uint8_t* var, size_t varLen, const uint8_t* payload, size_t payloadLen);
+    bool sendPing();
+    int poll(); // Parses inbound packets; returns the type of the last one (0 = none, -1 = error)
+
+    // Inbound parser (byte-wise: fixed header, remaining length, body)
+    uint8_t rxPhase;
+    uint8_t rxType;
+    uint32_t rxRemaining;
+    uint32_t rxMultiplier;
+    uint8_t rxBody[2];         // CONNACK flags + return code
+    uint8_t rxBodyLen;
+    uint8_t connackCode;       // 0xFF until a CONNACK arrived
+};
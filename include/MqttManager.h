@@ -0,0 +1,166 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Settings.h"
+#include "MqttClient.h"
+
+// Broker settings (Settings.h). An empty host disables MQTT.
+#ifndef MQTT_HOST
+#define MQTT_HOST ""
+#endif
+#ifndef MQTT_PORT
+#define MQTT_PORT 1883
+#endif
+#ifndef MQTT_USER
+#define MQTT_USER ""
+#endif
+#ifndef MQTT_PASS
+#define MQTT_PASS ""
+#endif
+#ifndef MQTT_SPILL_BYTES
+#define MQTT_SPILL_BYTES 65536 // Flash backlog behind the RAM queue (0 = RAM only)
+#endif
+
+class SensorManager; // Forward Declaration
+
+#if defined(ESP32)
+#include <WiFi.h>
+// Plain TCP to a broker on the LAN (persistent, reused for every publish)
+class WiFiMqttTransport : public MqttTransport {
+public:
+    bool open(const char* host, uint16_t port) override {
+        if (!client.connect(host, port, 2000)) return false;
+        client.setNoDelay(true); // Batches are flushed as whole segments anyway
+        return true;
+    }
+    void close() override { client.stop(); }
+    bool isOpen() override { return client.connected(); }
+    int write(const uint8_t* data, size_t len) override { return (int)client.write(data, len); }
+    int read(uint8_t* data, size_t len) override {
+        int available = client.available();
+        if (available <= 0) return client.connected() ? 0 : -1;
+        return client.read(data, min((size_t)available, len));
+    }
+
+private:
+    WiFiClient client;
+};
+#endif
+
+// MQTT publisher with Home Assistant discovery.
+//
+// Data flow: the sensor task pushes every reading and state transition
+// (onReading / onStateChange, cheap, own mutex). update() runs in the main
+// loop and turns them into messages:
+//   <base>/state     retained, latest reading + state + advice (HA sensors)
+//   <base>/readings  rapid mode: all readings of the last 30 s as one batch
+//   <base>/event     state transitions
+//   <base>/status    retained availability ("online", last will "offline")
+// Messages wait in a bounded RAM queue while the broker is unreachable.
+// When it is full, the oldest are moved to a flash file (FIFO, older than
+// everything in RAM), so the backlog is published in order on reconnect.
+// Discovery configs are published once per boot after the first connect.
+class MqttManager {
+public:
+    enum Topic : uint8_t { TOPIC_STATE, TOPIC_READINGS, TOPIC_EVENT, TOPIC_STATUS, TOPIC_COUNT };
+
+    static const size_t QUEUE_SLOTS = 16;
+    static const size_t MAX_PAYLOAD = 480;       // Fits a full batch
+    static const size_t BATCH_MAX = 10;          // Readings per batch message
+    static const uint32_t BATCH_MS = 30000;      // Rapid mode: flush interval
+    static const uint32_t STATE_MS = 60000;      // Stable mode: state message interval
+    static const size_t DRAIN_PER_UPDATE = 32;   // Messages per update() call (keeps loop() responsive)
+
+    struct Stats {
+        uint32_t queued;          // Messages accepted (RAM)
+        uint32_t published;
+        uint32_t spilled;         // Moved to flash
+        uint32_t dropped;         // Lost: RAM and flash full, or too large
+        uint32_t connects;
+        uint32_t connectFailures;
+        uint32_t backlogPeak;     // Largest RAM + flash backlog
+        uint32_t lastDrainMs;     // Reconnect: time until the backlog was empty
+        uint32_t lastDrainCount;  // Messages in that backlog
+    };
+
+    MqttManager(SensorManager* sm, MqttTransport* transport);
+    void begin(const char* deviceId);    // deviceId: unique, used in topics and HA ids
+    void setSpillFile(const char* path, size_t maxBytes); // Path on a mounted FS (nullptr = off)
+
+    // Sensor task (called by SensorManager::processReading)
+    void onReading(float t, float h, float absHum, int state);
+    void onStateChange(int from, int to);
+
+    // Main loop: batching, connection, discovery, drain. Returns ms until the next call.
+    uint32_t update();
+
+    bool isEnabled() const { return host[0] != 0; }
+    bool isConnected() { return client.isConnected(); }
+    size_t getBacklog() const;
+    const Stats& getStats() const { return stats; }
+
+    void setBroker(const char* host, uint16_t port, const char* user, const char* pass);
+
+private:
+    struct Message {
+        uint8_t topic;
+        uint8_t retain;
+        uint16_t len;
+        char payload[MAX_PAYLOAD];
+    };
+    struct Sample {
+        uint32_t ts;
+        float t;
+        float h;
+    };
+
+    SensorManager* sensorManager;
+    MqttClient client;
+    const char* host;
+    uint16_t port;
+    const char* user;
+    const char* pass;
+    char deviceId[24];
+    char base[40];
+
+    // Pending input from the sensor task (guarded)
+    SemaphoreHandle_t inputMutex;
+    Sample batch[BATCH_MAX];
+    size_t batchCount;
+    uint32_t batchStartMs;
+    Sample latest;
+    float latestAbsHum;
+    int latestState;
+    bool hasLatest;
+    int events[4][2];            // from, to
+    size_t eventCount;
+
+    // Outgoing queue (main loop only): RAM ring + flash FIFO in front of it
+    Message queue[QUEUE_SLOTS];
+    size_t head;                 // Oldest
+    size_t count;
+    const char* spillPath;
+    size_t spillMax;
+    uint32_t spillRead;          // Offset of the oldest unsent record
+    uint32_t spillWrite;         // File size
+    uint32_t spillCount;         // Records not yet sent
+
+    uint32_t lastStateMs;
+    int lastAdviceCode;
+    bool discoverySent;
+    uint32_t retryMs;            // Next reconnect backoff
+    uint32_t lastAttemptMs;
+    uint32_t connectWaitMs;      // 0 = connect on the next update()
+    uint32_t drainStartMs;       // 0 = no backlog pending since reconnect
+    uint32_t drainStartCount;
+    Stats stats;
+
+    Message* push(Topic topic, bool retain);  // Slot for a new message (spills / drops the oldest)
+    void collect(uint32_t now);               // Input -> queue
+    bool connect(uint32_t now);
+    void publishDiscovery();
+    size_t drain();
+    bool spill(const Message& m);
+    void topicName(uint8_t topic, char* out, size_t len) const;
+};
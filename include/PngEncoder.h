@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Streaming 1-bit grayscale PNG encoder (pure code, no Arduino dependencies)
+//
+// Pull-based: the consumer asks for bytes (available()/next()/read()) and the
+// encoder produces one PNG chunk at a time into a fixed segment buffer.
+// Deflate uses the fixed Huffman table with a two-candidate match finder
+// (distance 1 = horizontal run, distance = stride = same column one row up),
+// which is enough for line charts that are mostly blank.
+// Width is limited to MAX_WIDTH so that one worst-case row fits a segment.
+//
+// Bitmap layout: row-major, MSB first, (width + 7) / 8 bytes per row,
+// bit 1 = white (the layout of GFXcanvas1 and ChartRenderer).
+class PngEncoder {
+public:
+    static const size_t SEGMENT_SIZE = 512; // Output buffer (one IDAT chunk max)
+    static const uint16_t MAX_WIDTH = 2048;
+
+    PngEncoder(const uint8_t* bitmap, uint16_t width, uint16_t height);
+
+    void reset();                   // Rewind to the PNG signature
+    bool available();               // More bytes pending?
+    uint8_t next();                 // Next byte (call only if available())
+    size_t read(uint8_t* dst, size_t maxLen);
+    size_t totalSize();             // Dry run: encoded size in bytes (rewinds)
+
+private:
+    enum class Stage { HEADER, IDAT, IEND, DONE };
+
+    const uint8_t* bitmap;
+    uint16_t width;
+    uint16_t height;
+    uint16_t rowBytes;              // Packed pixel bytes per row
+    uint16_t stride;                // rowBytes + 1 filter byte
+
+    Stage stage;
+    uint16_t row;                   // Next scanline to encode
+    bool streamStarted;             // zlib header written
+
+    uint8_t segment[SEGMENT_SIZE];
+    size_t segLen;
+    size_t segPos;
+    size_t chunkStart;
+
+    uint32_t bitBuf;
+    uint8_t bitCount;
+    uint32_t adlerA;
+    uint32_t adlerB;
+
+    void fill();
+    void beginChunk(const char* type);
+    void endChunk();
+    void putByte(uint8_t b) { segment[segLen++] = b; }
+    void putU32(uint32_t v);
+
+    // Deflate helpers
+    uint8_t streamByte(uint16_t r, int col) const;
+    void encodeRow();
+    void writeBits(uint32_t value, uint8_t n);
+    void writeHuff(uint16_t code, uint8_t len);
+    void writeLitLen(uint16_t sym);
+    void writeMatch(uint16_t len, uint16_t dist);
+    void flushBits();
+};
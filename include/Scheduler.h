@@ -0,0 +1,91 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Cooperative timer-wheel scheduler for the main loop
+//
+// Jobs are plain callbacks that return the delay (ms) until their next run,
+// or Scheduler::STOP to become idle (one-shot). Periodic jobs simply return
+// their period; adaptive ones (e.g. rapid sensor mode) return a new value
+// each time.
+//
+// Deadlines are kept in a 3-level hierarchical wheel (64 slots per level,
+// 10 ms tick -> 640 ms / 41 s / 43 min ranges), so scheduling and dispatch
+// are O(1) per job regardless of how many timers are pending. Per-level
+// occupancy bitmaps let msUntilNext() find the next deadline from the first
+// occupied slot of each level, so the loop sleeps until a job is actually
+// due (cascades happen on the way) instead of spinning.
+//
+// No Arduino dependencies: time is passed in, so the wheel can be
+// exercised and benchmarked on the host.
+class Scheduler {
+public:
+    typedef uint32_t (*JobFn)();
+
+    static const uint32_t STOP = 0;       // Returned by a job: do not reschedule
+    static const uint32_t TICK_MS = 10;
+    static const size_t MAX_JOBS = 16;
+    static const uint32_t NEVER = 0xFFFFFFFF; // msUntilNext(): no job pending
+
+    struct Stats {
+        uint32_t wakeups;      // runDue() calls
+        uint32_t idleWakeups;  // runDue() calls that dispatched nothing
+        uint32_t dispatched;   // Job executions
+        uint32_t cascades;     // Entries moved down a wheel level
+    };
+
+    Scheduler();
+
+    // Registers a job (idle until scheduled). Higher priority runs first
+    // when several jobs are due in the same tick. Returns id or -1.
+    int add(const char* name, JobFn fn, uint8_t priority = 0);
+    // (Re)arms a job to run delayMs after nowMs (replaces a pending deadline)
+    void schedule(int id, uint32_t delayMs, uint32_t nowMs);
+    void cancel(int id);
+    bool isPending(int id) const;
+
+    // Runs every job whose deadline has passed. Returns ms until the next
+    // deadline (the caller may sleep that long), NEVER if nothing is pending.
+    uint32_t runDue(uint32_t nowMs);
+    uint32_t msUntilNext(uint32_t nowMs) const;
+
+    const Stats& getStats() const { return stats; }
+    size_t getJobCount() const { return jobCount; }
+    const char* getName(int id) const;
+    uint32_t getRuns(int id) const;
+
+private:
+    static const uint8_t LEVELS = 3;
+    static const uint8_t SLOT_BITS = 6;
+    static const uint8_t SLOTS = 1 << SLOT_BITS;
+    static const int8_t NONE = -1;
+
+    struct Job {
+        const char* name;
+        JobFn fn;
+        uint8_t priority;
+        bool pending;
+        int8_t next;        // Next job in the same slot
+        uint8_t level;
+        uint8_t slot;
+        uint32_t expires;   // Absolute tick
+        uint32_t runs;
+    };
+
+    Job jobs[MAX_JOBS];
+    size_t jobCount;
+    int8_t wheel[LEVELS][SLOTS];   // Slot list heads
+    uint64_t occupied[LEVELS];     // Bit per non-empty slot
+
+    uint32_t currentTick;  // Last processed tick
+    uint32_t tickBaseMs;   // millis() value corresponding to currentTick
+    bool started;
+    bool dispatching;      // Inside runDue(): inserts are relative to currentTick
+    Stats stats;
+
+    void syncClock(uint32_t nowMs);
+    void insert(int id);
+    void unlink(int id);
+    void cascade(uint8_t level);
+    int8_t collectDue(); // Detaches the current level-0 slot, sorted by priority
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Health of the DHT22 read path
+//
+// The sensor task reports every bus transaction: a valid frame (with the
+// read duration) or a failure. Failures are classified from the duration,
+// because the driver only returns true/false: a sensor that does not answer
+// gives up after ~3 ms, a complete frame takes 5-8 ms (so a failure in that
+// window is a checksum error), and a frame that breaks off mid-way waits
+// 1 ms per missing pulse and takes longer.
+//
+// Checks on the valid frames:
+//   - stuck: identical frames (T and RH) in a row. A stable room repeats
+//     frames too, so the limit follows the learned chance p that a repeat
+//     is followed by another one (not the plain repeat share: with values
+//     near the middle of a 0.1 step, runs are longer than that predicts).
+//     A run of n has probability p^n; the run limit is where that drops
+//     below 1e-9 (clamped to 2 min .. 1 h of readings).
+//   - implausible: outside the DHT22 range, or faster change than air at
+//     the sensor can physically do.
+//
+// All counters are updated in O(1) per attempt; no heap, no Arduino
+// dependencies (runs in the native benchmark). Single writer (the sensor
+// task); readers may see a value one reading old.
+class SensorHealth {
+public:
+    enum class Status : uint8_t {
+        OK,
+        ERRORS,       // Many failed attempts (retries still succeed)
+        IMPLAUSIBLE,  // Frequent out-of-range / out-of-physics frames
+        STUCK,        // Identical frames far beyond the expected run
+        NO_READINGS   // No valid frame for NO_READING_SLOTS slots
+    };
+    enum class Failure : uint8_t { TIMEOUT, CHECKSUM };
+
+    static const uint8_t MAX_ATTEMPTS = 3;       // Per slot
+    static const uint32_t RETRY_BASE_MS = 1000;  // Doubles per retry
+    static const uint32_t MIN_GAP_MS = 2000;     // Last attempt to next slot (DHT22 sampling period)
+    static const uint32_t FRAME_MIN_US = 4500;   // Failures in [MIN, MAX] read a whole frame: checksum
+    static const uint32_t FRAME_MAX_US = 9000;
+    static const uint16_t NO_READING_SLOTS = 10;    // 1 min without a valid frame
+    static const uint32_t STUCK_MIN_RUN = 20;    // 2 min of identical frames
+    static const uint32_t STUCK_MAX_RUN = 600;   // 1 h: always stuck
+    static constexpr float MAX_T_RATE = 0.5f;    // °C per second
+    static constexpr float MAX_H_RATE = 3.0f;    // % RH per second
+
+    struct Stats {
+        uint32_t slots;        // Read slots (one per 6 s)
+        uint32_t frames;       // Valid frames
+        uint32_t timeouts;     // Failed attempts: no / incomplete answer
+        uint32_t checksums;    // Failed attempts: full frame, bad checksum
+        uint32_t retries;      // Extra attempts
+        uint32_t recovered;    // Slots saved by a retry
+        uint32_t lost;         // Slots without a valid frame
+        uint16_t lostStreak;   // Consecutive lost slots
+        uint32_t lastReadUs;   // Valid frames only
+        uint32_t maxReadUs;
+        uint64_t totalReadUs;
+        uint32_t stuckRun;     // Current run of identical frames
+        uint32_t stuckLimit;   // Run length that counts as stuck now
+        uint32_t stuckEvents;
+        uint32_t implausible;  // Out-of-range or out-of-physics frames
+        float repeatRate;      // Learned P(another repeat | run of 2+ repeats)
+        uint32_t repeatSamples;
+        float errorRate;       // Share of failed attempts (EWMA, ~64 attempts)
+        float implausibleRate; // Share of implausible frames (EWMA, ~64 frames)
+    };
+
+    SensorHealth();
+
+    // Wait before the next attempt, 0 = no more attempts in this slot
+    // (attempt = attempts made so far, elapsedMs since the slot started)
+    static uint32_t retryDelayMs(uint8_t attempt, uint32_t elapsedMs, uint32_t slotMs);
+    static Failure classify(uint32_t durationUs);
+
+    Failure onFailure(uint32_t durationUs);
+    void onFrame(float t, float h, uint32_t durationUs, uint32_t nowMs);
+    void endSlot(bool valid, uint8_t attempts);
+
+    Status getStatus() const;
+    const Stats& getStats() const { return stats; }
+    static const char* getName(Status s);
+
+private:
+    Stats stats;
+    float prevT;
+    float prevH;
+    uint32_t prevMs;
+    bool havePrev;
+    bool errorsLatched;      // Hysteresis for ERRORS / IMPLAUSIBLE
+    bool implausibleLatched;
+
+    void updateStuckLimit();
+};
@@ -3,6 +3,14 @@
 #include <Arduino.h>
 #include <DHT.h>
 #include "Settings.h"
+#include "VentilationPlanner.h"
+#include "Advice.h"
+#include "HampelFilter.h"
+#include "ClimateKalman.h"
+#include "MoldIndex.h"
+#include "SessionJournal.h"
+#include "LockStats.h"
+#include "SensorHealth.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
@@ -10,6 +18,8 @@
 #include <vector>
 
 class WeatherManager; // Forward Declaration
+class MqttManager;    // Forward Declaration
+struct OutdoorSample;
 
 // Optimized Record (12 bytes)
 struct Record { 
@@ -18,6 +28,39 @@ struct Record {
     float h; 
 };
 
+// Aggregate of one channel over a set of history records (NaN skipped)
+struct HistoryStats {
+    uint32_t count = 0;
+    float min = NAN;
+    float max = NAN;
+    double sum = 0;
+    double sumSq = 0;
+
+    void add(float v) {
+        if (isnan(v)) return;
+        if (count == 0 || v < min) min = v;
+        if (count == 0 || v > max) max = v;
+        count++;
+        sum += v;
+        sumSq += (double)v * v;
+    }
+    void merge(const HistoryStats& o) {
+        if (o.count == 0) return;
+        if (count == 0 || o.min < min) min = o.min;
+        if (count == 0 || o.max > max) max = o.max;
+        count += o.count;
+        sum += o.sum;
+        sumSq += o.sumSq;
+    }
+    float mean() const { return count ? (float)(sum / count) : NAN; }
+    float stddev() const {
+        if (count == 0) return NAN;
+        double m = sum / count;
+        double var = sumSq / count - m * m;
+        return var > 0 ? (float)sqrt(var) : 0.0f;
+    }
+};
+
 class SensorManager {
 public:
     SensorManager();
@@ -28,7 +71,9 @@ public:
     static void sensorTask(void* parameter);
 
     unsigned long getStateEnterTime() const; 
+    float getStateEnterAbsHum() const; // Abs. humidity when the current session started
     void setWeatherManager(WeatherManager* wm); 
+    void setMqttManager(MqttManager* mm); // Optional: readings + transitions are forwarded
     
     // Getters (Thread Safe-ish)
     float getTemp() const;
@@ -44,12 +89,20 @@ public:
     // Thread-Safe Chunk Access: Copies up to 'count' items starting at 'offset'
     // Returns number of items actually copied
     size_t copyHistory(size_t offset, size_t count, Record* destination);
+    // Offset of the first record newer than 'since' (binary search, ring is time-ordered)
+    size_t findHistoryOffset(uint32_t since);
+    // Temperature and humidity aggregates over from <= ts <= to. Whole
+    // 32-record blocks are answered from their summaries, only the two edge
+    // blocks are scanned. false if the data mutex was not available.
+    bool queryHistory(uint32_t from, uint32_t to, HistoryStats& t, HistoryStats& h);
     
     // Returns reading at index (0 = Oldest, count-1 = Newest) for Graphing convenience
     Record getHistoryPoint(size_t index) const; 
     
     // Analysis
-    String getRecommendation(); // Improved with Caching
+    AdviceState getAdvice(); // Cached id + plan hint (no heap)
+    // Formats the cached advice into buffer (always NUL-terminated), returns length
+    size_t getRecommendation(char* buffer, size_t len, Lang lang = Lang::RU);
     int getAdviceCode(); // Improved with Caching
     float getAvg24h() const; 
     
@@ -59,7 +112,37 @@ public:
     float getOutdoorAbsHum() const;
     float getIndoorAbsHum() const;
     bool isWeatherValid() const;
-    String getWeatherStatus() const; 
+    // Outlier filter counters (temperature / humidity channel)
+    HampelFilter::Stats getTempFilterStats() const;
+    HampelFilter::Stats getHumFilterStats() const;
+    // Kalman trend estimates (per minute) and filter counters
+    float getTempRate() const;
+    float getAbsHumRate() const;
+    ClimateKalman::Stats getKalmanStats() const;
+    // VTT mold index on the coldest wall spot (see MoldIndex.h)
+    float getMoldIndex() const;
+    float getMoldRate() const;      // Index per day, < 0 while declining
+    bool isMoldGrowing() const;
+    float getSurfaceTemp() const;   // Modelled wall spot, °C
+    float getSurfaceHum() const;    // RH at that spot, %
+    MoldIndex::State getMoldState() const;
+    void restoreMold(const MoldIndex::State& s); // Warm start (before begin())
+
+    // Airing session journal (thread-safe copies, 0 / false if the mutex was busy)
+    size_t copySessions(size_t offset, size_t count, VentSession* destination); // Oldest first
+    size_t getSessionCount() const;
+    bool getOpenSession(VentSession& target);     // false if no session is running
+    bool getSessionSummary(uint32_t since, SessionJournal::Summary& target);
+    uint32_t getSessionsClosed() const;           // Since boot: changes when an entry is added
+    void restoreSessions(const VentSession* source, size_t count); // Warm start (before begin())
+    size_t getWeatherStatus(char* buffer, size_t len) const;
+
+    // Forecast Ventilation Plan (Thread Safe Copy)
+    // Returns number of slots; bestIndex = most efficient slot or -1
+    size_t getPlan(VentSlot* destination, size_t maxCount, int& bestIndex);
+    uint32_t getPlanTime() const;
+    uint32_t getPlanRecomputeCount() const;
+    uint32_t getPlanMicros() const; // Cost of the last recompute
     // Physics & Smart State Machine (v5.0)
     // New Enum States (Must be defined before usage)
     enum class ClimateState { STABLE, VENTILATING, TARGET_MET, INEFFICIENT };
@@ -71,21 +154,50 @@ public:
     String getStateString() const; 
     int getStateCode() const;
 
-    // Thread Safety
-    void lock();
-    void unlock();
+    // dataMutex call sites (names and timeouts: LOCK_SITES in SensorManager.cpp)
+    enum LockSite : uint8_t {
+        LOCK_SENSOR_TASK, LOCK_UPDATE, LOCK_ADVICE, LOCK_PLAN, LOCK_HISTORY_SNAPSHOT,
+        LOCK_HISTORY_CHUNK, LOCK_HISTORY_FIND, LOCK_HISTORY_QUERY, LOCK_SESSIONS, LOCK_DIAG,
+        LOCK_SITE_COUNT
+    };
+    // Contention statistics: names, timeouts, max holder, current holder
+    const LockStats& getLockStats() const { return lockStats; }
+    // Consistent copy of the per-site counters (taken under the mutex, counted
+    // as LOCK_DIAG). Returns the number of sites copied, 0 if the mutex was busy.
+    size_t copyLockStats(LockStats::Site* destination, size_t maxCount);
+    // DHT read path: failures, retries, read time, stuck / implausible frames
+    SensorHealth::Stats getSensorHealthStats() const;
+    SensorHealth::Status getSensorHealth() const;
 
 private:
+    friend struct SensorBench; // Native benchmark (bench/) drives the private pipeline steps
+
     DHT dht;
     WeatherManager* weather; 
+    MqttManager* mqtt;
 
     // Optimization 5: Ring Buffer
     Record history[HISTORY_SIZE];
     size_t historyHead; // Points to the NEXT write position
     size_t historyCount; // Total items stored
+    // Block summaries: records are grouped by insertion number into blocks
+    // of 32, so a block covers one contiguous time span. The summaries form
+    // a ring as well (the oldest block may be partly evicted: queries scan it).
+    struct HistoryBlock {
+        uint32_t firstTs;
+        uint32_t lastTs;
+        HistoryStats t;
+        HistoryStats h;
+    };
+    static const size_t HISTORY_BLOCK = 32;
+    static const size_t HISTORY_BLOCKS = HISTORY_SIZE / HISTORY_BLOCK + 2;
+    HistoryBlock historyBlocks[HISTORY_BLOCKS];
+    uint32_t historySeq; // Records ever added (insertion number of the next one)
     
-    // Thread Safety
+    // Thread Safety: take dataMutex only through ScopedLock (timeout per call site)
     SemaphoreHandle_t dataMutex;
+    static const LockStats::SiteInfo LOCK_SITES[LOCK_SITE_COUNT];
+    LockStats lockStats;
 
     float currentTemp;
     float currentHum;
@@ -94,12 +206,27 @@ private:
     float avg24h;
     
     // Caching (Optimization 2)
-    String cachedAdvice;
-    int cachedCode;
+    AdviceState cachedAdvice;
     unsigned long lastAdviceUpdate;
     
-    // Smoothing State
-    float lastValidTemp;
+    // DHT read path health (written by the sensor task only)
+    SensorHealth health;
+
+    // Outlier Filter (sliding median, before smoothing)
+    HampelFilter tempFilter;
+    HampelFilter humFilter;
+
+    // State Estimate (Kalman: level + trend of T and abs. humidity)
+    ClimateKalman kalman;
+    unsigned long lastReadingTime;
+
+    // Airing sessions (fed by the state machine transitions)
+    SessionJournal journal;
+
+    // Mold growth on the coldest wall spot (fed per reading)
+    MoldIndex mold;
+    float surfaceTemp;
+    float surfaceHum;
     
     // Window Detection State & Physics Tracking
     float lastTempForWindowCheck;
@@ -128,9 +255,19 @@ private:
 
     unsigned long lastLogTime;  
 
+    // Forecast-driven airing plan (recomputed incrementally from update())
+    VentilationPlanner planner;
+    HourlyForecast forecastCache;    // Local copy, refreshed when the version changes
+    uint32_t forecastCacheVersion;
+
     // Helper Functions
     // float calculateDropRate() const; // DEPRECATED: Physics-based logic used instead
-    void processReading(float t, float h); 
+    // Weather has its own mutex: callers read it (readOutdoor) before taking
+    // dataMutex and pass the copy in, so the two locks are never nested
+    OutdoorSample readOutdoor() const;
+    void processReading(float t, float h, const OutdoorSample& outdoor);
     void addHistoryPoint(float t, float h);
-    void updateAdvice(); // Updates the cached string
+    void appendHistory(const Record& r); // Ring + block summary (caller holds dataMutex)
+    size_t historyUpperBound(uint32_t ts) const; // First offset with ts > 'ts' (caller holds dataMutex)
+    void updateAdvice(const OutdoorSample& outdoor); // Updates the cached advice id
 };
@@ -0,0 +1,230 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+// Binary time-series format for history records {ts, t, h} and derived
+// columns. Same encoder on the ESP32 (/api/history.bin), in dump files and
+// in Linux tools; a reader can mmap a file and binary-search time ranges
+// without parsing anything. All fields are little-endian.
+//
+//   FileHeader   64 bytes
+//   Block 0      BLOCK_BYTES: BlockHeader (64) + columns
+//   Block 1 ...
+//   Index        one IndexEntry per block
+//   Footer       32 bytes (last bytes of the file)
+//
+// Every block has the same size and capacity (blockRecords), so block i is
+// at 64 + i * BLOCK_BYTES. Inside a block the data is columnar at fixed
+// positions: ts[blockRecords], then one float[blockRecords] per value
+// column in bit order of the column mask. Only the first 'count' entries
+// are valid (the last block is usually partial). Timestamps are
+// non-decreasing across the whole file.
+//
+// A file without a footer (writer interrupted) is still readable: the
+// reader then takes the time ranges from the block headers.
+namespace SeriesFormat {
+    static const uint32_t FILE_MAGIC = 0x31534d41;   // "AMS1"
+    static const uint32_t BLOCK_MAGIC = 0x4b4c4241;  // "ABLK"
+    static const uint32_t FOOTER_MAGIC = 0x58444941; // "AIDX"
+    static const uint16_t VERSION = 1;
+    static const size_t HEADER_BYTES = 64;
+    static const size_t BLOCK_BYTES = 4096;          // One flash sector / memory page
+    static const size_t MAX_VALUES = 4;
+
+    // Value columns (bit order = storage order)
+    enum Column : uint8_t {
+        COL_T = 1,   // Temperature, °C
+        COL_H = 2,   // Relative humidity, %
+        COL_DP = 4,  // Dew point, °C (derived)
+        COL_AH = 8,  // Absolute humidity, g/m³ (derived)
+    };
+
+    struct FileHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerBytes;   // 64
+        uint32_t blockBytes;    // BLOCK_BYTES
+        uint16_t blockRecords;  // Capacity of one block
+        uint8_t columns;        // Column mask
+        uint8_t valueCount;     // Number of value columns
+        uint32_t created;       // Unix time of the export (0 = unknown)
+        uint8_t reserved[44];
+    };
+
+    struct BlockHeader {
+        uint32_t magic;
+        uint16_t count;         // Valid records in this block
+        uint16_t reserved0;
+        uint32_t index;         // Block number
+        uint32_t tsFirst;
+        uint32_t tsLast;
+        float min[MAX_VALUES];  // Per value column, NaN values ignored
+        float max[MAX_VALUES];  // (NaN if the block has no valid value)
+        uint32_t crc;           // CRC-32 of the block after the header
+        uint8_t reserved[8];
+    };
+
+    struct IndexEntry {
+        uint32_t tsFirst;
+        uint32_t tsLast;
+    };
+
+    struct Footer {
+        uint32_t magic;
+        uint32_t blockCount;
+        uint64_t recordCount;
+        uint32_t indexCrc;      // CRC-32 of the index entries
+        uint32_t tsFirst;
+        uint32_t tsLast;
+        uint32_t magic2;        // FOOTER_MAGIC again (detects a torn tail)
+    };
+
+    static_assert(sizeof(FileHeader) == HEADER_BYTES, "file header layout");
+    static_assert(sizeof(BlockHeader) == 64, "block header layout");
+    static_assert(sizeof(Footer) == 32, "footer layout");
+
+    inline uint8_t countValues(uint8_t columns) {
+        uint8_t n = 0;
+        for (uint8_t m = columns & 0x0f; m; m >>= 1) n += m & 1;
+        return n;
+    }
+    inline uint16_t blockCapacity(uint8_t columns) {
+        return (uint16_t)((BLOCK_BYTES - sizeof(BlockHeader)) / (4 * (1 + countValues(columns))));
+    }
+
+    uint32_t crc32(const void* data, size_t len, uint32_t crc = 0);
+}
+
+// Encoder with fixed RAM (one block buffer). Records are pushed in with
+// append(); encoded bytes are pulled out with read(), so it can feed a
+// chunked HTTP response as well as a file (writeTo()). Derived columns are
+// computed from t and h.
+class SeriesWriter {
+public:
+    explicit SeriesWriter(uint8_t columns = SeriesFormat::COL_T | SeriesFormat::COL_H, uint32_t created = 0);
+
+    // false while a finished block is still waiting to be read (read, then
+    // append again). Records older than the previous one are dropped.
+    bool append(uint32_t ts, float t, float h);
+
+    // Seals the last block and queues index and footer
+    void finish();
+
+    // Copies up to maxLen encoded bytes into out; 0 if nothing is ready
+    size_t read(uint8_t* out, size_t maxLen);
+
+    // Drains everything that is ready into f; false on a write error
+    bool writeTo(FILE* f);
+
+    bool isDone() const { return finished && state == DONE; }
+    uint64_t getRecordCount() const { return records; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    // Output order: file header, blocks (each read out before the next is
+    // built), index, footer
+    enum State { BUILDING, BLOCK, INDEX, FOOTER, DONE };
+    State state;
+    bool headerSent;
+    bool finished;
+    uint8_t valueCount;
+    uint16_t capacity;
+    uint64_t records;
+    uint32_t dropped;
+    uint32_t lastTs;
+    size_t outPos;          // Read position in the current output part
+    SeriesFormat::FileHeader fileHeader;
+    SeriesFormat::Footer footer;
+    uint8_t block[SeriesFormat::BLOCK_BYTES]; // Block being built / read out
+    std::vector<SeriesFormat::IndexEntry> index;
+
+    SeriesFormat::BlockHeader& header() { return *(SeriesFormat::BlockHeader*)block; }
+    float* column(size_t slot) { return (float*)(block + sizeof(SeriesFormat::BlockHeader)) + capacity * (slot + 1); }
+    void startBlock();
+    void sealBlock();
+    void nextPart();
+};
+
+// Read access to a series file in memory (mmap, or any buffer). Nothing is
+// copied; the data must stay valid while the reader is used.
+class SeriesReader {
+public:
+    struct BlockView {
+        const SeriesFormat::BlockHeader* header;
+        const uint32_t* ts;
+        const float* values[SeriesFormat::MAX_VALUES];
+    };
+    struct Stats {
+        uint64_t count;
+        float min;
+        float max;
+        double sum;
+        double sumSq;
+    };
+
+    // false if the header is invalid; a missing footer is not an error
+    bool open(const void* data, size_t len);
+
+    size_t getBlockCount() const { return blockCount; }
+    uint64_t getRecordCount() const { return recordCount; }
+    uint8_t getColumns() const { return fileHeader->columns; }
+    bool hasIndex() const { return index != nullptr; }
+
+    // Storage slot of a value column, -1 if the file does not have it
+    int slot(SeriesFormat::Column column) const;
+    BlockView block(size_t i) const;
+
+    // First block with tsLast >= ts (== getBlockCount() if none)
+    size_t findBlock(uint32_t ts) const;
+
+    // Calls fn(ts, value) for every record with from <= ts <= to (NaN values skipped)
+    template <typename Fn>
+    void forEach(uint32_t from, uint32_t to, SeriesFormat::Column column, Fn&& fn) const {
+        int s = slot(column);
+        if (s < 0) return;
+        for (size_t b = findBlock(from); b < blockCount; b++) {
+            BlockView v = block(b);
+            if (v.header->tsFirst > to) break;
+            for (size_t i = 0; i < v.header->count; i++) {
+                if (v.ts[i] < from || v.ts[i] > to || v.values[s][i] != v.values[s][i]) continue;
+                fn(v.ts[i], v.values[s][i]);
+            }
+        }
+    }
+
+    // Count, min, max, sums over [from, to] (NaN values skipped). With
+    // minMaxOnly, blocks that lie completely inside the range are answered
+    // from their headers; only min and max are meaningful then.
+    Stats aggregate(uint32_t from, uint32_t to, SeriesFormat::Column column, bool minMaxOnly = false) const;
+
+    // Checks every block CRC and the index CRC
+    bool verify() const;
+
+private:
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    const SeriesFormat::FileHeader* fileHeader = nullptr;
+    const SeriesFormat::IndexEntry* index = nullptr; // From the footer, or null
+    size_t blockCount = 0;
+    uint64_t recordCount = 0;
+
+    uint32_t blockTsLast(size_t i) const;
+};
+
+#if !defined(ESP32)
+// Read-only mmap of a file (Linux tools, native build)
+class MappedFile {
+public:
+    ~MappedFile() { close(); }
+    bool open(const char* path);
+    void close();
+    const void* data() const { return addr; }
+    size_t size() const { return length; }
+
+private:
+    void* addr = nullptr;
+    size_t length = 0;
+};
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// How a phase of an airing session ended
+enum class SessionExit : uint8_t {
+    NONE,       // Still running
+    TARGET_MET, // Adaptive humidity target reached
+    PLATEAU,    // Drying stalled (INEFFICIENT)
+    REBOUND,    // Window closed (temperature / abs. humidity rebound)
+    TIMEOUT     // No window close seen within 1 h after target / plateau
+};
+
+// One airing session: STABLE -> VENTILATING [-> TARGET_MET | INEFFICIENT] -> STABLE.
+// Filled incrementally while the session runs (no history scan).
+struct VentSession {
+    uint32_t start;         // Unix time of the window opening
+    uint32_t durationSec;   // Opening -> back to STABLE
+    uint32_t dryingSec;     // VENTILATING phase
+    float startHum;         // RH %
+    float endHum;
+    float startAbsHum;      // g/m³
+    float dryEndAbsHum;     // At the end of the VENTILATING phase
+    float minAbsHum;
+    float endAbsHum;        // Latest while the session runs
+    float startTemp;        // °C
+    float minTemp;
+    float outTemp;          // Outdoor at the start, NAN without weather
+    float outAbsHum;
+    float peakRate;         // Fastest drying, g/m³ per min (positive)
+    uint16_t readings;
+    SessionExit dryingExit; // TARGET_MET, PLATEAU or REBOUND (closed while drying)
+    SessionExit exit;       // REBOUND or TIMEOUT
+
+    float removed() const { return startAbsHum - minAbsHum; }   // g/m³
+    float dryingRate() const;                                   // g/m³ per min over the drying phase
+    float heatLoss() const { return startTemp - minTemp; }      // °C
+};
+
+// Fixed-capacity ring of finished sessions plus the one in progress.
+// 64 bytes per entry; the oldest entry is overwritten. Not thread-safe:
+// SensorManager drives it from processReading() under its data mutex.
+// No Arduino dependencies (runs in the native benchmark).
+class SessionJournal {
+public:
+    static const size_t CAPACITY = 48; // ~2 weeks at 3 airings per day
+
+    struct Summary {
+        uint32_t count;
+        uint32_t byExit[5];    // Indexed by SessionExit of the drying phase
+        uint32_t timeouts;     // Closed by the 1 h timeout
+        float avgMinutes;      // Whole session
+        float avgRemoved;      // g/m³
+        float avgRate;         // g/m³ per min while drying
+        float avgHeatLoss;     // °C
+    };
+
+    SessionJournal();
+
+    // State machine hooks (millis-based durations, unix start time)
+    void open(uint32_t ts, uint32_t ms, float t, float hum, float absHum, float outTemp, float outAbsHum);
+    void reading(float t, float hum, float absHum, float absHumRate); // Every reading while open
+    void dryingEnded(uint32_t ms, SessionExit how, float absHum);
+    void close(uint32_t ms, SessionExit how, float hum, float absHum);
+
+    bool isOpen() const { return active; }
+    // Session in progress with durations up to 'ms'
+    VentSession current(uint32_t ms) const;
+    size_t count() const { return stored; }
+    uint32_t getClosedCount() const { return closed; } // Since boot (persistence trigger)
+
+    // Finished sessions, oldest first; returns the number copied
+    size_t copy(size_t offset, size_t n, VentSession* out) const;
+    // Warm start: entries oldest first (keeps the newest CAPACITY)
+    void restore(const VentSession* in, size_t n);
+    // Aggregate over finished sessions that started at or after 'since'
+    Summary summarize(uint32_t since) const;
+
+private:
+    VentSession ring[CAPACITY];
+    size_t head;     // Next write position
+    size_t stored;
+    uint32_t closed;
+    bool active;
+    VentSession cur;
+    uint32_t startMs;
+};
+
+const char* sessionExitName(SessionExit e); // "target", "plateau", "rebound", "timeout", "none"
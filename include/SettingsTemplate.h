@@ -27,6 +27,24 @@
 // Get your Chat ID by messaging @userinfobot on Telegram
 #define OWNER_CHAT_ID "YOUR_CHAT_ID_HERE"
 
+// -------------------------------------------------------------------------
+// MQTT / Home Assistant (optional — leave MQTT_HOST empty to disable)
+// -------------------------------------------------------------------------
+// Sensors appear in Home Assistant automatically (MQTT discovery)
+#define MQTT_HOST ""               // Broker address, e.g. "192.168.1.10"
+#define MQTT_PORT 1883
+#define MQTT_USER ""               // Empty = anonymous
+#define MQTT_PASS ""
+#define MQTT_SPILL_BYTES 65536     // Offline backlog in flash (LittleFS), 0 = RAM only
+
+// -------------------------------------------------------------------------
+// Mold Index (VTT model on the coldest wall spot)
+// -------------------------------------------------------------------------
+// Wall spot temperature = outdoor + MOLD_FRSI * (indoor - outdoor)
+// 0.75 = typical insulated wall corner, lower for old/uninsulated walls
+#define MOLD_FRSI 0.75f
+#define MOLD_ALERT_INDEX 1.0f      // Telegram alert + critical advice from this index
+
 // -------------------------------------------------------------------------
 // WiFi Connectivity
 // -------------------------------------------------------------------------
@@ -49,11 +67,13 @@ const float HUM_OFFSET = +10.9f;   // Humidity offset in %
 
 // Anomaly Detection
 const float MAX_TEMP_JUMP = 2.0f;  // Max allowed jump between readings
-const float EMA_ALPHA = 0.2f;      // EMA smoothing factor (0.0 - 1.0)
 
 // Advice Logic Thresholds
 const float HUMIDITY_HIGH_THRESHOLD = 60.0f; // >60% -> Elevated risk
-const float HUMIDITY_LOW_THRESHOLD = 40.0f;  // <40% -> Too dry
+const float HUMIDITY_LOW_THRESHOLD = 35.0f;  // <35% -> Too dry
+
+// NOTE: Offsets, filter and thresholds above are only the defaults. They can
+// be changed at runtime via /api/config (stored in NVS, see Config.h).
 const float RAPID_DROP_THRESHOLD = 2.0f;     // % drop per interval -> Ventilating
 
 // -------------------------------------------------------------------------
@@ -0,0 +1,63 @@
+#pragma once
+#include <Adafruit_GFX.h>
+#include "SensorManager.h"
+
+// 24h temperature / humidity sparkline for the OLED (two stacked panels).
+//
+// History is folded into fixed time buckets (one per pixel column) kept in
+// a column ring. New records are appended incrementally: when time moves
+// on, the ring and the 1-bit canvas are shifted left and only the newest
+// columns are drawn. The canvas is fully redrawn only when the (rounded)
+// scale of a panel changes or after a gap that requires a rebuild.
+class Sparkline {
+public:
+    static const uint16_t WIDTH = 128;
+    static const uint16_t HEIGHT = 56;                        // 896 B canvas
+    static const uint32_t BUCKET_SEC = 24UL * 3600 / WIDTH;   // 11.25 min per column
+
+    Sparkline();
+
+    // Pulls new history records (reads only the newest batch in steady state)
+    void sync(SensorManager* sensorManager);
+    // Brings the canvas up to date and blits it at (x, y)
+    void draw(Adafruit_GFX& target, int16_t x, int16_t y);
+
+    bool hasData() const { return lastTs != 0; }
+    // Current panel scales (rounded: 1 °C / 5 %)
+    void getRange(int16_t& tMin, int16_t& tMax, uint8_t& hMin, uint8_t& hMax) const;
+
+private:
+    static const int16_t EMPTY = INT16_MIN;
+    static const uint16_t PANEL_H = 27;   // Temperature: rows 0..26, humidity: 29..55
+    static const uint16_t H_TOP = 29;
+
+    GFXcanvas1 canvas;
+
+    // Column ring: index (head + i) % WIDTH, i = 0 oldest .. WIDTH-1 newest
+    int16_t colT10[WIDTH];
+    uint8_t colH[WIDTH];
+    uint16_t head;
+    uint32_t newestBucket;   // Absolute bucket number of the newest column
+    uint32_t lastTs;         // Newest record already folded in
+
+    // Running average of the newest (still open) column
+    int32_t sumT10;
+    uint16_t sumH;
+    uint8_t sumN;
+
+    // Incremental drawing state
+    uint16_t pendingShift;   // Columns shifted since the last draw
+    bool newestChanged;
+    bool needFull;
+    int16_t drawnTMin, drawnTMax;
+    uint8_t drawnHMin, drawnHMax;
+
+    void reset();
+    void rebuild(SensorManager* sensorManager);
+    void append(const Record& r);
+    void shiftColumns(uint32_t n);
+    int16_t columnT(uint16_t i) const { return colT10[(head + i) % WIDTH]; }
+    uint8_t columnH(uint16_t i) const { return colH[(head + i) % WIDTH]; }
+    void drawColumns(uint16_t from, uint16_t to, int16_t tMin, int16_t tMax, uint8_t hMin, uint8_t hMax);
+    void shiftCanvasLeft(uint16_t n);
+};
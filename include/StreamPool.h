@@ -0,0 +1,118 @@
+#pragma once
+#include <Arduino.h>
+#include <new>
+#include <utility>
+
+// Admission control for streaming responses
+//
+// A fixed number of slots, claimed with a lock-free bitmap. A full pool
+// rejects the request (the caller answers 503 + Retry-After) instead of
+// letting concurrent streams grow without bound. Counters never reset;
+// like LockStats, rates come from two reads. No heap.
+class StreamSlots {
+public:
+    static const size_t MAX_SLOTS = 32; // Bitmap width
+
+    struct Stats {
+        uint32_t capacity;
+        uint32_t inUse;
+        uint32_t peak;          // Most slots in use at once
+        uint32_t served;        // Streams started
+        uint32_t rejected;      // Requests turned away (pool full)
+        uint32_t completed;     // Streams that reached their end
+        uint32_t aborted;       // Ended early (client went away)
+        uint32_t maxDurationMs; // Longest stream so far
+        uint32_t lastDurationMs;
+    };
+
+    // 'name' must be a string literal (shown in diagnostics)
+    StreamSlots(const char* name, size_t capacity);
+
+    const char* getName() const { return name; }
+    Stats getStats() const;
+
+protected:
+    int claim();                            // Slot index, -1 if full
+    void release(int slot, bool completed); // Caller destroyed the context
+
+private:
+    const char* name;
+    uint32_t capacity;
+    uint32_t used;    // Bitmap of claimed slots
+    uint32_t peak;
+    uint32_t served;
+    uint32_t rejected;
+    uint32_t completed;
+    uint32_t aborted;
+    uint32_t maxDurationMs;
+    uint32_t lastDurationMs;
+    uint32_t started[MAX_SLOTS]; // millis() at claim
+};
+
+// N pre-allocated contexts of type T (T must provide isDone()).
+//
+// acquire() constructs a T in a free slot and returns a Lease: a
+// reference-counted handle (one pointer + slot) that is captured by value in
+// a chunked response callback. The context is destroyed and its slot freed
+// when the last copy goes, i.e. when the response is deleted, whether the
+// stream finished or the client disconnected.
+//
+//   auto lease = historyStreams.acquire(sensorManager, since);
+//   if (!lease) { /* 503 */ }
+//   request->beginChunkedResponse(..., [lease](...) { return lease->fill(...); });
+template <typename T, size_t N>
+class StreamPool : public StreamSlots {
+    static_assert(N > 0 && N <= MAX_SLOTS, "StreamPool: 1..32 slots");
+
+public:
+    class Lease {
+    public:
+        Lease() : pool(nullptr), slot(-1) {}
+        Lease(const Lease& o) : pool(o.pool), slot(o.slot) { retain(); }
+        Lease(Lease&& o) : pool(o.pool), slot(o.slot) { o.pool = nullptr; }
+        Lease& operator=(Lease o) {
+            std::swap(pool, o.pool);
+            std::swap(slot, o.slot);
+            return *this;
+        }
+        ~Lease() { if (pool) pool->drop(slot); }
+
+        explicit operator bool() const { return pool != nullptr; }
+        T* operator->() const { return pool->object(slot); }
+        T& operator*() const { return *pool->object(slot); }
+
+    private:
+        friend class StreamPool;
+        Lease(StreamPool* pool, int slot) : pool(pool), slot(slot) {}
+        void retain() { if (pool) __atomic_fetch_add(&pool->refs[slot], 1, __ATOMIC_RELAXED); }
+
+        StreamPool* pool;
+        int slot;
+    };
+
+    explicit StreamPool(const char* name) : StreamSlots(name, N), refs() {}
+
+    // Empty lease if every slot is busy
+    template <typename... Args>
+    Lease acquire(Args&&... args) {
+        int slot = claim();
+        if (slot < 0) return Lease();
+        new (storage[slot]) T(std::forward<Args>(args)...);
+        refs[slot] = 1;
+        return Lease(this, slot);
+    }
+
+private:
+    T* object(int slot) { return reinterpret_cast<T*>(storage[slot]); }
+
+    void drop(int slot) {
+        if (__atomic_sub_fetch(&refs[slot], 1, __ATOMIC_ACQ_REL) != 0) return;
+        T* obj = object(slot);
+        bool done = obj->isDone();
+        obj->~T();
+        release(slot, done);
+    }
+
+    alignas(T) uint8_t storage[N][sizeof(T)];
+    uint16_t refs[N];
+};
@@ -1,10 +1,11 @@
 #pragma once
 #include <Arduino.h>
-#include <WiFiClientSecure.h>
 #include <UniversalTelegramBot.h>
 #include <vector>
 #include "Settings.h"
 #include "SensorManager.h"
+#include "PngEncoder.h"
+#include "HttpsManager.h"
 
 // Struct for Subscriber
 struct Subscriber {
@@ -16,29 +17,41 @@ struct Subscriber {
 
 class TelegramManager {
 public:
-    TelegramManager(SensorManager* sm);
+    TelegramManager(SensorManager* sm, HttpsManager* https);
     void begin();
-    void update(); // Main loop handler
+    void update(); // Polls messages + checks alerts (scheduled every 3s)
     
-    void broadcastAlert(const String& msg, int level); // level: 1=Info/Green, 2=Warn/Red
+    void broadcastAlert(const char* msg, int level); // level: 1=Info/Green, 2=Warn/Red
     
 private:
     SensorManager* sensorManager;
-    WiFiClientSecure client;
+    HttpsManager* https; // Owns the pinned, persistent TLS client
     UniversalTelegramBot* bot;
     
-    unsigned long lastPollTime;
     int lastAdviceCode; // To track changes
     SensorManager::ClimateState lastClimateState;
-    bool moldAlertSent;
+    int8_t moldAlertStep; // Mold index thresholds announced (-1 = not yet known after boot)
     bool timeoutAlertSent;
+    SensorHealth::Status lastSensorHealth;
+    SensorHealth::Status sensorAlerted;  // Last problem announced
+    unsigned long sensorAlertTime;
+    bool sensorRecoveryPending;          // Problem announced, recovery not yet
     
     std::vector<Subscriber> subscribers;
     
+    bool connect(); // Reuses the open TLS session or performs a timed handshake
     void handleNewMessages(int numNewMessages);
     void sendMainMenu(const String& chatId, const String& welcomeMsg = "");
     void sendStatus(const String& chatId);
+    void sendChart(const String& chatId);
+    void sendSessions(const String& chatId); // 7-day airing summary + last sessions
     void subscribe(const String& chatId, const String& firstName);
     void toggleMute(const String& chatId);
     bool isAuthorized(const String& chatId); // Simple check if needed
+    static int moldStep(float index); // Mold alert thresholds reached by index (0 = none)
+
+    // sendPhotoByBinary() takes plain function pointers - route them to the active encoder
+    static PngEncoder* activePng;
+    static bool pngMoreData();
+    static byte pngNextByte();
 };
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+
+// Low-overhead hot-path tracing
+//
+// Begin/end/counter events with microsecond timestamps go into one fixed
+// ring buffer per core (oldest events are overwritten). Recording is a
+// lock-free slot reservation + 16-byte store, no allocation. Names must be
+// string literals (only the pointer is stored).
+//
+// Exported by /api/trace as Chrome trace-event JSON (open in Perfetto or
+// chrome://tracing). Compile out with -DTRACE_ENABLED=0; toggle at runtime
+// with Trace::setEnabled() or /api/trace?enable=0|1.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+namespace Trace {
+
+    static const size_t EVENTS_PER_CORE = 256; // Power of two (16 B each)
+    static const size_t CORES = 2;
+
+    enum Phase : uint8_t { BEGIN = 'B', END = 'E', COUNTER = 'C' };
+
+    struct Event {
+        uint32_t ts;        // micros()
+        const char* name;
+        int32_t value;      // Counter value
+        uint8_t phase;
+    };
+
+    struct Stats {
+        uint32_t recorded;    // Since last clear (both cores)
+        uint32_t dropped;     // Overwritten before export
+        uint32_t overheadNs;  // Measured cost of one event (calibrate())
+        bool enabled;
+    };
+
+    void begin();                // Clears buffers, measures per-event overhead
+    void setEnabled(bool on);
+    bool isEnabled();
+    void record(uint8_t phase, const char* name, int32_t value = 0);
+    Stats getStats();
+
+    // Export: freeze() stops recording and snapshots buffer positions,
+    // copy events with getEvent(), then thaw() resumes.
+    void freeze();
+    void thaw();
+    size_t getEventCount(size_t core);          // Valid (not overwritten) events
+    bool getEvent(size_t core, size_t i, Event& out); // i = 0 is the oldest
+    uint32_t getBaseTs();                       // Oldest timestamp (export origin)
+
+    // RAII begin/end pair for a scope
+    class Scope {
+    public:
+        explicit Scope(const char* name) : name(name) { record(BEGIN, name); }
+        ~Scope() { record(END, name); }
+    private:
+        const char* name;
+    };
+
+}
+
+#if TRACE_ENABLED
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(_trace_, __LINE__)(name)
+#define TRACE_BEGIN(name) Trace::record(Trace::BEGIN, name)
+#define TRACE_END(name) Trace::record(Trace::END, name)
+#define TRACE_COUNTER(name, value) Trace::record(Trace::COUNTER, name, (int32_t)(value))
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_BEGIN(name) do {} while (0)
+#define TRACE_END(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#endif
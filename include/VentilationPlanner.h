@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+#include "HourlyForecast.h"
+
+// One recommended airing window
+struct VentSlot {
+    uint32_t startTs;       // Unix time
+    uint16_t durationMin;   // Window open time
+    float outTemp;          // Forecast outdoor temperature, °C
+    float outAbsHum;        // Forecast outdoor absolute humidity, g/m3
+    float removedAbsHum;    // Expected indoor AH drop, g/m3
+    float heatLoss;         // Expected indoor temperature drop, °C
+    float efficiency;       // removedAbsHum / heatLoss
+};
+
+// Forecast-driven ventilation planner (next 24h)
+//
+// Indoor model: humidity relaxes towards outdoor AH with the air-exchange
+// time constant while the window is open; the room loses heat through the
+// exchanged air and, linearly with time, through cooled walls/furniture.
+// Between sessions indoor AH is assumed to drift up by occupant moisture.
+//
+// For every forecast hour the best duration is chosen (most moisture removed
+// per degree lost, with a minimum useful removal), and the MAX_SLOTS most
+// efficient hours are kept, sorted by time.
+//
+// Incremental: update() only replans when the forecast version changes,
+// indoor conditions moved noticeably, or the first planned slot has passed.
+class VentilationPlanner {
+public:
+    static const size_t MAX_SLOTS = 3;
+
+    VentilationPlanner();
+
+    // Returns true if the plan was recomputed
+    bool update(const HourlyForecast& forecast, uint32_t forecastVersion, uint32_t now,
+                float inTemp, float inAbsHum);
+    void invalidate();
+
+    size_t getSlotCount() const { return slotCount; }
+    const VentSlot& getSlot(size_t i) const { return slots[i]; }
+    int getBestIndex() const { return bestIndex; }   // -1 if no slot
+    uint32_t getPlanTime() const { return planTs; }
+    uint32_t getRecomputeCount() const { return recomputeCount; }
+    uint32_t getLastPlanMicros() const { return lastPlanMicros; }
+
+private:
+    VentSlot slots[MAX_SLOTS];
+    size_t slotCount;
+    int bestIndex;
+
+    // Inputs of the last plan (change detection)
+    uint32_t planTs;
+    uint32_t planForecastVersion;
+    float planInTemp;
+    float planInAbsHum;
+    bool planned;
+
+    uint32_t recomputeCount;
+    uint32_t lastPlanMicros;
+
+    bool needsReplan(uint32_t forecastVersion, uint32_t now, float inTemp, float inAbsHum) const;
+    void plan(const HourlyForecast& forecast, uint32_t now, float inTemp, float inAbsHum);
+    bool evaluate(uint32_t ts, float outT, float outAh, float inTemp, float inAh, VentSlot& out) const;
+    void insertCandidate(const VentSlot& s);
+};
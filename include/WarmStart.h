@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+#include "WeatherManager.h"
+#include "MoldIndex.h"
+#include "SessionJournal.h"
+
+// NVS cache for a usable first reading after reset / brownout:
+// - last weather snapshot (incl. 48h forecast) -> advice works before WiFi
+// - last known wall-clock time -> history timestamps before NTP sync
+// - mold index -> weeks of accumulated wall risk survive a reset
+// - airing session journal -> effectiveness can be compared across weeks
+namespace WarmStart {
+
+    // Seeds the system clock from NVS if it is not set (RTC time survives
+    // software resets, so this only applies after power loss).
+    // Returns true if the clock was seeded (time is an estimate).
+    bool restoreClock();
+    // Persists the current time (scheduled every 10 min to limit NVS wear)
+    void saveClock();
+
+    bool loadWeather(WeatherSnapshot& target);
+    void saveWeather(const WeatherSnapshot& snapshot);
+
+    bool loadMold(MoldIndex::State& target);
+    // Scheduled with the clock; skips the write if the stored state is current
+    void saveMold(const MoldIndex::State& state);
+
+    // Journal entries oldest first; returns the number loaded (<= maxCount)
+    size_t loadSessions(VentSession* target, size_t maxCount);
+    void saveSessions(const VentSession* sessions, size_t count);
+
+}
@@ -2,29 +2,104 @@
 #define WEATHER_MANAGER_H
 
 #include <Arduino.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "HttpsManager.h"
+#include "HourlyForecast.h"
+#include "ForecastParser.h"
+
+// Result of one successful fetch (published as a whole)
+struct WeatherSnapshot {
+    float outTemp;
+    float outHum;
+    float outAbsHum;       // Precomputed at fetch time
+    uint32_t fetchTs;      // Unix time of the 'current' block
+    bool valid;
+    uint32_t version;      // Incremented on every successful fetch
+    bool restored;         // Loaded from the NVS warm-start cache, not fetched
+    HourlyForecast forecast;
+};
+
+// Outdoor values at one instant, read under one lock (see WeatherManager::sample)
+struct OutdoorSample {
+    float temp;
+    float hum;
+    float absHum;
+    bool valid;            // isDataValid() at that instant
+};
+
+// HTTP GET under the weather fetch (HTTPClient over the shared TLS
+// connection on the device, a scripted stand-in in the native benchmark).
+// Runs on the weather task and may take seconds; the body goes to the
+// parser as it arrives.
+class WeatherTransport {
+public:
+    virtual ~WeatherTransport() {}
+    virtual bool isOnline() = 0;
+    // False if there was no 200 response or the body did not parse; error says why
+    virtual bool get(const char* url, ForecastParser& parser, char* error, size_t errorLen) = 0;
+};
+
+#if defined(ESP32)
+// HTTPS via the pinned keep-alive connection (HttpsManager::Host::WEATHER)
+class HttpsWeatherTransport : public WeatherTransport {
+public:
+    explicit HttpsWeatherTransport(HttpsManager* https) : https(https) {}
+    bool isOnline() override;
+    bool get(const char* url, ForecastParser& parser, char* error, size_t errorLen) override;
+
+private:
+    HttpsManager* https;
+};
+#endif
 
 class WeatherManager {
 public:
-    WeatherManager();
-    void update(); // Non-blocking update check (every 30 mins)
-    
+    WeatherManager(WeatherTransport* transport);
+    void begin(); // Starts the background fetch task (Core 0)
+    void requestRefresh(); // Wakes the task for an immediate fetch
+    void restore(const WeatherSnapshot& snapshot); // Warm start from NVS cache
+    bool isLive() const; // At least one fetch succeeded since boot
+
+    // Task wrapper
+    static void weatherTask(void* parameter);
+
+    // Interpolated between fetches (hourly forecast anchored to the last current value)
     float getOutdoorTemp() const;
     float getOutdoorHum() const;
     float getOutdoorAbsHum() const; // g/m3
+    // All of the above plus isDataValid() in one lock. Callers holding another
+    // mutex (SensorManager::dataMutex) read this first, never inside it.
+    OutdoorSample sample() const;
+    uint32_t copyForecast(HourlyForecast& target) const; // Returns its version
+    uint32_t getForecastVersion() const; // Incremented on every successful fetch
     String getConditionString() const; // e.g. "Rainy", "Clear"
-    String getStatusString() const; // Debug Info (Error or "OK")
+    size_t getStatus(char* buffer, size_t len) const; // Debug Info (Error or "OK")
     bool isDataValid() const;
 
 private:
-    float outTemp;
-    float outHum;
-    unsigned long lastUpdate;
-    bool valid;
-    String lastError;
+    friend struct WeatherBench; // Native benchmark (bench/) drives the fetch steps
+
+    WeatherTransport* transport;
+    TaskHandle_t taskHandle;
+
+    // Published state: written only by the weather task, copied under the mutex
+    SemaphoreHandle_t dataMutex;
+    WeatherSnapshot published;
+    char lastError[48];
+
+    // Retry state (weather task only)
+    uint8_t consecutiveFailures;
+    volatile uint32_t nextFetchMs;   // millis() of the next attempt (for status)
+    ForecastParser parser;           // ~3.7 KB JSON document, kept off the task stack
+    WeatherSnapshot* scratch;        // Result being fetched (heap, allocated on first use)
 
-    void fetchWeather();
+    uint32_t step(bool& fetched);    // One attempt; returns the delay until the next
+    bool fetchWeather(WeatherSnapshot& scratch, char* error, size_t errorLen);
+    void publish(const WeatherSnapshot* snapshot, const char* error);
+    uint32_t backoffDelayMs() const;
+    bool sampleNow(float& t, float& h, float& ah) const;
 };
 
 #endif
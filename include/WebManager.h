@@ -3,13 +3,42 @@
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 #include "SensorManager.h"
+#include "HttpsManager.h"
+#include "BootManager.h"
+#include "Scheduler.h"
+#include "DisplayManager.h"
+#include "MqttManager.h"
+#include "HistoryJson.h"
+#include "StreamPool.h"
 
 class WebManager {
 public:
+    static const uint32_t MAX_QUERY_BUCKETS = 96; // /api/query buckets per request
+    static const uint32_t MAX_SESSION_DAYS = 365; // /api/sessions summary window
+    static const size_t HISTORY_STREAMS = 4;      // Concurrent /api/history responses
+    static const size_t EXPORT_STREAMS = 1;       // Concurrent /api/history.bin responses (~4.2 KB each)
+    static const uint32_t STREAM_RETRY_S = 2;     // Retry-After when a pool is full
+
     WebManager(SensorManager* sm);
     void begin();
+    void setHttpsManager(HttpsManager* hm);
+    void setBootManager(BootManager* bm);
+    void setScheduler(Scheduler* s);
+    void setDisplayManager(DisplayManager* dm);
+    void setMqttManager(MqttManager* mm);
 
 private:
     AsyncWebServer server;
     SensorManager* sensorManager;
+    HttpsManager* https;
+    BootManager* boot;
+    Scheduler* scheduler;
+    DisplayManager* displayManager;
+    MqttManager* mqtt;
+
+    // Pre-allocated streaming contexts (admission control, see StreamPool.h)
+    StreamPool<HistoryJsonWriter, HISTORY_STREAMS> historyStreams;
+    StreamPool<HistorySeriesWriter, EXPORT_STREAMS> exportStreams;
+
+    void sendBusy(AsyncWebServerRequest* request);
 };
@@ -0,0 +1,67 @@
+#include "Advice.h"
+
+namespace {
+
+    struct Entry {
+        const char* ru;
+        const char* en;
+        uint8_t code;
+    };
+
+    // Order must match AdviceId
+    constexpr Entry TABLE[] = {
+        {"Загрузка...",                           "Loading...",                        0},
+        {"Анализ...",                             "Analyzing...",                      0},
+        {"Эффективность упала. Закрыть.",         "Efficiency dropped. Close.",        2},
+        {"Цель (50%) достигнута! Можно закрыть.", "Target (50%) reached! Can close.",  3},
+        {"Сушка (Идет активное проветривание)",   "Drying (ventilation in progress)",  1},
+        {"КРИТИЧНО! ГРЕТЬ/ОСУШАТЬ",               "CRITICAL! HEAT/DEHUMIDIFY",         2},
+        {"Влажно [ЗАЛП 5 мин]",                   "Humid [BURST 5 min]",               1},
+        {"Зимняя Норма",                          "Winter Normal",                     3},
+        {"Влажно [НЕ ОТКРЫВАТЬ!]",                "Humid [DO NOT OPEN!]",              3},
+        {"Влажно [Проветрить]",                   "Humid [Ventilate]",                 1},
+        {"Летняя Норма",                          "Summer Normal",                     3},
+        {"КРИТИЧНО! Открыть окно",                "CRITICAL! Open window",             2},
+        {"Влажно [Реком. проветрить]",            "Humid [Airing advised]",            1},
+        {"Сухой воздух [Увлажнить]",              "Dry air [Humidify]",                3},
+        {"Норма (Стены сохнут)",                  "Normal (walls drying)",             3},
+    };
+    static_assert(sizeof(TABLE) / sizeof(TABLE[0]) == (size_t)AdviceId::COUNT, "Advice table out of sync");
+
+    const Entry& entry(AdviceId id) {
+        size_t i = (size_t)id;
+        return TABLE[i < (size_t)AdviceId::COUNT ? i : 0];
+    }
+
+}
+
+namespace Advice {
+
+    const char* text(AdviceId id, Lang lang) {
+        return lang == Lang::EN ? entry(id).en : entry(id).ru;
+    }
+
+    uint8_t code(AdviceId id) {
+        return entry(id).code;
+    }
+
+    size_t format(const AdviceState& advice, Lang lang, char* buf, size_t len) {
+        if (!buf || len == 0) return 0;
+        int n;
+        if (advice.hintMinutes == 0) {
+            n = snprintf(buf, len, "%s", text(advice.id, lang));
+        } else if (advice.hintStartTs == 0) {
+            n = snprintf(buf, len, lang == Lang::EN ? "%s (now: %u min)" : "%s (сейчас: %u мин)",
+                         text(advice.id, lang), advice.hintMinutes);
+        } else {
+            time_t ts = advice.hintStartTs;
+            struct tm tmSlot;
+            localtime_r(&ts, &tmSlot);
+            n = snprintf(buf, len, lang == Lang::EN ? "%s (best at %02d:%02d, %u min)" : "%s (лучше в %02d:%02d, %u мин)",
+                         text(advice.id, lang), tmSlot.tm_hour, tmSlot.tm_min, advice.hintMinutes);
+        }
+        if (n < 0) { buf[0] = '\0'; return 0; }
+        return (size_t)n < len ? (size_t)n : len - 1;
+    }
+
+}
@@ -0,0 +1,78 @@
+#include "BootManager.h"
+
+BootManager::BootManager() : doneMask(0), timelinePrinted(false) {
+    for (size_t i = 0; i < JOB_COUNT; i++) {
+        jobs[i] = {"", 0, nullptr, nullptr, 0, State::UNUSED, false, 0, 0};
+    }
+}
+
+void BootManager::add(Job job, const char* name, uint32_t deps, StartFn start, PollFn poll, uint32_t budgetMs) {
+    jobs[(size_t)job] = {name, deps, start, poll, budgetMs, State::PENDING, false, 0, 0};
+}
+
+void BootManager::poll() {
+    if (isComplete()) {
+        if (!timelinePrinted) {
+            timelinePrinted = true;
+            printTimeline();
+        }
+        return;
+    }
+
+    uint32_t now = millis();
+    for (size_t i = 0; i < JOB_COUNT; i++) {
+        Entry& e = jobs[i];
+
+        if (e.state == State::PENDING && (e.deps & doneMask) == e.deps) {
+            e.state = State::RUNNING;
+            e.startMs = now;
+            Serial.printf("[BOOT] %6lu ms  start %s\n", (unsigned long)now, e.name);
+            if (e.start) e.start();
+        }
+
+        if (e.state == State::RUNNING) {
+            if (!e.poll || e.poll()) {
+                e.state = State::DONE;
+                e.doneMs = millis();
+                doneMask |= 1UL << i;
+                Serial.printf("[BOOT] %6lu ms  done  %s (%lu ms)\n", (unsigned long)e.doneMs, e.name,
+                              (unsigned long)(e.doneMs - e.startMs));
+            } else if (!e.late && now - e.startMs > e.budgetMs) {
+                e.late = true;
+                Serial.printf("[BOOT] %6lu ms  late  %s (budget %lu ms, still trying)\n", (unsigned long)now, e.name,
+                              (unsigned long)e.budgetMs);
+            }
+        }
+    }
+}
+
+bool BootManager::isDone(Job job) const { return jobs[(size_t)job].state == State::DONE; }
+
+bool BootManager::isComplete() const {
+    for (size_t i = 0; i < JOB_COUNT; i++) {
+        if (jobs[i].state != State::DONE && jobs[i].state != State::UNUSED) return false;
+    }
+    return true;
+}
+
+int32_t BootManager::getDoneMs(Job job) const {
+    const Entry& e = jobs[(size_t)job];
+    return e.state == State::DONE ? (int32_t)e.doneMs : -1;
+}
+
+bool BootManager::isLate(Job job) const { return jobs[(size_t)job].late; }
+const char* BootManager::getName(Job job) const { return jobs[(size_t)job].name; }
+
+void BootManager::printTimeline() const {
+    Serial.println("[BOOT] ---- timeline (ms since reset) ----");
+    for (size_t i = 0; i < JOB_COUNT; i++) {
+        const Entry& e = jobs[i];
+        if (e.state == State::UNUSED) continue;
+        if (e.state == State::DONE) {
+            Serial.printf("[BOOT] %-12s %6lu -> %6lu%s\n", e.name, (unsigned long)e.startMs,
+                          (unsigned long)e.doneMs, e.late ? "  (late)" : "");
+        } else {
+            Serial.printf("[BOOT] %-12s pending\n", e.name);
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include "ChartRenderer.h"
+
+// Layout (pixels)
+static const int16_t PLOT_LEFT = 30;                 // Room for Y labels
+static const int16_t PLOT_RIGHT = ChartRenderer::WIDTH - 1;
+static const int16_t PANEL_GAP = 4;
+static const uint32_t MAX_GAP_SEC = 30 * 60;         // Break the line on missing data
+static const size_t BATCH = 32;                      // Same batch size as /api/history
+
+// 5x7 label font: one byte per column, bit 0 = top row, 6 px advance.
+// Only the characters the labels use (numbers, units); others print blank.
+struct Glyph {
+    char c;
+    uint8_t cols[5];
+};
+static const Glyph FONT[] = {
+    {'0', {0x3E, 0x51, 0x49, 0x45, 0x3E}},
+    {'1', {0x00, 0x42, 0x7F, 0x40, 0x00}},
+    {'2', {0x72, 0x49, 0x49, 0x49, 0x46}},
+    {'3', {0x21, 0x41, 0x49, 0x4D, 0x33}},
+    {'4', {0x18, 0x14, 0x12, 0x7F, 0x10}},
+    {'5', {0x27, 0x45, 0x45, 0x45, 0x39}},
+    {'6', {0x3C, 0x4A, 0x49, 0x49, 0x31}},
+    {'7', {0x41, 0x21, 0x11, 0x09, 0x07}},
+    {'8', {0x36, 0x49, 0x49, 0x49, 0x36}},
+    {'9', {0x46, 0x49, 0x49, 0x29, 0x1E}},
+    {'.', {0x00, 0x60, 0x60, 0x00, 0x00}},
+    {',', {0x00, 0x50, 0x30, 0x00, 0x00}},
+    {'-', {0x08, 0x08, 0x08, 0x08, 0x08}},
+    {'%', {0x23, 0x13, 0x08, 0x64, 0x62}},
+    {'C', {0x3E, 0x41, 0x41, 0x41, 0x22}},
+    {'H', {0x7F, 0x08, 0x08, 0x08, 0x7F}},
+    {'R', {0x7F, 0x09, 0x19, 0x29, 0x46}},
+    {'T', {0x01, 0x01, 0x7F, 0x01, 0x01}},
+};
+static const int16_t GLYPH_ADVANCE = 6;
+
+ChartRenderer::ChartRenderer(SensorManager* sm) : sensorManager(sm), canvas(nullptr) {}
+
+bool ChartRenderer::render(uint8_t* bitmap, uint32_t now, uint32_t spanSec) {
+    if (!bitmap || now < spanSec) return false;
+    uint32_t from = now - spanSec;
+
+    const int16_t panelH = (HEIGHT - PANEL_GAP) / 2;
+    Panel tPanel = {0, panelH, NAN, NAN, 1};
+    Panel hPanel = {(int16_t)(panelH + PANEL_GAP), panelH, NAN, NAN, 0};
+
+    if (!scanRange(from, tPanel, hPanel)) return false;
+
+    canvas = bitmap;
+    memset(bitmap, 0xFF, BITMAP_SIZE); // White
+    drawPanel(tPanel, "T,C", from, spanSec);
+    drawPanel(hPanel, "RH,%", from, spanSec);
+    plot(tPanel, hPanel, from, spanSec);
+    canvas = nullptr;
+    return true;
+}
+
+// Pass 1: value range of the visible window
+bool ChartRenderer::scanRange(uint32_t from, Panel& tPanel, Panel& hPanel) {
+    Record batch[BATCH];
+    size_t offset = 0;
+    size_t points = 0;
+    size_t count;
+
+    while ((count = sensorManager->copyHistory(offset, BATCH, batch)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const Record& r = batch[i];
+            if (r.ts < from || isnan(r.t) || isnan(r.h)) continue;
+            if (points == 0) {
+                tPanel.minV = tPanel.maxV = r.t;
+                hPanel.minV = hPanel.maxV = r.h;
+            } else {
+                tPanel.minV = min(tPanel.minV, r.t);
+                tPanel.maxV = max(tPanel.maxV, r.t);
+                hPanel.minV = min(hPanel.minV, r.h);
+                hPanel.maxV = max(hPanel.maxV, r.h);
+            }
+            points++;
+        }
+        offset += count;
+    }
+    if (points < 2) return false;
+
+    // Keep a minimum visible span so sensor noise does not fill the panel
+    Panel* panels[2] = {&tPanel, &hPanel};
+    const float minSpan[2] = {2.0f, 5.0f};
+    for (int i = 0; i < 2; i++) {
+        Panel* p = panels[i];
+        if (p->maxV - p->minV < minSpan[i]) {
+            float mid = (p->maxV + p->minV) / 2.0f;
+            p->minV = mid - minSpan[i] / 2.0f;
+            p->maxV = mid + minSpan[i] / 2.0f;
+        }
+    }
+    return true;
+}
+
+void ChartRenderer::drawPanel(const Panel& p, const char* title, uint32_t from, uint32_t spanSec) {
+    const int16_t bottom = p.top + p.height - 1;
+    drawRect(PLOT_LEFT, p.top, PLOT_RIGHT - PLOT_LEFT + 1, p.height);
+
+    // Dotted grid: middle value + every 6 hours
+    const int16_t midY = p.top + p.height / 2;
+    for (int16_t x = PLOT_LEFT + 2; x < PLOT_RIGHT; x += 4) drawPixel(x, midY);
+    for (uint32_t back = 6 * 3600; back < spanSec; back += 6 * 3600) {
+        int16_t x = mapX(from + spanSec - back, from, spanSec);
+        for (int16_t y = p.top + 2; y < bottom; y += 4) drawPixel(x, y);
+    }
+
+    // Labels
+    char label[12];
+    snprintf(label, sizeof(label), "%.*f", p.decimals, p.maxV);
+    drawText(0, p.top, label);
+    drawText(0, midY - 3, title);
+    snprintf(label, sizeof(label), "%.*f", p.decimals, p.minV);
+    drawText(0, bottom - 7, label);
+}
+
+// Pass 2: polylines for both channels
+void ChartRenderer::plot(const Panel& tPanel, const Panel& hPanel, uint32_t from, uint32_t spanSec) {
+    Record batch[BATCH];
+    size_t offset = 0;
+    size_t count;
+    bool havePrev = false;
+    Record prev = {0, NAN, NAN};
+
+    while ((count = sensorManager->copyHistory(offset, BATCH, batch)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const Record& r = batch[i];
+            if (r.ts < from || isnan(r.t) || isnan(r.h)) continue;
+
+            int16_t x = mapX(r.ts, from, spanSec);
+            if (havePrev && r.ts - prev.ts <= MAX_GAP_SEC) {
+                int16_t px = mapX(prev.ts, from, spanSec);
+                drawLine(px, mapY(tPanel, prev.t), x, mapY(tPanel, r.t));
+                drawLine(px, mapY(hPanel, prev.h), x, mapY(hPanel, r.h));
+            } else {
+                drawPixel(x, mapY(tPanel, r.t));
+                drawPixel(x, mapY(hPanel, r.h));
+            }
+            prev = r;
+            havePrev = true;
+        }
+        offset += count;
+    }
+}
+
+int16_t ChartRenderer::mapY(const Panel& p, float v) const {
+    // 2px inner margin so extremes do not merge with the frame
+    const int16_t inner = p.height - 5;
+    float k = (v - p.minV) / (p.maxV - p.minV);
+    k = constrain(k, 0.0f, 1.0f);
+    return p.top + 2 + inner - (int16_t)(k * inner + 0.5f);
+}
+
+int16_t ChartRenderer::mapX(uint32_t ts, uint32_t from, uint32_t spanSec) const {
+    const int16_t inner = PLOT_RIGHT - PLOT_LEFT - 2;
+    uint32_t dt = (ts > from) ? ts - from : 0;
+    if (dt > spanSec) dt = spanSec;
+    return PLOT_LEFT + 1 + (int16_t)((uint64_t)dt * inner / spanSec);
+}
+
+void ChartRenderer::drawPixel(int16_t x, int16_t y) {
+    if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+    canvas[y * (WIDTH / 8) + x / 8] &= ~(0x80 >> (x & 7));
+}
+
+// Bresenham, both end points included
+void ChartRenderer::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    int16_t dx = abs(x1 - x0);
+    int16_t dy = -abs(y1 - y0);
+    int16_t sx = x0 < x1 ? 1 : -1;
+    int16_t sy = y0 < y1 ? 1 : -1;
+    int16_t err = dx + dy;
+    while (true) {
+        drawPixel(x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        int16_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void ChartRenderer::drawRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    drawLine(x, y, x + w - 1, y);
+    drawLine(x, y + h - 1, x + w - 1, y + h - 1);
+    drawLine(x, y, x, y + h - 1);
+    drawLine(x + w - 1, y, x + w - 1, y + h - 1);
+}
+
+void ChartRenderer::drawText(int16_t x, int16_t y, const char* text) {
+    for (; *text; text++, x += GLYPH_ADVANCE) {
+        const Glyph* g = nullptr;
+        for (const Glyph& f : FONT) {
+            if (f.c == *text) { g = &f; break; }
+        }
+        if (!g) continue;
+        for (int16_t col = 0; col < 5; col++) {
+            for (int16_t row = 0; row < 7; row++) {
+                if (g->cols[col] & (1 << row)) drawPixel(x + col, y + row);
+            }
+        }
+    }
+}
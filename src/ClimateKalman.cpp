@@ -0,0 +1,83 @@
+#include "ClimateKalman.h"
+
+static const float INITIAL_RATE_VAR = 0.01f; // (0.1 unit/min)²: a room is usually near steady at boot
+static const float BOOST = 100.0f;          // Process noise variance factor for a gated step (q x 10)
+
+ClimateKalman::ClimateKalman(float tNoise, float absHumNoise)
+    : tNoise(tNoise), absHumNoise(absHumNoise), stats{} {
+    reset();
+}
+
+void ClimateKalman::reset() {
+    temp = {0, 0, 0, 0, 0};
+    absHum = {0, 0, 0, 0, 0};
+    ready = false;
+}
+
+void ClimateKalman::init(Channel& c, float z, float r) {
+    c.x = z;
+    c.v = 0;
+    c.p00 = r * r;
+    c.p01 = 0;
+    c.p11 = INITIAL_RATE_VAR;
+}
+
+// x' = x + v*dt; P' = F P F^T + qd * [dt³/3 dt²/2; dt²/2 dt]
+void ClimateKalman::predict(Channel& c, float dt, float qd) {
+    float dt2 = dt * dt;
+    c.x += c.v * dt;
+    c.p00 += dt * (2.0f * c.p01 + dt * c.p11) + qd * dt2 * dt / 3.0f;
+    c.p01 += dt * c.p11 + qd * dt2 / 2.0f;
+    c.p11 += qd * dt;
+}
+
+// Predict + measurement update of one channel; returns true if the step was boosted
+bool ClimateKalman::correct(Channel& c, float z, float dt, float q, float r, float gate, float& innovation) {
+    float qd = q * q;
+    predict(c, dt, qd);
+
+    float y = z - c.x;
+    float s = c.p00 + r * r;
+    bool boosted = false;
+    if (gate > 0 && y * y > gate * gate * s) {
+        // Maneuver: add the remaining (BOOST - 1) * Q so the level and rate can move
+        float extra = (BOOST - 1.0f) * qd;
+        float dt2 = dt * dt;
+        c.p00 += extra * dt2 * dt / 3.0f;
+        c.p01 += extra * dt2 / 2.0f;
+        c.p11 += extra * dt;
+        s = c.p00 + r * r;
+        boosted = true;
+    }
+
+    float k0 = c.p00 / s;
+    float k1 = c.p01 / s;
+    c.x += k0 * y;
+    c.v += k1 * y;
+    // P = (I - K H) P with H = [1 0]
+    float p01 = c.p01;
+    c.p11 -= k1 * p01;
+    c.p01 -= k0 * p01;
+    c.p00 -= k0 * c.p00;
+    innovation = y;
+    return boosted;
+}
+
+void ClimateKalman::update(float t, float ah, float dtMin, float q, float gate, bool tValid) {
+    if (!ready) {
+        init(temp, t, tNoise);
+        init(absHum, ah, absHumNoise);
+        ready = true;
+        stats.updates++;
+        return;
+    }
+
+    if (tValid) {
+        if (correct(temp, t, dtMin, q, tNoise, gate, stats.tInnovation)) stats.boosts++;
+    } else {
+        predict(temp, dtMin, q * q);
+        stats.skipped++;
+    }
+    if (correct(absHum, ah, dtMin, q, absHumNoise, gate, stats.absHumInnovation)) stats.boosts++;
+    stats.updates++;
+}
@@ -0,0 +1,227 @@
+#include "Config.h"
+#include "Settings.h"
+#include <atomic>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#if defined(ESP32)
+#include <Preferences.h>
+#endif
+
+static const char* NVS_NAMESPACE = "config";
+static const uint8_t CONFIG_FORMAT = 3; // Bump when ClimateConfig layout changes
+
+// Settings.h constants are the defaults; the rest were literals in processReading()/updateAdvice()
+static const ClimateConfig DEFAULTS = {
+    TEMP_OFFSET,
+    HUM_OFFSET,
+    MAX_TEMP_JUMP,
+    3.0f,   // hampelK
+    7,      // hampelWindow (42 s at 6 s)
+    0.02f,  // kalmanQRest
+    0.5f,   // kalmanQActive
+    3.0f,   // kalmanGate
+    HUMIDITY_HIGH_THRESHOLD,
+    HUMIDITY_LOW_THRESHOLD,
+    55.0f,  // humWinterHigh
+    3.0f,   // ventHumDrop
+    0.5f,   // ventTempDrop
+    0.2f,   // ventAbsHumRate
+    15.0f,  // targetDrop
+    50.0f,  // targetFloor
+    0.15f,  // plateauSlope
+    15,     // plateauReadings (~90 s at 6 s)
+    0.15f,  // reboundTempRise
+    0.3f,   // reboundAbsHum
+};
+
+// Field table: key, offset, valid range (validation + JSON + NVS use the same list)
+struct FieldDef {
+    const char* key;
+    size_t offset;
+    bool isCount;   // uint16_t instead of float
+    float min;
+    float max;
+};
+
+static const FieldDef FIELDS[] = {
+    {"temp_offset",       offsetof(ClimateConfig, tempOffset),      false, -10.0f, 10.0f},
+    {"hum_offset",        offsetof(ClimateConfig, humOffset),       false, -30.0f, 30.0f},
+    {"max_temp_jump",     offsetof(ClimateConfig, maxTempJump),     false, 0.1f, 20.0f},
+    {"hampel_k",          offsetof(ClimateConfig, hampelK),         false, 0.0f, 10.0f},
+    {"hampel_window",     offsetof(ClimateConfig, hampelWindow),    true,  3.0f, 15.0f},
+    {"kalman_q_rest",     offsetof(ClimateConfig, kalmanQRest),     false, 0.001f, 10.0f},
+    {"kalman_q_active",   offsetof(ClimateConfig, kalmanQActive),   false, 0.001f, 10.0f},
+    {"kalman_gate",       offsetof(ClimateConfig, kalmanGate),      false, 0.0f, 10.0f},
+    {"hum_high",          offsetof(ClimateConfig, humHigh),         false, 30.0f, 95.0f},
+    {"hum_low",           offsetof(ClimateConfig, humLow),          false, 10.0f, 60.0f},
+    {"hum_winter_high",   offsetof(ClimateConfig, humWinterHigh),   false, 30.0f, 95.0f},
+    {"vent_hum_drop",     offsetof(ClimateConfig, ventHumDrop),     false, 0.5f, 20.0f},
+    {"vent_temp_drop",    offsetof(ClimateConfig, ventTempDrop),    false, 0.1f, 5.0f},
+    {"vent_abs_hum_rate", offsetof(ClimateConfig, ventAbsHumRate),  false, 0.0f, 5.0f},
+    {"target_drop",       offsetof(ClimateConfig, targetDrop),      false, 1.0f, 50.0f},
+    {"target_floor",      offsetof(ClimateConfig, targetFloor),     false, 20.0f, 80.0f},
+    {"plateau_slope",     offsetof(ClimateConfig, plateauSlope),    false, 0.01f, 2.0f},
+    {"plateau_readings",  offsetof(ClimateConfig, plateauReadings), true,  1.0f, 200.0f},
+    {"rebound_temp_rise", offsetof(ClimateConfig, reboundTempRise), false, 0.01f, 3.0f},
+    {"rebound_abs_hum",   offsetof(ClimateConfig, reboundAbsHum),   false, 0.05f, 3.0f},
+};
+static const size_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+// Two immutable slots; 'active' selects the published one
+static ClimateConfig slots[2] = {DEFAULTS, DEFAULTS};
+static std::atomic<uint32_t> active{0};
+static std::atomic<uint32_t> readers[2];
+static SemaphoreHandle_t writerMutex = nullptr; // Serializes writers only
+static Config::Stats stats = {};
+
+namespace Config {
+
+    Snapshot::Snapshot() {
+        for (;;) {
+            uint32_t s = active.load(std::memory_order_acquire);
+            readers[s].fetch_add(1, std::memory_order_acq_rel);
+            // Re-check: if a swap slipped in, the writer may be refilling slot s
+            if (active.load(std::memory_order_acquire) == s) {
+                slot = (uint8_t)s;
+                cfg = &slots[s];
+                return;
+            }
+            readers[s].fetch_sub(1, std::memory_order_release);
+            stats.readRetries++;
+        }
+    }
+
+    Snapshot::~Snapshot() {
+        readers[slot].fetch_sub(1, std::memory_order_release);
+    }
+
+    static bool validate(const ClimateConfig& cfg, char* error, size_t errorLen) {
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            float v = getField(cfg, i);
+            if (isnan(v) || v < FIELDS[i].min || v > FIELDS[i].max) {
+                snprintf(error, errorLen, "%s out of range [%g, %g]", FIELDS[i].key, FIELDS[i].min, FIELDS[i].max);
+                return false;
+            }
+        }
+        if (cfg.humLow >= cfg.humHigh) {
+            snprintf(error, errorLen, "hum_low must be below hum_high");
+            return false;
+        }
+        return true;
+    }
+
+    // Caller holds writerMutex
+    static void publish(const ClimateConfig& cfg) {
+        uint32_t start = micros();
+        uint32_t next = active.load(std::memory_order_relaxed) ^ 1;
+
+        // Grace period: wait until readers that still hold the old snapshot in 'next' leave
+        uint32_t graceStart = micros();
+        while (readers[next].load(std::memory_order_acquire) != 0) vTaskDelay(1);
+        uint32_t grace = micros() - graceStart;
+
+        slots[next] = cfg;
+        active.store(next, std::memory_order_release);
+
+        stats.swaps++;
+        stats.lastSwapUs = micros() - start;
+        if (grace > stats.maxGraceUs) stats.maxGraceUs = grace;
+    }
+
+    void begin() {
+        if (!writerMutex) writerMutex = xSemaphoreCreateMutex();
+#if defined(ESP32)
+        ClimateConfig stored;
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, true)) return;
+        bool ok = prefs.getUChar("fmt", 0) == CONFIG_FORMAT &&
+                  prefs.getBytes("cfg", &stored, sizeof(stored)) == sizeof(stored);
+        prefs.end();
+
+        char error[64];
+        if (ok && validate(stored, error, sizeof(error))) {
+            xSemaphoreTake(writerMutex, portMAX_DELAY);
+            publish(stored);
+            xSemaphoreGive(writerMutex);
+            Serial.println("[CONFIG] NVS override loaded");
+        } else if (ok) {
+            Serial.printf("[CONFIG] NVS override ignored: %s\n", error);
+        }
+#endif
+    }
+
+    const ClimateConfig& defaults() { return DEFAULTS; }
+
+    ClimateConfig get() {
+        Snapshot s;
+        return *s;
+    }
+
+    bool apply(const ClimateConfig& cfg, char* error, size_t errorLen) {
+        if (!validate(cfg, error, errorLen)) return false;
+        if (!writerMutex) writerMutex = xSemaphoreCreateMutex();
+        xSemaphoreTake(writerMutex, portMAX_DELAY);
+        publish(cfg);
+        xSemaphoreGive(writerMutex);
+        return true;
+    }
+
+    bool save() {
+#if defined(ESP32)
+        ClimateConfig cfg = get();
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, false)) return false;
+        bool ok = prefs.putBytes("cfg", &cfg, sizeof(cfg)) == sizeof(cfg);
+        prefs.putUChar("fmt", ok ? CONFIG_FORMAT : 0);
+        prefs.end();
+        return ok;
+#else
+        return false;
+#endif
+    }
+
+    void reset() {
+#if defined(ESP32)
+        Preferences prefs;
+        if (prefs.begin(NVS_NAMESPACE, false)) {
+            prefs.clear();
+            prefs.end();
+        }
+#endif
+        char error[8];
+        apply(DEFAULTS, error, sizeof(error));
+    }
+
+    size_t getFieldCount() { return FIELD_COUNT; }
+
+    const char* getFieldKey(size_t index) {
+        return index < FIELD_COUNT ? FIELDS[index].key : "";
+    }
+
+    float getField(const ClimateConfig& cfg, size_t index) {
+        if (index >= FIELD_COUNT) return NAN;
+        const uint8_t* base = (const uint8_t*)&cfg + FIELDS[index].offset;
+        if (FIELDS[index].isCount) return (float)*(const uint16_t*)base;
+        return *(const float*)base;
+    }
+
+    bool setField(ClimateConfig& cfg, const char* key, float value) {
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            if (strcmp(FIELDS[i].key, key) != 0) continue;
+            uint8_t* base = (uint8_t*)&cfg + FIELDS[i].offset;
+            if (FIELDS[i].isCount) {
+                // Out-of-range counts are clamped here and caught by validate()
+                *(uint16_t*)base = (value < 0 || isnan(value)) ? 0 : (value > 65535.0f ? 65535 : (uint16_t)lroundf(value));
+            } else {
+                *(float*)base = value;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    const Stats& getStats() { return stats; }
+
+}
@@ -1,8 +1,16 @@
 #include "DisplayManager.h"
-#include <WiFi.h>
+#include "Trace.h"
+#include "HeapTags.h"
 
-DisplayManager::DisplayManager() 
-    : display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET) {}
+static const size_t I2C_CHUNK = 64; // Data bytes per transaction (ESP32 Wire buffer is 128)
+
+DisplayManager::DisplayManager(SensorManager* sm) 
+    : display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET), sensorManager(sm),
+      taskHandle(nullptr), snapshotMutex(nullptr), page(PAGE_LIVE), pageSinceMs(0), lastFrameMs(0),
+      panelOn(true), stats{}, nightCheckMinute(-1), nightCached(false) {
+    pending = {NAN, NAN, NAN, NAN, NAN, NAN, 0, 0, 0, NAN, NAN, ""};
+    current = pending;
+}
 
 void DisplayManager::begin() {
     Wire.begin(I2C_SDA, I2C_SCL);
@@ -11,72 +19,278 @@ void DisplayManager::begin() {
         Serial.println(F("SSD1306 allocation failed"));
     }
     display.clearDisplay();
-    display.display();
+    display.display(); // Panel RAM now matches the (zeroed) shadow frame
+
+    snapshotMutex = xSemaphoreCreateMutex();
+    // Low priority, Core 1: rendering + I2C run while loop() sleeps
+    xTaskCreatePinnedToCore(
+        DisplayManager::displayTask,
+        "OLED_Task",
+        4 * 1024,
+        this,
+        1,
+        &taskHandle,
+        1
+    );
 }
 
-bool DisplayManager::isNightMode() {
-    struct tm timeinfo;
-    if(!getLocalTime(&timeinfo)) return false; 
-    int hr = timeinfo.tm_hour;
-    if (hr >= NIGHT_MODE_START_HOUR || hr < NIGHT_MODE_END_HOUR) return true;
-    return false;
+void DisplayManager::publish(const DisplaySnapshot& snapshot) {
+    if (!snapshotMutex) return;
+    xSemaphoreTake(snapshotMutex, portMAX_DELAY);
+    pending = snapshot;
+    xSemaphoreGive(snapshotMutex);
+    xTaskNotifyGive(taskHandle);
 }
 
-void DisplayManager::update(float t, float h, float dp, bool win, String advice, int adviceCode, int rawState, String ip) {
-    if(isNightMode()) {
-        display.clearDisplay();
-        display.display();
-        return;
+// Wakes on a new snapshot or when the current page has been shown long enough
+void DisplayManager::displayTask(void* parameter) {
+    DisplayManager* self = (DisplayManager*)parameter;
+    HeapTags::setTaskTag(HeapTags::DISPLAY);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PAGE_DWELL_MS));
+
+        // Frame rate cap: bursts of snapshots collapse into one frame
+        uint32_t since = millis() - self->lastFrameMs;
+        if (since < MIN_FRAME_MS) vTaskDelay(pdMS_TO_TICKS(MIN_FRAME_MS - since));
+
+        xSemaphoreTake(self->snapshotMutex, portMAX_DELAY);
+        self->current = self->pending;
+        xSemaphoreGive(self->snapshotMutex);
+
+        // Night mode: panel off (RAM is kept, so nothing to redraw in the morning)
+        bool on = !self->isNightMode();
+        if (on != self->panelOn) {
+            uint8_t cmd = on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF;
+            self->sendCommands(&cmd, 1);
+            self->panelOn = on;
+        }
+        if (!on) continue;
+
+        self->renderFrame();
+        self->lastFrameMs = millis();
     }
+}
+
+bool DisplayManager::isPageActive(uint8_t p) const {
+    switch (p) {
+        case PAGE_SPARKLINE: return sparkline.hasData();
+        case PAGE_ABS_HUM: return !isnan(current.inAbsHum);
+        case PAGE_SESSION: return current.state != 0; // Airing in progress / just finished
+        default: return true;
+    }
+}
 
+void DisplayManager::renderFrame() {
+    TRACE_SCOPE("oled_render");
+    sparkline.sync(sensorManager); // Cheap: newest batch only
+
+    uint32_t now = millis();
+    if (pageSinceMs == 0) pageSinceMs = now; // First frame stays on the live page
+    if (now - pageSinceMs >= PAGE_DWELL_MS) {
+        for (uint8_t i = 0; i < PAGE_COUNT; i++) {
+            page = (page + 1) % PAGE_COUNT;
+            if (isPageActive(page)) break;
+        }
+        pageSinceMs = now;
+    }
+    if (!isPageActive(page)) page = PAGE_LIVE;
+
+    uint32_t start = micros();
     display.clearDisplay();
     display.setTextColor(SSD1306_WHITE);
-    
-    // Header
     display.setTextSize(1);
+    switch (page) {
+        case PAGE_SPARKLINE: renderSparkline(); break;
+        case PAGE_ABS_HUM:   renderAbsHum(); break;
+        case PAGE_SESSION:   renderSession(); break;
+        default:             renderLive(); break;
+    }
+    stats.renderUs[page] = micros() - start;
+    stats.frames++;
+
+    if (diff.commit(display.getBuffer()) == 0) {
+        stats.skipped++; // Identical frame: nothing goes over I2C
+        return;
+    }
+    flush();
+}
+
+void DisplayManager::renderLive() {
+    const DisplaySnapshot& s = current;
+
+    // Header
     display.setCursor(0,0);
     display.print(F("ACM-1 "));
     
     // Advice Code Logic
     // 0=Safe/Gray, 1=Vent/Yellow, 2=Crit/Red, 3=Safe/Green(Close/Dry)
-    String lcdAdvice = "SAFE";
-    switch(adviceCode) {
+    const char* lcdAdvice = "SAFE";
+    switch(s.adviceCode) {
         case 2: lcdAdvice = "CRITICAL"; break;
         case 1: lcdAdvice = "VENTILATE"; break;
         case 3: lcdAdvice = "OPTIMAL"; break; // Close/Dry
         case 0: lcdAdvice = "NORMAL"; break;
     }
     
-    // Overrides based on internal State Machine (rawState)
-    // 0=STABLE, 1=VENTILATING, 2=PLATEAU
-    if (rawState == 1) lcdAdvice = "DRYING...";
-    if (rawState == 2) lcdAdvice = "PLATEAU";
+    // Overrides based on internal State Machine (state)
+    // 0=STABLE, 1=VENTILATING, 2=TARGET_MET, 3=INEFFICIENT
+    if (s.state == 1) lcdAdvice = "DRYING...";
+    if (s.state == 3) lcdAdvice = "PLATEAU";
 
     display.print(lcdAdvice);
     
     // Main Stats
     display.setTextSize(2);
     display.setCursor(0, 16);
-    if(isnan(t)) display.print(F("--.-"));
-    else display.print(t, 1);
+    if(isnan(s.t)) display.print(F("--.-"));
+    else display.print(s.t, 1);
     display.print(F("C"));
 
     display.setCursor(70, 16);
-    if(isnan(h)) display.print(F("--"));
-    else display.print(h, 0);
+    if(isnan(s.h)) display.print(F("--"));
+    else display.print(s.h, 0);
     display.print(F("%"));
 
     // Footer Info
     display.setTextSize(1);
     display.setCursor(0, 44);
-    if(win) {
-         display.print(F("[WIN OPEN] "));
-    }
     display.print(F("DP:"));
-    if(!isnan(dp)) display.print(dp, 1);
+    if(!isnan(s.dp)) display.print(s.dp, 1);
+
+    display.setCursor(70, 44);
+    display.print(F("MOLD:"));
+    if(!isnan(s.moldIndex)) display.print(s.moldIndex, 1);
     
     display.setCursor(0, 56);
-    display.print(ip);
+    display.print(s.ip);
+}
 
-    display.display();
+void DisplayManager::renderSparkline() {
+    int16_t tMin, tMax;
+    uint8_t hMin, hMax;
+    sparkline.getRange(tMin, tMax, hMin, hMax);
+
+    char line[24];
+    snprintf(line, sizeof(line), "24h %d-%dC %u-%u%%", tMin, tMax, hMin, hMax);
+    display.setCursor(0, 0);
+    display.print(line);
+    sparkline.draw(display, 0, SCREEN_HEIGHT - Sparkline::HEIGHT);
 }
+
+void DisplayManager::renderAbsHum() {
+    const DisplaySnapshot& s = current;
+    display.setCursor(0, 0);
+    display.print(F("ABS HUM g/m3"));
+
+    display.setCursor(0, 14);
+    display.print(F("IN "));
+    display.setTextSize(2);
+    display.print(s.inAbsHum, 1);
+
+    display.setTextSize(1);
+    display.setCursor(0, 34);
+    display.print(F("OUT"));
+    display.setTextSize(2);
+    display.setCursor(18, 34);
+    if (isnan(s.outAbsHum)) display.print(F("--.-"));
+    else display.print(s.outAbsHum, 1);
+
+    display.setTextSize(1);
+    display.setCursor(0, 56);
+    if (isnan(s.outAbsHum)) {
+        display.print(F("No weather data"));
+    } else {
+        // Airing only dries the room if outdoor air holds less water
+        display.print(s.outAbsHum < s.inAbsHum ? F("Airing dries ") : F("Airing adds water "));
+        if (!isnan(s.outTemp)) {
+            display.print(s.outTemp, 0);
+            display.print(F("C"));
+        }
+    }
+}
+
+void DisplayManager::renderSession() {
+    const DisplaySnapshot& s = current;
+    uint32_t elapsedSec = (millis() - s.stateEnterMs) / 1000;
+
+    display.setCursor(0, 0);
+    display.print(s.state == 1 ? F("AIRING") : s.state == 2 ? F("TARGET MET") : F("PLATEAU"));
+
+    char line[24];
+    display.setTextSize(2);
+    display.setCursor(0, 12);
+    snprintf(line, sizeof(line), "%lu:%02lu", (unsigned long)(elapsedSec / 60), (unsigned long)(elapsedSec % 60));
+    display.print(line);
+
+    display.setTextSize(1);
+    display.setCursor(0, 32);
+    if (!isnan(s.sessionStartAbsHum) && !isnan(s.inAbsHum)) {
+        snprintf(line, sizeof(line), "%.1f->%.1f g/m3", s.sessionStartAbsHum, s.inAbsHum);
+        display.print(line);
+        display.setCursor(0, 42);
+        snprintf(line, sizeof(line), "Removed %.1f g/m3", s.sessionStartAbsHum - s.inAbsHum);
+        display.print(line);
+    }
+
+    // Progress against the 20 min safety timer
+    const uint32_t SAFETY_SEC = 20 * 60;
+    uint16_t w = (uint16_t)(min(elapsedSec, SAFETY_SEC) * (SCREEN_WIDTH - 2) / SAFETY_SEC);
+    display.drawRect(0, 56, SCREEN_WIDTH, 8, SSD1306_WHITE);
+    display.fillRect(1, 57, w, 6, SSD1306_WHITE);
+}
+
+uint32_t DisplayManager::sendCommands(const uint8_t* cmds, size_t count) {
+    Wire.beginTransmission(SCREEN_ADDRESS);
+    Wire.write((uint8_t)0x00); // Co = 0, D/C = 0: command stream
+    Wire.write(cmds, count);
+    Wire.endTransmission();
+    return count + 2; // + address + control byte
+}
+
+void DisplayManager::flush() {
+    TRACE_SCOPE("oled_flush"); // I2C transfer of the dirty segments
+    uint32_t start = micros();
+    uint32_t bytes = 0;
+    uint8_t segment[FrameDiff::WIDTH];
+
+    for (uint8_t page = 0; page < FrameDiff::PAGES; page++) {
+        uint8_t lo, hi;
+        if (!diff.takePage(page, lo, hi, segment)) continue;
+
+        // Horizontal addressing mode (set by Adafruit begin): window = one page, lo..hi
+        const uint8_t window[] = {SSD1306_PAGEADDR, page, page, SSD1306_COLUMNADDR, lo, hi};
+        bytes += sendCommands(window, sizeof(window));
+
+        size_t len = hi - lo + 1;
+        for (size_t off = 0; off < len; off += I2C_CHUNK) {
+            size_t n = (len - off < I2C_CHUNK) ? len - off : I2C_CHUNK;
+            Wire.beginTransmission(SCREEN_ADDRESS);
+            Wire.write((uint8_t)0x40); // Co = 0, D/C = 1: data stream
+            Wire.write(segment + off, n);
+            Wire.endTransmission();
+            bytes += n + 2;
+        }
+    }
+
+    if (bytes > 0) {
+        stats.lastBusBytes = bytes;
+        stats.totalBusBytes += bytes;
+        stats.lastFlushUs = micros() - start;
+        TRACE_COUNTER("oled_bus_bytes", bytes);
+    }
+}
+
+bool DisplayManager::isNightMode() {
+    // time() instead of getLocalTime(): no wait when the clock is not set yet
+    time_t now = time(NULL);
+    if (now < 1600000000) return false;
+    if (now / 60 != nightCheckMinute) {
+        nightCheckMinute = now / 60;
+        struct tm timeinfo;
+        localtime_r(&now, &timeinfo);
+        int hr = timeinfo.tm_hour;
+        nightCached = (hr >= NIGHT_MODE_START_HOUR || hr < NIGHT_MODE_END_HOUR);
+    }
+    return nightCached;
+}
+
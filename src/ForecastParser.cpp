@@ -0,0 +1,52 @@
+#include "ForecastParser.h"
+#include <math.h>
+#include <stdio.h>
+
+ForecastParser::ForecastParser() : curTime(0), curTemp(NAN), curHum(NAN) {
+    filter["current"]["time"] = true;
+    filter["current"]["temperature_2m"] = true;
+    filter["current"]["relative_humidity_2m"] = true;
+    filter["hourly"]["time"] = true;
+    filter["hourly"]["temperature_2m"] = true;
+    filter["hourly"]["relative_humidity_2m"] = true;
+    filter["reason"] = true;
+}
+
+bool ForecastParser::finish(DeserializationError result, char* error, size_t errorLen) {
+    curTime = 0;
+    curTemp = NAN;
+    curHum = NAN;
+    if (result) {
+        snprintf(error, errorLen, "JSON Error: %s", result.c_str());
+        return false;
+    }
+    if (const char* reason = doc["reason"]) {
+        snprintf(error, errorLen, "API Error: %s", reason);
+        return false;
+    }
+    JsonObjectConst current = doc["current"];
+    curTime = current["time"] | (uint32_t)0;
+    curTemp = current["temperature_2m"] | NAN;
+    curHum = current["relative_humidity_2m"] | NAN;
+    if (isnan(curTemp) || isnan(curHum)) {
+        snprintf(error, errorLen, "JSON Error: no current data");
+        return false;
+    }
+    return true;
+}
+
+void ForecastParser::copyForecast(HourlyForecast& target) const {
+    target.clear();
+    JsonObjectConst hourly = doc["hourly"];
+    JsonArrayConst times = hourly["time"];
+    uint32_t start = times[0] | (uint32_t)0;
+    if (start == 0) return;
+    if (times.size() >= 2 && (times[1] | (uint32_t)0) - start != 3600) return; // Not an hourly series
+    JsonArrayConst temps = hourly["temperature_2m"];
+    JsonArrayConst hums = hourly["relative_humidity_2m"];
+    target.begin(start);
+    size_t n = temps.size() < hums.size() ? temps.size() : hums.size();
+    for (size_t i = 0; i < n; i++) {
+        if (!target.append(temps[i] | NAN, hums[i] | NAN)) break;
+    }
+}
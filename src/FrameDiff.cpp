@@ -0,0 +1,59 @@
+#include "FrameDiff.h"
+#include <string.h>
+
+static const uint8_t CLEAN_LO = 0xFF;
+static const uint8_t CLEAN_HI = 0;
+
+FrameDiff::FrameDiff() {
+    memset(shadow, 0, sizeof(shadow)); // Matches a freshly cleared panel
+    for (uint8_t p = 0; p < PAGES; p++) {
+        dirtyLo[p] = CLEAN_LO;
+        dirtyHi[p] = CLEAN_HI;
+    }
+}
+
+size_t FrameDiff::commit(const uint8_t* frame) {
+    size_t changed = 0;
+    for (uint8_t p = 0; p < PAGES; p++) {
+        const uint8_t* src = frame + (size_t)p * WIDTH;
+        uint8_t* dst = shadow + (size_t)p * WIDTH;
+        if (memcmp(src, dst, WIDTH) == 0) continue; // Fast path: page unchanged
+
+        for (uint8_t c = 0; c < WIDTH; c++) {
+            if (src[c] == dst[c]) continue;
+            dst[c] = src[c];
+            changed++;
+            if (c < dirtyLo[p]) dirtyLo[p] = c;
+            if (c > dirtyHi[p]) dirtyHi[p] = c;
+        }
+    }
+    return changed;
+}
+
+void FrameDiff::markAllDirty() {
+    for (uint8_t p = 0; p < PAGES; p++) {
+        dirtyLo[p] = 0;
+        dirtyHi[p] = WIDTH - 1;
+    }
+}
+
+bool FrameDiff::isPageDirty(uint8_t page) const {
+    return page < PAGES && dirtyLo[page] <= dirtyHi[page]; // Clean = 0xFF > 0
+}
+
+bool FrameDiff::isDirty() const {
+    for (uint8_t p = 0; p < PAGES; p++) {
+        if (isPageDirty(p)) return true;
+    }
+    return false;
+}
+
+bool FrameDiff::takePage(uint8_t page, uint8_t& colStart, uint8_t& colEnd, uint8_t* out) {
+    if (!isPageDirty(page)) return false;
+    colStart = dirtyLo[page];
+    colEnd = dirtyHi[page];
+    memcpy(out, shadow + (size_t)page * WIDTH + colStart, colEnd - colStart + 1);
+    dirtyLo[page] = CLEAN_LO;
+    dirtyHi[page] = CLEAN_HI;
+    return true;
+}
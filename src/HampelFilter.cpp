@@ -0,0 +1,101 @@
+#include "HampelFilter.h"
+#include <math.h>
+#include <string.h>
+
+static const float MAD_SCALE = 1.4826f; // MAD -> standard deviation for Gaussian noise
+
+HampelFilter::HampelFilter(float madFloor) : madFloor(madFloor), stats{} {
+    reset();
+}
+
+void HampelFilter::reset() {
+    head = 0;
+    count = 0;
+    window = 0;
+    lastOutlier = false;
+}
+
+uint8_t HampelFilter::lowerBound(float v) const {
+    uint8_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint8_t mid = (lo + hi) / 2;
+        if (sorted[mid] < v) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// rank-th smallest (0-based) of |sorted[i] - median| over the window.
+// Left of the median the deviations grow to the left, right of it to the
+// right, so they are two ascending runs; select across them by binary search.
+float HampelFilter::deviationRank(uint8_t rank, float median) const {
+    const int left = count / 2;          // A(i) = median - sorted[left - 1 - i]
+    const int right = count - left;      // B(j) = sorted[left + j] - median
+    const int take = rank + 1;           // Elements in the selection
+
+    int lo = take > right ? take - right : 0;
+    int hi = take < left ? take : left;
+    while (lo < hi) {
+        int i = (lo + hi) / 2;           // Taken from A
+        int j = take - i;                // Taken from B
+        float a = median - sorted[left - 1 - i];
+        float b = sorted[left + j - 1] - median;
+        if (b > a) lo = i + 1;           // B's last pick is larger than A's next: take more from A
+        else hi = i;
+    }
+    int i = lo, j = take - lo;
+    float a = i > 0 ? median - sorted[left - i] : -1.0f;
+    float b = j > 0 ? sorted[left + j - 1] - median : -1.0f;
+    return a > b ? a : b;
+}
+
+float HampelFilter::getMedian() const {
+    return count ? sorted[count / 2] : NAN;
+}
+
+float HampelFilter::getMad() const {
+    if (count == 0) return NAN;
+    return MAD_SCALE * deviationRank(count / 2, sorted[count / 2]);
+}
+
+float HampelFilter::update(float x, uint8_t w, float k) {
+    lastOutlier = false;
+    if (isnan(x)) return x;
+
+    w |= 1;
+    if (w < 3) w = 3;
+    if (w > MAX_WINDOW) w = MAX_WINDOW;
+    if (w != window) {
+        reset(); // Window size changed (config): refill
+        window = w;
+    }
+
+    // Expire the oldest sample
+    if (count == window) {
+        float oldest = ring[head];
+        uint8_t pos = lowerBound(oldest);
+        memmove(&sorted[pos], &sorted[pos + 1], (count - pos - 1) * sizeof(float));
+        count--;
+    }
+
+    // Insert the new one
+    uint8_t pos = lowerBound(x);
+    memmove(&sorted[pos + 1], &sorted[pos], (count - pos) * sizeof(float));
+    sorted[pos] = x;
+    count++;
+    ring[head] = x;
+    head = (head + 1) % window;
+    stats.samples++;
+
+    if (count < window || k <= 0) return x;
+
+    float median = sorted[count / 2];
+    float mad = MAD_SCALE * deviationRank(count / 2, median);
+    if (mad < madFloor) mad = madFloor;
+    if (fabsf(x - median) > k * mad) {
+        lastOutlier = true;
+        stats.outliers++;
+        return median;
+    }
+    return x;
+}
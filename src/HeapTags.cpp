@@ -0,0 +1,290 @@
+#include "HeapTags.h"
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#define HEAP_LOCK() portENTER_CRITICAL(&mux)
+#define HEAP_UNLOCK() portEXIT_CRITICAL(&mux)
+// NULL before the scheduler starts (global constructors): charged to OTHER.
+// Not thread_local: task TLS is not set up that early.
+static void* currentTask() { return xTaskGetCurrentTaskHandle(); }
+#else
+#include <atomic>
+static std::atomic_flag spin = ATOMIC_FLAG_INIT;
+#define HEAP_LOCK() while (spin.test_and_set(std::memory_order_acquire)) {}
+#define HEAP_UNLOCK() spin.clear(std::memory_order_release)
+static void* currentTask() {
+    static thread_local char id;
+    return &id;
+}
+#endif
+
+namespace HeapTags {
+
+    static const char* const NAMES[TAG_COUNT] = {
+        "other", "web", "tls", "telegram", "weather", "mqtt", "sensor", "display"
+    };
+
+    // Live tagged block: size (24 bit) and tag packed into one word
+    struct Entry {
+        uintptr_t ptr; // 0 = empty slot
+        uint32_t sizeTag;
+    };
+
+    static Entry table[TABLE_SIZE];
+    static volatile size_t tracked = 0;
+    static uint32_t untracked = 0;
+    static Stats stats[TAG_COUNT];
+    static Sample samples[SAMPLES];
+    static size_t sampleHead = 0;
+    static size_t sampleCount = 0;
+    static uint32_t minLargest = UINT32_MAX;
+    static uint32_t minLargestAt = 0;
+
+    // Active tag per task. Tasks never end here, so slots are not reclaimed;
+    // a task beyond TASK_SLOTS stays OTHER. Lookups take no lock: slots are
+    // only appended (published through taskCount), and a slot's tag is only
+    // written by its own task, so a task always reads its current tag.
+    static const size_t TASK_SLOTS = 12;
+    struct TaskSlot {
+        void* task;
+        volatile uint8_t tag;
+    };
+    static TaskSlot tasks[TASK_SLOTS];
+    static size_t taskCount = 0;
+
+    static TaskSlot* findTask(void* task) {
+        if (!task) return nullptr;
+        size_t n = __atomic_load_n(&taskCount, __ATOMIC_ACQUIRE);
+        for (size_t i = 0; i < n; i++) {
+            if (tasks[i].task == task) return &tasks[i];
+        }
+        return nullptr;
+    }
+
+    // Only the task itself adds its slot, so it cannot be added twice
+    static TaskSlot* claimTask(void* task) {
+        TaskSlot* slot = findTask(task);
+        if (slot || !task) return slot;
+        HEAP_LOCK();
+        if (taskCount < TASK_SLOTS) {
+            slot = &tasks[taskCount];
+            slot->task = task;
+            slot->tag = OTHER;
+            __atomic_store_n(&taskCount, taskCount + 1, __ATOMIC_RELEASE);
+        }
+        HEAP_UNLOCK();
+        return slot;
+    }
+
+    // Returns the previous tag
+    static uint8_t swapTag(uint8_t tag) {
+        TaskSlot* slot = claimTask(currentTask());
+        if (!slot) return OTHER;
+        uint8_t old = slot->tag;
+        slot->tag = tag;
+        return old;
+    }
+
+    static size_t slotOf(uintptr_t p) {
+        uint32_t x = (uint32_t)(p >> 3) ^ (uint32_t)((uint64_t)p >> 32);
+        return (x * 2654435761u) >> 23; // Top 9 bits: 512 slots
+    }
+    static_assert(TABLE_SIZE == 512, "slotOf() returns 9 bits");
+
+    // Linear probing delete without tombstones: pull later entries of the
+    // same cluster back into the hole
+    static void eraseAt(size_t i) {
+        size_t j = i;
+        for (;;) {
+            table[i].ptr = 0;
+            for (;;) {
+                j = (j + 1) & (TABLE_SIZE - 1);
+                if (table[j].ptr == 0) return;
+                size_t k = slotOf(table[j].ptr);
+                bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+                if (!stays) break;
+            }
+            table[i] = table[j];
+            i = j;
+        }
+    }
+
+    const char* getName(Tag tag) { return tag < TAG_COUNT ? NAMES[tag] : "?"; }
+
+    void setTaskTag(Tag tag) { swapTag(tag); }
+
+    Tag currentTag() {
+        TaskSlot* slot = findTask(currentTask());
+        return slot ? (Tag)slot->tag : OTHER;
+    }
+
+    Scope::Scope(Tag tag) : saved(swapTag(tag)) {}
+    Scope::~Scope() { swapTag(saved); }
+
+    void onAlloc(void* p, size_t size) {
+        if (!p) return;
+        uint32_t sz = size < 0xFFFFFF ? (uint32_t)size : 0xFFFFFF;
+        uint8_t tag = currentTag();
+        Stats& s = stats[tag];
+        if (tag == OTHER) {
+            // Only counted: the common case takes no lock
+            __atomic_fetch_add(&s.allocs, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&s.bytes, sz, __ATOMIC_RELAXED);
+            return;
+        }
+        HEAP_LOCK();
+        if (tracked < TABLE_LIMIT) {
+            size_t i = slotOf((uintptr_t)p);
+            while (table[i].ptr != 0 && table[i].ptr != (uintptr_t)p) i = (i + 1) & (TABLE_SIZE - 1);
+            if (table[i].ptr == 0) { // Already present: nested allocator call, counted once
+                tracked++;
+                table[i].ptr = (uintptr_t)p;
+                table[i].sizeTag = (sz << 8) | tag;
+                s.allocs++;
+                s.bytes += sz;
+                s.blocks++;
+                s.current += sz;
+                if (s.current > s.peak) s.peak = s.current;
+            }
+        } else {
+            s.allocs++;
+            s.bytes += sz;
+            untracked++;
+        }
+        HEAP_UNLOCK();
+    }
+
+    void onFree(void* p) {
+        if (!p) return;
+        HEAP_LOCK();
+        if (tracked > 0) {
+            size_t i = slotOf((uintptr_t)p);
+            while (table[i].ptr != 0) {
+                if (table[i].ptr == (uintptr_t)p) {
+                    Stats& s = stats[table[i].sizeTag & 0xFF];
+                    s.frees++;
+                    s.blocks--;
+                    s.current -= table[i].sizeTag >> 8;
+                    tracked--;
+                    eraseAt(i);
+                    break;
+                }
+                i = (i + 1) & (TABLE_SIZE - 1);
+            }
+        }
+        HEAP_UNLOCK();
+    }
+
+    Stats getStats(Tag tag) {
+        HEAP_LOCK();
+        Stats s = stats[tag < TAG_COUNT ? tag : OTHER];
+        HEAP_UNLOCK();
+        return s;
+    }
+
+    uint32_t getUntracked() { return untracked; }
+    size_t getTracked() { return tracked; }
+
+    void addSample(const Sample& s) {
+        HEAP_LOCK();
+        samples[sampleHead] = s;
+        sampleHead = (sampleHead + 1) % SAMPLES;
+        if (sampleCount < SAMPLES) sampleCount++;
+        HEAP_UNLOCK();
+    }
+
+    size_t getSampleCount() { return sampleCount; }
+
+    bool getSample(size_t i, Sample& out) {
+        HEAP_LOCK();
+        bool ok = i < sampleCount;
+        if (ok) out = samples[(sampleHead + SAMPLES - sampleCount + i) % SAMPLES];
+        HEAP_UNLOCK();
+        return ok;
+    }
+
+    void observe(uint32_t largest, uint32_t uptimeS) {
+        if (largest < minLargest) {
+            minLargest = largest;
+            minLargestAt = uptimeS;
+        }
+    }
+
+    uint32_t getMinLargest() { return minLargest == UINT32_MAX ? 0 : minLargest; }
+    uint32_t getMinLargestAt() { return minLargestAt; }
+
+}
+
+// -------------------------------------------------------------------------
+// ESP32: allocator wrappers (-Wl,--wrap=... in platformio.ini). heap_caps_*
+// is wrapped as well because mbedTLS and the WiFi/LWIP libraries allocate
+// through it directly. When one
+// wrapped function reaches another (free -> heap_caps_free), the hooks see
+// the block twice: a known block is not charged again, an unknown free is
+// ignored. A block leaves the table before the allocator releases it (its
+// address may be handed out again right away).
+// -------------------------------------------------------------------------
+#ifdef ESP32
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_calloc(size_t n, size_t size);
+    void* __real_realloc(void* p, size_t size);
+    void __real_free(void* p);
+    void* __real_heap_caps_malloc(size_t size, uint32_t caps);
+    void* __real_heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+    void* __real_heap_caps_realloc(void* p, size_t size, uint32_t caps);
+    void __real_heap_caps_free(void* p);
+
+    void* __wrap_malloc(size_t size) {
+        void* p = __real_malloc(size);
+        HeapTags::onAlloc(p, size);
+        return p;
+    }
+
+    void* __wrap_calloc(size_t n, size_t size) {
+        void* p = __real_calloc(n, size);
+        HeapTags::onAlloc(p, n * size);
+        return p;
+    }
+
+    void* __wrap_heap_caps_malloc(size_t size, uint32_t caps) {
+        void* p = __real_heap_caps_malloc(size, caps);
+        HeapTags::onAlloc(p, size);
+        return p;
+    }
+
+    void* __wrap_heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+        void* p = __real_heap_caps_calloc(n, size, caps);
+        HeapTags::onAlloc(p, n * size);
+        return p;
+    }
+
+    void* __wrap_realloc(void* old, size_t size) {
+        // Resized or moved: recharged to the current tag (a failed realloc
+        // leaves the old block untracked)
+        HeapTags::onFree(old);
+        void* p = __real_realloc(old, size);
+        HeapTags::onAlloc(p, size);
+        return p;
+    }
+
+    void* __wrap_heap_caps_realloc(void* old, size_t size, uint32_t caps) {
+        HeapTags::onFree(old);
+        void* p = __real_heap_caps_realloc(old, size, caps);
+        HeapTags::onAlloc(p, size);
+        return p;
+    }
+
+    void __wrap_free(void* p) {
+        HeapTags::onFree(p);
+        __real_free(p);
+    }
+
+    void __wrap_heap_caps_free(void* p) {
+        HeapTags::onFree(p);
+        __real_heap_caps_free(p);
+    }
+}
+#endif
@@ -0,0 +1,108 @@
+#include "HistoryJson.h"
+#include "SensorManager.h"
+
+HistoryJsonWriter::HistoryJsonWriter(SensorManager* sm, uint32_t since)
+    : sensorManager(sm), offset(0), since(since), started(false), first(true), finalized(false) {}
+
+size_t HistoryJsonWriter::fill(uint8_t* buffer, size_t maxLen) {
+    if (finalized) return 0;
+    size_t used = 0;
+    
+    // 1. Start Array (and skip what the client already has)
+    if (!started) {
+        if (maxLen == 0) return 0;
+        buffer[used++] = '[';
+        started = true;
+        if (since > 0) offset = sensorManager->findHistoryOffset(since);
+    }
+    
+    // 2. Determine Batch Size
+    // We need enough space for at least one JSON object (~60 bytes)
+    // If buffer is tiny, wait for next chunk
+    if (maxLen - used < MAX_RECORD) return used;
+
+    // Max items that fit in buffer (conservative estimate)
+    size_t maxItems = (maxLen - used) / MAX_RECORD;
+    // Cap at BATCH to ensure we yield frequent enough (approx every 10-20ms)
+    size_t batchLimit = (maxItems > BATCH) ? BATCH : maxItems;
+
+    Record batch[BATCH]; 
+    
+    // 3. Fetch Batch (Thread Safe Copy)
+    size_t count = sensorManager->copyHistory(offset, batchLimit, batch);
+    
+    // 4. Serialize Batch
+    size_t done = 0;
+    for (size_t i = 0; i < count; i++) {
+        // Check remaining space before writing
+        size_t remaining = maxLen - used;
+        if (remaining < MAX_RECORD) break; // Not enough space, continue in next chunk
+        size_t start = used;
+        
+        // Add comma if this is NOT the very first item
+        if (!first) {
+            buffer[used++] = ',';
+            remaining--;
+        }
+        
+        // Format: {"t":22.5,"h":45.0,"time":1700000000}
+        int written = snprintf((char*)(buffer + used), remaining, 
+            "{\"t\":%.1f,\"h\":%.1f,\"time\":%lu}", 
+            isnan(batch[i].t) ? 0.0f : batch[i].t, 
+            isnan(batch[i].h) ? 0.0f : batch[i].h, 
+            (unsigned long)batch[i].ts);
+        
+        // FIX: Proper snprintf overflow check
+        if (written > 0 && written < (int)remaining) {
+            used += written;
+            done++;
+            first = false;
+        } else {
+            // Truncation occurred or error: drop the partial item, retry it next chunk
+            used = start;
+            break;
+        }
+    }
+    
+    offset += done; // Only records actually written
+
+    // 5. Finalize if Done
+    if (count == 0) {
+        // We asked for data but got 0 -> End of Buffer
+        if (maxLen - used >= 1) {
+             buffer[used++] = ']';
+             finalized = true;
+        }
+        // if no space for ']', we return 'used'. Next call, count will be 0 again, and we try ']' again.
+    }
+
+    return used;
+}
+
+HistorySeriesWriter::HistorySeriesWriter(SensorManager* sm, uint32_t since, uint8_t columns, uint32_t created)
+    : sensorManager(sm), offset(0), since(since), started(false), writer(columns, created) {}
+
+size_t HistorySeriesWriter::fill(uint8_t* buffer, size_t maxLen) {
+    if (!started) {
+        started = true;
+        if (since > 0) offset = sensorManager->findHistoryOffset(since);
+    }
+    size_t used = 0;
+    while (used < maxLen && !writer.isDone()) {
+        size_t n = writer.read(buffer + used, maxLen - used);
+        used += n;
+        if (n > 0) continue;
+
+        // Nothing encoded yet: feed the next batch (a full block stops the feed)
+        Record batch[HistoryJsonWriter::BATCH];
+        size_t count = sensorManager->copyHistory(offset, HistoryJsonWriter::BATCH, batch);
+        if (count == 0) {
+            writer.finish();
+            continue;
+        }
+        size_t done = 0;
+        while (done < count && writer.append(batch[done].ts, batch[done].t, batch[done].h)) done++;
+        offset += done;
+    }
+    return used;
+}
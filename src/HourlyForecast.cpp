@@ -0,0 +1,50 @@
+#include "HourlyForecast.h"
+#include "ClimateMath.h"
+
+HourlyForecast::HourlyForecast() { clear(); }
+
+void HourlyForecast::clear() {
+    startTs = 0;
+    count = 0;
+}
+
+void HourlyForecast::begin(uint32_t ts) {
+    startTs = ts;
+    count = 0;
+}
+
+bool HourlyForecast::append(float t, float rh) {
+    if (count >= HOURS || isnan(t) || isnan(rh)) return false;
+    rh = constrain(rh, 0.0f, 100.0f);
+    float ah = ClimateMath::calculateAbsHumidity(t, rh);
+
+    Point& p = points[count++];
+    p.t10 = (int16_t)lroundf(t * 10.0f);
+    p.rh = (uint8_t)lroundf(rh);
+    p.ah100 = (uint16_t)lroundf(constrain(ah, 0.0f, 655.0f) * 100.0f);
+    return true;
+}
+
+uint32_t HourlyForecast::getEndTime() const {
+    return count ? startTs + (uint32_t)(count - 1) * 3600 : startTs;
+}
+
+bool HourlyForecast::covers(uint32_t ts) const {
+    return count >= 2 && ts >= startTs && ts <= getEndTime();
+}
+
+bool HourlyForecast::sample(uint32_t ts, float& t, float& rh, float& ah) const {
+    if (!covers(ts)) return false;
+
+    uint32_t dt = ts - startTs;
+    size_t i = dt / 3600;
+    if (i >= (size_t)count - 1) i = count - 2; // ts == end time
+    float k = (dt - i * 3600) / 3600.0f;
+
+    const Point& a = points[i];
+    const Point& b = points[i + 1];
+    t = (a.t10 + (b.t10 - a.t10) * k) / 10.0f;
+    rh = a.rh + (b.rh - a.rh) * k;
+    ah = (a.ah100 + ((float)b.ah100 - a.ah100) * k) / 100.0f;
+    return true;
+}
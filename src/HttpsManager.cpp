@@ -0,0 +1,107 @@
+#include "HttpsManager.h"
+#include <WiFi.h>
+#include <UniversalTelegramBot.h>
+#include "RootCerts.h"
+#include "Trace.h"
+#include "HeapTags.h"
+
+// Telegram is polled every 3s -> keep it open. Weather is fetched every
+// 10 min over HTTP/1.0 (streamed JSON), so the server closes the socket
+// after each response -> release soon after use.
+const HttpsManager::Endpoint HttpsManager::ENDPOINTS[HttpsManager::HOST_COUNT] = {
+    {"api.telegram.org", 443, TELEGRAM_CERTIFICATE_ROOT, 60000},
+    {"api.open-meteo.com", 443, OPEN_METEO_ROOT_CA, 15000},
+};
+
+HttpsManager::HttpsManager() {
+    for (size_t i = 0; i < HOST_COUNT; i++) {
+        clients[i].setCACert(ENDPOINTS[i].rootCA);
+        clients[i].setHandshakeTimeout(10); // Seconds
+        stats[i] = {};
+        lastActivity[i] = 0;
+        locks[i] = xSemaphoreCreateMutex();
+    }
+}
+
+void HttpsManager::update() {
+    unsigned long now = millis();
+    for (size_t i = 0; i < HOST_COUNT; i++) {
+        if (lastActivity[i] == 0) continue;
+        // In use by its task: not idle, and not ours to touch
+        if (xSemaphoreTake(locks[i], 0) != pdTRUE) continue;
+        if (lastActivity[i] != 0 && now - lastActivity[i] > ENDPOINTS[i].idleTimeoutMs) {
+            if (clients[i].connected()) stats[i].idleCloses++;
+            clients[i].stop();
+            lastActivity[i] = 0;
+        }
+        xSemaphoreGive(locks[i]);
+    }
+}
+
+WiFiClientSecure& HttpsManager::client(Host host) {
+    return clients[(size_t)host];
+}
+
+bool HttpsManager::ensureConnected(Host host) {
+    size_t i = (size_t)host;
+    Stats& s = stats[i];
+    s.requests++;
+
+    if (WiFi.status() != WL_CONNECTED) return false;
+    xSemaphoreTake(locks[i], portMAX_DELAY); // Only the reaper competes, for a moment
+
+    if (clients[i].connected()) {
+        s.reused++;
+        lastActivity[i] = millis();
+        return true;
+    }
+
+    clients[i].stop(); // Drop half-closed socket state before reconnecting
+    unsigned long start = millis();
+    bool ok;
+    {
+        HeapTags::Scope tlsTag(HeapTags::TLS); // mbedTLS context + record buffers (kept while connected)
+        TRACE_BEGIN("tls_handshake");
+        ok = clients[i].connect(ENDPOINTS[i].host, ENDPOINTS[i].port);
+        TRACE_END("tls_handshake");
+    }
+    uint32_t dur = millis() - start;
+
+    if (!ok) {
+        s.failures++;
+        xSemaphoreGive(locks[i]);
+        Serial.printf("[TLS] %s connect failed (%lu ms)\n", ENDPOINTS[i].host, (unsigned long)dur);
+        return false;
+    }
+
+    s.handshakes++;
+    s.lastHandshakeMs = dur;
+    s.totalHandshakeMs += dur;
+    if (dur > s.maxHandshakeMs) s.maxHandshakeMs = dur;
+    lastActivity[i] = millis();
+    Serial.printf("[TLS] %s handshake %lu ms (#%lu)\n", ENDPOINTS[i].host, (unsigned long)dur, (unsigned long)s.handshakes);
+    return true;
+}
+
+void HttpsManager::touch(Host host) {
+    lastActivity[(size_t)host] = millis();
+    xSemaphoreGive(locks[(size_t)host]);
+}
+
+void HttpsManager::close(Host host) {
+    size_t i = (size_t)host;
+    xSemaphoreTake(locks[i], portMAX_DELAY);
+    clients[i].stop();
+    lastActivity[i] = 0;
+    xSemaphoreGive(locks[i]);
+}
+
+const HttpsManager::Stats& HttpsManager::getStats(Host host) const { return stats[(size_t)host]; }
+const char* HttpsManager::getHostName(Host host) const { return ENDPOINTS[(size_t)host].host; }
+bool HttpsManager::isConnected(Host host) {
+    size_t i = (size_t)host;
+    if (xSemaphoreTake(locks[i], 0) != pdTRUE) return true; // In use, so open
+    bool open = clients[i].connected();
+    xSemaphoreGive(locks[i]);
+    return open;
+}
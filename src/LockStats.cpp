@@ -0,0 +1,65 @@
+#include "LockStats.h"
+
+LockStats::LockStats(const SiteInfo* table, size_t n)
+    : info(table), count(n < MAX_SITES ? n : MAX_SITES),
+      sites(), maxHoldUs(0), maxHoldSite(-1), holder(-1), holdStart(0) {}
+
+uint8_t LockStats::bucket(uint32_t us) {
+    uint8_t b = 0;
+    for (uint32_t limit = 10; b < BUCKETS - 1 && us >= limit; limit *= 10) b++;
+    return b;
+}
+
+int LockStats::getHolder(uint32_t& heldUs) const {
+    int site = holder;
+    heldUs = (site >= 0) ? micros() - holdStart : 0;
+    return site;
+}
+
+void LockStats::acquired(uint8_t site, uint32_t waitUs, uint32_t now) {
+    Site& s = sites[site];
+    s.acquired++;
+    s.wait[bucket(waitUs)]++;
+    s.totalWaitUs += waitUs;
+    if (waitUs > s.maxWaitUs) s.maxWaitUs = waitUs;
+    holdStart = now;
+    holder = site;
+}
+
+void LockStats::released(uint8_t site, uint32_t now) {
+    uint32_t held = now - holdStart;
+    holder = -1;
+    Site& s = sites[site];
+    s.hold[bucket(held)]++;
+    s.totalHoldUs += held;
+    if (held > s.maxHoldUs) s.maxHoldUs = held;
+    if (held > maxHoldUs) {
+        maxHoldUs = held;
+        maxHoldSite = site;
+    }
+}
+
+void LockStats::timedOut(uint8_t site) {
+    // Not holding the mutex: another site may be updating its counters
+    __atomic_fetch_add(&sites[site].timeouts, 1, __ATOMIC_RELAXED);
+}
+
+ScopedLock::ScopedLock(SemaphoreHandle_t mutex, LockStats& stats, uint8_t site)
+    : mutex(mutex), stats(stats), site(site < stats.getSiteCount() ? site : 0), owned(false) {
+    if (!mutex) return;
+    uint32_t start = micros();
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(stats.getInfo(this->site).timeoutMs)) == pdTRUE) {
+        owned = true;
+        uint32_t now = micros();
+        stats.acquired(this->site, now - start, now);
+    } else {
+        stats.timedOut(this->site);
+    }
+}
+
+void ScopedLock::unlock() {
+    if (!owned) return;
+    stats.released(site, micros()); // Still holding: counters are protected
+    owned = false;
+    xSemaphoreGive(mutex);
+}
@@ -0,0 +1,86 @@
+#include "MoldIndex.h"
+#include <math.h>
+
+// Material: very sensitive class (pine sapwood), sawn surface
+static const float SPECIES = 0.0f;       // W: 0 = pine, 1 = spruce
+static const float SURFACE = 0.0f;       // SQ: 0 = sawn, 1 = kiln-dried quality
+static const float MAX_INDEX = 6.0f;
+// Decline while dry (index per day): fast for the first 6 h, none until
+// 24 h, then slow. Together with the growth formula this is the original
+// hourly model; here it is integrated exactly over any step length.
+static const float DECLINE_FAST = 0.032f;
+static const float DECLINE_SLOW = 0.016f;
+static const float FAST_HOURS = 6.0f;
+static const float PAUSE_HOURS = 24.0f;
+
+MoldIndex::MoldIndex() : state{0.0f, 0.0f}, rate(0.0f), carry(0.0f) {}
+
+void MoldIndex::restore(const State& s) {
+    state.index = (s.index >= 0 && s.index <= MAX_INDEX) ? s.index : 0.0f; // Also rejects NAN
+    state.dryHours = (s.dryHours >= 0) ? s.dryHours : 0.0f;
+    rate = 0.0f;
+    carry = 0.0f;
+}
+
+float MoldIndex::criticalRh(float t) {
+    if (t > 20.0f) return 80.0f;
+    return ((-0.00267f * t + 0.160f) * t - 3.13f) * t + 100.0f;
+}
+
+float MoldIndex::surfaceTemp(float indoor, float outdoor, float fRsi) {
+    if (isnan(outdoor) || outdoor >= indoor) return indoor;
+    return outdoor + fRsi * (indoor - outdoor);
+}
+
+// Length of [a, b) inside [lo, hi)
+static float overlap(float a, float b, float lo, float hi) {
+    float s = a > lo ? a : lo;
+    float e = b < hi ? b : hi;
+    return e > s ? e - s : 0.0f;
+}
+
+void MoldIndex::update(float t, float rh, float hours) {
+    if (!(hours > 0)) return;
+    float delta;
+    float rhCrit = criticalRh(t);
+
+    if (t > 0.0f && t < 50.0f && rh >= rhCrit && rhCrit < 100.0f) { // NAN fails every test
+        if (rh > 100.0f) rh = 100.0f;
+        float lnT = logf(t);
+        float lnRh = logf(rh);
+        // Weeks to reach index 1 (initial growth) under these conditions
+        float tm = expf(-0.68f * lnT - 13.9f * lnRh + 0.14f * SPECIES - 0.33f * SURFACE + 66.02f);
+        float k1 = 1.0f;
+        if (state.index >= 1.0f) {
+            // Weeks to reach index 3: growth after the start is faster
+            float tv = expf(-0.74f * lnT - 12.72f * lnRh + 0.06f * SPECIES + 61.50f);
+            if (tv > tm) k1 = 2.0f / (tv / tm - 1.0f);
+        }
+        // The attainable maximum drops towards the critical humidity
+        float x = (rhCrit - rh) / (rhCrit - 100.0f);
+        float mMax = 1.0f + 7.0f * x - 2.0f * x * x;
+        float k2 = 1.0f - expf(2.3f * (state.index - mMax));
+        if (k2 < 0) k2 = 0;
+        delta = k1 * k2 / (7.0f * tm) * (hours / 24.0f);
+        state.dryHours = 0.0f;
+    } else {
+        float from = state.dryHours;
+        float to = from + hours;
+        delta = -(overlap(from, to, 0.0f, FAST_HOURS) * DECLINE_FAST +
+                  overlap(from, to, PAUSE_HOURS, INFINITY) * DECLINE_SLOW) / 24.0f;
+        state.dryHours = to < PAUSE_HOURS ? to : PAUSE_HOURS; // Saturates: keeps float steps exact
+    }
+
+    // One 6 s reading moves the index by ~1e-6, close to the float step at
+    // index 2..6: compensated (Kahan) summation keeps the small steps
+    rate = delta * 24.0f / hours;
+    float y = delta - carry;
+    float m = state.index + y;
+    carry = (m - state.index) - y;
+    if (m < 0 || m > MAX_INDEX) {
+        m = (m < 0) ? 0.0f : MAX_INDEX;
+        carry = 0.0f;
+        rate = 0.0f; // Pinned at a bound
+    }
+    state.index = m;
+}
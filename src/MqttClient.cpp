@@ -0,0 +1,226 @@
+#include "MqttClient.h"
+#include <Arduino.h>
+
+// Control packet types (upper nibble of the fixed header)
+static const uint8_t CONNECT = 0x10;
+static const uint8_t CONNACK = 0x20;
+static const uint8_t PUBLISH = 0x30;
+static const uint8_t PINGREQ = 0xC0;
+static const uint8_t PINGRESP = 0xD0;
+static const uint8_t DISCONNECT = 0xE0;
+
+static const uint32_t PING_TIMEOUT_MS = 10000; // No PINGRESP -> connection is dead
+
+enum RxPhase : uint8_t { RX_HEADER, RX_LENGTH, RX_BODY };
+
+static size_t putString(uint8_t* out, const char* s) {
+    size_t len = strlen(s);
+    out[0] = (uint8_t)(len >> 8);
+    out[1] = (uint8_t)len;
+    memcpy(out + 2, s, len);
+    return len + 2;
+}
+
+MqttClient::MqttClient(MqttTransport* transport)
+    : transport(transport), connected(false), txLen(0), txPackets(0), sentPackets(0), lastTxMs(0), pingSentMs(0), pongs(0),
+      rxPhase(RX_HEADER), rxType(0), rxRemaining(0), rxMultiplier(1), rxBodyLen(0), connackCode(0xFF) {}
+
+bool MqttClient::append(const uint8_t* data, size_t len) {
+    if (txLen + len > TX_SIZE && !flush()) return false;
+    memcpy(tx + txLen, data, len);
+    txLen += len;
+    return true;
+}
+
+// Fixed header + remaining length (varint) + variable header + payload
+bool MqttClient::appendPacket(uint8_t header, const uint8_t* var, size_t varLen, const uint8_t* payload, size_t payloadLen) {
+    uint8_t fixed[5];
+    size_t n = 0;
+    size_t remaining = varLen + payloadLen;
+    fixed[n++] = header;
+    do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        if (remaining > 0) digit |= 0x80;
+        fixed[n++] = digit;
+    } while (remaining > 0);
+
+    if (n + varLen + payloadLen > TX_SIZE) return false;
+    if (txLen + n + varLen + payloadLen > TX_SIZE && !flush()) return false;
+    if (!append(fixed, n) || !append(var, varLen) || (payloadLen > 0 && !append(payload, payloadLen))) return false;
+    txPackets++;
+    return true;
+}
+
+bool MqttClient::flush() {
+    if (txLen == 0) return true;
+    size_t off = 0;
+    uint32_t start = millis();
+    while (off < txLen) {
+        int n = transport->write(tx + off, txLen - off);
+        if (n < 0 || (n == 0 && millis() - start > 2000)) {
+            txLen = 0;
+            txPackets = 0;
+            transport->close();
+            connected = false;
+            return false;
+        }
+        off += n;
+    }
+    txLen = 0;
+    sentPackets += txPackets;
+    txPackets = 0;
+    lastTxMs = millis();
+    return true;
+}
+
+bool MqttClient::connect(const char* host, uint16_t port, const char* clientId, const Will& will,
+                         const char* user, const char* pass, uint32_t timeoutMs) {
+    disconnect();
+    if (!transport->open(host, port)) return false;
+
+    uint8_t var[10] = {0, 4, 'M', 'Q', 'T', 'T', 4, 0, KEEP_ALIVE_SEC >> 8, KEEP_ALIVE_SEC & 0xFF};
+    uint8_t flags = 0x02 | 0x04; // Clean session, will (QoS 0)
+    if (will.retain) flags |= 0x20;
+    if (user && *user) flags |= 0x80;
+    if (pass && *pass) flags |= 0x40;
+    var[7] = flags;
+
+    uint8_t payload[256];
+    size_t n = 0;
+    size_t need = strlen(clientId) + strlen(will.topic) + strlen(will.payload) + 6 +
+                  ((flags & 0x80) ? strlen(user) + 2 : 0) + ((flags & 0x40) ? strlen(pass) + 2 : 0);
+    if (need > sizeof(payload)) {
+        transport->close();
+        return false;
+    }
+    n += putString(payload + n, clientId);
+    n += putString(payload + n, will.topic);
+    n += putString(payload + n, will.payload);
+    if (flags & 0x80) n += putString(payload + n, user);
+    if (flags & 0x40) n += putString(payload + n, pass);
+
+    txLen = 0;
+    txPackets = 0;
+    rxPhase = RX_HEADER;
+    connackCode = 0xFF;
+    connected = true; // flush() needs it; cleared again on any failure below
+    if (!appendPacket(CONNECT, var, sizeof(var), payload, n) || !flush()) return false;
+
+    uint32_t start = millis();
+    while (connackCode == 0xFF && millis() - start < timeoutMs) {
+        if (poll() < 0) break;
+        if (connackCode == 0xFF) delay(10);
+    }
+    if (connackCode != 0) { // Timeout or refused (bad credentials, id rejected)
+        transport->close();
+        connected = false;
+        return false;
+    }
+    pingSentMs = 0;
+    return true;
+}
+
+void MqttClient::disconnect() {
+    if (connected && transport->isOpen()) {
+        flush();
+        const uint8_t packet[2] = {DISCONNECT, 0};
+        transport->write(packet, sizeof(packet));
+    }
+    transport->close();
+    connected = false;
+    txLen = 0;
+    txPackets = 0;
+}
+
+bool MqttClient::isConnected() {
+    if (connected && !transport->isOpen()) connected = false;
+    return connected;
+}
+
+bool MqttClient::publish(const char* topic, const char* payload, size_t len, bool retain) {
+    if (!isConnected()) return false;
+    uint8_t var[128];
+    if (strlen(topic) + 2 > sizeof(var)) return false;
+    size_t varLen = putString(var, topic);
+    return appendPacket(PUBLISH | (retain ? 0x01 : 0x00), var, varLen, (const uint8_t*)payload, len);
+}
+
+bool MqttClient::sendPing() {
+    const uint8_t packet[2] = {PINGREQ, 0};
+    if (!append(packet, sizeof(packet)) || !flush()) return false;
+    pingSentMs = millis();
+    if (pingSentMs == 0) pingSentMs = 1;
+    return true;
+}
+
+int MqttClient::poll() {
+    uint8_t buf[32];
+    int last = 0;
+    for (;;) {
+        int n = transport->read(buf, sizeof(buf));
+        if (n < 0) {
+            transport->close();
+            connected = false;
+            return -1;
+        }
+        if (n == 0) return last;
+
+        for (int i = 0; i < n; i++) {
+            uint8_t b = buf[i];
+            if (rxPhase == RX_HEADER) {
+                rxType = b & 0xF0;
+                rxRemaining = 0;
+                rxMultiplier = 1;
+                rxBodyLen = 0;
+                rxPhase = RX_LENGTH;
+                continue;
+            }
+            if (rxPhase == RX_LENGTH) {
+                rxRemaining += (b & 0x7F) * rxMultiplier;
+                rxMultiplier *= 128;
+                if (b & 0x80) continue;
+                if (rxRemaining > 0) {
+                    rxPhase = RX_BODY;
+                    continue;
+                }
+            } else {
+                if (rxBodyLen < sizeof(rxBody)) rxBody[rxBodyLen++] = b; // Longer bodies are skipped
+                if (--rxRemaining > 0) continue;
+            }
+
+            // Packet complete
+            if (rxType == CONNACK) connackCode = (rxBodyLen == 2) ? rxBody[1] : 0x80;
+            if (rxType == PINGRESP) {
+                pingSentMs = 0;
+                pongs++;
+            }
+            last = rxType;
+            rxPhase = RX_HEADER;
+        }
+    }
+}
+
+void MqttClient::loop() {
+    if (!isConnected()) return;
+    if (poll() < 0) return;
+    uint32_t now = millis();
+    if (pingSentMs != 0 && now - pingSentMs > PING_TIMEOUT_MS) {
+        transport->close(); // Half-open connection: the broker stopped answering
+        connected = false;
+        return;
+    }
+    if (pingSentMs == 0 && now - lastTxMs > KEEP_ALIVE_SEC * 1000UL / 2) sendPing();
+}
+
+bool MqttClient::sync(uint32_t timeoutMs) {
+    if (!isConnected()) return false;
+    uint32_t target = pongs + 1;
+    if (!sendPing()) return false;
+    uint32_t start = millis();
+    while (pongs < target && millis() - start < timeoutMs) {
+        if (poll() < 0) return false;
+        if (pongs < target) delay(1);
+    }
+    return pongs >= target;
+}
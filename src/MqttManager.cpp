@@ -0,0 +1,362 @@
+#include "MqttManager.h"
+#include "SensorManager.h"
+#include "ClimateMath.h"
+#include "Trace.h"
+#include <stdio.h>
+
+static const char* TOPIC_SUFFIX[MqttManager::TOPIC_COUNT] = {"state", "readings", "event", "status"};
+static const char* STATE_NAMES[] = {"stable", "ventilating", "target_met", "inefficient"};
+static const uint32_t RETRY_MIN_MS = 2000;
+static const uint32_t RETRY_MAX_MS = 60000;
+static const uint32_t IDLE_UPDATE_MS = 5000; // Connected, nothing queued (keep-alive needs < 30 s)
+
+// Home Assistant entities, all read from <base>/state
+struct Entity {
+    const char* key;      // JSON field and object id
+    const char* name;
+    const char* unit;     // nullptr = none
+    const char* devClass; // nullptr = none
+};
+static const Entity ENTITIES[] = {
+    {"t",       "Temperature",       "°C",       "temperature"},
+    {"h",       "Humidity",          "%",        "humidity"},
+    {"dp",      "Dew point",         "°C",       "temperature"},
+    {"ah",      "Absolute humidity", "g/m³",     nullptr},
+    {"t_rate",  "Temperature trend", "°C/min",   nullptr},
+    {"ah_rate", "Humidity trend",    "g/m³/min", nullptr},
+    {"state",   "Airing state",      nullptr,    nullptr},
+    {"advice",  "Advice code",       nullptr,    nullptr},
+};
+
+// Spill record header: topic, retain, payload length (little endian)
+static const size_t SPILL_HEADER = 4;
+
+static const char* stateName(int state) {
+    return (state >= 0 && state < 4) ? STATE_NAMES[state] : "unknown";
+}
+
+// JSON number or null (printf would write "nan")
+static const char* jsonFloat(char* buf, size_t len, float v, int decimals) {
+    if (isnan(v)) strlcpy(buf, "null", len);
+    else snprintf(buf, len, "%.*f", decimals, v);
+    return buf;
+}
+
+MqttManager::MqttManager(SensorManager* sm, MqttTransport* transport)
+    : sensorManager(sm), client(transport), host(MQTT_HOST), port(MQTT_PORT), user(MQTT_USER), pass(MQTT_PASS),
+      inputMutex(nullptr), batchCount(0), batchStartMs(0), latest{0, NAN, NAN}, latestAbsHum(NAN), latestState(0),
+      hasLatest(false), eventCount(0), head(0), count(0), spillPath(nullptr), spillMax(0), spillRead(0),
+      spillWrite(0), spillCount(0), lastStateMs(0), lastAdviceCode(-1), discoverySent(false),
+      retryMs(RETRY_MIN_MS), lastAttemptMs(0), connectWaitMs(0), drainStartMs(0), drainStartCount(0), stats{} {
+    deviceId[0] = 0;
+    base[0] = 0;
+}
+
+void MqttManager::begin(const char* id) {
+    strlcpy(deviceId, id, sizeof(deviceId));
+    snprintf(base, sizeof(base), "acm1/%s", deviceId);
+    if (!inputMutex) inputMutex = xSemaphoreCreateMutex();
+}
+
+void MqttManager::setBroker(const char* h, uint16_t p, const char* u, const char* pw) {
+    host = h ? h : "";
+    port = p;
+    user = u;
+    pass = pw;
+}
+
+void MqttManager::setSpillFile(const char* path, size_t maxBytes) {
+    spillPath = (path && maxBytes > 0) ? path : nullptr;
+    spillMax = maxBytes;
+    spillRead = spillWrite = spillCount = 0;
+    if (!spillPath) return;
+
+    // Backlog left from before a reset is published first
+    FILE* f = fopen(spillPath, "rb");
+    if (!f) return;
+    uint8_t header[SPILL_HEADER];
+    while (fread(header, 1, SPILL_HEADER, f) == SPILL_HEADER) {
+        uint16_t len = header[2] | (header[3] << 8);
+        if (len > MAX_PAYLOAD || fseek(f, len, SEEK_CUR) != 0) break;
+        spillWrite += SPILL_HEADER + len;
+        spillCount++;
+    }
+    fclose(f);
+    if (spillCount == 0) remove(spillPath);
+}
+
+size_t MqttManager::getBacklog() const { return count + spillCount; }
+
+void MqttManager::topicName(uint8_t topic, char* out, size_t len) const {
+    snprintf(out, len, "%s/%s", base, TOPIC_SUFFIX[topic < TOPIC_COUNT ? topic : TOPIC_EVENT]);
+}
+
+// -------------------------------------------------------------------------
+// Input (sensor task)
+// -------------------------------------------------------------------------
+void MqttManager::onReading(float t, float h, float absHum, int state) {
+    if (!inputMutex || !isEnabled()) return;
+    if (xSemaphoreTake(inputMutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+    latest = {(uint32_t)time(NULL), t, h};
+    latestAbsHum = absHum;
+    latestState = state;
+    hasLatest = true;
+    // Rapid mode (airing session): every reading goes out, batched
+    if (state != 0 && batchCount < BATCH_MAX) {
+        if (batchCount == 0) batchStartMs = millis();
+        batch[batchCount++] = latest;
+    }
+    xSemaphoreGive(inputMutex);
+}
+
+void MqttManager::onStateChange(int from, int to) {
+    if (!inputMutex || !isEnabled()) return;
+    if (xSemaphoreTake(inputMutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+    if (eventCount < 4) {
+        events[eventCount][0] = from;
+        events[eventCount][1] = to;
+        eventCount++;
+    }
+    xSemaphoreGive(inputMutex);
+}
+
+// -------------------------------------------------------------------------
+// Queue (main loop)
+// -------------------------------------------------------------------------
+MqttManager::Message* MqttManager::push(Topic topic, bool retain) {
+    if (count == QUEUE_SLOTS) {
+        // Full: the oldest RAM message goes to flash (still older than anything in RAM)
+        if (!spill(queue[head])) stats.dropped++;
+        head = (head + 1) % QUEUE_SLOTS;
+        count--;
+    }
+    Message* m = &queue[(head + count) % QUEUE_SLOTS];
+    count++;
+    m->topic = topic;
+    m->retain = retain ? 1 : 0;
+    m->len = 0;
+    stats.queued++;
+    uint32_t backlog = getBacklog();
+    if (backlog > stats.backlogPeak) stats.backlogPeak = backlog;
+    return m;
+}
+
+bool MqttManager::spill(const Message& m) {
+    if (!spillPath || spillWrite + SPILL_HEADER + m.len > spillMax) return false;
+    FILE* f = fopen(spillPath, "ab");
+    if (!f) return false;
+    uint8_t header[SPILL_HEADER] = {m.topic, m.retain, (uint8_t)(m.len & 0xFF), (uint8_t)(m.len >> 8)};
+    bool ok = fwrite(header, 1, SPILL_HEADER, f) == SPILL_HEADER && fwrite(m.payload, 1, m.len, f) == m.len;
+    fclose(f);
+    if (!ok) return false;
+    spillWrite += SPILL_HEADER + m.len;
+    spillCount++;
+    stats.spilled++;
+    return true;
+}
+
+void MqttManager::collect(uint32_t now) {
+    Sample samples[BATCH_MAX];
+    size_t sampleCount = 0;
+    int pending[4][2];
+    size_t pendingCount;
+    Sample last;
+    float lastAbsHum;
+    int state;
+    bool have;
+
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    pendingCount = eventCount;
+    memcpy(pending, events, sizeof(pending));
+    eventCount = 0;
+    last = latest;
+    lastAbsHum = latestAbsHum;
+    state = latestState;
+    have = hasLatest;
+    // Flush the batch every BATCH_MS, when full, or when the session ended
+    if (batchCount > 0 && (batchCount >= BATCH_MAX || now - batchStartMs >= BATCH_MS || state == 0)) {
+        sampleCount = batchCount;
+        memcpy(samples, batch, sampleCount * sizeof(Sample));
+        batchCount = 0;
+    }
+    xSemaphoreGive(inputMutex);
+
+    char a[12], b[12], c[12], d[12], e[12], f[12];
+    for (size_t i = 0; i < pendingCount; i++) {
+        Message* m = push(TOPIC_EVENT, false);
+        m->len = snprintf(m->payload, MAX_PAYLOAD, "{\"from\":\"%s\",\"to\":\"%s\",\"ts\":%lu}",
+                          stateName(pending[i][0]), stateName(pending[i][1]), (unsigned long)time(NULL));
+    }
+
+    if (sampleCount > 0) {
+        Message* m = push(TOPIC_READINGS, false);
+        size_t used = snprintf(m->payload, MAX_PAYLOAD, "{\"n\":%u,\"r\":[", (unsigned)sampleCount);
+        for (size_t i = 0; i < sampleCount && used < MAX_PAYLOAD; i++) {
+            used += snprintf(m->payload + used, MAX_PAYLOAD - used, "%s[%lu,%s,%s]", i ? "," : "",
+                             (unsigned long)samples[i].ts, jsonFloat(a, sizeof(a), samples[i].t, 2),
+                             jsonFloat(b, sizeof(b), samples[i].h, 1));
+        }
+        if (used < MAX_PAYLOAD) used += snprintf(m->payload + used, MAX_PAYLOAD - used, "]}");
+        m->len = used < MAX_PAYLOAD ? used : MAX_PAYLOAD - 1;
+    }
+
+    // State: on transitions, advice changes, and periodically (faster while airing)
+    if (!have) return;
+    int advice = sensorManager->getAdviceCode();
+    uint32_t interval = state != 0 ? BATCH_MS : STATE_MS;
+    if (pendingCount == 0 && advice == lastAdviceCode && lastStateMs != 0 && now - lastStateMs < interval) return;
+    lastAdviceCode = advice;
+    lastStateMs = now ? now : 1;
+
+    Message* m = push(TOPIC_STATE, true);
+    int len = snprintf(m->payload, MAX_PAYLOAD,
+        "{\"t\":%s,\"h\":%s,\"dp\":%s,\"ah\":%s,\"t_rate\":%s,\"ah_rate\":%s,\"state\":\"%s\",\"advice\":%d,\"ts\":%lu}",
+        jsonFloat(a, sizeof(a), last.t, 2), jsonFloat(b, sizeof(b), last.h, 1),
+        jsonFloat(c, sizeof(c), ClimateMath::calculateDewPoint(last.t, last.h), 1),
+        jsonFloat(d, sizeof(d), lastAbsHum, 2),
+        jsonFloat(e, sizeof(e), sensorManager->getTempRate(), 3),
+        jsonFloat(f, sizeof(f), sensorManager->getAbsHumRate(), 3),
+        stateName(state), advice, (unsigned long)last.ts);
+    m->len = (len > 0 && len < (int)MAX_PAYLOAD) ? len : 0;
+}
+
+// -------------------------------------------------------------------------
+// Connection + drain (main loop)
+// -------------------------------------------------------------------------
+bool MqttManager::connect(uint32_t now) {
+    if (connectWaitMs != 0 && now - lastAttemptMs < connectWaitMs) return false;
+#if defined(ESP32)
+    if (WiFi.status() != WL_CONNECTED) return false;
+#endif
+    char statusTopic[48];
+    topicName(TOPIC_STATUS, statusTopic, sizeof(statusTopic));
+    MqttClient::Will will = {statusTopic, "offline", true};
+
+    TRACE_SCOPE("mqtt_connect");
+    if (!client.connect(host, port, deviceId, will, user, pass)) {
+        stats.connectFailures++;
+        lastAttemptMs = now;
+        connectWaitMs = retryMs;
+        retryMs = min(retryMs * 2, RETRY_MAX_MS);
+        return false;
+    }
+    stats.connects++;
+    retryMs = RETRY_MIN_MS;
+    connectWaitMs = 0;
+    client.publish(statusTopic, "online", 6, true);
+    if (!discoverySent) publishDiscovery();
+    client.flush();
+
+    if (getBacklog() > 0) {
+        drainStartMs = millis();
+        drainStartCount = getBacklog();
+    }
+    Serial.printf("[MQTT] Connected to %s:%u (backlog %u)\n", host, port, (unsigned)getBacklog());
+    return true;
+}
+
+void MqttManager::publishDiscovery() {
+    char topic[96];
+    char payload[MAX_PAYLOAD];
+    bool ok = true;
+    for (const Entity& e : ENTITIES) {
+        snprintf(topic, sizeof(topic), "homeassistant/sensor/%s/%s/config", deviceId, e.key);
+        char unit[80] = "";
+        char devClass[64] = "";
+        if (e.unit) snprintf(unit, sizeof(unit), ",\"unit_of_meas\":\"%s\",\"stat_cla\":\"measurement\"", e.unit);
+        if (e.devClass) snprintf(devClass, sizeof(devClass), ",\"dev_cla\":\"%s\"", e.devClass);
+        int len = snprintf(payload, sizeof(payload),
+            "{\"name\":\"%s\",\"uniq_id\":\"%s_%s\",\"stat_t\":\"%s/state\",\"val_tpl\":\"{{ value_json.%s }}\","
+            "\"avty_t\":\"%s/status\"%s%s,\"dev\":{\"ids\":[\"%s\"],\"name\":\"ACM-1 %s\",\"mdl\":\"ACM-1\",\"mf\":\"DIY\"}}",
+            e.name, deviceId, e.key, base, e.key, base, unit, devClass, deviceId, deviceId);
+        if (len <= 0 || len >= (int)sizeof(payload) || !client.publish(topic, payload, len, true)) ok = false;
+    }
+    discoverySent = ok;
+}
+
+size_t MqttManager::drain() {
+    char topic[48];
+    size_t sent = 0;
+    uint32_t readOffset = spillRead;
+    uint32_t spillEnd[DRAIN_PER_UPDATE]; // File offset after each spilled message sent
+    uint32_t spillSent = 0;
+    size_t ramSent = 0;
+    Message m;
+
+    // Packet n of this drain is message n: a publish that does not fit flushes
+    // the buffer, and a failed flush drops it, so the sent-packet count is what
+    // reached the socket.
+    if (!client.flush()) return 0;
+    uint32_t packets0 = client.getSentPackets();
+
+    // Flash first (older), then RAM
+    FILE* f = (spillCount > 0) ? fopen(spillPath, "rb") : nullptr;
+    if (f && fseek(f, readOffset, SEEK_SET) != 0) {
+        fclose(f);
+        f = nullptr;
+    }
+    while (sent < DRAIN_PER_UPDATE) {
+        const Message* next;
+        if (f && spillSent < spillCount) {
+            uint8_t header[SPILL_HEADER];
+            if (fread(header, 1, SPILL_HEADER, f) != SPILL_HEADER) break;
+            m.topic = header[0];
+            m.retain = header[1];
+            m.len = header[2] | (header[3] << 8);
+            if (m.len > MAX_PAYLOAD || fread(m.payload, 1, m.len, f) != m.len) break;
+            next = &m;
+        } else if (ramSent < count) {
+            next = &queue[(head + ramSent) % QUEUE_SLOTS];
+        } else {
+            break;
+        }
+        topicName(next->topic, topic, sizeof(topic));
+        if (!client.publish(topic, next->payload, next->len, next->retain)) break;
+        if (next == &m) {
+            readOffset += SPILL_HEADER + m.len;
+            spillEnd[spillSent++] = readOffset;
+        } else {
+            ramSent++;
+        }
+        sent++;
+    }
+    if (f) fclose(f);
+
+    // Commit only what reached the socket (the rest is resent after reconnecting)
+    if (sent > 0) client.flush();
+    sent = client.getSentPackets() - packets0;
+    if (sent == 0) return 0;
+    spillSent = sent < spillSent ? sent : spillSent;
+    ramSent = sent - spillSent;
+    if (spillSent > 0) spillRead = spillEnd[spillSent - 1];
+    spillCount -= spillSent;
+    if (spillCount == 0 && spillPath && spillWrite > 0) {
+        remove(spillPath);
+        spillRead = spillWrite = 0;
+    }
+    head = (head + ramSent) % QUEUE_SLOTS;
+    count -= ramSent;
+    stats.published += sent;
+    return sent;
+}
+
+uint32_t MqttManager::update() {
+    if (!isEnabled() || !inputMutex) return IDLE_UPDATE_MS;
+    uint32_t now = millis();
+    collect(now);
+
+    if (!client.isConnected() && !connect(now)) {
+        // Offline: keep collecting (queue / spill), retry with backoff
+        uint32_t elapsed = now - lastAttemptMs;
+        return (connectWaitMs > elapsed) ? min(connectWaitMs - elapsed, (uint32_t)BATCH_MS) : 1000;
+    }
+
+    client.loop();
+    drain();
+    if (drainStartMs != 0 && getBacklog() == 0) {
+        stats.lastDrainMs = millis() - drainStartMs;
+        stats.lastDrainCount = drainStartCount;
+        drainStartMs = 0;
+    }
+    return getBacklog() > 0 ? 10 : IDLE_UPDATE_MS;
+}
@@ -0,0 +1,271 @@
+#include "PngEncoder.h"
+
+// CRC-32 (PNG chunk checksum), 4-bit table to keep flash usage small
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+// Deflate length/distance tables (RFC 1951, 3.2.5)
+static const uint16_t LEN_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                       257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                       8193, 12289, 16385, 24577};
+static const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                       7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static const uint16_t MIN_MATCH = 3;
+static const uint16_t MAX_MATCH = 258;
+static const uint32_t ADLER_MOD = 65521;
+
+PngEncoder::PngEncoder(const uint8_t* bitmap, uint16_t width, uint16_t height)
+    : bitmap(bitmap), width(width > MAX_WIDTH ? MAX_WIDTH : width), height(height) {
+    rowBytes = (this->width + 7) / 8;
+    stride = rowBytes + 1;
+    reset();
+}
+
+void PngEncoder::reset() {
+    stage = Stage::HEADER;
+    row = 0;
+    streamStarted = false;
+    segLen = 0;
+    segPos = 0;
+    chunkStart = 0;
+    bitBuf = 0;
+    bitCount = 0;
+    adlerA = 1;
+    adlerB = 0;
+}
+
+bool PngEncoder::available() {
+    if (segPos < segLen) return true;
+    if (stage == Stage::DONE) return false;
+    fill();
+    return segPos < segLen;
+}
+
+uint8_t PngEncoder::next() {
+    if (!available()) return 0;
+    return segment[segPos++];
+}
+
+size_t PngEncoder::read(uint8_t* dst, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen && available()) {
+        size_t chunk = segLen - segPos;
+        if (chunk > maxLen - n) chunk = maxLen - n;
+        for (size_t i = 0; i < chunk; i++) dst[n + i] = segment[segPos + i];
+        segPos += chunk;
+        n += chunk;
+    }
+    return n;
+}
+
+size_t PngEncoder::totalSize() {
+    reset();
+    size_t total = 0;
+    while (available()) {
+        total += segLen - segPos;
+        segPos = segLen;
+    }
+    reset();
+    return total;
+}
+
+// -------------------------------------------------------------------------
+// Chunk framing
+// -------------------------------------------------------------------------
+void PngEncoder::putU32(uint32_t v) {
+    putByte((uint8_t)(v >> 24));
+    putByte((uint8_t)(v >> 16));
+    putByte((uint8_t)(v >> 8));
+    putByte((uint8_t)v);
+}
+
+void PngEncoder::beginChunk(const char* type) {
+    chunkStart = segLen;
+    putU32(0); // Length placeholder (patched in endChunk)
+    for (int i = 0; i < 4; i++) putByte((uint8_t)type[i]);
+}
+
+void PngEncoder::endChunk() {
+    uint32_t dataLen = segLen - chunkStart - 8;
+    segment[chunkStart + 0] = (uint8_t)(dataLen >> 24);
+    segment[chunkStart + 1] = (uint8_t)(dataLen >> 16);
+    segment[chunkStart + 2] = (uint8_t)(dataLen >> 8);
+    segment[chunkStart + 3] = (uint8_t)dataLen;
+    putU32(crc32(segment + chunkStart + 4, dataLen + 4)); // CRC covers type + data
+}
+
+void PngEncoder::fill() {
+    segLen = 0;
+    segPos = 0;
+
+    switch (stage) {
+        case Stage::HEADER: {
+            static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+            for (int i = 0; i < 8; i++) putByte(SIGNATURE[i]);
+            beginChunk("IHDR");
+            putU32(width);
+            putU32(height);
+            putByte(1); // Bit depth
+            putByte(0); // Color type: grayscale
+            putByte(0); // Compression: deflate
+            putByte(0); // Filter method
+            putByte(0); // No interlace
+            endChunk();
+            stage = Stage::IDAT;
+            break;
+        }
+        case Stage::IDAT: {
+            beginChunk("IDAT");
+            if (!streamStarted) {
+                putByte(0x78); // zlib: deflate, 32K window
+                putByte(0x01); // zlib: no dict, fastest (FCHECK valid)
+                writeBits(1, 1); // BFINAL: single block for the whole image
+                writeBits(1, 2); // BTYPE: fixed Huffman
+                streamStarted = true;
+            }
+            // Worst case row: every byte a 9-bit literal, plus pending bits
+            const size_t worstRow = (stride * 9 + 7) / 8 + 1;
+            const size_t tail = 1 + 1 + 4 + 4; // EOB, pad, Adler-32, CRC
+            while (row < height && segLen + worstRow + tail <= SEGMENT_SIZE) {
+                encodeRow();
+            }
+
+            if (row >= height) {
+                writeHuff(0, 7); // End of block (symbol 256)
+                flushBits();
+                putU32((adlerB << 16) | adlerA);
+                stage = Stage::IEND;
+            }
+            endChunk();
+            break;
+        }
+        case Stage::IEND:
+            beginChunk("IEND");
+            endChunk();
+            stage = Stage::DONE;
+            break;
+        case Stage::DONE:
+            break;
+    }
+}
+
+// -------------------------------------------------------------------------
+// Deflate (fixed Huffman)
+// -------------------------------------------------------------------------
+void PngEncoder::writeBits(uint32_t value, uint8_t n) {
+    bitBuf |= value << bitCount;
+    bitCount += n;
+    while (bitCount >= 8) {
+        putByte((uint8_t)bitBuf);
+        bitBuf >>= 8;
+        bitCount -= 8;
+    }
+}
+
+void PngEncoder::writeHuff(uint16_t code, uint8_t len) {
+    // Huffman codes are packed starting with the most significant bit
+    uint16_t rev = 0;
+    for (uint8_t i = 0; i < len; i++) {
+        rev = (rev << 1) | (code & 1);
+        code >>= 1;
+    }
+    writeBits(rev, len);
+}
+
+void PngEncoder::writeLitLen(uint16_t sym) {
+    if (sym < 144) writeHuff(0x30 + sym, 8);
+    else if (sym < 256) writeHuff(0x190 + (sym - 144), 9);
+    else if (sym < 280) writeHuff(sym - 256, 7);
+    else writeHuff(0xC0 + (sym - 280), 8);
+}
+
+void PngEncoder::writeMatch(uint16_t len, uint16_t dist) {
+    int li = 28;
+    while (LEN_BASE[li] > len) li--;
+    writeLitLen(257 + li);
+    if (LEN_EXTRA[li]) writeBits(len - LEN_BASE[li], LEN_EXTRA[li]);
+
+    int di = 29;
+    while (DIST_BASE[di] > dist) di--;
+    writeHuff(di, 5);
+    if (DIST_EXTRA[di]) writeBits(dist - DIST_BASE[di], DIST_EXTRA[di]);
+}
+
+void PngEncoder::flushBits() {
+    if (bitCount > 0) {
+        putByte((uint8_t)bitBuf);
+        bitBuf = 0;
+        bitCount = 0;
+    }
+}
+
+// Byte of the filtered scanline stream. col 0 is the filter byte (None),
+// col -1 is the last byte of the previous row.
+uint8_t PngEncoder::streamByte(uint16_t r, int col) const {
+    if (col < 0) {
+        r--;
+        col = stride - 1;
+    }
+    if (col == 0) return 0;
+    return bitmap[(size_t)r * rowBytes + (col - 1)];
+}
+
+void PngEncoder::encodeRow() {
+    const uint16_t r = row;
+    int col = 0;
+    while (col < stride) {
+        uint16_t maxLen = stride - col;
+        if (maxLen > MAX_MATCH) maxLen = MAX_MATCH;
+
+        // Candidate 1: run of the previous byte (distance 1)
+        uint16_t runLen = 0;
+        if (r > 0 || col > 0) {
+            while (runLen < maxLen && streamByte(r, col + runLen) == streamByte(r, col + runLen - 1)) runLen++;
+        }
+        // Candidate 2: same bytes as the row above (distance = stride)
+        uint16_t upLen = 0;
+        if (r > 0) {
+            while (upLen < maxLen && streamByte(r, col + upLen) == streamByte(r - 1, col + upLen)) upLen++;
+        }
+
+        uint16_t len = runLen;
+        uint16_t dist = 1;
+        if (upLen > runLen) {
+            len = upLen;
+            dist = stride;
+        }
+
+        if (len >= MIN_MATCH) {
+            writeMatch(len, dist);
+        } else {
+            len = 1;
+            writeLitLen(streamByte(r, col));
+        }
+
+        for (uint16_t i = 0; i < len; i++) {
+            adlerA += streamByte(r, col + i);
+            if (adlerA >= ADLER_MOD) adlerA -= ADLER_MOD;
+            adlerB += adlerA;
+            if (adlerB >= ADLER_MOD) adlerB -= ADLER_MOD;
+        }
+        col += len;
+    }
+    row++;
+}
@@ -0,0 +1,204 @@
+#include "Scheduler.h"
+
+static const uint8_t LEVEL_DUE = 0xFF; // Detached into the dispatch batch
+
+static inline uint32_t ticksFor(uint32_t ms) {
+    uint32_t t = (ms + Scheduler::TICK_MS - 1) / Scheduler::TICK_MS;
+    return t == 0 ? 1 : t;
+}
+
+// Offset (1..64) from slot 'idx' to the next occupied slot after it
+static inline uint32_t nextOffset(uint64_t bits, uint32_t idx) {
+    uint32_t r = (idx + 1) & 63;
+    uint64_t rot = r ? (bits >> r) | (bits << (64 - r)) : bits;
+    return (uint32_t)__builtin_ctzll(rot) + 1;
+}
+
+Scheduler::Scheduler()
+    : jobCount(0), currentTick(0), tickBaseMs(0), started(false), dispatching(false), stats{0, 0, 0, 0} {
+    for (uint8_t l = 0; l < LEVELS; l++) {
+        occupied[l] = 0;
+        for (uint8_t s = 0; s < SLOTS; s++) wheel[l][s] = NONE;
+    }
+}
+
+int Scheduler::add(const char* name, JobFn fn, uint8_t priority) {
+    if (jobCount >= MAX_JOBS || !fn) return -1;
+    jobs[jobCount] = {name, fn, priority, false, NONE, 0, 0, 0, 0};
+    return (int)jobCount++;
+}
+
+void Scheduler::syncClock(uint32_t nowMs) {
+    if (started) return;
+    started = true;
+    tickBaseMs = nowMs;
+}
+
+void Scheduler::schedule(int id, uint32_t delayMs, uint32_t nowMs) {
+    if (id < 0 || (size_t)id >= jobCount) return;
+    syncClock(nowMs);
+    if (jobs[id].pending) unlink(id);
+
+    // Inside dispatch the wheel is exactly at nowMs; outside it may lag behind
+    uint32_t base = dispatching ? currentTick : currentTick + (nowMs - tickBaseMs) / TICK_MS;
+    jobs[id].expires = base + ticksFor(delayMs);
+    jobs[id].pending = true;
+    insert(id);
+}
+
+void Scheduler::cancel(int id) {
+    if (id < 0 || (size_t)id >= jobCount || !jobs[id].pending) return;
+    unlink(id);
+    jobs[id].pending = false;
+}
+
+bool Scheduler::isPending(int id) const {
+    return id >= 0 && (size_t)id < jobCount && jobs[id].pending;
+}
+
+void Scheduler::insert(int id) {
+    Job& j = jobs[id];
+    uint32_t delta = j.expires - currentTick;
+    uint32_t at = j.expires;
+
+    if (delta < (1UL << SLOT_BITS)) {
+        j.level = 0;
+    } else if (delta < (1UL << (2 * SLOT_BITS))) {
+        j.level = 1;
+    } else {
+        // Beyond the wheel range: park in the last level-2 slot, re-cascaded later
+        if (delta >= (1UL << (3 * SLOT_BITS))) at = currentTick + (1UL << (3 * SLOT_BITS)) - 1;
+        j.level = 2;
+    }
+    j.slot = (at >> (SLOT_BITS * j.level)) & (SLOTS - 1);
+    j.next = wheel[j.level][j.slot];
+    wheel[j.level][j.slot] = (int8_t)id;
+    occupied[j.level] |= 1ULL << j.slot;
+}
+
+void Scheduler::unlink(int id) {
+    Job& j = jobs[id];
+    if (j.level == LEVEL_DUE) return; // In the current batch: skipped via 'pending'
+
+    int8_t* link = &wheel[j.level][j.slot];
+    while (*link != NONE && *link != id) link = &jobs[*link].next;
+    if (*link == id) *link = j.next;
+    if (wheel[j.level][j.slot] == NONE) occupied[j.level] &= ~(1ULL << j.slot);
+}
+
+void Scheduler::cascade(uint8_t level) {
+    uint8_t slot = (currentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    int8_t id = wheel[level][slot];
+    wheel[level][slot] = NONE;
+    occupied[level] &= ~(1ULL << slot);
+    while (id != NONE) {
+        int8_t next = jobs[id].next;
+        stats.cascades++;
+        insert(id);
+        id = next;
+    }
+}
+
+int8_t Scheduler::collectDue() {
+    uint8_t slot = currentTick & (SLOTS - 1);
+    int8_t id = wheel[0][slot];
+    wheel[0][slot] = NONE;
+    occupied[0] &= ~(1ULL << slot);
+
+    // Re-link sorted by priority (descending, stable). Lists are tiny.
+    int8_t head = NONE;
+    while (id != NONE) {
+        int8_t next = jobs[id].next;
+        jobs[id].level = LEVEL_DUE;
+        int8_t* link = &head;
+        while (*link != NONE && jobs[*link].priority >= jobs[id].priority) link = &jobs[*link].next;
+        jobs[id].next = *link;
+        *link = id;
+        id = next;
+    }
+    return head;
+}
+
+uint32_t Scheduler::runDue(uint32_t nowMs) {
+    syncClock(nowMs);
+    stats.wakeups++;
+
+    uint32_t target = currentTick + (nowMs - tickBaseMs) / TICK_MS;
+    tickBaseMs += (target - currentTick) * TICK_MS;
+    uint32_t ran = 0;
+
+    dispatching = true;
+    while (currentTick != target) {
+        // Nothing in level 0: skip straight to the next cascade boundary
+        if (occupied[0] == 0) {
+            uint32_t boundary = (currentTick | (SLOTS - 1)) + 1;
+            if ((int32_t)(target - boundary) < 0) {
+                currentTick = target;
+                break;
+            }
+            currentTick = boundary - 1;
+        }
+
+        currentTick++;
+        if ((currentTick & (SLOTS - 1)) == 0) {
+            if (((currentTick >> SLOT_BITS) & (SLOTS - 1)) == 0) cascade(2);
+            cascade(1);
+        }
+
+        // Batch ids first: a job may reschedule or cancel others while running
+        int8_t batch[MAX_JOBS];
+        size_t n = 0;
+        for (int8_t id = collectDue(); id != NONE; id = jobs[id].next) batch[n++] = id;
+
+        for (size_t i = 0; i < n; i++) {
+            Job& j = jobs[batch[i]];
+            if (!j.pending || j.level != LEVEL_DUE) continue; // Cancelled or re-armed meanwhile
+            j.pending = false;
+            j.runs++;
+            ran++;
+            uint32_t delayMs = j.fn();
+            if (delayMs != STOP && !j.pending) {
+                j.expires = currentTick + ticksFor(delayMs);
+                j.pending = true;
+                insert(batch[i]);
+            }
+        }
+    }
+    dispatching = false;
+
+    stats.dispatched += ran;
+    if (ran == 0) stats.idleWakeups++;
+    return msUntilNext(nowMs);
+}
+
+uint32_t Scheduler::msUntilNext(uint32_t nowMs) const {
+    if ((occupied[0] | occupied[1] | occupied[2]) == 0) return NEVER;
+
+    // Earliest deadline: the first occupied slot of each level holds the
+    // level's earliest jobs. Higher levels are woken for the job itself, not
+    // for the cascade (runDue() cascades on the way), so a 1 s job does not
+    // cost an extra idle wake-up at every 640 ms boundary.
+    uint32_t best = NEVER;
+    for (uint8_t l = 0; l < LEVELS; l++) {
+        if (!occupied[l]) continue;
+        uint32_t shift = SLOT_BITS * l;
+        uint32_t idx = (currentTick >> shift) & (SLOTS - 1);
+        uint32_t slot = (idx + nextOffset(occupied[l], idx)) & (SLOTS - 1);
+        for (int8_t id = wheel[l][slot]; id != NONE; id = jobs[id].next) {
+            uint32_t ahead = jobs[id].expires - currentTick;
+            if (ahead < best) best = ahead;
+        }
+    }
+
+    uint32_t dueMs = best * TICK_MS;
+    uint32_t elapsed = started ? nowMs - tickBaseMs : 0;
+    return elapsed >= dueMs ? 0 : dueMs - elapsed;
+}
+
+const char* Scheduler::getName(int id) const {
+    return (id >= 0 && (size_t)id < jobCount) ? jobs[id].name : "";
+}
+
+uint32_t Scheduler::getRuns(int id) const {
+    return (id >= 0 && (size_t)id < jobCount) ? jobs[id].runs : 0;
+}
@@ -0,0 +1,125 @@
+#include "SensorHealth.h"
+#include <math.h>
+
+// EWMA weights: errors/implausible follow the last ~64 events, the repeat
+// rate the last ~256 samples so one quiet spell does not move it. Until
+// then the repeat rate is a running mean that starts from a cautious prior
+// (0.9, worth 10 samples): an unlearned rate must not give a short limit.
+static const float EVENT_ALPHA = 1.0f / 64;
+static const uint32_t REPEAT_WINDOW = 256;
+static const float REPEAT_PRIOR = 0.9f;
+static const uint32_t REPEAT_PRIOR_WEIGHT = 10;
+static const float STUCK_FALSE_RATE = 1e-9f;  // Small: p itself is an estimate
+static const float ERRORS_ON = 0.25f, ERRORS_OFF = 0.10f;
+static const float IMPLAUSIBLE_ON = 0.05f, IMPLAUSIBLE_OFF = 0.01f;
+
+SensorHealth::SensorHealth()
+    : stats(), prevT(0), prevH(0), prevMs(0), havePrev(false), errorsLatched(false), implausibleLatched(false) {
+    stats.repeatRate = REPEAT_PRIOR;
+    updateStuckLimit();
+}
+
+uint32_t SensorHealth::retryDelayMs(uint8_t attempt, uint32_t elapsedMs, uint32_t slotMs) {
+    if (attempt == 0 || attempt >= MAX_ATTEMPTS) return 0;
+    uint32_t wait = RETRY_BASE_MS << (attempt - 1);
+    if (elapsedMs + wait + MIN_GAP_MS > slotMs) return 0; // Would crowd the next slot
+    return wait;
+}
+
+SensorHealth::Failure SensorHealth::classify(uint32_t durationUs) {
+    return (durationUs >= FRAME_MIN_US && durationUs <= FRAME_MAX_US) ? Failure::CHECKSUM : Failure::TIMEOUT;
+}
+
+SensorHealth::Failure SensorHealth::onFailure(uint32_t durationUs) {
+    Failure f = classify(durationUs);
+    if (f == Failure::CHECKSUM) stats.checksums++;
+    else stats.timeouts++;
+    stats.errorRate += (1.0f - stats.errorRate) * EVENT_ALPHA;
+    return f;
+}
+
+void SensorHealth::onFrame(float t, float h, uint32_t durationUs, uint32_t nowMs) {
+    stats.frames++;
+    stats.lastReadUs = durationUs;
+    stats.totalReadUs += durationUs;
+    if (durationUs > stats.maxReadUs) stats.maxReadUs = durationUs;
+    stats.errorRate -= stats.errorRate * EVENT_ALPHA;
+
+    bool bad = t < -40.0f || t > 80.0f || h < 0.0f || h > 100.0f; // DHT22 range
+    if (havePrev) {
+        uint32_t dtMs = nowMs - prevMs;
+        float dt = (dtMs > 1000 ? dtMs : 1000) / 1000.0f; // Retries are >= 1 s apart
+        bad = bad || fabsf(t - prevT) > MAX_T_RATE * dt || fabsf(h - prevH) > MAX_H_RATE * dt;
+
+        bool same = t == prevT && h == prevH;
+        uint32_t prevRun = stats.stuckRun;
+        if (same) {
+            stats.stuckRun++;
+            if (stats.stuckRun == stats.stuckLimit) stats.stuckEvents++;
+        } else {
+            stats.stuckRun = 0;
+        }
+        // Learn the run continuation inside runs of 2+ repeats (long runs
+        // sit in the most likely 0.1 step, which repeats more often than
+        // the others), and only below STUCK_MIN_RUN: a stuck sensor must not
+        // teach that repeats are normal
+        if (prevRun >= 2 && prevRun < STUCK_MIN_RUN) {
+            uint32_t n = ++stats.repeatSamples + REPEAT_PRIOR_WEIGHT;
+            float alpha = 1.0f / (n < REPEAT_WINDOW ? n : REPEAT_WINDOW);
+            stats.repeatRate += ((same ? 1.0f : 0.0f) - stats.repeatRate) * alpha;
+            updateStuckLimit();
+        }
+    }
+    if (bad) stats.implausible++;
+    stats.implausibleRate += ((bad ? 1.0f : 0.0f) - stats.implausibleRate) * EVENT_ALPHA;
+
+    prevT = t;
+    prevH = h;
+    prevMs = nowMs;
+    havePrev = true;
+}
+
+void SensorHealth::endSlot(bool valid, uint8_t attempts) {
+    stats.slots++;
+    if (attempts > 1) stats.retries += attempts - 1;
+    if (valid) {
+        if (attempts > 1) stats.recovered++;
+        stats.lostStreak = 0;
+    } else {
+        stats.lost++;
+        if (stats.lostStreak < UINT16_MAX) stats.lostStreak++;
+    }
+    if (stats.errorRate >= ERRORS_ON) errorsLatched = true;
+    else if (stats.errorRate < ERRORS_OFF) errorsLatched = false;
+    if (stats.implausibleRate >= IMPLAUSIBLE_ON) implausibleLatched = true;
+    else if (stats.implausibleRate < IMPLAUSIBLE_OFF) implausibleLatched = false;
+}
+
+void SensorHealth::updateStuckLimit() {
+    float p = stats.repeatRate;
+    if (p < 0.01f) p = 0.01f;
+    if (p > 0.99f) p = 0.99f;
+    float n = ceilf(logf(STUCK_FALSE_RATE) / logf(p));
+    if (n < STUCK_MIN_RUN) n = STUCK_MIN_RUN;
+    if (n > STUCK_MAX_RUN) n = STUCK_MAX_RUN;
+    stats.stuckLimit = (uint32_t)n;
+}
+
+SensorHealth::Status SensorHealth::getStatus() const {
+    if (stats.lostStreak >= NO_READING_SLOTS) return Status::NO_READINGS;
+    if (stats.stuckRun >= stats.stuckLimit) return Status::STUCK;
+    if (implausibleLatched) return Status::IMPLAUSIBLE;
+    if (errorsLatched) return Status::ERRORS;
+    return Status::OK;
+}
+
+const char* SensorHealth::getName(Status s) {
+    switch (s) {
+        case Status::OK: return "ok";
+        case Status::ERRORS: return "errors";
+        case Status::IMPLAUSIBLE: return "implausible";
+        case Status::STUCK: return "stuck";
+        case Status::NO_READINGS: return "no_readings";
+    }
+    return "?";
+}
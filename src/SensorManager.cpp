@@ -1,20 +1,30 @@
 #include "SensorManager.h"
 #include "WeatherManager.h" 
+#include "MqttManager.h"
 #include "ClimateMath.h"
+#include "Trace.h"
+#include "Config.h"
+#include "HeapTags.h"
+#include "SensorHealth.h"
 
 SensorManager::SensorManager() 
-    : dht(DHTPIN, DHTTYPE), 
+    : dht(DHTPIN, DHTTYPE), weather(nullptr), mqtt(nullptr),
+      historyHead(0), historyCount(0), historySeq(0),
+      lockStats(LOCK_SITES, LOCK_SITE_COUNT),
       currentTemp(NAN), currentHum(NAN), currentDP(NAN), currentAbsHum(NAN), avg24h(NAN),
-      lastValidTemp(NAN), lastTempForWindowCheck(NAN), windowOpen(false), 
-      state(ClimateState::STABLE), stateEnterTime(0), weather(nullptr),
-      historyHead(0), historyCount(0), lastLogTime(0),
-      cachedAdvice("Загрузка..."), cachedCode(0), lastAdviceUpdate(0),
+      cachedAdvice{AdviceId::LOADING, 0, 0}, lastAdviceUpdate(0),
+      tempFilter(0.1f), humFilter(0.5f), // MAD floors: ~DHT22 resolution / noise
+      kalman(0.1f, 0.1f), lastReadingTime(0), // DHT22 noise: ~0.1 °C, ~0.5% RH (~0.1 g/m³)
+      surfaceTemp(NAN), surfaceHum(NAN),
       // FIX: Initialize all physics tracking variables to NAN
-      lastAbsHumForWindowCheck(NAN), stateEnterAbsHum(NAN), lastAbsHum(NAN), stateEnterHum(NAN),
+      lastTempForWindowCheck(NAN), lastAbsHumForWindowCheck(NAN), stateEnterAbsHum(NAN), lastAbsHum(NAN), stateEnterHum(NAN),
+      windowOpen(false),
       // Plateau v2.0 initialization
       slopeWindowHead(0), slopeWindowCount(0), plateauConfirmCounter(0), baselineUpdateCounter(0),
       // Improved Rebound Detection
-      reboundStartTime(0), reboundStartTemp(NAN), reboundDetected(false)
+      reboundStartTime(0), reboundStartTemp(NAN), reboundDetected(false),
+      state(ClimateState::STABLE), stateEnterTime(0), lastLogTime(0),
+      forecastCacheVersion(0)
 {
     dataMutex = xSemaphoreCreateMutex();
     // Initialize slope window to NAN
@@ -23,13 +33,30 @@ SensorManager::SensorManager()
     }
 }
 
-void SensorManager::lock() {
-    // Use timeout to prevent infinite deadlock (WebServer locking during slow network)
-    if(dataMutex) xSemaphoreTake(dataMutex, pdMS_TO_TICKS(500));
-}
+// dataMutex call sites. A timeout skips the caller's work (counted per site):
+// the sensor task loses one reading, the loop retries on its next pass, web
+// handlers answer with what they have. Keep timeouts well below the 6 s
+// reading slot and the async_tcp watchdog.
+const LockStats::SiteInfo SensorManager::LOCK_SITES[LOCK_SITE_COUNT] = {
+    {"sensor_task", 100},      // processReading()
+    {"update", 10},            // Loop: history logging + advice (retried next pass)
+    {"advice", 10},            // getAdvice(): display / web / Telegram
+    {"plan", 100},
+    {"history_snapshot", 200}, // getHistoryCopy(): whole ring
+    {"history_chunk", 100},    // copyHistory(): streaming
+    {"history_find", 100},
+    {"history_query", 100},
+    {"sessions", 100},
+    {"diag", 100},             // copyLockStats()
+};
 
-void SensorManager::unlock() {
-    if(dataMutex) xSemaphoreGive(dataMutex);
+size_t SensorManager::copyLockStats(LockStats::Site* destination, size_t maxCount) {
+    if (!destination) return 0;
+    ScopedLock lock(dataMutex, lockStats, LOCK_DIAG);
+    if (!lock) return 0;
+    size_t n = min(maxCount, lockStats.getSiteCount());
+    for (size_t i = 0; i < n; i++) destination[i] = lockStats.getSite(i);
+    return n;
 }
 
 // -------------------------------------------------------------------------
@@ -37,20 +64,58 @@ void SensorManager::unlock() {
 // -------------------------------------------------------------------------
 void SensorManager::sensorTask(void* parameter) {
     SensorManager* self = (SensorManager*)parameter;
-    const TickType_t intervalTicks = pdMS_TO_TICKS(6000);
+    const uint32_t slotMs = 6000;
+    const TickType_t intervalTicks = pdMS_TO_TICKS(slotMs);
     TickType_t lastWakeTime = xTaskGetTickCount();
+    HeapTags::setTaskTag(HeapTags::SENSOR); // Expected to stay at 0 bytes
     
     for(;;) {
-        // Read DHT (blocking, but isolated in this task)
-        float t = self->dht.readTemperature();
-        float h = self->dht.readHumidity();
+        // Read DHT (blocking, but isolated in this task). A failed frame is
+        // retried with backoff as long as the sensor still gets its rest
+        // before the next slot (see SensorHealth::retryDelayMs)
+        uint32_t slotStart = millis();
+        float t = NAN, h = NAN;
+        uint8_t attempts = 0;
+        for (;;) {
+            TRACE_BEGIN("dht_read");
+            uint32_t start = micros();
+            bool ok = self->dht.read(true); // Forced: the driver caches results for 2 s
+            if (ok) {
+                t = self->dht.readTemperature(); // From the frame just read
+                h = self->dht.readHumidity();
+            }
+            uint32_t us = micros() - start;
+            TRACE_END("dht_read");
+            attempts++;
+            if (ok && !isnan(t) && !isnan(h)) {
+                self->health.onFrame(t, h, us, millis());
+                break;
+            }
+            t = h = NAN;
+            SensorHealth::Failure f = self->health.onFailure(us);
+            uint32_t wait = SensorHealth::retryDelayMs(attempts, millis() - slotStart, slotMs);
+            Serial.printf("[DHT] Read failed (%s, %lu us), %s\n",
+                          f == SensorHealth::Failure::CHECKSUM ? "checksum" : "timeout", (unsigned long)us,
+                          wait ? "retrying" : "slot lost");
+            if (wait == 0) break;
+            vTaskDelay(pdMS_TO_TICKS(wait));
+        }
+        self->health.endSlot(!isnan(t), attempts);
 
         // Only process when both values are valid
         if (!isnan(t) && !isnan(h)) {
+            OutdoorSample outdoor = self->readOutdoor(); // Before dataMutex, never inside it
             // Acquire mutex just for the processing step – keep critical section short
-            if (xSemaphoreTake(self->dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                self->processReading(t, h);
-                xSemaphoreGive(self->dataMutex);
+            ScopedLock lock(self->dataMutex, self->lockStats, LOCK_SENSOR_TASK);
+            if (lock) {
+                TRACE_BEGIN("process_reading"); // = dataMutex hold time
+                self->processReading(t, h, outdoor);
+                TRACE_END("process_reading");
+            } else {
+                uint32_t heldUs;
+                int holder = self->lockStats.getHolder(heldUs);
+                Serial.printf("[LOCK] Reading dropped: dataMutex held by %s for %lu us\n",
+                              holder >= 0 ? LOCK_SITES[holder].name : "-", (unsigned long)heldUs);
             }
         }
         
@@ -92,7 +157,21 @@ void SensorManager::update() {
         logInterval = 30000; // 30 Seconds
     }
 
-    if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10))) {
+    // Weather has its own mutex: what advice and planning need from it is
+    // copied first, so the weather lock is never taken while holding dataMutex
+    const bool adviceDue = now - lastAdviceUpdate > 2000;
+    OutdoorSample outdoor = {NAN, NAN, NAN, false};
+    if (adviceDue) {
+        outdoor = readOutdoor();
+        // Weather is published by its own task: copy only when a new fetch landed
+        // (forecastCache is only touched by this loop task)
+        if (weather && weather->getForecastVersion() != forecastCacheVersion) {
+            forecastCacheVersion = weather->copyForecast(forecastCache);
+        }
+    }
+
+    ScopedLock lock(dataMutex, lockStats, LOCK_UPDATE);
+    if (lock) {
         // Check Trigger
         long el = now - lastLogTime;
         if (el >= logInterval) {
@@ -113,91 +192,118 @@ void SensorManager::update() {
         }
         
         // 2. Advice Caching Logic (Update every 2s or if forced)
-        if (now - lastAdviceUpdate > 2000) {
-            updateAdvice();
+        if (adviceDue) {
+            // Plan first: cheap no-op unless forecast or indoor conditions changed
+            if (weather) {
+                planner.update(forecastCache, forecastCacheVersion, time(NULL),
+                               currentTemp, currentAbsHum);
+            }
+            updateAdvice(outdoor);
             lastAdviceUpdate = now;
         }
-        
-        xSemaphoreGive(dataMutex);
     }
 }
 
 // -------------------------------------------------------------------------
 // OPTIMIZATION 2: Caching
 // -------------------------------------------------------------------------
-void SensorManager::updateAdvice() {
-    // Re-run the heavy string logic
-    String s;
-    int code = 0;
+void SensorManager::updateAdvice(const OutdoorSample& outdoor) {
+    // Pick the advice id (no strings built here - text is formatted on demand)
+    Config::Snapshot cfg;
+    AdviceId id;
     
     if (isnan(currentHum)) {
-        s = "Анализ...";
-        code = 0;
+        id = AdviceId::ANALYZING;
     } 
     else if (state == ClimateState::INEFFICIENT) {
-        s = "Эффективность упала. Закрыть.";
-        code = 2; // Red
+        id = AdviceId::INEFFICIENT; // Red
     }
     else if (state == ClimateState::TARGET_MET) {
-        s = "Цель (50%) достигнута! Можно закрыть.";
-        code = 3; // Green
+        id = AdviceId::TARGET_MET; // Green
     }
     else if (state == ClimateState::VENTILATING) {
         // Physics-based advice
-        s = "Сушка (Идет активное проветривание)";
-        code = 1; // Yellow
+        id = AdviceId::DRYING; // Yellow
     }
     else {
         // STABLE
-        float outTemp = (weather && weather->isDataValid()) ? weather->getOutdoorTemp() : 20.0;
+        float outTemp = outdoor.valid ? outdoor.temp : 20.0;
         
         // Winter
         if (outTemp < 10.0) {
-            float margin = currentTemp - currentDP;
-            if (margin < 3.0) { s = "КРИТИЧНО! ГРЕТЬ/ОСУШАТЬ"; code = 2; }
-            else if (currentHum > 55.0) { s = "Влажно [ЗАЛП 5 мин]"; code = 1; }
-            else { s = "Зимняя Норма"; code = 3; }
+            // Critical once mold has started on the cold walls; growth
+            // conditions alone (still reversible) call for airing
+            if (mold.getIndex() >= MOLD_ALERT_INDEX) id = AdviceId::WINTER_CRITICAL;
+            else if (currentHum > cfg->humWinterHigh || mold.isGrowing()) id = AdviceId::WINTER_HUMID;
+            else id = AdviceId::WINTER_NORMAL;
         }
         // Summer
         else if (outTemp > 18.0) {
-             if (weather && weather->isDataValid()) {
+             if (outdoor.valid) {
                 float inAbs = ClimateMath::calculateAbsHumidity(currentTemp, currentHum);
-                float outAbs = weather->getOutdoorAbsHum();
-                if (outAbs > inAbs) { s = "Влажно [НЕ ОТКРЫВАТЬ!]"; code = 3; } // Blue/Green
-                else if (currentHum > 60.0) { s = "Влажно [Проветрить]"; code = 1; } // Yellow
-                else { s = "Летняя Норма"; code = 3; }
+                float outAbs = outdoor.absHum;
+                if (outAbs > inAbs) id = AdviceId::SUMMER_KEEP_CLOSED; // Blue/Green
+                else if (currentHum > cfg->humHigh) id = AdviceId::HUMID_VENTILATE; // Yellow
+                else id = AdviceId::SUMMER_NORMAL;
              } else {
-                 if (currentHum > 60.0) { s = "Влажно [Проветрить]"; code = 1; }
-                 else { s = "Летняя Норма"; code = 3; }
+                 if (currentHum > cfg->humHigh) id = AdviceId::HUMID_VENTILATE;
+                 else id = AdviceId::SUMMER_NORMAL;
              }
         }
         // Transition
         else {
-            if ((currentTemp - currentDP) < 2.5) { s = "КРИТИЧНО! Открыть окно"; code = 2; }
-            else if (currentHum > 60.0) { s = "Влажно [Реком. проветрить]"; code = 1; }
-            else if (currentHum < 35.0) { s = "Сухой воздух [Увлажнить]"; code = 3; }
-            else { s = "Норма (Стены сохнут)"; code = 3; }
+            if (mold.getIndex() >= MOLD_ALERT_INDEX) id = AdviceId::CRITICAL_OPEN;
+            else if (currentHum > cfg->humHigh || mold.isGrowing()) id = AdviceId::HUMID_RECOMMEND;
+            else if (currentHum < cfg->humLow) id = AdviceId::DRY_AIR;
+            else id = AdviceId::NORMAL;
         }
     }
     
-    cachedAdvice = s;
-    cachedCode = code;
+    AdviceState a = {id, 0, 0};
+
+    // Forecast plan hint (only when airing is advised in STABLE)
+    int best = planner.getBestIndex();
+    if (state == ClimateState::STABLE && Advice::code(id) == 1 && best >= 0) {
+        const VentSlot& slot = planner.getSlot(best);
+        a.hintMinutes = slot.durationMin;
+        a.hintStartTs = (slot.startTs <= (uint32_t)time(NULL) + 600) ? 0 : slot.startTs;
+    }
+    
+    cachedAdvice = a;
+}
+
+AdviceState SensorManager::getAdvice() {
+    AdviceState copy = {AdviceId::LOADING, 0, 0};
+    ScopedLock lock(dataMutex, lockStats, LOCK_ADVICE);
+    if (lock) copy = cachedAdvice;
+    return copy;
+}
+
+size_t SensorManager::getRecommendation(char* buffer, size_t len, Lang lang) {
+    // Copy the small struct under the mutex, format outside of it
+    return Advice::format(getAdvice(), lang, buffer, len);
 }
 
-String SensorManager::getRecommendation() {
-    // Return cached value (Thread safe read technically requires mutex but String copy is atomic enough for display)
-    // For strict correctness we take mutex for string copy
-    String copy;
-    if(xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10))) {
-        copy = cachedAdvice;
-        xSemaphoreGive(dataMutex);
+size_t SensorManager::getPlan(VentSlot* destination, size_t maxCount, int& bestIndex) {
+    size_t n = 0;
+    bestIndex = -1;
+    if (!destination) return 0;
+    ScopedLock lock(dataMutex, lockStats, LOCK_PLAN);
+    if (lock) {
+        n = min(maxCount, planner.getSlotCount());
+        for (size_t i = 0; i < n; i++) destination[i] = planner.getSlot(i);
+        if (planner.getBestIndex() < (int)n) bestIndex = planner.getBestIndex();
     }
-    return copy; 
+    return n;
 }
 
+uint32_t SensorManager::getPlanTime() const { return planner.getPlanTime(); }
+uint32_t SensorManager::getPlanRecomputeCount() const { return planner.getRecomputeCount(); }
+uint32_t SensorManager::getPlanMicros() const { return planner.getLastPlanMicros(); }
+
 int SensorManager::getAdviceCode() {
-    // Integer read is atomic on ESP32
-    return cachedCode;
+    // Single byte read is atomic on ESP32
+    return Advice::code(cachedAdvice.id);
 }
 
 // -------------------------------------------------------------------------
@@ -211,8 +317,22 @@ void SensorManager::addHistoryPoint(float t, float h) {
     if(isnan(avg24h)) avg24h = h;
     else avg24h = (avg24h * 0.99f) + (h * 0.01f);
 
-    Record r = {(uint32_t)now, t, h};
-    
+    appendHistory({(uint32_t)now, t, h});
+}
+
+void SensorManager::appendHistory(const Record& r) {
+    // Block summary: a new block starts every 32 records (its slot held a block
+    // that has left the ring completely)
+    uint32_t seq = historySeq++;
+    HistoryBlock& block = historyBlocks[(seq / HISTORY_BLOCK) % HISTORY_BLOCKS];
+    if (seq % HISTORY_BLOCK == 0) {
+        block = HistoryBlock();
+        block.firstTs = r.ts;
+    }
+    block.lastTs = r.ts;
+    block.t.add(r.t);
+    block.h.add(r.h);
+
     // Ring Buffer Write
     history[historyHead] = r;
     historyHead = (historyHead + 1) % HISTORY_SIZE;
@@ -222,7 +342,8 @@ void SensorManager::addHistoryPoint(float t, float h) {
 size_t SensorManager::getHistoryCount() const { return historyCount; }
 
 void SensorManager::getHistoryCopy(std::vector<Record>& target) {
-    if(xSemaphoreTake(dataMutex, pdMS_TO_TICKS(200))) {
+    ScopedLock lock(dataMutex, lockStats, LOCK_HISTORY_SNAPSHOT);
+    if (lock) {
         target.clear();
         target.reserve(historyCount);
         
@@ -245,7 +366,6 @@ void SensorManager::getHistoryCopy(std::vector<Record>& target) {
                  target.push_back(history[i]);
              }
         }
-        xSemaphoreGive(dataMutex);
     }
 }
 
@@ -254,7 +374,9 @@ size_t SensorManager::copyHistory(size_t offset, size_t count, Record* destinati
     
     size_t actualCopied = 0;
 
-    if(xSemaphoreTake(dataMutex, pdMS_TO_TICKS(100))) { // Short timeout for chunk access
+    ScopedLock lock(dataMutex, lockStats, LOCK_HISTORY_CHUNK);
+    if (lock) {
+        TRACE_SCOPE("history_copy");
         // Calculate safe count
         size_t available = historyCount - offset;
         size_t toCopy = (count < available) ? count : available;
@@ -283,11 +405,63 @@ size_t SensorManager::copyHistory(size_t offset, size_t count, Record* destinati
         }
         
         actualCopied = toCopy;
-        xSemaphoreGive(dataMutex);
     }
     return actualCopied;
 }
 
+size_t SensorManager::historyUpperBound(uint32_t ts) const {
+    size_t lo = 0;
+    size_t hi = historyCount;
+    size_t oldest = (historyCount < HISTORY_SIZE) ? 0 : historyHead;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (history[(oldest + mid) % HISTORY_SIZE].ts <= ts) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t SensorManager::findHistoryOffset(uint32_t since) {
+    size_t offset = 0;
+    ScopedLock lock(dataMutex, lockStats, LOCK_HISTORY_FIND);
+    if (lock) offset = historyUpperBound(since);
+    return offset;
+}
+
+bool SensorManager::queryHistory(uint32_t from, uint32_t to, HistoryStats& t, HistoryStats& h) {
+    t = HistoryStats();
+    h = HistoryStats();
+    if (from > to) return true;
+    ScopedLock lock(dataMutex, lockStats, LOCK_HISTORY_QUERY);
+    if (!lock) return false;
+
+    // Matching records as insertion numbers [seq, end)
+    uint32_t oldestSeq = historySeq - historyCount;
+    size_t oldestSlot = (historyCount < HISTORY_SIZE) ? 0 : historyHead;
+    uint32_t seq = oldestSeq + (from > 0 ? historyUpperBound(from - 1) : 0);
+    uint32_t end = oldestSeq + historyUpperBound(to);
+    while (seq < end) {
+        uint32_t blockStart = seq - seq % HISTORY_BLOCK;
+        uint32_t blockEnd = blockStart + HISTORY_BLOCK;
+        if (seq == blockStart && blockEnd <= end) {
+            // Whole block in range (and in the ring: seq >= oldestSeq)
+            const HistoryBlock& block = historyBlocks[(seq / HISTORY_BLOCK) % HISTORY_BLOCKS];
+            t.merge(block.t);
+            h.merge(block.h);
+            seq = blockEnd;
+            continue;
+        }
+        // Edge block: scan the records inside the range
+        uint32_t stop = blockEnd < end ? blockEnd : end;
+        for (; seq < stop; seq++) {
+            const Record& r = history[(oldestSlot + (seq - oldestSeq)) % HISTORY_SIZE];
+            t.add(r.t);
+            h.add(r.h);
+        }
+    }
+    return true;
+}
+
 Record SensorManager::getHistoryPoint(size_t index) const {
     // Note: This method is inherently unsafe if called while writing happens
     // Prefer getHistoryCopy() for bulk access
@@ -313,27 +487,43 @@ Record SensorManager::getHistoryPoint(size_t index) const {
     return history[actualIndex];
 }
 
-void SensorManager::processReading(float rawT, float rawH) {
-    float t = rawT + TEMP_OFFSET;
-    float h = constrain(rawH + HUM_OFFSET, 0.0f, 100.0f); // FIX: Prevent impossible humidity values
+void SensorManager::processReading(float rawT, float rawH, const OutdoorSample& outdoor) {
+    Config::Snapshot cfg; // Lock-free read of the active thresholds for this reading
+    const ClimateState prevState = state;
+    SessionExit dryingExit = SessionExit::NONE; // Set by the transitions below for the journal
+    SessionExit sessionExit = SessionExit::REBOUND;
+    float t = rawT + cfg->tempOffset;
+    float h = constrain(rawH + cfg->humOffset, 0.0f, 100.0f); // FIX: Prevent impossible humidity values
 
-    // Filter
-    if (!isnan(lastValidTemp) && abs(t - lastValidTemp) > MAX_TEMP_JUMP) {
-         t = lastValidTemp; 
-    } else {
-         if (!isnan(lastValidTemp)) t = (lastValidTemp * 0.8f) + (t * 0.2f);
-         else lastValidTemp = t;
-    }
-    lastValidTemp = t; 
-    
-    currentTemp = t;
-    currentHum = h;
-    // PHYSICS ENGINE UPDATE: Absolute Humidity
-    currentAbsHum = ClimateMath::calculateAbsHumidity(currentTemp, currentHum);
+    // Outlier stage: one bad DHT frame must not fake a 3% drop and start a session
+    t = tempFilter.update(t, cfg->hampelWindow, cfg->hampelK);
+    h = humFilter.update(h, cfg->hampelWindow, cfg->hampelK);
+
+    // State estimate: Kalman over [T, AH, dT/dt, dAH/dt]. Process noise follows the
+    // climate state (quiet at rest, agile while airing); jumps > maxTempJump are not measured.
+    unsigned long now = millis();
+    float dtMin = (now - lastReadingTime) / 60000.0f;
+    if (kalman.isReady() && dtMin > 5.0f) kalman.reset(); // Sensor gap: restart from this reading
+    float moldHours = lastReadingTime ? min(dtMin, 60.0f) / 60.0f : 0.0f; // Long gaps count as 1 h
+    bool tValid = !kalman.isReady() || abs(t - kalman.getTemp()) <= cfg->maxTempJump;
+    if (!tValid) t = kalman.getTemp();
+    float q = (state == ClimateState::STABLE) ? cfg->kalmanQRest : cfg->kalmanQActive;
+    kalman.update(t, ClimateMath::calculateAbsHumidity(t, h), dtMin, q, cfg->kalmanGate, tValid);
+    lastReadingTime = now;
+
+    currentTemp = kalman.getTemp();
+    // PHYSICS ENGINE UPDATE: Absolute Humidity (estimated), RH derived from it
+    currentAbsHum = kalman.getAbsHum();
+    currentHum = constrain(ClimateMath::calculateRelHumidity(currentTemp, currentAbsHum), 0.0f, 100.0f);
     currentDP = ClimateMath::calculateDewPoint(currentTemp, currentHum);
+
+    // Mold index: the room's water content at the temperature of the coldest wall spot
+    const float outTemp = outdoor.valid ? outdoor.temp : NAN;
+    surfaceTemp = MoldIndex::surfaceTemp(currentTemp, outTemp, MOLD_FRSI);
+    surfaceHum = min(ClimateMath::calculateRelHumidity(surfaceTemp, currentAbsHum), 100.0f);
+    mold.update(surfaceTemp, surfaceHum, moldHours);
     
     // --- SMART STATE MACHINE v5.2 ---
-    unsigned long now = millis();
     
     // Helper: Update slope window (called only during VENTILATING logging)
     // We'll use this for Plateau v2.0 detection
@@ -356,10 +546,12 @@ void SensorManager::processReading(float rawT, float rawH) {
             unsigned long timeSinceStable = now - stateEnterTime;
             bool lockoutActive = (timeSinceStable < 60000); // 60 sec lockout
             
-            bool rapidHumDrop = (last.h - currentHum) > 3.0; // -3% Trigger
-            bool rapidTempDrop = (!isnan(lastTempForWindowCheck) && (lastTempForWindowCheck - currentTemp) > 0.5);
+            bool rapidHumDrop = (last.h - currentHum) > cfg->ventHumDrop; // -3% Trigger
+            bool rapidTempDrop = (!isnan(lastTempForWindowCheck) && (lastTempForWindowCheck - currentTemp) > cfg->ventTempDrop);
+            // Trend: water leaving the room faster than any indoor process removes it
+            bool rapidAbsHumFall = (cfg->ventAbsHumRate > 0 && kalman.getAbsHumRate() < -cfg->ventAbsHumRate);
 
-            if ((rapidHumDrop || rapidTempDrop) && !lockoutActive) {
+            if ((rapidHumDrop || rapidTempDrop || rapidAbsHumFall) && !lockoutActive) {
                 state = ClimateState::VENTILATING;
                 stateEnterTime = now;
                 stateEnterAbsHum = currentAbsHum;
@@ -398,7 +590,7 @@ void SensorManager::processReading(float rawT, float rawH) {
         
         // --- A. SUCCESS CONDITION (Highest Priority) ---
         // Adaptive target: max(50%, startHum - 15%)
-        float targetHum = max(50.0f, stateEnterHum - 15.0f);
+        float targetHum = max(cfg->targetFloor, stateEnterHum - cfg->targetDrop);
         
         if (currentHum <= targetHum) {
             state = ClimateState::TARGET_MET;
@@ -407,6 +599,7 @@ void SensorManager::processReading(float rawT, float rawH) {
             lastAbsHumForWindowCheck = currentAbsHum;
             reboundDetected = false;
             reboundStartTemp = NAN;
+            dryingExit = SessionExit::TARGET_MET;
             Serial.printf("[STATE] VENTILATING -> TARGET_MET (%.1f%% <= %.1f%%)\n", currentHum, targetHum);
         }
         
@@ -426,10 +619,10 @@ void SensorManager::processReading(float rawT, float rawH) {
                 
                 // If slope > -0.15 g/m³ over 3 min → very slow drying (< 0.05 g/m³/min)
                 // This is our PLATEAU_THRESHOLD
-                if (slope > -0.15f) {
+                if (slope > -cfg->plateauSlope) {
                     plateauConfirmCounter++;
                     // Need 15 consecutive readings (~90 sec at 6s interval) to confirm
-                    if (plateauConfirmCounter >= 15) {
+                    if (plateauConfirmCounter >= cfg->plateauReadings) {
                         // Additional check: Did we achieve at least 10% drop from start?
                         float dropPercent = ((stateEnterAbsHum - currentAbsHum) / stateEnterAbsHum) * 100.0f;
                         
@@ -439,6 +632,7 @@ void SensorManager::processReading(float rawT, float rawH) {
                         lastAbsHumForWindowCheck = currentAbsHum;
                         reboundDetected = false;
                         reboundStartTemp = NAN;
+                        dryingExit = SessionExit::PLATEAU;
                         Serial.printf("[STATE] VENTILATING -> INEFFICIENT (slope=%.3f, drop=%.1f%%)\n", slope, dropPercent);
                     }
                 } else {
@@ -455,7 +649,7 @@ void SensorManager::processReading(float rawT, float rawH) {
             unsigned long reboundDur = now - reboundStartTime;
             
             // If temp rose by +0.15°C over 2 minutes → window is closed
-            if (tempRise > 0.15f && reboundDur > 120000) {
+            if (tempRise > cfg->reboundTempRise && reboundDur > 120000) {
                 state = ClimateState::STABLE;
                 stateEnterTime = now;
                 lastTempForWindowCheck = currentTemp;
@@ -477,7 +671,7 @@ void SensorManager::processReading(float rawT, float rawH) {
         }
         
         // Fallback: Old absolute threshold (faster for obvious window close)
-        if (currentAbsHum - lastAbsHumForWindowCheck > 0.3f) {
+        if (currentAbsHum - lastAbsHumForWindowCheck > cfg->reboundAbsHum) {
             state = ClimateState::STABLE;
             stateEnterTime = now;
             lastTempForWindowCheck = currentTemp;
@@ -495,7 +689,7 @@ void SensorManager::processReading(float rawT, float rawH) {
             float tempRise = currentTemp - reboundStartTemp;
             unsigned long reboundDur = now - reboundStartTime;
             
-            if (tempRise > 0.15f && reboundDur > 120000) {
+            if (tempRise > cfg->reboundTempRise && reboundDur > 120000) {
                 state = ClimateState::STABLE;
                 stateEnterTime = now; // For lockout
                 // FIX: Update baseline to prevent false re-detection
@@ -514,7 +708,7 @@ void SensorManager::processReading(float rawT, float rawH) {
             }
         }
         
-        if (currentAbsHum - lastAbsHumForWindowCheck > 0.3f) {
+        if (currentAbsHum - lastAbsHumForWindowCheck > cfg->reboundAbsHum) {
             state = ClimateState::STABLE;
             stateEnterTime = now;
             lastTempForWindowCheck = currentTemp;
@@ -527,6 +721,7 @@ void SensorManager::processReading(float rawT, float rawH) {
             stateEnterTime = now;
             lastTempForWindowCheck = currentTemp;
             lastAbsHumForWindowCheck = currentAbsHum;
+            sessionExit = SessionExit::TIMEOUT;
             Serial.println("[STATE] TARGET_MET -> STABLE (Timeout 1h)");
         }
     }
@@ -540,7 +735,7 @@ void SensorManager::processReading(float rawT, float rawH) {
             float tempRise = currentTemp - reboundStartTemp;
             unsigned long reboundDur = now - reboundStartTime;
             
-            if (tempRise > 0.15f && reboundDur > 120000) {
+            if (tempRise > cfg->reboundTempRise && reboundDur > 120000) {
                 state = ClimateState::STABLE;
                 stateEnterTime = now;
                 lastTempForWindowCheck = currentTemp;
@@ -557,7 +752,7 @@ void SensorManager::processReading(float rawT, float rawH) {
             }
         }
         
-        if (currentAbsHum - lastAbsHumForWindowCheck > 0.3f) {
+        if (currentAbsHum - lastAbsHumForWindowCheck > cfg->reboundAbsHum) {
             state = ClimateState::STABLE;
             stateEnterTime = now;
             lastTempForWindowCheck = currentTemp;
@@ -571,12 +766,33 @@ void SensorManager::processReading(float rawT, float rawH) {
             stateEnterTime = now;
             lastTempForWindowCheck = currentTemp;
             lastAbsHumForWindowCheck = currentAbsHum;
+            sessionExit = SessionExit::TIMEOUT;
             Serial.println("[STATE] INEFFICIENT -> STABLE (Timeout 1h)");
         }
     }
     
+    // Session journal: follows the transitions made above
+    if (prevState == ClimateState::STABLE && state != ClimateState::STABLE) {
+        journal.open((uint32_t)time(NULL), now, currentTemp, currentHum, currentAbsHum,
+                     outTemp, outdoor.valid ? outdoor.absHum : NAN);
+    }
+    if (dryingExit != SessionExit::NONE) journal.dryingEnded(now, dryingExit, currentAbsHum);
+    journal.reading(currentTemp, currentHum, currentAbsHum, kalman.getAbsHumRate());
+    if (prevState != ClimateState::STABLE && state == ClimateState::STABLE) {
+        journal.close(now, sessionExit, currentHum, currentAbsHum);
+        VentSession s = journal.current(now);
+        Serial.printf("[SESSION] %lu min, -%.2f g/m3, %s/%s\n", (unsigned long)(s.durationSec / 60),
+                      s.removed(), sessionExitName(s.dryingExit), sessionExitName(s.exit));
+    }
+
     // Physics Tracking Update
     lastAbsHum = currentAbsHum;
+
+    // Publisher input (queued, sent from the main loop)
+    if (mqtt) {
+        mqtt->onReading(currentTemp, currentHum, currentAbsHum, (int)state);
+        if (state != prevState) mqtt->onStateChange((int)prevState, (int)state);
+    }
 }
 
 // DEPRECATED: Physics logic moved inside processReading
@@ -601,14 +817,67 @@ String SensorManager::getStateString() const {
 SensorManager::ClimateState SensorManager::getClimateState() const { return state; }
 int SensorManager::getStateCode() const { return (int)state; }
 unsigned long SensorManager::getStateEnterTime() const { return stateEnterTime; }
+float SensorManager::getStateEnterAbsHum() const { return stateEnterAbsHum; }
 
 void SensorManager::setWeatherManager(WeatherManager* wm) {
     this->weather = wm;
 }
 
-float SensorManager::getOutdoorTemp() const { return (weather && weather->isDataValid()) ? weather->getOutdoorTemp() : NAN; }
-float SensorManager::getOutdoorHum() const { return (weather && weather->isDataValid()) ? weather->getOutdoorHum() : NAN; }
-float SensorManager::getOutdoorAbsHum() const { return (weather && weather->isDataValid()) ? weather->getOutdoorAbsHum() : NAN; }
+void SensorManager::setMqttManager(MqttManager* mm) {
+    this->mqtt = mm;
+}
+
+OutdoorSample SensorManager::readOutdoor() const {
+    if (!weather) return {NAN, NAN, NAN, false};
+    return weather->sample();
+}
+
+float SensorManager::getOutdoorTemp() const { OutdoorSample o = readOutdoor(); return o.valid ? o.temp : NAN; }
+float SensorManager::getOutdoorHum() const { OutdoorSample o = readOutdoor(); return o.valid ? o.hum : NAN; }
+float SensorManager::getOutdoorAbsHum() const { OutdoorSample o = readOutdoor(); return o.valid ? o.absHum : NAN; }
 float SensorManager::getIndoorAbsHum() const { return ClimateMath::calculateAbsHumidity(currentTemp, currentHum); }
 bool SensorManager::isWeatherValid() const { return (weather && weather->isDataValid()); }
-String SensorManager::getWeatherStatus() const { return weather ? weather->getStatusString() : "No Manager"; }
+HampelFilter::Stats SensorManager::getTempFilterStats() const { return tempFilter.getStats(); }
+HampelFilter::Stats SensorManager::getHumFilterStats() const { return humFilter.getStats(); }
+float SensorManager::getTempRate() const { return kalman.isReady() ? kalman.getTempRate() : NAN; }
+float SensorManager::getAbsHumRate() const { return kalman.isReady() ? kalman.getAbsHumRate() : NAN; }
+ClimateKalman::Stats SensorManager::getKalmanStats() const { return kalman.getStats(); }
+SensorHealth::Stats SensorManager::getSensorHealthStats() const { return health.getStats(); }
+SensorHealth::Status SensorManager::getSensorHealth() const { return health.getStatus(); }
+size_t SensorManager::copySessions(size_t offset, size_t count, VentSession* destination) {
+    if (!destination) return 0;
+    ScopedLock lock(dataMutex, lockStats, LOCK_SESSIONS);
+    if (!lock) return 0;
+    return journal.copy(offset, count, destination);
+}
+
+size_t SensorManager::getSessionCount() const { return journal.count(); }
+
+bool SensorManager::getOpenSession(VentSession& target) {
+    ScopedLock lock(dataMutex, lockStats, LOCK_SESSIONS);
+    if (!lock || !journal.isOpen()) return false;
+    target = journal.current(millis());
+    return true;
+}
+
+bool SensorManager::getSessionSummary(uint32_t since, SessionJournal::Summary& target) {
+    ScopedLock lock(dataMutex, lockStats, LOCK_SESSIONS);
+    if (!lock) return false;
+    target = journal.summarize(since);
+    return true;
+}
+
+uint32_t SensorManager::getSessionsClosed() const { return journal.getClosedCount(); }
+void SensorManager::restoreSessions(const VentSession* source, size_t count) { journal.restore(source, count); }
+
+float SensorManager::getMoldIndex() const { return mold.getIndex(); }
+float SensorManager::getMoldRate() const { return mold.getRate(); }
+bool SensorManager::isMoldGrowing() const { return mold.isGrowing(); }
+float SensorManager::getSurfaceTemp() const { return surfaceTemp; }
+float SensorManager::getSurfaceHum() const { return surfaceHum; }
+MoldIndex::State SensorManager::getMoldState() const { return mold.getState(); }
+void SensorManager::restoreMold(const MoldIndex::State& s) { mold.restore(s); }
+size_t SensorManager::getWeatherStatus(char* buffer, size_t len) const {
+    if (weather) return weather->getStatus(buffer, len);
+    return strlcpy(buffer, "No Manager", len);
+}
@@ -0,0 +1,313 @@
+#include "SeriesFile.h"
+#include "ClimateMath.h"
+#include <string.h>
+#if !defined(ESP32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SeriesFormat;
+
+// Nibble-table CRC-32 (IEEE, reflected): 64 bytes of table instead of 1 KB
+uint32_t SeriesFormat::crc32(const void* data, size_t len, uint32_t crc) {
+    static const uint32_t TABLE[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0f];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0f];
+    }
+    return ~crc;
+}
+
+// -------------------------------------------------------------------------
+// Writer
+// -------------------------------------------------------------------------
+SeriesWriter::SeriesWriter(uint8_t columns, uint32_t created)
+    : state(BUILDING), headerSent(false), finished(false), records(0), dropped(0), lastTs(0), outPos(0) {
+    columns &= 0x0f;
+    valueCount = countValues(columns);
+    capacity = blockCapacity(columns);
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    fileHeader.magic = FILE_MAGIC;
+    fileHeader.version = VERSION;
+    fileHeader.headerBytes = HEADER_BYTES;
+    fileHeader.blockBytes = BLOCK_BYTES;
+    fileHeader.blockRecords = capacity;
+    fileHeader.columns = columns;
+    fileHeader.valueCount = valueCount;
+    fileHeader.created = created;
+    memset(&footer, 0, sizeof(footer));
+    startBlock();
+}
+
+void SeriesWriter::startBlock() {
+    memset(block, 0, sizeof(block));
+    BlockHeader& h = header();
+    h.magic = BLOCK_MAGIC;
+    h.index = (uint32_t)index.size();
+    for (size_t s = 0; s < MAX_VALUES; s++) h.min[s] = h.max[s] = NAN;
+    state = BUILDING;
+}
+
+void SeriesWriter::sealBlock() {
+    BlockHeader& h = header();
+    h.crc = crc32(block + sizeof(BlockHeader), BLOCK_BYTES - sizeof(BlockHeader));
+    index.push_back({h.tsFirst, h.tsLast});
+    state = BLOCK;
+}
+
+bool SeriesWriter::append(uint32_t ts, float t, float h) {
+    if (finished || state != BUILDING) return false;
+    if (ts < lastTs) {
+        dropped++;
+        return true;
+    }
+    BlockHeader& bh = header();
+    size_t i = bh.count;
+    ((uint32_t*)(block + sizeof(BlockHeader)))[i] = ts;
+    float values[MAX_VALUES];
+    size_t n = 0;
+    uint8_t columns = fileHeader.columns;
+    if (columns & COL_T) values[n++] = t;
+    if (columns & COL_H) values[n++] = h;
+    if (columns & COL_DP) values[n++] = ClimateMath::calculateDewPoint(t, h);
+    if (columns & COL_AH) values[n++] = ClimateMath::calculateAbsHumidity(t, h);
+    for (size_t s = 0; s < n; s++) {
+        float v = values[s];
+        column(s)[i] = v;
+        if (isnan(v)) continue;
+        if (isnan(bh.min[s]) || v < bh.min[s]) bh.min[s] = v;
+        if (isnan(bh.max[s]) || v > bh.max[s]) bh.max[s] = v;
+    }
+    if (i == 0) bh.tsFirst = ts;
+    bh.tsLast = ts;
+    bh.count++;
+    lastTs = ts;
+    records++;
+    if (bh.count == capacity) sealBlock();
+    return true;
+}
+
+void SeriesWriter::finish() {
+    if (finished) return;
+    finished = true;
+    if (state == BUILDING) {
+        if (header().count > 0) sealBlock();
+        else state = INDEX;
+    }
+    footer.magic = FOOTER_MAGIC;
+    footer.blockCount = (uint32_t)index.size();
+    footer.recordCount = records;
+    footer.indexCrc = crc32(index.data(), index.size() * sizeof(IndexEntry));
+    footer.tsFirst = index.empty() ? 0 : index.front().tsFirst;
+    footer.tsLast = index.empty() ? 0 : index.back().tsLast;
+    footer.magic2 = FOOTER_MAGIC;
+}
+
+// Current output part is completely read: move to the next one
+void SeriesWriter::nextPart() {
+    outPos = 0;
+    if (!headerSent) {
+        headerSent = true;
+        return;
+    }
+    switch (state) {
+        case BLOCK:
+            if (finished) state = INDEX;
+            else startBlock();
+            break;
+        case INDEX:
+            state = FOOTER;
+            break;
+        case FOOTER:
+            state = DONE;
+            break;
+        default:
+            break;
+    }
+}
+
+size_t SeriesWriter::read(uint8_t* out, size_t maxLen) {
+    size_t used = 0;
+    while (used < maxLen) {
+        const uint8_t* src;
+        size_t srcLen;
+        if (!headerSent) {
+            src = (const uint8_t*)&fileHeader;
+            srcLen = sizeof(fileHeader);
+        } else if (state == BLOCK) {
+            src = block;
+            srcLen = BLOCK_BYTES;
+        } else if (state == INDEX) {
+            src = (const uint8_t*)index.data();
+            srcLen = index.size() * sizeof(IndexEntry);
+        } else if (state == FOOTER) {
+            src = (const uint8_t*)&footer;
+            srcLen = sizeof(footer);
+        } else {
+            break; // Building (needs records or finish()) or done
+        }
+        size_t n = srcLen - outPos;
+        if (n > maxLen - used) n = maxLen - used;
+        memcpy(out + used, src + outPos, n);
+        used += n;
+        outPos += n;
+        if (outPos == srcLen) nextPart();
+    }
+    return used;
+}
+
+bool SeriesWriter::writeTo(FILE* f) {
+    uint8_t buf[1024];
+    size_t n;
+    while ((n = read(buf, sizeof(buf))) > 0) {
+        if (fwrite(buf, 1, n, f) != n) return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// Reader
+// -------------------------------------------------------------------------
+bool SeriesReader::open(const void* d, size_t length) {
+    data = (const uint8_t*)d;
+    len = length;
+    fileHeader = nullptr;
+    index = nullptr;
+    blockCount = 0;
+    recordCount = 0;
+    if (len < HEADER_BYTES) return false;
+    const FileHeader* fh = (const FileHeader*)data;
+    if (fh->magic != FILE_MAGIC || fh->version != VERSION || fh->headerBytes != HEADER_BYTES ||
+        fh->blockBytes != BLOCK_BYTES || fh->blockRecords != blockCapacity(fh->columns)) {
+        return false;
+    }
+    fileHeader = fh;
+
+    // Complete file: the footer says how many blocks and where the index is
+    if (len >= HEADER_BYTES + sizeof(Footer)) {
+        const Footer* f = (const Footer*)(data + len - sizeof(Footer));
+        size_t expected = HEADER_BYTES + (size_t)f->blockCount * (BLOCK_BYTES + sizeof(IndexEntry)) + sizeof(Footer);
+        if (f->magic == FOOTER_MAGIC && f->magic2 == FOOTER_MAGIC && expected == len) {
+            blockCount = f->blockCount;
+            recordCount = f->recordCount;
+            index = (const IndexEntry*)(data + HEADER_BYTES + blockCount * BLOCK_BYTES);
+            return true;
+        }
+    }
+    // No footer: every complete block with a valid header, in order
+    size_t maxBlocks = (len - HEADER_BYTES) / BLOCK_BYTES;
+    while (blockCount < maxBlocks) {
+        const BlockHeader* h = (const BlockHeader*)(data + HEADER_BYTES + blockCount * BLOCK_BYTES);
+        if (h->magic != BLOCK_MAGIC || h->index != blockCount || h->count == 0 || h->count > fh->blockRecords) break;
+        recordCount += h->count;
+        blockCount++;
+    }
+    return true;
+}
+
+int SeriesReader::slot(Column column) const {
+    if (!(fileHeader->columns & column)) return -1;
+    return countValues(fileHeader->columns & (column - 1));
+}
+
+SeriesReader::BlockView SeriesReader::block(size_t i) const {
+    BlockView v;
+    const uint8_t* base = data + HEADER_BYTES + i * BLOCK_BYTES;
+    v.header = (const BlockHeader*)base;
+    v.ts = (const uint32_t*)(base + sizeof(BlockHeader));
+    for (size_t s = 0; s < MAX_VALUES; s++) {
+        v.values[s] = (s < fileHeader->valueCount) ? (const float*)(v.ts + fileHeader->blockRecords * (s + 1)) : nullptr;
+    }
+    return v;
+}
+
+uint32_t SeriesReader::blockTsLast(size_t i) const {
+    if (index) return index[i].tsLast;
+    return ((const BlockHeader*)(data + HEADER_BYTES + i * BLOCK_BYTES))->tsLast;
+}
+
+size_t SeriesReader::findBlock(uint32_t ts) const {
+    size_t lo = 0, hi = blockCount;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (blockTsLast(mid) < ts) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+SeriesReader::Stats SeriesReader::aggregate(uint32_t from, uint32_t to, Column column, bool minMaxOnly) const {
+    Stats st = {0, NAN, NAN, 0.0, 0.0};
+    int s = slot(column);
+    if (s < 0) return st;
+    for (size_t b = findBlock(from); b < blockCount; b++) {
+        BlockView v = block(b);
+        const BlockHeader* h = v.header;
+        if (h->tsFirst > to) break;
+        if (minMaxOnly && h->tsFirst >= from && h->tsLast <= to) {
+            // Whole block inside the range: the header has the answer
+            st.count += h->count;
+            if (!isnan(h->min[s]) && (isnan(st.min) || h->min[s] < st.min)) st.min = h->min[s];
+            if (!isnan(h->max[s]) && (isnan(st.max) || h->max[s] > st.max)) st.max = h->max[s];
+            continue;
+        }
+        const float* values = v.values[s];
+        for (size_t i = 0; i < h->count; i++) {
+            float x = values[i];
+            if (v.ts[i] < from || v.ts[i] > to || isnan(x)) continue;
+            st.count++;
+            st.sum += x;
+            st.sumSq += (double)x * x;
+            if (isnan(st.min) || x < st.min) st.min = x;
+            if (isnan(st.max) || x > st.max) st.max = x;
+        }
+    }
+    return st;
+}
+
+bool SeriesReader::verify() const {
+    for (size_t b = 0; b < blockCount; b++) {
+        const uint8_t* base = data + HEADER_BYTES + b * BLOCK_BYTES;
+        const BlockHeader* h = (const BlockHeader*)base;
+        if (h->magic != BLOCK_MAGIC || h->index != b) return false;
+        if (crc32(base + sizeof(BlockHeader), BLOCK_BYTES - sizeof(BlockHeader)) != h->crc) return false;
+    }
+    if (index) {
+        const Footer* f = (const Footer*)(data + len - sizeof(Footer));
+        if (crc32(index, blockCount * sizeof(IndexEntry)) != f->indexCrc) return false;
+    }
+    return true;
+}
+
+#if !defined(ESP32)
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping stays valid
+    if (p == MAP_FAILED) return false;
+    addr = p;
+    length = st.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (addr) munmap(addr, length);
+    addr = nullptr;
+    length = 0;
+}
+#endif
@@ -0,0 +1,125 @@
+#include "SessionJournal.h"
+#include <math.h>
+#include <string.h>
+
+const char* sessionExitName(SessionExit e) {
+    switch (e) {
+        case SessionExit::TARGET_MET: return "target";
+        case SessionExit::PLATEAU:    return "plateau";
+        case SessionExit::REBOUND:    return "rebound";
+        case SessionExit::TIMEOUT:    return "timeout";
+        default:                      return "none";
+    }
+}
+
+float VentSession::dryingRate() const {
+    if (dryingSec < 60) return NAN;
+    return (startAbsHum - dryEndAbsHum) / (dryingSec / 60.0f);
+}
+
+SessionJournal::SessionJournal() : head(0), stored(0), closed(0), active(false), startMs(0) {
+    memset(&cur, 0, sizeof(cur));
+}
+
+void SessionJournal::open(uint32_t ts, uint32_t ms, float t, float hum, float absHum, float outTemp, float outAbsHum) {
+    memset(&cur, 0, sizeof(cur));
+    cur.start = ts;
+    cur.startHum = cur.endHum = hum;
+    cur.startAbsHum = cur.dryEndAbsHum = cur.minAbsHum = cur.endAbsHum = absHum;
+    cur.startTemp = cur.minTemp = t;
+    cur.outTemp = outTemp;
+    cur.outAbsHum = outAbsHum;
+    cur.dryingExit = SessionExit::NONE;
+    cur.exit = SessionExit::NONE;
+    startMs = ms;
+    active = true;
+}
+
+void SessionJournal::reading(float t, float hum, float absHum, float absHumRate) {
+    if (!active) return;
+    cur.endHum = hum;
+    cur.endAbsHum = absHum;
+    if (absHum < cur.minAbsHum) cur.minAbsHum = absHum;
+    if (t < cur.minTemp) cur.minTemp = t;
+    if (-absHumRate > cur.peakRate) cur.peakRate = -absHumRate; // NAN compares false
+    if (cur.readings < UINT16_MAX) cur.readings++;
+}
+
+void SessionJournal::dryingEnded(uint32_t ms, SessionExit how, float absHum) {
+    if (!active || cur.dryingExit != SessionExit::NONE) return;
+    cur.dryingExit = how;
+    cur.dryingSec = (ms - startMs) / 1000;
+    cur.dryEndAbsHum = absHum;
+}
+
+void SessionJournal::close(uint32_t ms, SessionExit how, float hum, float absHum) {
+    if (!active) return;
+    dryingEnded(ms, SessionExit::REBOUND, absHum); // Closed while still drying
+    cur.exit = how;
+    cur.durationSec = (ms - startMs) / 1000;
+    cur.endHum = hum;
+    cur.endAbsHum = absHum;
+    ring[head] = cur;
+    head = (head + 1) % CAPACITY;
+    if (stored < CAPACITY) stored++;
+    closed++;
+    active = false;
+}
+
+VentSession SessionJournal::current(uint32_t ms) const {
+    VentSession s = cur;
+    s.durationSec = (ms - startMs) / 1000;
+    if (s.dryingExit == SessionExit::NONE) {
+        s.dryingSec = s.durationSec;
+        s.dryEndAbsHum = s.endAbsHum;
+    }
+    return s;
+}
+
+size_t SessionJournal::copy(size_t offset, size_t n, VentSession* out) const {
+    if (offset >= stored) return 0;
+    if (n > stored - offset) n = stored - offset;
+    size_t oldest = (head + CAPACITY - stored) % CAPACITY;
+    for (size_t i = 0; i < n; i++) out[i] = ring[(oldest + offset + i) % CAPACITY];
+    return n;
+}
+
+void SessionJournal::restore(const VentSession* in, size_t n) {
+    head = 0;
+    stored = 0;
+    if (n > CAPACITY) {
+        in += n - CAPACITY;
+        n = CAPACITY;
+    }
+    for (size_t i = 0; i < n; i++) ring[i] = in[i];
+    stored = n;
+    head = n % CAPACITY;
+}
+
+SessionJournal::Summary SessionJournal::summarize(uint32_t since) const {
+    Summary s;
+    memset(&s, 0, sizeof(s));
+    double minutes = 0, removed = 0, rate = 0, heat = 0;
+    uint32_t rated = 0;
+    size_t oldest = (head + CAPACITY - stored) % CAPACITY;
+    for (size_t i = 0; i < stored; i++) {
+        const VentSession& e = ring[(oldest + i) % CAPACITY];
+        if (e.start < since) continue;
+        s.count++;
+        s.byExit[(size_t)e.dryingExit]++;
+        if (e.exit == SessionExit::TIMEOUT) s.timeouts++;
+        minutes += e.durationSec / 60.0;
+        removed += e.removed();
+        heat += e.heatLoss();
+        float r = e.dryingRate();
+        if (!isnan(r)) {
+            rate += r;
+            rated++;
+        }
+    }
+    s.avgMinutes = s.count ? minutes / s.count : NAN;
+    s.avgRemoved = s.count ? removed / s.count : NAN;
+    s.avgHeatLoss = s.count ? heat / s.count : NAN;
+    s.avgRate = rated ? rate / rated : NAN;
+    return s;
+}
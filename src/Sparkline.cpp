@@ -0,0 +1,198 @@
+#include "Sparkline.h"
+
+static const size_t BATCH = 32;
+
+Sparkline::Sparkline() : canvas(WIDTH, HEIGHT) {
+    reset();
+}
+
+void Sparkline::reset() {
+    for (uint16_t i = 0; i < WIDTH; i++) {
+        colT10[i] = EMPTY;
+        colH[i] = 0;
+    }
+    head = 0;
+    newestBucket = 0;
+    lastTs = 0;
+    sumT10 = 0;
+    sumH = 0;
+    sumN = 0;
+    pendingShift = 0;
+    newestChanged = false;
+    needFull = true;
+    drawnTMin = drawnTMax = 0;
+    drawnHMin = drawnHMax = 0;
+}
+
+void Sparkline::sync(SensorManager* sensorManager) {
+    if (!sensorManager) return;
+    size_t count = sensorManager->getHistoryCount();
+    if (count == 0) return;
+    if (lastTs == 0) {
+        rebuild(sensorManager);
+        return;
+    }
+
+    // Steady state: only the newest batch is read
+    Record batch[BATCH];
+    size_t n = count < BATCH ? count : BATCH;
+    size_t got = sensorManager->copyHistory(count - n, n, batch);
+    if (got == 0) return;
+    if (batch[0].ts > lastTs && count > n) {
+        // More new records than one batch (e.g. after night mode) - refold everything
+        rebuild(sensorManager);
+        return;
+    }
+    for (size_t i = 0; i < got; i++) append(batch[i]);
+}
+
+void Sparkline::rebuild(SensorManager* sensorManager) {
+    reset();
+    Record batch[BATCH];
+    size_t offset = 0;
+    size_t got;
+    while ((got = sensorManager->copyHistory(offset, BATCH, batch)) > 0) {
+        for (size_t i = 0; i < got; i++) append(batch[i]);
+        offset += got;
+    }
+    needFull = true;
+}
+
+void Sparkline::append(const Record& r) {
+    if (r.ts <= lastTs) return;
+    if (isnan(r.t) || isnan(r.h)) {
+        lastTs = r.ts;
+        return;
+    }
+
+    uint32_t bucket = r.ts / BUCKET_SEC;
+    if (lastTs == 0) {
+        newestBucket = bucket;
+    } else if (bucket > newestBucket) {
+        shiftColumns(bucket - newestBucket);
+        newestBucket = bucket;
+    }
+    lastTs = r.ts;
+
+    // Newest column = running average of its records
+    sumT10 += (int32_t)lroundf(r.t * 10.0f);
+    sumH += (uint16_t)lroundf(r.h);
+    sumN++;
+    uint16_t idx = (head + WIDTH - 1) % WIDTH;
+    colT10[idx] = (int16_t)(sumT10 / sumN);
+    colH[idx] = (uint8_t)(sumH / sumN);
+    newestChanged = true;
+}
+
+void Sparkline::shiftColumns(uint32_t n) {
+    sumT10 = 0;
+    sumH = 0;
+    sumN = 0;
+    if (n >= WIDTH) {
+        for (uint16_t i = 0; i < WIDTH; i++) colT10[i] = EMPTY;
+        head = 0;
+        needFull = true;
+        return;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        colT10[head] = EMPTY; // Oldest slot becomes the new newest column
+        head = (head + 1) % WIDTH;
+    }
+    pendingShift += n;
+    if (pendingShift >= WIDTH) needFull = true;
+}
+
+void Sparkline::getRange(int16_t& tMin, int16_t& tMax, uint8_t& hMin, uint8_t& hMax) const {
+    int16_t lo = INT16_MAX, hi = INT16_MIN;
+    uint8_t hLo = 255, hHi = 0;
+    for (uint16_t i = 0; i < WIDTH; i++) {
+        int16_t t = colT10[i];
+        if (t == EMPTY) continue;
+        if (t < lo) lo = t;
+        if (t > hi) hi = t;
+        if (colH[i] < hLo) hLo = colH[i];
+        if (colH[i] > hHi) hHi = colH[i];
+    }
+    if (lo > hi) {
+        tMin = 0; tMax = 1; hMin = 0; hMax = 100;
+        return;
+    }
+    // Round outward so small changes do not rescale (and force a full redraw)
+    tMin = (int16_t)floorf(lo / 10.0f);
+    tMax = (int16_t)ceilf(hi / 10.0f);
+    if (tMax - tMin < 2) tMax = tMin + 2;
+    hMin = (hLo / 5) * 5;
+    hMax = ((hHi + 4) / 5) * 5;
+    if (hMax - hMin < 10) hMax = hMin + 10;
+    if (hMax > 100) { hMax = 100; hMin = 90 < hMin ? 90 : hMin; }
+}
+
+void Sparkline::draw(Adafruit_GFX& target, int16_t x, int16_t y) {
+    int16_t tMin, tMax;
+    uint8_t hMin, hMax;
+    getRange(tMin, tMax, hMin, hMax);
+    bool rescaled = tMin != drawnTMin || tMax != drawnTMax || hMin != drawnHMin || hMax != drawnHMax;
+
+    if (needFull || rescaled) {
+        canvas.fillScreen(0);
+        drawColumns(0, WIDTH, tMin, tMax, hMin, hMax);
+    } else if (pendingShift > 0 || newestChanged) {
+        // Shift the bitmap, then redraw only the columns that are new or still open
+        if (pendingShift > 0) {
+            shiftCanvasLeft(pendingShift);
+            // The new first column still holds the segment from its old left neighbour
+            canvas.fillRect(0, 0, 1, HEIGHT, 0);
+            drawColumns(0, 1, tMin, tMax, hMin, hMax);
+        }
+        uint16_t from = WIDTH - 1 - pendingShift;
+        canvas.fillRect(from, 0, WIDTH - from, HEIGHT, 0);
+        drawColumns(from, WIDTH, tMin, tMax, hMin, hMax);
+    }
+
+    drawnTMin = tMin; drawnTMax = tMax;
+    drawnHMin = hMin; drawnHMax = hMax;
+    pendingShift = 0;
+    newestChanged = false;
+    needFull = false;
+
+    target.drawBitmap(x, y, canvas.getBuffer(), WIDTH, HEIGHT, 1);
+}
+
+// Each column only draws inside itself (vertical segment from the previous
+// column's value), so redrawing a column never leaves stale pixels elsewhere.
+void Sparkline::drawColumns(uint16_t from, uint16_t to, int16_t tMin, int16_t tMax, uint8_t hMin, uint8_t hMax) {
+    const int32_t tSpan = (int32_t)(tMax - tMin) * 10;
+    const int32_t hSpan = hMax - hMin;
+    for (uint16_t i = from; i < to; i++) {
+        int16_t t = columnT(i);
+        if (t == EMPTY) continue;
+        int16_t yT = (PANEL_H - 1) - (int16_t)((t - tMin * 10) * (int32_t)(PANEL_H - 1) / tSpan);
+        int16_t yH = H_TOP + (PANEL_H - 1) - (int16_t)((columnH(i) - hMin) * (int32_t)(PANEL_H - 1) / hSpan);
+
+        int16_t yT0 = yT, yH0 = yH;
+        if (i > 0 && columnT(i - 1) != EMPTY) {
+            int16_t pt = columnT(i - 1);
+            yT0 = (PANEL_H - 1) - (int16_t)((pt - tMin * 10) * (int32_t)(PANEL_H - 1) / tSpan);
+            yH0 = H_TOP + (PANEL_H - 1) - (int16_t)((columnH(i - 1) - hMin) * (int32_t)(PANEL_H - 1) / hSpan);
+        }
+        canvas.drawFastVLine(i, min(yT, yT0), abs(yT - yT0) + 1, 1);
+        canvas.drawFastVLine(i, min(yH, yH0), abs(yH - yH0) + 1, 1);
+    }
+}
+
+// GFXcanvas1 is row-major, MSB = leftmost pixel: shift every row left by n bits
+void Sparkline::shiftCanvasLeft(uint16_t n) {
+    uint8_t* buf = canvas.getBuffer();
+    const uint16_t stride = (WIDTH + 7) / 8;
+    const uint16_t byteShift = n / 8;
+    const uint8_t bitShift = n % 8;
+    for (uint16_t row = 0; row < HEIGHT; row++) {
+        uint8_t* r = buf + (size_t)row * stride;
+        for (uint16_t i = 0; i < stride; i++) {
+            uint16_t src = i + byteShift;
+            uint8_t a = src < stride ? r[src] : 0;
+            uint8_t b = (src + 1) < stride ? r[src + 1] : 0;
+            r[i] = bitShift ? (uint8_t)((a << bitShift) | (b >> (8 - bitShift))) : a;
+        }
+    }
+}
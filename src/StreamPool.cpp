@@ -0,0 +1,52 @@
+#include "StreamPool.h"
+
+StreamSlots::StreamSlots(const char* name, size_t capacity)
+    : name(name), capacity(capacity < MAX_SLOTS ? capacity : MAX_SLOTS), used(0), peak(0), served(0),
+      rejected(0), completed(0), aborted(0), maxDurationMs(0), lastDurationMs(0), started() {}
+
+int StreamSlots::claim() {
+    uint32_t all = (capacity == 32) ? 0xFFFFFFFFu : ((1u << capacity) - 1);
+    uint32_t cur = __atomic_load_n(&used, __ATOMIC_RELAXED);
+    for (;;) {
+        uint32_t idle = ~cur & all;
+        if (idle == 0) {
+            __atomic_fetch_add(&rejected, 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+        int slot = __builtin_ctz(idle);
+        uint32_t next = cur | (1u << slot);
+        if (__atomic_compare_exchange_n(&used, &cur, next, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            started[slot] = millis();
+            __atomic_fetch_add(&served, 1, __ATOMIC_RELAXED);
+            uint32_t n = __builtin_popcount(next);
+            uint32_t p = __atomic_load_n(&peak, __ATOMIC_RELAXED);
+            while (n > p && !__atomic_compare_exchange_n(&peak, &p, n, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+            return slot;
+        }
+        // cur was reloaded by the failed exchange
+    }
+}
+
+void StreamSlots::release(int slot, bool done) {
+    uint32_t ms = millis() - started[slot];
+    __atomic_fetch_add(done ? &completed : &aborted, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&lastDurationMs, ms, __ATOMIC_RELAXED);
+    uint32_t m = __atomic_load_n(&maxDurationMs, __ATOMIC_RELAXED);
+    while (ms > m && !__atomic_compare_exchange_n(&maxDurationMs, &m, ms, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    // Last: the slot may be claimed again right away
+    __atomic_fetch_and(&used, ~(1u << slot), __ATOMIC_RELEASE);
+}
+
+StreamSlots::Stats StreamSlots::getStats() const {
+    Stats s;
+    s.capacity = capacity;
+    s.inUse = __builtin_popcount(__atomic_load_n(&used, __ATOMIC_RELAXED));
+    s.peak = peak;
+    s.served = served;
+    s.rejected = rejected;
+    s.completed = completed;
+    s.aborted = aborted;
+    s.maxDurationMs = maxDurationMs;
+    s.lastDurationMs = lastDurationMs;
+    return s;
+}
@@ -1,12 +1,40 @@
 #include "TelegramManager.h"
+#include "ChartRenderer.h"
+#include "Trace.h"
+#include <memory>
+#include <new>
 
-TelegramManager::TelegramManager(SensorManager* sm) 
-    : sensorManager(sm), lastPollTime(0), lastAdviceCode(-1), 
+PngEncoder* TelegramManager::activePng = nullptr;
+
+// Mold alerts: MOLD_ALERT_INDEX and the next whole levels up to visible growth
+static const int MOLD_ALERT_STEPS = 3;
+static const float MOLD_REARM = 0.5f; // Index hysteresis before a step can fire again
+// Sensor health: the same problem is announced at most once per hour (a
+// loose wire can flap between working and not)
+static const unsigned long SENSOR_ALERT_GAP_MS = 60UL * 60 * 1000;
+
+static const char* sensorHealthText(SensorHealth::Status s) {
+    switch (s) {
+        case SensorHealth::Status::ERRORS: return "Частые ошибки чтения DHT22 (контрольная сумма / таймаут). Проверьте провода и питание.";
+        case SensorHealth::Status::IMPLAUSIBLE: return "DHT22 выдаёт физически невозможные значения. Показания ненадёжны.";
+        case SensorHealth::Status::STUCK: return "Показания DHT22 не меняются дольше ожидаемого. Датчик, вероятно, завис.";
+        case SensorHealth::Status::NO_READINGS: return "Нет данных от DHT22 больше минуты. Проверьте подключение.";
+        default: return "Датчик в норме.";
+    }
+}
+
+TelegramManager::TelegramManager(SensorManager* sm, HttpsManager* https) 
+    : sensorManager(sm), https(https), lastAdviceCode(-1), 
       lastClimateState(SensorManager::ClimateState::STABLE), 
-      moldAlertSent(false), timeoutAlertSent(false) {
-    // Insecure client for simplicity (no cert management)
-    client.setInsecure();
-    bot = new UniversalTelegramBot(BOT_TOKEN, client);
+      moldAlertStep(-1), timeoutAlertSent(false),
+      lastSensorHealth(SensorHealth::Status::OK), sensorAlerted(SensorHealth::Status::OK), sensorAlertTime(0),
+      sensorRecoveryPending(false) {
+    // Pinned CA + keep-alive client shared through HttpsManager
+    bot = new UniversalTelegramBot(BOT_TOKEN, https->client(HttpsManager::Host::TELEGRAM));
+}
+
+bool TelegramManager::connect() {
+    return https->ensureConnected(HttpsManager::Host::TELEGRAM);
 }
 
 void TelegramManager::begin() {
@@ -14,8 +42,10 @@ void TelegramManager::begin() {
     subscribers.push_back({OWNER_CHAT_ID, false, "Admin", 0});
     
     // Send Hello to Owner
+    if (!connect()) return;
     bot->sendMessage(OWNER_CHAT_ID, "🤖 **Climate Bot Online**\nSystem restarted.", "Markdown");
     sendMainMenu(OWNER_CHAT_ID);
+    https->touch(HttpsManager::Host::TELEGRAM);
 }
 
 void TelegramManager::update() {
@@ -25,14 +55,15 @@ void TelegramManager::update() {
         return;
     }
     
-    // 1. Poll Telegram (3s interval - balance between responsiveness and WiFi load)
-    if (millis() - lastPollTime > 3000) {
+    // 1. Poll Telegram (scheduled every 3s - balance between responsiveness and WiFi load)
+    if (connect()) {
+        TRACE_SCOPE("tg_poll");
         int numNewMessages = bot->getUpdates(bot->last_message_received + 1);
         while (numNewMessages) {
             handleNewMessages(numNewMessages);
             numNewMessages = bot->getUpdates(bot->last_message_received + 1);
         }
-        lastPollTime = millis();
+        https->touch(HttpsManager::Host::TELEGRAM);
     }
 
     // 2. Check for Alerts (Logic: Change of State)
@@ -42,14 +73,12 @@ void TelegramManager::update() {
     
     // A. Transition to TARGET_MET (Success)
     if (lastClimateState == SensorManager::ClimateState::VENTILATING && currentState == SensorManager::ClimateState::TARGET_MET) {
-        String msg = "✅ **Цель достигнута!**\nВлажность в норме. Можно закрывать.";
-        broadcastAlert(msg, 1);
+        broadcastAlert("✅ **Цель достигнута!**\nВлажность в норме. Можно закрывать.", 1);
     }
 
     // B. Transition to INEFFICIENT (Stalled)
     if (lastClimateState == SensorManager::ClimateState::VENTILATING && currentState == SensorManager::ClimateState::INEFFICIENT) {
-        String msg = "⚠️ **Эффективность упала**\nВлага почти не уходит. Закрывайте, чтобы не выстужать стены.";
-        broadcastAlert(msg, 2);
+        broadcastAlert("⚠️ **Эффективность упала**\nВлага почти не уходит. Закрывайте, чтобы не выстужать стены.", 2);
     }
 
     // C. Rebound (Window Closed) - Silent Log
@@ -68,16 +97,44 @@ void TelegramManager::update() {
         timeoutAlertSent = false; // Reset when not ventilating
     }
     
-    // C. Mold Risk (Independent Check)
-    // Condition: Temp - DP < 3.0
-    float margin = sensorManager->getTemp() - sensorManager->getDewPoint();
-    if (!isnan(margin) && margin < 3.0) {
-        if (!moldAlertSent) {
-            broadcastAlert("🔴 **Риск плесени!**\nСтены холодные. Требуется прогрев и осушение!", 2);
-            moldAlertSent = true; 
-        }
+    // C. Mold Risk (Independent Check): accumulated VTT index, not the
+    // momentary dew point margin - a damp evening does not alert, weeks do
+    float moldIndex = sensorManager->getMoldIndex();
+    int step = moldStep(moldIndex);
+    if (moldAlertStep < 0) {
+        moldAlertStep = step; // Restored index after a reset was announced before
+    } else if (step > moldAlertStep) {
+        static const char* const MOLD_TEXT[MOLD_ALERT_STEPS] = {
+            "Начался микроскопический рост на холодных стенах. Требуется прогрев и осушение!",
+            "Рост продолжается. Прогрейте и осушите комнату, проверьте углы и откосы.",
+            "Вероятен видимый налёт. Осмотрите стены и обработайте поражённые места.",
+        };
+        char msg[256];
+        snprintf(msg, sizeof(msg), "🔴 **Риск плесени!** Индекс %.1f\n%s", moldIndex, MOLD_TEXT[step - 1]);
+        broadcastAlert(msg, 2);
+        moldAlertStep = step;
     } else {
-        if (margin > 3.5) moldAlertSent = false; // Hysteresis 0.5C to reset
+        int rearmed = moldStep(moldIndex + MOLD_REARM);
+        if (rearmed < moldAlertStep) moldAlertStep = rearmed; // Index declined: step may fire again
+    }
+
+    // D. Sensor Health (DHT read path): alert on a new problem, report recovery
+    SensorHealth::Status health = sensorManager->getSensorHealth();
+    if (health != lastSensorHealth) {
+        char msg[256];
+        if (health != SensorHealth::Status::OK) {
+            if (health != sensorAlerted || millis() - sensorAlertTime > SENSOR_ALERT_GAP_MS) {
+                snprintf(msg, sizeof(msg), "🌡️ **Проблема с датчиком!**\n%s", sensorHealthText(health));
+                broadcastAlert(msg, 2);
+                sensorAlerted = health;
+                sensorAlertTime = millis();
+                sensorRecoveryPending = true;
+            }
+        } else if (sensorRecoveryPending) {
+            broadcastAlert("✅ **Датчик снова в норме.**", 1);
+            sensorRecoveryPending = false;
+        }
+        lastSensorHealth = health;
     }
     
     lastClimateState = currentState;
@@ -98,6 +155,12 @@ void TelegramManager::handleNewMessages(int numNewMessages) {
         else if (text == "🌡️ Статус") {
             sendStatus(chatId);
         }
+        else if (text == "📈 График") {
+            sendChart(chatId);
+        }
+        else if (text == "🪟 Сессии" || text == "/sessions") {
+            sendSessions(chatId);
+        }
         else if (text == "🔇/🔊 Звук") {
             toggleMute(chatId);
         }
@@ -115,41 +178,179 @@ void TelegramManager::handleNewMessages(int numNewMessages) {
 }
 
 void TelegramManager::sendMainMenu(const String& chatId, const String& welcomeMsg) {
-    String keyboardJson = "[[\"🌡️ Статус\", \"🔇/🔊 Звук\"], [\"🔗 Веб-панель\"]]";
+    String keyboardJson = "[[\"🌡️ Статус\", \"📈 График\", \"🪟 Сессии\"], [\"🔇/🔊 Звук\", \"🔗 Веб-панель\"]]";
     bot->sendMessageWithReplyKeyboard(chatId, welcomeMsg.length() > 0 ? welcomeMsg : "Меню:", "", keyboardJson, true);
 }
 
+// Appends printf-style text to a fixed buffer (truncates, never allocates)
+static void appendf(char* buf, size_t len, size_t& used, const char* fmt, ...) {
+    if (used + 1 >= len) return;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + used, len - used, fmt, args);
+    va_end(args);
+    if (n > 0) used = min(used + (size_t)n, len - 1);
+}
+
 void TelegramManager::sendStatus(const String& chatId) {
     float t = sensorManager->getTemp();
     float h = sensorManager->getHum();
     float outT = sensorManager->getOutdoorTemp();
-    String advice = sensorManager->getRecommendation();
     int code = sensorManager->getAdviceCode();
+    char advice[128];
+    sensorManager->getRecommendation(advice, sizeof(advice));
     
-    String icon = "😐";
+    const char* icon = "😐";
     if(code == 3) icon = "✅"; // Good/Safe
     if(code == 2) icon = "🔴"; // Critical
     if(code == 1) icon = "🟡"; // Vent
     
-    String msg = icon + " **КЛИМАТ:**\n\n";
-    msg += "🏠 **Дома:** " + String(t, 1) + "°C | " + String(h, 1) + "%\n";
+    char msg[768];
+    size_t used = 0;
+    appendf(msg, sizeof(msg), used, "%s **КЛИМАТ:**\n\n", icon);
+    appendf(msg, sizeof(msg), used, "🏠 **Дома:** %.1f°C | %.1f%%\n", t, h);
     if(!isnan(outT)) {
-        msg += "🌳 **Улица:** " + String(outT, 1) + "°C\n";
+        appendf(msg, sizeof(msg), used, "🌳 **Улица:** %.1f°C\n", outT);
     } else {
-        msg += "🌑 **Погода:** " + sensorManager->getWeatherStatus() + "\n";
+        char status[64];
+        sensorManager->getWeatherStatus(status, sizeof(status));
+        appendf(msg, sizeof(msg), used, "🌑 **Погода:** %s\n", status);
+    }
+    float mold = sensorManager->getMoldIndex();
+    appendf(msg, sizeof(msg), used, "🍄 **Плесень:** индекс %.2f%s\n", mold,
+            sensorManager->isMoldGrowing() ? " (растёт)" : "");
+    SensorHealth::Status health = sensorManager->getSensorHealth();
+    if (health != SensorHealth::Status::OK) {
+        appendf(msg, sizeof(msg), used, "⚠️ **Датчик:** %s\n", sensorHealthText(health));
+    }
+    appendf(msg, sizeof(msg), used, "\n💡 **Совет:** %s", advice);
+
+    // Forecast airing plan (next 24h)
+    VentSlot slots[VentilationPlanner::MAX_SLOTS];
+    int best;
+    size_t n = sensorManager->getPlan(slots, VentilationPlanner::MAX_SLOTS, best);
+    if (n > 0) {
+        appendf(msg, sizeof(msg), used, "\n\n🪟 **План проветривания:**");
+        for (size_t i = 0; i < n; i++) {
+            time_t ts = slots[i].startTs;
+            struct tm tmSlot;
+            localtime_r(&ts, &tmSlot);
+            appendf(msg, sizeof(msg), used, "\n%s %02d:%02d — %u мин (−%.1f г/м³, −%.1f°C)",
+                    (int)i == best ? "⭐" : "•", tmSlot.tm_hour, tmSlot.tm_min,
+                    slots[i].durationMin, slots[i].removedAbsHum, slots[i].heatLoss);
+        }
     }
-    msg += "\n💡 **Совет:** " + advice;
     
+    bot->sendMessage(chatId, msg, "Markdown"); // Library takes String: one short-lived copy
+}
+
+static const char* sessionExitText(SessionExit e) {
+    switch (e) {
+        case SessionExit::TARGET_MET: return "цель";
+        case SessionExit::PLATEAU:    return "плато";
+        case SessionExit::REBOUND:    return "закрыто";
+        case SessionExit::TIMEOUT:    return "таймаут";
+        default:                      return "идёт";
+    }
+}
+
+void TelegramManager::sendSessions(const String& chatId) {
+    const size_t LAST = 5;
+    const uint32_t WEEK = 7 * 86400;
+    uint32_t now = (uint32_t)time(NULL);
+    SessionJournal::Summary sum;
+    VentSession last[LAST];
+    size_t total = sensorManager->getSessionCount();
+    size_t n = sensorManager->copySessions(total > LAST ? total - LAST : 0, LAST, last);
+    if (!sensorManager->getSessionSummary(now > WEEK ? now - WEEK : 0, sum)) {
+        bot->sendMessage(chatId, "⏳ Данные заняты, попробуйте ещё раз.", "");
+        return;
+    }
+
+    char msg[768];
+    size_t used = 0;
+    appendf(msg, sizeof(msg), used, "🪟 **Проветривания за 7 дней:** %lu\n", (unsigned long)sum.count);
+    if (sum.count > 0) {
+        appendf(msg, sizeof(msg), used, "✅ цель %lu · ⚠️ плато %lu · 🚪 закрыто раньше %lu · ⏱ таймаут %lu\n",
+                (unsigned long)sum.byExit[(size_t)SessionExit::TARGET_MET],
+                (unsigned long)sum.byExit[(size_t)SessionExit::PLATEAU],
+                (unsigned long)sum.byExit[(size_t)SessionExit::REBOUND], (unsigned long)sum.timeouts);
+        appendf(msg, sizeof(msg), used, "⌀ %.0f мин, −%.1f г/м³", sum.avgMinutes, sum.avgRemoved);
+        if (!isnan(sum.avgRate)) appendf(msg, sizeof(msg), used, ", %.2f г/м³/мин", sum.avgRate);
+        appendf(msg, sizeof(msg), used, ", −%.1f°C\n", sum.avgHeatLoss);
+    }
+    if (n > 0) appendf(msg, sizeof(msg), used, "\n**Последние:**");
+    for (size_t i = n; i-- > 0;) { // Newest first
+        const VentSession& s = last[i];
+        time_t ts = s.start;
+        struct tm tmStart;
+        localtime_r(&ts, &tmStart);
+        appendf(msg, sizeof(msg), used, "\n• %02d.%02d %02d:%02d — %lu мин, %.0f→%.0f%%, −%.1f г/м³",
+                tmStart.tm_mday, tmStart.tm_mon + 1, tmStart.tm_hour, tmStart.tm_min,
+                (unsigned long)(s.durationSec / 60), s.startHum, s.endHum, s.removed());
+        if (!isnan(s.outTemp)) appendf(msg, sizeof(msg), used, ", улица %.0f°C", s.outTemp);
+        appendf(msg, sizeof(msg), used, ", %s", sessionExitText(s.dryingExit));
+        if (s.exit == SessionExit::TIMEOUT) appendf(msg, sizeof(msg), used, " (таймаут)");
+    }
+    if (sum.count == 0 && n == 0) appendf(msg, sizeof(msg), used, "Сессий пока не было.");
+
     bot->sendMessage(chatId, msg, "Markdown");
 }
 
-void TelegramManager::broadcastAlert(const String& msg, int level) {
+// 24h chart as PNG photo.
+// RAM: 4 KB bitmap + ~0.6 KB encoder, both released after the upload.
+// The PNG is encoded twice (size pass + upload pass) instead of buffering it.
+void TelegramManager::sendChart(const String& chatId) {
+    time_t now = time(NULL);
+    if (now < 1600000000) {
+        bot->sendMessage(chatId, "⏳ Время не синхронизировано, график недоступен.", "");
+        return;
+    }
+
+    std::unique_ptr<uint8_t[]> bitmap(new (std::nothrow) uint8_t[ChartRenderer::BITMAP_SIZE]);
+    if (!bitmap) {
+        bot->sendMessage(chatId, "⚠️ Недостаточно памяти для графика.", "");
+        return;
+    }
+
+    ChartRenderer renderer(sensorManager);
+    if (!renderer.render(bitmap.get(), (uint32_t)now)) {
+        bot->sendMessage(chatId, "📉 Пока недостаточно данных для графика.", "");
+        return;
+    }
+
+    PngEncoder png(bitmap.get(), ChartRenderer::WIDTH, ChartRenderer::HEIGHT);
+    size_t size = png.totalSize();
+
+    activePng = &png;
+    bot->sendPhotoByBinary(chatId, "image/png", size, pngMoreData, pngNextByte, nullptr, nullptr);
+    activePng = nullptr;
+}
+
+bool TelegramManager::pngMoreData() {
+    return activePng && activePng->available();
+}
+
+byte TelegramManager::pngNextByte() {
+    return activePng ? activePng->next() : 0;
+}
+
+int TelegramManager::moldStep(float index) {
+    if (!(index >= MOLD_ALERT_INDEX)) return 0;
+    int step = 1 + (int)(index - MOLD_ALERT_INDEX);
+    return step < MOLD_ALERT_STEPS ? step : MOLD_ALERT_STEPS;
+}
+
+void TelegramManager::broadcastAlert(const char* msg, int level) {
+    if (!connect()) return;
+    String text(msg); // Library takes String: build it once for all subscribers
     for (auto &sub : subscribers) {
         if (!sub.isMuted) {
             // Optional: Add silent flag for minor alerts? keeping loud for now
-            bot->sendMessage(sub.chatId, msg, "Markdown");
+            bot->sendMessage(sub.chatId, text, "Markdown");
         }
     }
+    https->touch(HttpsManager::Host::TELEGRAM);
 }
 
 void TelegramManager::subscribe(const String& chatId, const String& firstName) {
@@ -164,8 +365,7 @@ void TelegramManager::toggleMute(const String& chatId) {
     for (auto &sub : subscribers) {
         if (sub.chatId == chatId) {
             sub.isMuted = !sub.isMuted;
-            String status = sub.isMuted ? "🔇 Уведомления ОТКЛЮЧЕНЫ" : "🔔 Уведомления ВКЛЮЧЕНЫ";
-            bot->sendMessage(chatId, status, "Markdown");
+            bot->sendMessage(chatId, sub.isMuted ? "🔇 Уведомления ОТКЛЮЧЕНЫ" : "🔔 Уведомления ВКЛЮЧЕНЫ", "Markdown");
             return;
         }
     }
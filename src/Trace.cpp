@@ -0,0 +1,96 @@
+#include "Trace.h"
+
+namespace Trace {
+
+    static Event buffers[CORES][EVENTS_PER_CORE];
+    static volatile uint32_t heads[CORES];   // Total events written per core
+    static uint32_t frozenHeads[CORES];
+    static volatile bool enabled = TRACE_ENABLED;
+    static volatile bool frozen = false;
+    static uint32_t overheadNs = 0;
+
+    static void clear() {
+        for (size_t c = 0; c < CORES; c++) heads[c] = 0;
+    }
+
+    void begin() {
+        // Calibrate: cost of one record() call on this core at the current CPU clock
+        const int N = 128;
+        bool was = enabled;
+        enabled = true;
+        uint32_t start = micros();
+        for (int i = 0; i < N; i++) record(COUNTER, "calibrate", i);
+        uint32_t dur = micros() - start;
+        overheadNs = dur * 1000 / N;
+        enabled = was;
+        clear();
+        Serial.printf("[TRACE] %u events/core, %lu ns/event\n", (unsigned)EVENTS_PER_CORE, (unsigned long)overheadNs);
+    }
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() { return enabled; }
+
+    void record(uint8_t phase, const char* name, int32_t value) {
+        if (!enabled || frozen) return;
+        size_t core = xPortGetCoreID();
+        // Reserve a slot atomically: tasks on the same core may preempt each other
+        uint32_t idx = __atomic_fetch_add(&heads[core], 1, __ATOMIC_RELAXED);
+        Event& e = buffers[core][idx & (EVENTS_PER_CORE - 1)];
+        e.ts = micros();
+        e.name = name;
+        e.value = value;
+        e.phase = phase;
+    }
+
+    Stats getStats() {
+        Stats s;
+        s.recorded = 0;
+        s.dropped = 0;
+        for (size_t c = 0; c < CORES; c++) {
+            uint32_t h = heads[c];
+            s.recorded += h;
+            if (h > EVENTS_PER_CORE) s.dropped += h - EVENTS_PER_CORE;
+        }
+        s.overheadNs = overheadNs;
+        s.enabled = enabled;
+        return s;
+    }
+
+    void freeze() {
+        frozen = true;
+        for (size_t c = 0; c < CORES; c++) frozenHeads[c] = heads[c];
+    }
+
+    void thaw() {
+        frozen = false;
+    }
+
+    size_t getEventCount(size_t core) {
+        if (core >= CORES) return 0;
+        uint32_t h = frozenHeads[core];
+        return h < EVENTS_PER_CORE ? h : EVENTS_PER_CORE;
+    }
+
+    bool getEvent(size_t core, size_t i, Event& out) {
+        size_t count = getEventCount(core);
+        if (i >= count) return false;
+        uint32_t first = frozenHeads[core] - count;
+        out = buffers[core][(first + i) & (EVENTS_PER_CORE - 1)];
+        return true;
+    }
+
+    uint32_t getBaseTs() {
+        bool found = false;
+        uint32_t base = 0;
+        uint32_t now = micros();
+        for (size_t c = 0; c < CORES; c++) {
+            Event e;
+            if (!getEvent(c, 0, e)) continue;
+            // Compare by age so micros() wrap-around is handled
+            if (!found || now - e.ts > now - base) base = e.ts;
+            found = true;
+        }
+        return base;
+    }
+
+}
@@ -0,0 +1,130 @@
+#include "VentilationPlanner.h"
+
+// Room model (typical 15-20 m2 room, window fully open)
+static const float AIR_EXCHANGE_TAU_MIN = 8.0f;   // Indoor air replaced with e-folding time
+static const float AIR_HEAT_SHARE = 0.3f;         // Share of dT felt from exchanged air
+static const float WALL_COOLING_PER_MIN = 0.004f; // Share of dT lost per minute by surfaces
+static const float MOISTURE_GAIN_PER_H = 0.05f;   // Occupant moisture, g/m3 per hour
+static const float MIN_HEAT_LOSS = 0.1f;          // °C, floor for warm-outside slots
+
+// Plan filters
+static const float MIN_GRADIENT = 0.5f;           // g/m3, indoor AH must exceed outdoor by this
+static const float MIN_REMOVAL_SHARE = 0.6f;      // Must remove >= 60% of the gradient
+static const uint16_t DURATIONS_MIN[] = {5, 10, 15, 20, 30};
+static const uint32_t HORIZON_H = 24;
+
+// Replan triggers
+static const float REPLAN_ABS_HUM = 0.3f;         // g/m3
+static const float REPLAN_TEMP = 1.0f;            // °C
+
+VentilationPlanner::VentilationPlanner() { invalidate(); }
+
+void VentilationPlanner::invalidate() {
+    slotCount = 0;
+    bestIndex = -1;
+    planTs = 0;
+    planForecastVersion = 0;
+    planInTemp = NAN;
+    planInAbsHum = NAN;
+    planned = false;
+    recomputeCount = 0;
+    lastPlanMicros = 0;
+}
+
+bool VentilationPlanner::update(const HourlyForecast& forecast, uint32_t forecastVersion, uint32_t now,
+                                float inTemp, float inAbsHum) {
+    if (isnan(inTemp) || isnan(inAbsHum) || now < 1600000000) return false;
+    if (!needsReplan(forecastVersion, now, inTemp, inAbsHum)) return false;
+
+    unsigned long start = micros();
+    plan(forecast, now, inTemp, inAbsHum);
+    lastPlanMicros = micros() - start;
+
+    planTs = now;
+    planForecastVersion = forecastVersion;
+    planInTemp = inTemp;
+    planInAbsHum = inAbsHum;
+    planned = true;
+    recomputeCount++;
+    return true;
+}
+
+bool VentilationPlanner::needsReplan(uint32_t forecastVersion, uint32_t now, float inTemp, float inAbsHum) const {
+    if (!planned || forecastVersion != planForecastVersion) return true;
+    if (fabsf(inAbsHum - planInAbsHum) > REPLAN_ABS_HUM) return true;
+    if (fabsf(inTemp - planInTemp) > REPLAN_TEMP) return true;
+    // Hour rolled over: the earliest slot may now be in the past
+    if (now / 3600 != planTs / 3600) return true;
+    return false;
+}
+
+// Best duration for one start time. Returns false if airing would not help.
+bool VentilationPlanner::evaluate(uint32_t ts, float outT, float outAh, float inTemp, float inAh, VentSlot& out) const {
+    float gradient = inAh - outAh;
+    if (gradient < MIN_GRADIENT) return false;
+
+    float dT = max(inTemp - outT, 0.0f);
+    bool found = false;
+
+    for (uint16_t d : DURATIONS_MIN) {
+        float exchanged = 1.0f - expf(-d / AIR_EXCHANGE_TAU_MIN);
+        float removed = gradient * exchanged;
+        if (removed < gradient * MIN_REMOVAL_SHARE) continue;
+
+        float heat = dT * (AIR_HEAT_SHARE * exchanged + WALL_COOLING_PER_MIN * d);
+        float eff = removed / max(heat, MIN_HEAT_LOSS);
+        // Prefer the more efficient duration; on ties (warm outside) remove more
+        if (!found || eff > out.efficiency * 1.01f ||
+            (eff >= out.efficiency * 0.99f && removed > out.removedAbsHum)) {
+            out = {ts, d, outT, outAh, removed, heat, eff};
+            found = true;
+        }
+    }
+    return found;
+}
+
+void VentilationPlanner::insertCandidate(const VentSlot& s) {
+    // Keep the MAX_SLOTS most efficient (insertion into a tiny sorted array)
+    size_t pos = slotCount;
+    while (pos > 0 && slots[pos - 1].efficiency < s.efficiency) pos--;
+    if (pos >= MAX_SLOTS) return;
+    size_t last = (slotCount < MAX_SLOTS) ? slotCount : MAX_SLOTS - 1;
+    for (size_t i = last; i > pos; i--) slots[i] = slots[i - 1];
+    slots[pos] = s;
+    if (slotCount < MAX_SLOTS) slotCount++;
+}
+
+void VentilationPlanner::plan(const HourlyForecast& forecast, uint32_t now, float inTemp, float inAbsHum) {
+    slotCount = 0;
+    bestIndex = -1;
+
+    uint32_t hourStart = now - now % 3600;
+    for (uint32_t h = 0; h < HORIZON_H; h++) {
+        uint32_t ts = (h == 0) ? now : hourStart + h * 3600;
+        float outT, outRh, outAh;
+        if (!forecast.sample(ts, outT, outRh, outAh)) continue;
+
+        // Indoor AH keeps rising until the next airing
+        float hours = (ts - now) / 3600.0f;
+        float inAh = inAbsHum + MOISTURE_GAIN_PER_H * hours;
+
+        VentSlot s;
+        if (evaluate(ts, outT, outAh, inTemp, inAh, s)) insertCandidate(s);
+    }
+    if (slotCount == 0) return;
+
+    // slots[0] is the most efficient; present the plan in time order
+    uint32_t bestTs = slots[0].startTs;
+    for (size_t i = 1; i < slotCount; i++) {
+        VentSlot key = slots[i];
+        size_t j = i;
+        while (j > 0 && slots[j - 1].startTs > key.startTs) {
+            slots[j] = slots[j - 1];
+            j--;
+        }
+        slots[j] = key;
+    }
+    for (size_t i = 0; i < slotCount; i++) {
+        if (slots[i].startTs == bestTs) bestIndex = (int)i;
+    }
+}
@@ -0,0 +1,98 @@
+#include "WarmStart.h"
+#include <Preferences.h>
+#include <sys/time.h>
+
+static const char* NVS_NAMESPACE = "warm";
+static const uint8_t WEATHER_FORMAT = 1;               // Bump when WeatherSnapshot layout changes
+static const uint8_t SESSION_FORMAT = 1;               // Bump when VentSession layout changes
+static const uint32_t CLOCK_SKEW_SEC = 60;             // Assume at least a short outage
+static const float MOLD_SAVE_STEP = 0.01f;             // Index change worth a flash write
+
+namespace WarmStart {
+
+    bool restoreClock() {
+        if (time(NULL) >= 1600000000) return false; // RTC still valid
+
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, true)) return false;
+        uint32_t saved = prefs.getUInt("clock", 0);
+        prefs.end();
+        if (saved < 1600000000) return false;
+
+        struct timeval tv = {(time_t)(saved + CLOCK_SKEW_SEC), 0};
+        settimeofday(&tv, nullptr);
+        Serial.printf("[WARM] Clock estimate restored: %lu\n", (unsigned long)tv.tv_sec);
+        return true;
+    }
+
+    void saveClock() {
+        time_t now = time(NULL);
+        if (now < 1600000000) return;
+
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, false)) return;
+        prefs.putUInt("clock", (uint32_t)now);
+        prefs.end();
+    }
+
+    bool loadWeather(WeatherSnapshot& target) {
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, true)) return false;
+        bool ok = prefs.getUChar("wx_fmt", 0) == WEATHER_FORMAT &&
+                  prefs.getBytes("wx", &target, sizeof(target)) == sizeof(target);
+        prefs.end();
+        return ok;
+    }
+
+    void saveWeather(const WeatherSnapshot& snapshot) {
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, false)) return;
+        prefs.putBytes("wx", &snapshot, sizeof(snapshot));
+        prefs.putUChar("wx_fmt", WEATHER_FORMAT);
+        prefs.end();
+    }
+
+    size_t loadSessions(VentSession* target, size_t maxCount) {
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, true)) return 0;
+        size_t n = 0;
+        if (prefs.getUChar("ses_fmt", 0) == SESSION_FORMAT) {
+            size_t bytes = prefs.getBytesLength("ses");
+            if (bytes % sizeof(VentSession) == 0 && bytes / sizeof(VentSession) <= maxCount) {
+                n = prefs.getBytes("ses", target, bytes) / sizeof(VentSession);
+            }
+        }
+        prefs.end();
+        return n;
+    }
+
+    void saveSessions(const VentSession* sessions, size_t count) {
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, false)) return;
+        prefs.putBytes("ses", sessions, count * sizeof(VentSession));
+        prefs.putUChar("ses_fmt", SESSION_FORMAT);
+        prefs.end();
+    }
+
+    bool loadMold(MoldIndex::State& target) {
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, true)) return false;
+        bool ok = prefs.getBytes("mold", &target, sizeof(target)) == sizeof(target);
+        prefs.end();
+        return ok;
+    }
+
+    void saveMold(const MoldIndex::State& state) {
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, false)) return;
+        // The index moves ~0.003/h at most while dry: most calls write nothing
+        MoldIndex::State stored;
+        bool known = prefs.getBytes("mold", &stored, sizeof(stored)) == sizeof(stored);
+        bool phaseChanged = (stored.dryHours > 0) != (state.dryHours > 0);
+        if (!known || phaseChanged || fabsf(stored.index - state.index) >= MOLD_SAVE_STEP) {
+            prefs.putBytes("mold", &state, sizeof(state));
+        }
+        prefs.end();
+    }
+
+}
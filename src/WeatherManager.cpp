@@ -1,68 +1,294 @@
 #include "WeatherManager.h"
+#if defined(ESP32)
+#include <HTTPClient.h>
+#endif
 #include "Settings.h"
 #include "ClimateMath.h"
+#include "WarmStart.h"
+#include "Trace.h"
+#include "HeapTags.h"
 
 const unsigned long UPDATE_INTERVAL = 10 * 60 * 1000; // 10 mins
+const uint32_t ANCHOR_DECAY_SEC = 3600; // Measured-vs-forecast offset fades out over 1h
 
-WeatherManager::WeatherManager() : outTemp(NAN), outHum(NAN), lastUpdate(0), valid(false) {}
+// Appended to WEATHER_API_URL: 48h hourly forecast, unix timestamps
+static const char* FORECAST_QUERY = "&hourly=temperature_2m,relative_humidity_2m&forecast_hours=48&timeformat=unixtime";
 
-void WeatherManager::update() {
-    if (WiFi.status() != WL_CONNECTED) return;
+// Retry policy (exponential backoff with jitter)
+const uint32_t RETRY_BASE_MS = 5000;     // 1st retry after 2.5-5s
+const uint32_t OFFLINE_POLL_MS = 2000;   // WiFi down: re-check soon, no backoff
+const uint32_t CACHED_CURRENT_MAX_AGE_SEC = 3600; // Cached 'current' block still usable
 
-    if (millis() - lastUpdate > UPDATE_INTERVAL || lastUpdate == 0) {
-        fetchWeather();
-        lastUpdate = millis();
+WeatherManager::WeatherManager(WeatherTransport* transport)
+    : transport(transport), taskHandle(nullptr), consecutiveFailures(0), nextFetchMs(0), scratch(nullptr) {
+    dataMutex = xSemaphoreCreateMutex();
+    published.outTemp = NAN;
+    published.outHum = NAN;
+    published.outAbsHum = NAN;
+    published.fetchTs = 0;
+    published.valid = false;
+    published.version = 0;
+    published.restored = false;
+    lastError[0] = '\0';
+}
+
+// -------------------------------------------------------------------------
+// Async Weather Task: all network I/O happens here, loop() never blocks
+// -------------------------------------------------------------------------
+void WeatherManager::begin() {
+    if (taskHandle) return;
+    // Core 0 next to the WiFi stack; TLS handshake needs a large stack
+    xTaskCreatePinnedToCore(
+        WeatherManager::weatherTask, // Function
+        "Weather_Task",              // Name
+        8 * 1024,                    // Stack size (8KB, mbedTLS)
+        this,                        // Param
+        1,                           // Priority (Low)
+        &taskHandle,                 // Handle
+        0                            // Core 0
+    );
+}
+
+void WeatherManager::requestRefresh() {
+    if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+void WeatherManager::weatherTask(void* parameter) {
+    WeatherManager* self = (WeatherManager*)parameter;
+    HeapTags::setTaskTag(HeapTags::WEATHER);
+
+    for(;;) {
+        bool fetched;
+        uint32_t delayMs = self->step(fetched);
+#if defined(ESP32)
+        if (fetched) WarmStart::saveWeather(*self->scratch); // Next boot starts with this result
+#endif
+        // Sleep until due; requestRefresh() wakes us early
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(delayMs));
+    }
+}
+
+// Fetch / retry state machine. Only the transport blocks, and it holds no
+// lock: readers keep getting the last published result meanwhile.
+uint32_t WeatherManager::step(bool& fetched) {
+    fetched = false;
+    // Scratch result lives on the heap, not on the (TLS-heavy) task stack
+    if (!scratch) scratch = new WeatherSnapshot();
+
+    uint32_t delayMs;
+    if (!transport || !transport->isOnline()) {
+        delayMs = OFFLINE_POLL_MS;
+    } else {
+        char error[48] = "";
+        if (fetchWeather(*scratch, error, sizeof(error))) {
+            consecutiveFailures = 0;
+            publish(scratch, "");
+            fetched = true;
+            delayMs = UPDATE_INTERVAL;
+        } else {
+            if (consecutiveFailures < 255) consecutiveFailures++;
+            publish(nullptr, error);
+            delayMs = backoffDelayMs();
+            Serial.printf("Weather Error: %s (retry %u in %lus)\n", error,
+                          (unsigned)consecutiveFailures, (unsigned long)(delayMs / 1000));
+        }
     }
+    nextFetchMs = millis() + delayMs;
+    return delayMs;
+}
+
+// 5s, 10s, 20s ... capped at the normal interval. Random point in the upper
+// half of the window so several devices do not retry in lockstep.
+uint32_t WeatherManager::backoffDelayMs() const {
+    uint8_t shift = consecutiveFailures > 0 ? consecutiveFailures - 1 : 0;
+    if (shift > 7) shift = 7;
+    uint32_t ceiling = RETRY_BASE_MS << shift;
+    if (ceiling > UPDATE_INTERVAL) ceiling = UPDATE_INTERVAL;
+    return ceiling / 2 + esp_random() % (ceiling / 2 + 1);
+}
+
+void WeatherManager::restore(const WeatherSnapshot& snapshot) {
+    WeatherSnapshot s = snapshot;
+    uint32_t now = time(NULL);
+    // The forecast stays useful for up to 48h; the 'current' block only briefly
+    s.valid = s.valid && now >= s.fetchTs && now - s.fetchTs < CACHED_CURRENT_MAX_AGE_SEC;
+    s.restored = true;
+    publish(&s, "");
+    Serial.printf("[WARM] Weather cache restored (%uh forecast, current %s)\n",
+                  (unsigned)s.forecast.size(), s.valid ? "fresh" : "stale");
+}
+
+// Word-sized reads, no lock needed
+bool WeatherManager::isLive() const { return published.version > 0 && !published.restored; }
+
+// Swaps in a complete result under the mutex; readers never see a half-parsed fetch
+void WeatherManager::publish(const WeatherSnapshot* snapshot, const char* error) {
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    if (snapshot) {
+        uint32_t version = published.version + 1;
+        published = *snapshot;
+        published.version = version;
+    } else {
+        published.valid = false; // Keep the forecast, drop the 'current' block
+    }
+    strlcpy(lastError, error, sizeof(lastError));
+    xSemaphoreGive(dataMutex);
 }
 
 // Getter for debug
-String WeatherManager::getStatusString() const {
-    if(valid) return "OK (Updated)";
-    if(lastError.length() > 0) return lastError;
-    return "Waiting...";
+size_t WeatherManager::getStatus(char* buffer, size_t len) const {
+    if (!buffer || len == 0) return 0;
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    bool hasForecast = published.forecast.covers(time(NULL));
+    int n;
+    if (published.valid) n = snprintf(buffer, len, "%s", published.restored ? "OK (Cached)" : "OK (Updated)");
+    else if (hasForecast) n = snprintf(buffer, len, lastError[0] ? "Forecast / %s" : "Forecast", lastError);
+    else if (lastError[0]) n = snprintf(buffer, len, "%s", lastError);
+    else n = snprintf(buffer, len, "Waiting...");
+    xSemaphoreGive(dataMutex);
+
+    if (n > 0 && (size_t)n < len && consecutiveFailures > 0) {
+        long wait = (long)(nextFetchMs - millis());
+        n += snprintf(buffer + n, len - n, " (retry %lds)", wait > 0 ? wait / 1000 : 0L);
+    }
+    if (n < 0) { buffer[0] = '\0'; return 0; }
+    return (size_t)n < len ? (size_t)n : len - 1;
+}
+
+bool WeatherManager::fetchWeather(WeatherSnapshot& scratch, char* error, size_t errorLen) {
+    TRACE_SCOPE("weather_fetch");
+    char url[256];
+    snprintf(url, sizeof(url), "%s%s", WEATHER_API_URL, FORECAST_QUERY);
+    if (!transport->get(url, parser, error, errorLen)) return false;
+
+    scratch.outTemp = parser.getTemp();
+    scratch.outHum = parser.getHum();
+    scratch.outAbsHum = ClimateMath::calculateAbsHumidity(scratch.outTemp, scratch.outHum);
+    scratch.fetchTs = parser.getTime() ? parser.getTime() : (uint32_t)time(NULL);
+    // Starts at hourly.time[0], not necessarily the hour of 'current'
+    parser.copyForecast(scratch.forecast);
+    scratch.valid = true;
+    scratch.restored = false;
+    Serial.printf("Weather Updated: %.1fC, %.1f%% (+%uh forecast)\n",
+                  scratch.outTemp, scratch.outHum, (unsigned)scratch.forecast.size());
+    return true;
 }
 
-void WeatherManager::fetchWeather() {
+#if defined(ESP32)
+bool HttpsWeatherTransport::isOnline() { return WiFi.status() == WL_CONNECTED; }
+
+bool HttpsWeatherTransport::get(const char* url, ForecastParser& parser, char* error, size_t errorLen) {
+    // Reuse the pinned keep-alive connection (no handshake if still open)
+    if (!https->ensureConnected(HttpsManager::Host::WEATHER)) {
+        strlcpy(error, "TLS Connect Error", errorLen);
+        return false;
+    }
+
     HTTPClient http;
-    http.begin(WEATHER_API_URL);
-    http.setTimeout(2000); // 2s timeout to prevent loop freeze
-    
+    // HTTP/1.0: no chunked transfer encoding, so the raw stream is plain JSON
+    // and can be parsed directly without buffering the payload in a String
+    http.useHTTP10(true);
+    http.begin(https->client(HttpsManager::Host::WEATHER), url);
+    http.setTimeout(5000); // Runs on its own task - a slow server no longer freezes loop()
+
     int httpCode = http.GET();
+    bool ok = false;
     if (httpCode == 200) {
-        String payload = http.getString();
-        
-        StaticJsonDocument<96> filter;
-        filter["current"]["temperature_2m"] = true;
-        filter["current"]["relative_humidity_2m"] = true;
-
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, payload, DeserializationOption::Filter(filter));
-
-        if (!error) {
-            outTemp = doc["current"]["temperature_2m"];
-            outHum = doc["current"]["relative_humidity_2m"];
-            valid = true;
-            lastError = ""; // Clear error
-            Serial.printf("Weather Updated: %.1fC, %.1f%%\n", outTemp, outHum);
-        } else {
-            lastError = "JSON Error: " + String(error.c_str());
-            Serial.println(lastError);
-        }
+        // Parsed as it arrives through the filter (no String, fixed document)
+        ok = parser.parse(http.getStream(), error, errorLen);
     } else {
-        valid = false; // Invalidate data on fetch fail? optional, but safer
-        if(httpCode > 0) lastError = "HTTP " + String(httpCode);
-        else lastError = "Timeout/Conn Error";
-        Serial.printf("Weather Error: %s\n", lastError.c_str());
+        if(httpCode > 0) snprintf(error, errorLen, "HTTP %d", httpCode);
+        else strlcpy(error, "Timeout/Conn Error", errorLen);
     }
     http.end();
+    https->touch(HttpsManager::Host::WEATHER);
+    return ok;
+}
+#endif
+
+// Forecast at 'now', shifted by the (measured - forecast) offset seen at fetch time.
+// The offset fades out so a stale 'current' value does not stick for 10 minutes.
+// Caller holds dataMutex.
+bool WeatherManager::sampleNow(float& t, float& h, float& ah) const {
+    const WeatherSnapshot& w = published;
+    uint32_t now = time(NULL);
+    if (!w.forecast.covers(now)) return false;
+    if (!w.forecast.sample(now, t, h, ah)) return false;
+
+    float ft, fh, fah;
+    if (w.valid && w.forecast.sample(w.fetchTs, ft, fh, fah)) {
+        uint32_t age = (now > w.fetchTs) ? now - w.fetchTs : 0;
+        float k = (age >= ANCHOR_DECAY_SEC) ? 0.0f : 1.0f - (float)age / ANCHOR_DECAY_SEC;
+        t += (w.outTemp - ft) * k;
+        h = constrain(h + (w.outHum - fh) * k, 0.0f, 100.0f);
+        ah += (w.outAbsHum - fah) * k;
+    }
+    return true;
+}
+
+float WeatherManager::getOutdoorTemp() const {
+    float t, h, ah;
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    if (!sampleNow(t, h, ah)) t = published.outTemp;
+    xSemaphoreGive(dataMutex);
+    return t;
+}
+
+float WeatherManager::getOutdoorHum() const {
+    float t, h, ah;
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    if (!sampleNow(t, h, ah)) h = published.outHum;
+    xSemaphoreGive(dataMutex);
+    return h;
 }
 
-float WeatherManager::getOutdoorTemp() const { return outTemp; }
-float WeatherManager::getOutdoorHum() const { return outHum; }
-float WeatherManager::getOutdoorAbsHum() const { return ClimateMath::calculateAbsHumidity(outTemp, outHum); }
-bool WeatherManager::isDataValid() const { return valid; }
+float WeatherManager::getOutdoorAbsHum() const {
+    float t, h, ah;
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    if (!sampleNow(t, h, ah)) ah = published.outAbsHum;
+    xSemaphoreGive(dataMutex);
+    return ah;
+}
+
+OutdoorSample WeatherManager::sample() const {
+    OutdoorSample s;
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    if (!sampleNow(s.temp, s.hum, s.absHum)) {
+        s.temp = published.outTemp;
+        s.hum = published.outHum;
+        s.absHum = published.outAbsHum;
+    }
+    s.valid = published.valid || published.forecast.covers(time(NULL));
+    xSemaphoreGive(dataMutex);
+    return s;
+}
+
+uint32_t WeatherManager::copyForecast(HourlyForecast& target) const {
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    target = published.forecast;
+    uint32_t version = published.version;
+    xSemaphoreGive(dataMutex);
+    return version;
+}
+
+// Word-sized read, no lock needed
+uint32_t WeatherManager::getForecastVersion() const { return published.version; }
+
+// A failed fetch is not fatal while the stored forecast still covers 'now'
+bool WeatherManager::isDataValid() const {
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    bool ok = published.valid || published.forecast.covers(time(NULL));
+    xSemaphoreGive(dataMutex);
+    return ok;
+}
 
 String WeatherManager::getConditionString() const {
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    bool valid = published.valid;
+    float outTemp = published.outTemp;
+    float outHum = published.outHum;
+    xSemaphoreGive(dataMutex);
+
     if(!valid) return "Нет данных";
     if(outTemp < 0) return "Мороз";
     if(outHum > 85) return "Влажно (Улица)";
@@ -1,6 +1,11 @@
 #include "WebManager.h"
+#include "HistoryJson.h"
+#include "Config.h"
+#include "Trace.h"
+#include "HeapTags.h"
 #if defined(ESP32)
 #include <esp_task_wdt.h>
+#include <esp_heap_caps.h>
 #endif
 
 // -------------------------------------------------------------------------
@@ -287,6 +292,11 @@ const char index_html[] PROGMEM = R"rawliteral(
         async function fetchHistory() {
             try {
                 const res = await fetch('/api/history');
+                if (res.status === 503) { // All history streams busy: retry when told
+                    const wait = parseInt(res.headers.get('Retry-After') || '2', 10);
+                    setTimeout(fetchHistory, wait * 1000);
+                    return;
+                }
                 const history = await res.json();
 
                 if (tempChart && humChart) {
@@ -321,9 +331,94 @@ const char index_html[] PROGMEM = R"rawliteral(
 </html>
 )rawliteral";
 
-WebManager::WebManager(SensorManager* sm) : server(80), sensorManager(sm) {}
+WebManager::WebManager(SensorManager* sm) : server(80), sensorManager(sm), https(nullptr), boot(nullptr), scheduler(nullptr), displayManager(nullptr), mqtt(nullptr),
+    historyStreams("history"), exportStreams("history_bin") {}
+
+void WebManager::sendBusy(AsyncWebServerRequest* request) {
+    AsyncWebServerResponse* response = request->beginResponse(503, "text/plain", "busy");
+    char retry[8];
+    snprintf(retry, sizeof(retry), "%lu", (unsigned long)STREAM_RETRY_S);
+    response->addHeader("Retry-After", retry);
+    request->send(response);
+}
+
+void WebManager::setHttpsManager(HttpsManager* hm) {
+    this->https = hm;
+}
+
+void WebManager::setBootManager(BootManager* bm) {
+    this->boot = bm;
+}
+
+void WebManager::setScheduler(Scheduler* s) {
+    this->scheduler = s;
+}
+
+void WebManager::setDisplayManager(DisplayManager* dm) {
+    this->displayManager = dm;
+}
+
+void WebManager::setMqttManager(MqttManager* mm) {
+    this->mqtt = mm;
+}
+
+// Active config, defaults and swap stats (GET and POST reply)
+static void sendConfig(AsyncWebServerRequest *request) {
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    StaticJsonDocument<1280> doc;
+    ClimateConfig cfg = Config::get();
+    JsonObject active = doc.createNestedObject("config");
+    JsonObject defaults = doc.createNestedObject("defaults");
+    for (size_t i = 0; i < Config::getFieldCount(); i++) {
+        active[Config::getFieldKey(i)] = Config::getField(cfg, i);
+        defaults[Config::getFieldKey(i)] = Config::getField(Config::defaults(), i);
+    }
+    const Config::Stats& cs = Config::getStats();
+    JsonObject st = doc.createNestedObject("stats");
+    st["swaps"] = cs.swaps;
+    st["last_swap_us"] = cs.lastSwapUs;
+    st["max_grace_us"] = cs.maxGraceUs;
+    st["read_retries"] = cs.readRetries;
+    serializeJson(doc, *response);
+    request->send(response);
+}
+
+// JSON number or null (NAN = no weather / not enough data)
+static const char* jsonNum(char* buf, size_t len, float v, int decimals) {
+    if (isnan(v)) return "null";
+    snprintf(buf, len, "%.*f", decimals, v);
+    return buf;
+}
+
+static void printSession(AsyncResponseStream* response, const VentSession& s) {
+    char b[6][16];
+    response->printf("{\"start\":%lu,\"duration_s\":%lu,\"drying_s\":%lu,\"readings\":%u,"
+                     "\"drying_exit\":\"%s\",\"exit\":\"%s\",",
+                     (unsigned long)s.start, (unsigned long)s.durationSec, (unsigned long)s.dryingSec,
+                     (unsigned)s.readings, sessionExitName(s.dryingExit), sessionExitName(s.exit));
+    response->printf("\"start_h\":%.1f,\"end_h\":%.1f,\"start_ah\":%.2f,\"min_ah\":%.2f,\"end_ah\":%.2f,"
+                     "\"start_t\":%.1f,\"min_t\":%.1f,",
+                     s.startHum, s.endHum, s.startAbsHum, s.minAbsHum, s.endAbsHum, s.startTemp, s.minTemp);
+    response->printf("\"removed\":%s,\"rate\":%s,\"peak_rate\":%s,\"heat_loss\":%s,\"out_t\":%s,\"out_ah\":%s}",
+                     jsonNum(b[0], 16, s.removed(), 2), jsonNum(b[1], 16, s.dryingRate(), 3),
+                     jsonNum(b[2], 16, s.peakRate, 3), jsonNum(b[3], 16, s.heatLoss(), 1),
+                     jsonNum(b[4], 16, s.outTemp, 1), jsonNum(b[5], 16, s.outAbsHum, 2));
+}
+
+// Charges the async_tcp task's allocations (requests, responses, chunk
+// buffers) to WEB. Registered first and never handles a request: the server
+// asks it before every other handler, on its own task.
+class HeapTagHandler : public AsyncWebHandler {
+public:
+    bool canHandle(AsyncWebServerRequest *request) override {
+        HeapTags::setTaskTag(HeapTags::WEB);
+        return false;
+    }
+};
 
 void WebManager::begin() {
+    server.addHandler(new HeapTagHandler());
+
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
         request->send_P(200, "text/html", index_html);
     });
@@ -331,7 +426,12 @@ void WebManager::begin() {
     // 1. LIGHTWEIGHT STATUS API (Calling every 3s)
     server.on("/api/status", HTTP_GET, [this](AsyncWebServerRequest *request){
         AsyncResponseStream *response = request->beginResponseStream("application/json");
-        StaticJsonDocument<512> doc; // Static allocation - no heap fragmentation
+        StaticJsonDocument<2816> doc; // Static allocation - no heap fragmentation
+        Lang lang = (request->hasParam("lang") && request->getParam("lang")->value() == "en") ? Lang::EN : Lang::RU;
+        char advice[128];
+        char weatherStatus[64];
+        sensorManager->getRecommendation(advice, sizeof(advice), lang);
+        sensorManager->getWeatherStatus(weatherStatus, sizeof(weatherStatus));
 
         float t = sensorManager->getTemp();
         float h = sensorManager->getHum();
@@ -339,37 +439,215 @@ void WebManager::begin() {
         doc["t"] = isnan(t) ? 0 : t;
         doc["h"] = isnan(h) ? 0 : h;
         doc["dp"] = sensorManager->getDewPoint();
-        doc["advice"] = sensorManager->getRecommendation();
+        doc["advice"] = advice;
         doc["code"] = sensorManager->getAdviceCode();
+        doc["t_rate"] = sensorManager->getTempRate();    // °C/min (Kalman trend)
+        doc["ah_rate"] = sensorManager->getAbsHumRate(); // g/m³/min
+
+        // VTT mold index (0..6) on the modelled coldest wall spot
+        JsonObject mold = doc.createNestedObject("mold");
+        mold["index"] = sensorManager->getMoldIndex();
+        mold["level"] = (int)sensorManager->getMoldIndex();
+        mold["rate"] = sensorManager->getMoldRate();   // Index per day
+        mold["surface_t"] = sensorManager->getSurfaceTemp();
+        mold["surface_h"] = sensorManager->getSurfaceHum();
         
         // Debug
         JsonObject dbg = doc.createNestedObject("debug");
         dbg["avg"] = sensorManager->getAvg24h();
         dbg["in_abs"] = sensorManager->getIndoorAbsHum();
         dbg["valid"] = sensorManager->isWeatherValid();
-        dbg["status"] = sensorManager->getWeatherStatus();
+        dbg["status"] = weatherStatus;
         dbg["out_t"] = sensorManager->getOutdoorTemp();
         dbg["out_h"] = sensorManager->getOutdoorHum();
         dbg["out_abs"] = sensorManager->getOutdoorAbsHum();
+
+        // Hampel outlier filter: readings replaced by the window median
+        JsonObject filter = dbg.createNestedObject("filter");
+        filter["samples"] = sensorManager->getTempFilterStats().samples;
+        filter["t_outliers"] = sensorManager->getTempFilterStats().outliers;
+        filter["h_outliers"] = sensorManager->getHumFilterStats().outliers;
+        ClimateKalman::Stats kf = sensorManager->getKalmanStats();
+        filter["kf_boosts"] = kf.boosts;     // Steps that followed a real change faster
+        filter["kf_skipped"] = kf.skipped;   // Temperature jumps > max_temp_jump
+
+        // DHT read path: failed attempts, retries, read time, stuck / implausible frames
+        SensorHealth::Stats sh = sensorManager->getSensorHealthStats();
+        JsonObject sensor = dbg.createNestedObject("sensor");
+        sensor["status"] = SensorHealth::getName(sensorManager->getSensorHealth());
+        sensor["frames"] = sh.frames;
+        sensor["checksums"] = sh.checksums;
+        sensor["timeouts"] = sh.timeouts;
+        sensor["retries"] = sh.retries;
+        sensor["recovered"] = sh.recovered;
+        sensor["lost"] = sh.lost;
+        sensor["read_us"] = sh.lastReadUs;
+        sensor["max_read_us"] = sh.maxReadUs;
+        sensor["stuck_run"] = sh.stuckRun;
+        sensor["stuck_limit"] = sh.stuckLimit;
+        sensor["implausible"] = sh.implausible;
+        sensor["error_rate"] = sh.errorRate;
+
+        // dataMutex contention (per call site: /api/locks)
+        const LockStats& ls = sensorManager->getLockStats();
+        JsonObject lk = dbg.createNestedObject("lock");
+        uint32_t acquired = 0, timeouts = 0, heldUs;
+        for (uint8_t i = 0; i < ls.getSiteCount(); i++) {
+            acquired += ls.getSite(i).acquired; // Lock-free read: totals may lag by one
+            timeouts += ls.getSite(i).timeouts;
+        }
+        int holder = ls.getHolder(heldUs);
+        lk["acquired"] = acquired;
+        lk["timeouts"] = timeouts;
+        lk["max_hold_us"] = ls.getMaxHoldUs();
+        lk["max_hold_site"] = ls.getMaxHoldSite() >= 0 ? ls.getInfo(ls.getMaxHoldSite()).name : nullptr;
+        lk["holder"] = holder >= 0 ? ls.getInfo(holder).name : nullptr;
+        lk["held_us"] = heldUs;
+
+        // Streaming admission: pool occupancy, rejections (503) and aborted streams
+        JsonObject streams = dbg.createNestedObject("streams");
+        const StreamSlots* pools[] = {&historyStreams, &exportStreams};
+        for (const StreamSlots* pool : pools) {
+            StreamSlots::Stats ss = pool->getStats();
+            JsonObject p = streams.createNestedObject(pool->getName());
+            p["cap"] = ss.capacity;
+            p["in_use"] = ss.inUse;
+            p["peak"] = ss.peak;
+            p["served"] = ss.served;
+            p["rejected"] = ss.rejected;
+            p["completed"] = ss.completed;
+            p["aborted"] = ss.aborted;
+            p["last_ms"] = ss.lastDurationMs;
+            p["max_ms"] = ss.maxDurationMs;
+        }
+
+        // TLS connection reuse metrics (per host)
+        if (https) {
+            JsonObject tls = dbg.createNestedObject("tls");
+            for (size_t i = 0; i < (size_t)HttpsManager::Host::COUNT; i++) {
+                HttpsManager::Host host = (HttpsManager::Host)i;
+                const HttpsManager::Stats& s = https->getStats(host);
+                JsonObject h = tls.createNestedObject(https->getHostName(host));
+                h["req"] = s.requests;
+                h["reused"] = s.reused;
+                h["hs"] = s.handshakes;
+                h["fail"] = s.failures;
+                h["idle_close"] = s.idleCloses;
+                h["hs_last_ms"] = s.lastHandshakeMs;
+                h["hs_max_ms"] = s.maxHandshakeMs;
+                h["hs_avg_ms"] = s.handshakes ? s.totalHandshakeMs / s.handshakes : 0;
+            }
+        }
         
+        // Boot timeline: ms since reset when each boot job finished (-1 = pending)
+        if (boot) {
+            JsonObject bt = dbg.createNestedObject("boot");
+            for (size_t i = 0; i < (size_t)BootManager::Job::COUNT; i++) {
+                BootManager::Job job = (BootManager::Job)i;
+                bt[boot->getName(job)] = boot->getDoneMs(job);
+            }
+        }
+
+        // Heap health (soak check: free/largest should stay flat over days)
+        JsonObject heap = dbg.createNestedObject("heap");
+        uint32_t freeHeap = ESP.getFreeHeap();
+        uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        heap["free"] = freeHeap;
+        heap["min_free"] = ESP.getMinFreeHeap();
+        heap["largest"] = largest;
+        heap["frag"] = freeHeap ? 100 - (largest * 100 / freeHeap) : 0; // % of free heap not in the largest block
+        heap["min_largest"] = HeapTags::getMinLargest(); // Per subsystem: /api/heap
+
+        // OLED partial refresh (full frame would be ~1040 bytes on the bus)
+        if (displayManager) {
+            DisplayManager::Stats ds = displayManager->getStats();
+            JsonObject oled = dbg.createNestedObject("oled");
+            oled["frames"] = ds.frames;
+            oled["skipped"] = ds.skipped;
+            oled["last_bytes"] = ds.lastBusBytes;
+            oled["total_bytes"] = ds.totalBusBytes;
+            oled["last_flush_us"] = ds.lastFlushUs;
+            JsonArray render = oled.createNestedArray("render_us"); // Per page: live, spark, abs_hum, session
+            for (uint8_t i = 0; i < DisplayManager::PAGE_COUNT; i++) render.add(ds.renderUs[i]);
+        }
+
+        // Main loop wake-ups (the loop sleeps until the next job deadline)
+        if (scheduler) {
+            const Scheduler::Stats& ss = scheduler->getStats();
+            JsonObject sc = dbg.createNestedObject("sched");
+            sc["wakeups"] = ss.wakeups;
+            sc["idle"] = ss.idleWakeups;
+            sc["runs"] = ss.dispatched;
+            sc["uptime_s"] = millis() / 1000;
+        }
+
+        // MQTT publisher: backlog = RAM queue + flash spill waiting for the broker
+        if (mqtt && mqtt->isEnabled()) {
+            const MqttManager::Stats& ms = mqtt->getStats();
+            JsonObject mq = dbg.createNestedObject("mqtt");
+            mq["connected"] = mqtt->isConnected();
+            mq["backlog"] = mqtt->getBacklog();
+            mq["backlog_peak"] = ms.backlogPeak;
+            mq["queued"] = ms.queued;
+            mq["published"] = ms.published;
+            mq["spilled"] = ms.spilled;
+            mq["dropped"] = ms.dropped;
+            mq["connects"] = ms.connects;
+            mq["connect_failures"] = ms.connectFailures;
+            mq["last_drain_ms"] = ms.lastDrainMs;
+            mq["last_drain_count"] = ms.lastDrainCount;
+        }
+
+        serializeJson(doc, *response);
+        request->send(response);
+    });
+
+    // 2. VENTILATION PLAN API (forecast-driven, next 24h)
+    server.on("/api/plan", HTTP_GET, [this](AsyncWebServerRequest *request){
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        StaticJsonDocument<768> doc;
+
+        VentSlot slots[VentilationPlanner::MAX_SLOTS];
+        int best;
+        size_t n = sensorManager->getPlan(slots, VentilationPlanner::MAX_SLOTS, best);
+
+        doc["generated"] = sensorManager->getPlanTime();
+        doc["recomputes"] = sensorManager->getPlanRecomputeCount();
+        doc["plan_us"] = sensorManager->getPlanMicros();
+        doc["best"] = best;
+        JsonArray arr = doc.createNestedArray("slots");
+        for (size_t i = 0; i < n; i++) {
+            JsonObject o = arr.createNestedObject();
+            o["start"] = slots[i].startTs;
+            o["min"] = slots[i].durationMin;
+            o["out_t"] = slots[i].outTemp;
+            o["out_abs"] = slots[i].outAbsHum;
+            o["removed"] = slots[i].removedAbsHum;
+            o["heat_loss"] = slots[i].heatLoss;
+            o["eff"] = slots[i].efficiency;
+        }
+
         serializeJson(doc, *response);
         request->send(response);
     });
 
-    // 2. HEAVY HISTORY API (Chunked Streaming - Zero RAM Allocation)
+    // 3. HEAVY HISTORY API (Chunked Streaming - Zero RAM Allocation)
     server.on("/api/history", HTTP_GET, [this](AsyncWebServerRequest *request){
-        // State for the chunker (Captured by value in lambda)
-        // We use a safe batch size to prevent WDT and Stack Overflow
-        struct ChunkerState {
-            size_t offset = 0;
-            bool finalized = false;
-        };
-        auto state = std::make_shared<ChunkerState>();
+        // Writer lives in a pool slot as long as the response (lease captured by value).
+        // All slots busy: 503 + Retry-After instead of another concurrent stream.
+        // ?since=<unix ts>: only newer records (incremental polling)
+        uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+        auto writer = historyStreams.acquire(sensorManager, since);
+        if (!writer) {
+            sendBusy(request);
+            return;
+        }
         
         request->send(request->beginChunkedResponse("application/json",
-            [this, state](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            [writer](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
                 // Returns 0 to signal end of stream
-                if (state->finalized) return 0;
+                if (writer->isDone()) return 0;
+                TRACE_SCOPE("history_chunk");
 
                 // CRITICAL: Yield to allow WiFi and Watchdog to breathe
                 // This prevents "Interrupt Watchdog" resets during slow transfers
@@ -378,74 +656,315 @@ void WebManager::begin() {
                 esp_task_wdt_reset();
                 #endif
 
+                return writer->fill(buffer, maxLen);
+            }
+        ));
+    });
+
+    // 3a. HISTORY AGGREGATES (from block summaries, no history download)
+    // ?from=&to= unix seconds (default: last 24 h), agg=avg|min|max|std, bucket=<s> (0 = one bucket)
+    server.on("/api/query", HTTP_GET, [this](AsyncWebServerRequest *request){
+        uint32_t now = (uint32_t)time(nullptr);
+        uint32_t to = request->hasParam("to") ? strtoul(request->getParam("to")->value().c_str(), nullptr, 10) : now;
+        uint32_t from = request->hasParam("from") ? strtoul(request->getParam("from")->value().c_str(), nullptr, 10)
+                                                  : (to > 86400 ? to - 86400 : 0);
+        uint32_t bucket = request->hasParam("bucket") ? strtoul(request->getParam("bucket")->value().c_str(), nullptr, 10) : 0;
+        String agg = request->hasParam("agg") ? request->getParam("agg")->value() : String("avg");
+        if (agg != "avg" && agg != "min" && agg != "max" && agg != "std") {
+            request->send(400, "text/plain", "agg must be avg, min, max or std");
+            return;
+        }
+        if (from > to || (bucket > 0 && (to - from) / bucket >= MAX_QUERY_BUCKETS)) {
+            request->send(400, "text/plain", "bad range or too many buckets");
+            return;
+        }
+        // 64-bit: the whole range 0..UINT32_MAX is 2^32 seconds
+        uint64_t step = bucket > 0 ? bucket : (uint64_t)to - from + 1;
+
+        auto value = [&agg](const HistoryStats& s) -> float {
+            if (agg == "min") return s.min;
+            if (agg == "max") return s.max;
+            if (agg == "std") return s.stddev();
+            return s.mean();
+        };
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->printf("{\"from\":%lu,\"to\":%lu,\"agg\":\"%s\",\"bucket\":%llu,\"data\":[",
+                         (unsigned long)from, (unsigned long)to, agg.c_str(), (unsigned long long)step);
+        uint32_t t0 = micros();
+        bool first = true;
+        for (uint64_t start = from; start <= to; start += step) {
+            uint32_t end = (start + step - 1 < to) ? (uint32_t)(start + step - 1) : to;
+            HistoryStats t, h;
+            if (!sensorManager->queryHistory((uint32_t)start, end, t, h)) break;
+            float tv = value(t);
+            float hv = value(h);
+            char tBuf[12], hBuf[12];
+            if (isnan(tv)) strcpy(tBuf, "null"); else snprintf(tBuf, sizeof(tBuf), "%.2f", tv);
+            if (isnan(hv)) strcpy(hBuf, "null"); else snprintf(hBuf, sizeof(hBuf), "%.2f", hv);
+            response->printf("%s{\"ts\":%lu,\"n\":%lu,\"t\":%s,\"h\":%s}", first ? "" : ",",
+                             (unsigned long)start, (unsigned long)t.count, tBuf, hBuf);
+            first = false;
+        }
+        response->printf("],\"us\":%lu}", (unsigned long)(micros() - t0));
+        request->send(response);
+    });
+
+    // 3b. HISTORY EXPORT (binary series file, see SeriesFile.h)
+    // ?since=<unix ts> as above; ?derived=1 adds dew point and absolute humidity columns.
+    server.on("/api/history.bin", HTTP_GET, [this](AsyncWebServerRequest *request){
+        uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+        uint8_t columns = SeriesFormat::COL_T | SeriesFormat::COL_H;
+        if (request->hasParam("derived") && request->getParam("derived")->value() == "1") {
+            columns |= SeriesFormat::COL_DP | SeriesFormat::COL_AH;
+        }
+        auto writer = exportStreams.acquire(sensorManager, since, columns, (uint32_t)time(nullptr));
+        if (!writer) {
+            sendBusy(request);
+            return;
+        }
+
+        request->send(request->beginChunkedResponse("application/octet-stream",
+            [writer](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                if (writer->isDone()) return 0;
+                TRACE_SCOPE("history_bin_chunk");
+                vTaskDelay(1);
+                return writer->fill(buffer, maxLen);
+            }
+        ));
+    });
+
+    // 3c. AIRING SESSIONS (journal, oldest first) + summary over the last ?days= (default 7)
+    // ?since=<unix ts> lists only sessions that started at or after it.
+    server.on("/api/sessions", HTTP_GET, [this](AsyncWebServerRequest *request){
+        uint32_t now = (uint32_t)time(nullptr);
+        uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+        uint32_t days = request->hasParam("days") ? strtoul(request->getParam("days")->value().c_str(), nullptr, 10) : 7;
+        if (days > MAX_SESSION_DAYS) days = MAX_SESSION_DAYS; // Reported as clamped; days * 86400 stays in range
+        uint32_t window = days * 86400;
+        SessionJournal::Summary sum;
+        if (!sensorManager->getSessionSummary(now > window ? now - window : 0, sum)) {
+            request->send(503, "text/plain", "busy");
+            return;
+        }
+
+        char b[4][16];
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->printf("{\"capacity\":%u,\"summary\":{\"days\":%lu,\"count\":%lu,\"target\":%lu,\"plateau\":%lu,"
+                         "\"rebound\":%lu,\"timeouts\":%lu,",
+                         (unsigned)SessionJournal::CAPACITY, (unsigned long)days, (unsigned long)sum.count,
+                         (unsigned long)sum.byExit[(size_t)SessionExit::TARGET_MET],
+                         (unsigned long)sum.byExit[(size_t)SessionExit::PLATEAU],
+                         (unsigned long)sum.byExit[(size_t)SessionExit::REBOUND], (unsigned long)sum.timeouts);
+        response->printf("\"avg_min\":%s,\"avg_removed\":%s,\"avg_rate\":%s,\"avg_heat_loss\":%s},\"open\":",
+                         jsonNum(b[0], 16, sum.avgMinutes, 1), jsonNum(b[1], 16, sum.avgRemoved, 2),
+                         jsonNum(b[2], 16, sum.avgRate, 3), jsonNum(b[3], 16, sum.avgHeatLoss, 1));
+        VentSession open;
+        if (sensorManager->getOpenSession(open)) printSession(response, open);
+        else response->print("null");
+
+        response->print(",\"sessions\":[");
+        VentSession batch[8]; // 512 B on the stack, one mutex hold per batch
+        size_t offset = 0, n;
+        bool first = true;
+        while ((n = sensorManager->copySessions(offset, 8, batch)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                if (batch[i].start < since) continue;
+                if (!first) response->print(",");
+                printSession(response, batch[i]);
+                first = false;
+            }
+            offset += n;
+        }
+        response->print("]}");
+        request->send(response);
+    });
+
+    // 3d. LOCK CONTENTION (dataMutex, per call site)
+    // Histograms: counts per decade of wait / hold time, bucket upper bounds in "buckets_us".
+    server.on("/api/locks", HTTP_GET, [this](AsyncWebServerRequest *request){
+        LockStats::Site sites[SensorManager::LOCK_SITE_COUNT]; // ~900 B on the stack
+        size_t n = sensorManager->copyLockStats(sites, SensorManager::LOCK_SITE_COUNT);
+        if (n == 0) {
+            request->send(503, "text/plain", "busy");
+            return;
+        }
+        const LockStats& ls = sensorManager->getLockStats();
+        uint32_t heldUs;
+        int holder = ls.getHolder(heldUs);
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->printf("{\"buckets_us\":[10,100,1000,10000,100000,null],\"max_hold_us\":%lu,\"max_hold_site\":",
+                         (unsigned long)ls.getMaxHoldUs());
+        if (ls.getMaxHoldSite() >= 0) response->printf("\"%s\"", ls.getInfo(ls.getMaxHoldSite()).name);
+        else response->print("null");
+        response->print(",\"holder\":");
+        if (holder >= 0) response->printf("\"%s\"", ls.getInfo(holder).name);
+        else response->print("null");
+        response->printf(",\"held_us\":%lu,\"sites\":[", (unsigned long)heldUs);
+        for (size_t i = 0; i < n; i++) {
+            const LockStats::Site& s = sites[i];
+            response->printf("%s{\"name\":\"%s\",\"timeout_ms\":%lu,\"acquired\":%lu,\"timeouts\":%lu,"
+                             "\"max_wait_us\":%lu,\"max_hold_us\":%lu,\"avg_wait_us\":%lu,\"avg_hold_us\":%lu,",
+                             i ? "," : "", ls.getInfo(i).name, (unsigned long)ls.getInfo(i).timeoutMs,
+                             (unsigned long)s.acquired, (unsigned long)s.timeouts,
+                             (unsigned long)s.maxWaitUs, (unsigned long)s.maxHoldUs,
+                             (unsigned long)(s.acquired ? s.totalWaitUs / s.acquired : 0),
+                             (unsigned long)(s.acquired ? s.totalHoldUs / s.acquired : 0));
+            for (int hist = 0; hist < 2; hist++) {
+                const uint32_t* counts = hist ? s.hold : s.wait;
+                response->print(hist ? ",\"hold\":[" : "\"wait\":[");
+                for (size_t b = 0; b < LockStats::BUCKETS; b++) {
+                    response->printf("%s%lu", b ? "," : "", (unsigned long)counts[b]);
+                }
+                response->print("]");
+            }
+            response->print("}");
+        }
+        response->print("]}");
+        request->send(response);
+    });
+
+    // 3e. HEAP ACCOUNTING (per subsystem tag) + fragmentation samples (oldest first)
+    server.on("/api/heap", HTTP_GET, [](AsyncWebServerRequest *request){
+        uint32_t freeHeap = ESP.getFreeHeap();
+        uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->printf("{\"free\":%lu,\"min_free\":%lu,\"largest\":%lu,\"min_largest\":%lu,\"min_largest_at\":%lu,"
+                         "\"tracked\":%u,\"untracked\":%lu,\"tags\":[",
+                         (unsigned long)freeHeap, (unsigned long)ESP.getMinFreeHeap(), (unsigned long)largest,
+                         (unsigned long)HeapTags::getMinLargest(), (unsigned long)HeapTags::getMinLargestAt(),
+                         (unsigned)HeapTags::getTracked(), (unsigned long)HeapTags::getUntracked());
+        for (uint8_t i = 0; i < HeapTags::TAG_COUNT; i++) {
+            HeapTags::Tag tag = (HeapTags::Tag)i;
+            HeapTags::Stats s = HeapTags::getStats(tag);
+            response->printf("%s{\"name\":\"%s\",\"current\":%lu,\"peak\":%lu,\"blocks\":%lu,"
+                             "\"allocs\":%lu,\"frees\":%lu,\"bytes\":%lu}",
+                             i ? "," : "", HeapTags::getName(tag), (unsigned long)s.current, (unsigned long)s.peak,
+                             (unsigned long)s.blocks, (unsigned long)s.allocs, (unsigned long)s.frees,
+                             (unsigned long)s.bytes);
+        }
+        response->print("],\"samples\":[");
+        HeapTags::Sample s;
+        for (size_t i = 0; HeapTags::getSample(i, s); i++) {
+            response->printf("%s{\"uptime_s\":%lu,\"free\":%lu,\"min_free\":%lu,\"largest\":%lu,\"frag\":%lu}",
+                             i ? "," : "", (unsigned long)s.uptimeS, (unsigned long)s.freeBytes,
+                             (unsigned long)s.minFree, (unsigned long)s.largest,
+                             (unsigned long)(s.freeBytes ? 100 - (s.largest * 100 / s.freeBytes) : 0));
+        }
+        response->print("]}");
+        request->send(response);
+    });
+
+    // 4. TRACE API (Chrome trace-event JSON, open in Perfetto / chrome://tracing)
+    // Recording is frozen while the buffers are streamed out; ?enable=0|1 toggles it.
+    server.on("/api/trace", HTTP_GET, [](AsyncWebServerRequest *request){
+        if (request->hasParam("enable")) {
+            Trace::setEnabled(request->getParam("enable")->value() != "0");
+        }
+
+        struct TraceState {
+            size_t core = 0;
+            size_t index = 0;
+            uint8_t stage = 0; // 0=header, 1=events, 2=footer, 3=done
+            uint32_t baseTs = 0;
+            ~TraceState() { Trace::thaw(); } // Also resumes if the client disconnects
+        };
+        Trace::freeze();
+        auto state = std::make_shared<TraceState>();
+        state->baseTs = Trace::getBaseTs();
+
+        request->send(request->beginChunkedResponse("application/json",
+            [state](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                if (state->stage == 3) return 0;
+                vTaskDelay(1); // Yield (same as history streaming)
+
+                char* out = (char*)buffer;
                 size_t used = 0;
-                
-                // 1. Start Array
-                if (state->offset == 0) {
-                    if (maxLen > used) buffer[used++] = '[';
+
+                if (state->stage == 0) {
+                    if (maxLen < 256) return 0; // Never happens with TCP-sized chunks
+                    used += snprintf(out, maxLen,
+                        "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+                        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"core0 (PRO)\"}},"
+                        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"core1 (APP)\"}}");
+                    state->stage = 1;
                 }
-                
-                // 2. Determine Batch Size
-                // We need enough space for at least one JSON object (~60 bytes)
-                // If buffer is tiny, wait for next chunk
-                if (maxLen - used < 64) return used;
-
-                // Max items that fit in buffer (conservative estimate)
-                size_t maxItems = (maxLen - used) / 64;
-                // Cap at 32 to ensure we yield frequent enough (approx every 10-20ms)
-                size_t batchLimit = (maxItems > 32) ? 32 : maxItems;
-                
-                if (batchLimit == 0) return used; // Should not happen given check above, but safety first
 
-                Record batch[32]; 
-                
-                // 3. Fetch Batch (Thread Safe Copy)
-                size_t count = sensorManager->copyHistory(state->offset, batchLimit, batch);
-                
-                // 4. Serialize Batch
-                for (size_t i = 0; i < count; i++) {
-                    // Check remaining space before writing
-                    size_t remaining = maxLen - used;
-                    if (remaining < 64) break; // Not enough space, continue in next chunk
-                    
-                    // Add comma if this is NOT the very first item
-                    if (state->offset > 0 || i > 0) {
-                        buffer[used++] = ',';
-                        remaining--;
+                // ~110 bytes worst case per event
+                Trace::Event e;
+                while (state->stage == 1 && maxLen - used >= 128) {
+                    if (!Trace::getEvent(state->core, state->index, e)) {
+                        if (++state->core >= Trace::CORES) state->stage = 2;
+                        state->index = 0;
+                        continue;
                     }
-                    
-                    // Format: {"t":22.5,"h":45.0,"time":1700000000}
-                    int written = snprintf((char*)(buffer + used), remaining, 
-                        "{\"t\":%.1f,\"h\":%.1f,\"time\":%lu}", 
-                        isnan(batch[i].t) ? 0.0f : batch[i].t, 
-                        isnan(batch[i].h) ? 0.0f : batch[i].h, 
-                        (unsigned long)batch[i].ts);
-                    
-                    // FIX: Proper snprintf overflow check
-                    if (written > 0 && written < (int)remaining) {
-                        used += written;
+                    state->index++;
+                    int written;
+                    if (e.phase == Trace::COUNTER) {
+                        written = snprintf(out + used, maxLen - used,
+                            ",{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%lu,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%ld}}",
+                            e.name, (unsigned long)(e.ts - state->baseTs), (unsigned)state->core, (long)e.value);
                     } else {
-                        // Truncation occurred or error, stop this batch
-                        break;
-                    }
-                }
-                
-                state->offset += count;
-
-                // 5. Finalize if Done
-                if (count == 0) {
-                    // We asked for data but got 0 -> End of Buffer
-                    if (maxLen - used >= 1) {
-                         buffer[used++] = ']';
-                         state->finalized = true;
+                        written = snprintf(out + used, maxLen - used,
+                            ",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%u}",
+                            e.name, (char)e.phase, (unsigned long)(e.ts - state->baseTs), (unsigned)state->core);
                     }
-                    // if no space for ']', we return 'used'. Next call, count will be 0 again, and we try ']' again.
+                    if (written > 0 && written < (int)(maxLen - used)) used += written;
+                    else break;
                 }
 
+                if (state->stage == 2 && maxLen - used >= 160) {
+                    Trace::Stats st = Trace::getStats();
+                    used += snprintf(out + used, maxLen - used,
+                        "],\"otherData\":{\"recorded\":%lu,\"dropped\":%lu,\"overhead_ns\":%lu,\"enabled\":%s}}",
+                        (unsigned long)st.recorded, (unsigned long)st.dropped,
+                        (unsigned long)st.overheadNs, st.enabled ? "true" : "false");
+                    state->stage = 3;
+                }
                 return used;
             }
         ));
     });
 
+    // 5. CONFIG API (runtime thresholds, persisted in NVS)
+    // GET: active values + defaults. POST ?key=value&...: validate, swap, save; ?reset=1: defaults.
+    server.on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request){
+        sendConfig(request);
+    });
+
+    server.on("/api/config", HTTP_POST, [](AsyncWebServerRequest *request){
+        if (request->hasParam("reset") || request->hasParam("reset", true)) {
+            Config::reset();
+            sendConfig(request);
+            return;
+        }
+
+        ClimateConfig cfg = Config::get();
+        char error[96];
+        for (size_t i = 0; i < (size_t)request->params(); i++) {
+            AsyncWebParameter* p = request->getParam(i);
+            char* end;
+            float value = strtof(p->value().c_str(), &end);
+            if (end == p->value().c_str() || *end != '\0') {
+                snprintf(error, sizeof(error), "{\"error\":\"%s: not a number\"}", p->name().c_str());
+                request->send(400, "application/json", error);
+                return;
+            }
+            if (!Config::setField(cfg, p->name().c_str(), value)) {
+                snprintf(error, sizeof(error), "{\"error\":\"unknown key %s\"}", p->name().c_str());
+                request->send(400, "application/json", error);
+                return;
+            }
+        }
+
+        char reason[48];
+        if (!Config::apply(cfg, reason, sizeof(reason))) {
+            snprintf(error, sizeof(error), "{\"error\":\"%s\"}", reason);
+            request->send(400, "application/json", error);
+            return;
+        }
+        Config::save();
+        sendConfig(request);
+    });
+
     server.begin();
 }
@@ -11,19 +11,39 @@
 #include "WebManager.h"
 #include "WeatherManager.h" // NEW
 #include "TelegramManager.h" // [NEW]
+#include "HttpsManager.h"
+#include "BootManager.h"
+#include "WarmStart.h"
+#include "Scheduler.h"
+#include "Trace.h"
+#include "Config.h"
+#include "MqttManager.h"
+#include "HeapTags.h"
+#include <LittleFS.h>
+#include <esp_sntp.h>
+#include <esp_heap_caps.h>
 
 // Modules
+HttpsManager httpsManager; // Shared TLS connections (must be constructed first)
 SensorManager sensorManager;
-DisplayManager displayManager;
+DisplayManager displayManager(&sensorManager);
 WebManager webManager(&sensorManager);
-WeatherManager weatherManager; // NEW
-TelegramManager telegramManager(&sensorManager); // [NEW]
+HttpsWeatherTransport weatherTransport(&httpsManager);
+WeatherManager weatherManager(&weatherTransport); // NEW
+TelegramManager telegramManager(&sensorManager, &httpsManager); // [NEW]
+WiFiMqttTransport mqttTransport;
+MqttManager mqttManager(&sensorManager, &mqttTransport); // Disabled unless MQTT_HOST is set
 
-// Timer
-unsigned long lastSensorRead = 0;
+BootManager bootManager;
+Scheduler scheduler;
+
+// Scheduler Jobs (ids)
+int bootJob, sensorJob, connJob, httpsJob, telegramJob, clockJob, mqttJob, heapJob;
+bool clockEstimated = false; // Clock seeded from NVS, waiting for NTP
+bool weatherFromCache = false;
 
 // Helper: Get Reset Reason
-String getResetReason() {
+const char* getResetReason() {
     esp_reset_reason_t reason = esp_reset_reason();
     switch (reason) {
         case ESP_RST_POWERON: return "Power On";
@@ -35,93 +55,140 @@ String getResetReason() {
         case ESP_RST_DEEPSLEEP: return "Deep Sleep Wake";
         case ESP_RST_BROWNOUT: return "Brownout (Low Voltage)";
         case ESP_RST_SDIO: return "SDIO Reset";
-        default: return "Unknown (" + String(reason) + ")";
+        default: {
+            static char unknown[24];
+            snprintf(unknown, sizeof(unknown), "Unknown (%d)", (int)reason);
+            return unknown;
+        }
     }
 }
 
-void setup() {
-    setCpuFrequencyMhz(80);
-    Serial.begin(115200);
+void refreshDisplay() {
+    // Snapshot only - rendering and I2C happen in the display task
+    DisplaySnapshot snap;
+    snap.t = sensorManager.getTemp();
+    snap.h = sensorManager.getHum();
+    snap.dp = sensorManager.getDewPoint();
+    snap.inAbsHum = sensorManager.getIndoorAbsHum();
+    snap.outAbsHum = sensorManager.getOutdoorAbsHum();
+    snap.outTemp = sensorManager.isWeatherValid() ? sensorManager.getOutdoorTemp() : NAN;
+    snap.adviceCode = sensorManager.getAdviceCode();
+    snap.state = sensorManager.getStateCode();
+    snap.stateEnterMs = sensorManager.getStateEnterTime();
+    snap.sessionStartAbsHum = sensorManager.getStateEnterAbsHum();
+    snap.moldIndex = sensorManager.getMoldIndex();
+    IPAddress addr = WiFi.localIP();
+    snprintf(snap.ip, sizeof(snap.ip), "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+    displayManager.publish(snap);
+}
 
-    // Init Modules
-    displayManager.begin();
-    displayManager.update(NAN, NAN, NAN, false, "CONNECTING...", 0, 0, "Init WiFi");
-    
-    // Connect WiFi
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASS);
-    int retries = 0;
-    while (WiFi.status() != WL_CONNECTED && retries < 20) {
-        delay(500);
-        retries++;
-    }
-    
-    if(WiFi.status() == WL_CONNECTED) {
-        displayManager.update(NAN, NAN, NAN, false, "SYNC TIME...", 0, 0, WiFi.localIP().toString());
-        
-        // Time sync
-        configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
-        struct tm timeinfo;
-        int timeRetry = 0;
-        // Wait for time (blocking up to 20s)
-        while(!getLocalTime(&timeinfo) && timeRetry < 20) {
-             delay(500);
-             timeRetry++;
-        }
-        
-        displayManager.update(NAN, NAN, NAN, false, "GET WEATHER...", 0, 0, "Weiden (DE)");
-        
-        // Weather fetch (blocking up to 10s)
-        weatherManager.update(); 
-        int wRetry = 0;
-        while(!weatherManager.isDataValid() && wRetry < 20) {
-            weatherManager.update(); // Keep trying
-            delay(500);
-            wRetry++;
-        }
-        
-    } else {
-         displayManager.update(NAN, NAN, NAN, false, "WIFI FAIL", 0, 0, "Offline Mode");
-    }
+// -------------------------------------------------------------------------
+// Boot Jobs (non-blocking: start kicks off, poll reports completion)
+// Dependencies: FIRST_SCREEN <- SENSOR, WEB/NTP/WEATHER <- WIFI, TELEGRAM <- WIFI+NTP
+// -------------------------------------------------------------------------
+void registerBootJobs() {
+    using Job = BootManager::Job;
+
+    bootManager.add(Job::SENSOR, "sensor", 0,
+        []() {
+            // Weather may still be the NVS cache here - advice works from the first reading
+            sensorManager.setWeatherManager(&weatherManager);
+            sensorManager.begin();
+        },
+        []() { return !isnan(sensorManager.getTemp()); },
+        2000);
+
+    bootManager.add(Job::FIRST_SCREEN, "first_screen", BootManager::bit(Job::SENSOR),
+        []() {
+            sensorManager.update(); // Advice + first history point
+            refreshDisplay();
+            scheduler.schedule(sensorJob, SENSOR_INTERVAL_MS, millis());
+        },
+        nullptr, 2000);
+
+    bootManager.add(Job::WIFI, "wifi", 0,
+        []() {
+            WiFi.mode(WIFI_STA);
+            WiFi.begin(WIFI_SSID, WIFI_PASS);
+        },
+        []() { return WiFi.status() == WL_CONNECTED; },
+        10000);
+
+    bootManager.add(Job::WEB, "web", BootManager::bit(Job::WIFI),
+        []() {
+            webManager.setHttpsManager(&httpsManager);
+            webManager.setBootManager(&bootManager);
+            webManager.setScheduler(&scheduler);
+            webManager.setDisplayManager(&displayManager);
+            webManager.setMqttManager(&mqttManager);
+            webManager.begin();
+            refreshDisplay(); // Show IP
+        },
+        nullptr, 1000);
+
+    bootManager.add(Job::NTP, "ntp", BootManager::bit(Job::WIFI),
+        []() { configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER); },
+        []() {
+            // An NVS clock estimate already passes the "time valid" check - wait for real sync
+            if (sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED) return true;
+            return !clockEstimated && time(NULL) >= 1600000000;
+        },
+        10000);
 
-    // NOW start sensors (timestamps will be correct)
-    displayManager.update(NAN, NAN, NAN, false, "STARTING...", 0, 0, "Sensors Init");
-    
-    // 4. Managers Init — ALWAYS set weather manager (even if offline for status reporting)
-    sensorManager.setWeatherManager(&weatherManager);
-    weatherManager.update(); // Will fail gracefully if no WiFi
-    sensorManager.begin();
-    webManager.begin();
-    
-    // Telegram Init
-    telegramManager.begin();
-    String reason = getResetReason();
-    telegramManager.broadcastAlert("🟢 **Система Запущена**\nВерсия: v5.2 (Smart Detection)\nПричина: " + reason, 1);
-
-    lastSensorRead = millis(); // Reset timer
-    
-    // First read
-    sensorManager.update();
-
-    displayManager.update(
-        sensorManager.getTemp(), 
-        sensorManager.getHum(), 
-        sensorManager.getDewPoint(), 
-        false, 
-        sensorManager.getRecommendation(),
-        sensorManager.getAdviceCode(), // [NEW] Code
-        sensorManager.getStateCode(),  // [NEW] State
-        WiFi.localIP().toString()
-    );
+    bootManager.add(Job::WEATHER, "weather", BootManager::bit(Job::WIFI),
+        []() { weatherManager.requestRefresh(); },
+        []() { return weatherManager.isLive(); },
+        10000);
+
+    bootManager.add(Job::TELEGRAM, "telegram", BootManager::bit(Job::WIFI) | BootManager::bit(Job::NTP),
+        []() {
+            HeapTags::Scope tag(HeapTags::TELEGRAM);
+            clockEstimated = false;
+            telegramManager.begin();
+            char msg[256];
+            int n = snprintf(msg, sizeof(msg), "🟢 **Система Запущена**\nВерсия: v5.2 (Smart Detection)\nПричина: %s",
+                             getResetReason());
+            int32_t firstMs = bootManager.getDoneMs(BootManager::Job::FIRST_SCREEN);
+            if (firstMs >= 0 && n < (int)sizeof(msg)) {
+                n += snprintf(msg + n, sizeof(msg) - n, "\nПервое показание: %ld мс", (long)firstMs);
+            }
+            if (weatherFromCache && n < (int)sizeof(msg)) {
+                snprintf(msg + n, sizeof(msg) - n, "\nПогода при старте: из кэша");
+            }
+            telegramManager.broadcastAlert(msg, 1);
+            scheduler.schedule(telegramJob, 3000, millis());
+        },
+        nullptr, 5000);
 }
 
-void loop() {
-    unsigned long now = millis();
+// -------------------------------------------------------------------------
+// Loop Jobs (return ms until next run, Scheduler::STOP = idle)
+// -------------------------------------------------------------------------
+void registerLoopJobs() {
+    // Boot jobs need fast polling only until everything is up
+    bootJob = scheduler.add("boot", []() -> uint32_t {
+        bootManager.poll();
+        if (bootManager.isComplete()) {
+            bootManager.poll(); // Prints the timeline
+            return Scheduler::STOP;
+        }
+        return 20;
+    }, 3);
+
+    // Sensor logic + OLED refresh (Adaptive: 10s in rapid mode, 2 mins default)
+    sensorJob = scheduler.add("sensor", []() -> uint32_t {
+        sensorManager.update();
+        refreshDisplay(); // Update OLED immediately after new data
+        uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        HeapTags::observe(largest, millis() / 1000);
+        TRACE_COUNTER("heap_free", ESP.getFreeHeap());
+        TRACE_COUNTER("heap_largest", largest);
+        return sensorManager.isRapidChange() ? 10000 : SENSOR_INTERVAL_MS;
+    }, 2);
 
-    // 0. Periodic Connectivity Check (every 30s)
-    static unsigned long lastConnCheck = 0;
-    if (now - lastConnCheck > 30000) {
-        lastConnCheck = now;
+    // Periodic Connectivity Check (once boot brought WiFi up)
+    connJob = scheduler.add("conn", []() -> uint32_t {
+        if (!bootManager.isDone(BootManager::Job::WIFI)) return 30000;
         if (WiFi.status() != WL_CONNECTED) {
             Serial.println("[WIFI] Reconnecting...");
             WiFi.reconnect();
@@ -131,36 +198,111 @@ void loop() {
             Serial.println("[NTP] Time invalid, re-syncing...");
             configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
         }
-    }
+        return 30000;
+    }, 1);
+
+    // Releases idle TLS connections
+    httpsJob = scheduler.add("https", []() -> uint32_t {
+        httpsManager.update();
+        return 1000;
+    }, 0);
+
+    // Incoming messages + state alerts (started by the TELEGRAM boot job)
+    telegramJob = scheduler.add("telegram", []() -> uint32_t {
+        HeapTags::Scope tag(HeapTags::TELEGRAM);
+        telegramManager.update();
+        return 3000;
+    }, 0);
 
-    // 1. Core Updates (Polling)
-    telegramManager.update(); // Handles incoming messages (non-blocking)
+    // MQTT: batching, reconnect, backlog drain (fast while a backlog is pending)
+    mqttJob = scheduler.add("mqtt", []() -> uint32_t {
+        HeapTags::Scope tag(HeapTags::MQTT);
+        return mqttManager.update();
+    }, 1);
+
+    // Heap history for /api/heap: fragmentation over the last 24 h
+    heapJob = scheduler.add("heap", []() -> uint32_t {
+        HeapTags::addSample({millis() / 1000, ESP.getFreeHeap(), ESP.getMinFreeHeap(),
+                             heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)});
+        return 30 * 60 * 1000;
+    }, 0);
+
+    // Warm start backups: wall clock (only meaningful after NTP sync), mold index, session journal
+    clockJob = scheduler.add("clock", []() -> uint32_t {
+        if (bootManager.isDone(BootManager::Job::NTP)) WarmStart::saveClock();
+        WarmStart::saveMold(sensorManager.getMoldState());
+        // Session journal: only when a session has been added since the last save
+        static uint32_t savedSessions = 0;
+        uint32_t closedSessions = sensorManager.getSessionsClosed();
+        if (closedSessions != savedSessions) {
+            VentSession* sessions = new VentSession[SessionJournal::CAPACITY]; // 3 KB, released right after
+            size_t n = sensorManager.copySessions(0, SessionJournal::CAPACITY, sessions);
+            if (n > 0) {
+                WarmStart::saveSessions(sessions, n);
+                savedSessions = closedSessions;
+            }
+            delete[] sessions;
+        }
+        return 10 * 60 * 1000;
+    }, 0);
 
-    // 2. Periodic Sensor & Logic Update (Adaptive)
-    unsigned long dynamicInterval = SENSOR_INTERVAL_MS; // Default 2 mins
-    if(sensorManager.isRapidChange()) {
-        dynamicInterval = 10000; // 10 seconds (Rapid Mode)
+    unsigned long now = millis();
+    scheduler.schedule(bootJob, 0, now);
+    scheduler.schedule(connJob, 30000, now);
+    scheduler.schedule(httpsJob, 1000, now);
+    scheduler.schedule(clockJob, 10 * 60 * 1000, now);
+    scheduler.schedule(heapJob, 60 * 1000, now); // First sample once boot allocations settled
+    if (mqttManager.isEnabled()) scheduler.schedule(mqttJob, 1000, now);
+}
+
+void setup() {
+    setCpuFrequencyMhz(80);
+    Serial.begin(115200);
+    Trace::begin();
+    Config::begin(); // Runtime thresholds (NVS override or Settings.h defaults)
+
+    // Warm start: clock estimate + last weather result from NVS
+    clockEstimated = WarmStart::restoreClock();
+    WeatherSnapshot* cached = new WeatherSnapshot();
+    if (WarmStart::loadWeather(*cached)) {
+        weatherManager.restore(*cached);
+        weatherFromCache = true;
     }
+    delete cached;
+    MoldIndex::State mold;
+    if (WarmStart::loadMold(mold)) sensorManager.restoreMold(mold);
+    VentSession* sessions = new VentSession[SessionJournal::CAPACITY];
+    sensorManager.restoreSessions(sessions, WarmStart::loadSessions(sessions, SessionJournal::CAPACITY));
+    delete[] sessions;
+
+    // Init Modules
+    displayManager.begin();
+    DisplaySnapshot bootSnap = {NAN, NAN, NAN, NAN, NAN, NAN, 0, 0, 0, NAN, NAN, "Init"};
+    displayManager.publish(bootSnap);
+    weatherManager.begin(); // Background task: fetches as soon as WiFi is up
 
-    if (now - lastSensorRead >= dynamicInterval) {
-        lastSensorRead = now;
-        
-        weatherManager.update(); // Checks if 10m passed
-        sensorManager.update();  // Actual sensor read
-        
-        // Update OLED immediately after new data
-        displayManager.update(
-            sensorManager.getTemp(), 
-            sensorManager.getHum(), 
-            sensorManager.getDewPoint(), 
-            false, 
-            sensorManager.getRecommendation(),
-            sensorManager.getAdviceCode(),
-            sensorManager.getStateCode(),
-            WiFi.localIP().toString()
-        );
+    // MQTT (optional): hooked before the sensor task starts so no transition is missed
+    if (mqttManager.isEnabled()) {
+        HeapTags::Scope tag(HeapTags::MQTT); // RAM queue + transmit buffer
+        char deviceId[16];
+        snprintf(deviceId, sizeof(deviceId), "acm1_%06x", (unsigned)((ESP.getEfuseMac() >> 24) & 0xFFFFFF));
+        mqttManager.begin(deviceId);
+        // Offline backlog beyond the RAM queue survives resets in flash
+        if (MQTT_SPILL_BYTES > 0 && LittleFS.begin(true)) mqttManager.setSpillFile("/littlefs/mqtt.q", MQTT_SPILL_BYTES);
+        sensorManager.setMqttManager(&mqttManager);
     }
-    
-    // 3. Yield to system tasks (CRITICAL for WiFi stability)
-    delay(1);
-}
\ No newline at end of file
+
+    // Everything else runs as concurrent boot jobs driven by the scheduler
+    registerBootJobs();
+    registerLoopJobs();
+    bootManager.poll();
+}
+
+void loop() {
+    // Run due jobs, then sleep until the next deadline (no busy polling).
+    // delay() yields to WiFi / system tasks; the async web server has its own task.
+    TRACE_BEGIN("loop_jobs");
+    uint32_t sleepMs = scheduler.runDue(millis());
+    TRACE_END("loop_jobs");
+    delay(sleepMs == Scheduler::NEVER ? 1000 : sleepMs);
+}
@@ -0,0 +1,666 @@
+// ACM-1 fleet collector (Linux).
+//
+// Polls /api/history (incrementally, ?since=<last stored ts>) and /api/status
+// of many devices from one epoll loop on one thread, appends new history
+// points to a columnar store per device and serves range queries for
+// Grafana (JSON datasource protocol) from a second thread.
+//
+// GET /export?device=<name>[&from=&to=] returns the stored history of one
+// device as a series file (SeriesFile.h).
+//
+//   collector --devices devices.txt [--data fleet] [--listen 8086]
+//             [--history-interval 60] [--status-interval 15]
+//             [--max-inflight 256] [--timeout 5000] [--stats 10]
+//
+// devices.txt: one "name host[:port]" per line, '#' starts a comment.
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FleetJson.h"
+#include "FleetStore.h"
+#include "HttpParser.h"
+#include "SeriesFile.h"
+
+static std::atomic<bool> running{true};
+
+static uint64_t nowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static uint64_t threadCpuUs() {
+    rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+struct Options {
+    const char* devicesFile = nullptr;
+    std::string dataDir = "fleet";
+    uint16_t listenPort = 8086;
+    uint32_t historyIntervalMs = 60000;
+    uint32_t statusIntervalMs = 15000;
+    size_t maxInflight = 256;
+    uint32_t timeoutMs = 5000;
+    uint32_t statsMs = 10000;
+};
+
+// Latest /api/status of a device (written by the poller, read by queries)
+struct DeviceStatus {
+    bool online = false;
+    uint32_t lastSeen = 0;      // Wall clock of the last good response
+    uint32_t failures = 0;      // Consecutive failed requests
+    double t = NAN, h = NAN, tRate = NAN, ahRate = NAN;
+    int code = -1;
+    double uptime = NAN, heapFree = NAN;
+};
+
+struct Device {
+    enum Phase { IDLE, CONNECTING, SENDING, READING };
+    enum Kind { HISTORY, STATUS };
+
+    std::string name;
+    sockaddr_in addr;
+    std::string host;           // Host header
+    int series;
+
+    Phase phase = IDLE;
+    Kind kind = HISTORY;
+    int fd = -1;
+    std::string request;
+    size_t sent = 0;
+    uint64_t startMs = 0;
+    HttpResponseParser parser;
+    uint64_t nextHistoryMs = 0;
+    uint64_t nextStatusMs = 0;
+
+    std::mutex statusMutex;
+    DeviceStatus status;
+};
+
+struct PollStats {
+    uint64_t requests = 0;
+    uint64_t failed = 0;
+    uint64_t busy = 0;       // 503 from a device whose stream slots were full
+    uint64_t bytesIn = 0;
+    uint64_t records = 0;
+    uint64_t latencyMsSum = 0;
+    size_t inflightPeak = 0;
+};
+
+// -------------------------------------------------------------------------
+// Poller (one thread, non-blocking sockets, epoll)
+// -------------------------------------------------------------------------
+class Poller {
+public:
+    Poller(const Options& opt, FleetStore& store, std::vector<Device*>& devices)
+        : opt(opt), store(store), devices(devices), inflight(0) {
+        epfd = epoll_create1(0);
+    }
+
+    void run() {
+        uint64_t start = nowMs();
+        // Spread the first polls over the interval (no thundering herd)
+        for (size_t i = 0; i < devices.size(); i++) {
+            devices[i]->nextStatusMs = start + opt.statusIntervalMs * i / devices.size();
+            devices[i]->nextHistoryMs = start + opt.historyIntervalMs * i / devices.size();
+        }
+        uint64_t statsStart = start;
+        uint64_t cpuStart = threadCpuUs();
+        epoll_event events[256];
+        while (running) {
+            uint64_t now = nowMs();
+            startDue(now);
+            expire(now);
+            int n = epoll_wait(epfd, events, 256, 20);
+            for (int i = 0; i < n; i++) onEvent((Device*)events[i].data.ptr, events[i].events);
+
+            if (opt.statsMs && now - statsStart >= opt.statsMs) {
+                uint64_t cpu = threadCpuUs();
+                double wall = (now - statsStart) / 1000.0;
+                printf("[poll] %.0fs: %llu req (%llu failed, %llu busy), %.1f KB in, %llu new points, avg %.1f ms, "
+                       "inflight peak %zu, cpu %.1f ms (%.2f%%)\n",
+                       wall, (unsigned long long)stats.requests, (unsigned long long)stats.failed,
+                       (unsigned long long)stats.busy,
+                       stats.bytesIn / 1024.0, (unsigned long long)stats.records,
+                       stats.requests ? (double)stats.latencyMsSum / stats.requests : 0.0, stats.inflightPeak,
+                       (cpu - cpuStart) / 1000.0, (cpu - cpuStart) / (wall * 10000.0));
+                fflush(stdout);
+                stats = PollStats();
+                statsStart = now;
+                cpuStart = cpu;
+            }
+        }
+    }
+
+private:
+    const Options& opt;
+    FleetStore& store;
+    std::vector<Device*>& devices;
+    int epfd;
+    size_t inflight;
+    PollStats stats;
+
+    void startDue(uint64_t now) {
+        for (Device* d : devices) {
+            if (inflight >= opt.maxInflight) return;
+            if (d->phase != Device::IDLE) continue;
+            // Status first when both are due (cheap, tells if the device is up)
+            if (now >= d->nextStatusMs) start(d, Device::STATUS, now);
+            else if (now >= d->nextHistoryMs) start(d, Device::HISTORY, now);
+        }
+    }
+
+    void start(Device* d, Device::Kind kind, uint64_t now) {
+        char req[256];
+        if (kind == Device::HISTORY) {
+            uint32_t since = store.get(d->series)->lastTs();
+            snprintf(req, sizeof(req),
+                     "GET /api/history?since=%u HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n", since, d->host.c_str());
+        } else {
+            snprintf(req, sizeof(req), "GET /api/status HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n", d->host.c_str());
+        }
+        d->kind = kind;
+        d->request = req;
+        d->sent = 0;
+        d->startMs = now;
+        d->parser.reset();
+
+        d->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (d->fd < 0) {
+            fail(d);
+            return;
+        }
+        int one = 1;
+        setsockopt(d->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        inflight++;
+        if (inflight > stats.inflightPeak) stats.inflightPeak = inflight;
+        stats.requests++;
+        int rc = connect(d->fd, (sockaddr*)&d->addr, sizeof(d->addr));
+        if (rc < 0 && errno != EINPROGRESS) {
+            fail(d);
+            return;
+        }
+        d->phase = Device::CONNECTING;
+        epoll_event ev = {};
+        ev.events = EPOLLOUT;
+        ev.data.ptr = d;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, d->fd, &ev);
+    }
+
+    void expire(uint64_t now) {
+        for (Device* d : devices) {
+            if (d->phase != Device::IDLE && now - d->startMs > opt.timeoutMs) fail(d);
+        }
+    }
+
+    void onEvent(Device* d, uint32_t events) {
+        if (d->phase == Device::CONNECTING) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(d->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0) {
+                fail(d);
+                return;
+            }
+            d->phase = Device::SENDING;
+        }
+        if (d->phase == Device::SENDING) {
+            while (d->sent < d->request.size()) {
+                ssize_t n = send(d->fd, d->request.data() + d->sent, d->request.size() - d->sent, MSG_NOSIGNAL);
+                if (n < 0) {
+                    if (errno == EAGAIN) return;
+                    fail(d);
+                    return;
+                }
+                d->sent += n;
+            }
+            d->phase = Device::READING;
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.ptr = d;
+            epoll_ctl(epfd, EPOLL_CTL_MOD, d->fd, &ev);
+            return;
+        }
+        if (d->phase != Device::READING) return;
+
+        char buf[16384];
+        for (;;) {
+            ssize_t n = recv(d->fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                stats.bytesIn += n;
+                if (!d->parser.feed(buf, n)) break;
+                if (d->parser.isDone()) break;
+                continue;
+            }
+            if (n == 0) {
+                d->parser.finish();
+                break;
+            }
+            if (errno == EAGAIN) return;
+            fail(d);
+            return;
+        }
+        if (d->parser.isDone() && d->parser.getStatus() == 200) complete(d);
+        else if (d->parser.isDone() && d->parser.getStatus() == 503) busy(d);
+        else fail(d);
+    }
+
+    void close(Device* d) {
+        if (d->fd >= 0) {
+            epoll_ctl(epfd, EPOLL_CTL_DEL, d->fd, nullptr);
+            ::close(d->fd);
+            inflight--;
+        }
+        d->fd = -1;
+        d->phase = Device::IDLE;
+    }
+
+    void schedule(Device* d) {
+        uint64_t now = nowMs();
+        if (d->kind == Device::HISTORY) d->nextHistoryMs = now + opt.historyIntervalMs;
+        else d->nextStatusMs = now + opt.statusIntervalMs;
+    }
+
+    void fail(Device* d) {
+        stats.failed++;
+        close(d);
+        {
+            std::lock_guard<std::mutex> lock(d->statusMutex);
+            d->status.failures++;
+            d->status.online = false;
+        }
+        schedule(d); // Retry at the normal interval
+    }
+
+    // Device is up but has no free stream slot: not a failure, retry when told
+    void busy(Device* d) {
+        stats.busy++;
+        int retry = d->parser.getRetryAfter();
+        uint64_t waitMs = (retry > 0 && retry < 60) ? retry * 1000ull : 2000;
+        close(d);
+        if (d->kind == Device::HISTORY) d->nextHistoryMs = nowMs() + waitMs;
+        else d->nextStatusMs = nowMs() + waitMs;
+    }
+
+    void complete(Device* d) {
+        const std::string& body = d->parser.getBody();
+        stats.latencyMsSum += nowMs() - d->startMs;
+        if (d->kind == Device::HISTORY) {
+            std::vector<FleetRecord> records;
+            FleetJson::parseHistory(body.data(), body.size(), records);
+            stats.records += store.get(d->series)->append(records);
+        } else {
+            DeviceStatus s;
+            const char* j = body.data();
+            size_t n = body.size();
+            FleetJson::findNumber(j, n, "t", s.t);
+            FleetJson::findNumber(j, n, "h", s.h);
+            FleetJson::findNumber(j, n, "t_rate", s.tRate);
+            FleetJson::findNumber(j, n, "ah_rate", s.ahRate);
+            FleetJson::findNumber(j, n, "uptime_s", s.uptime);
+            FleetJson::findNumber(j, n, "free", s.heapFree);
+            double code;
+            if (FleetJson::findNumber(j, n, "code", code)) s.code = (int)code;
+            s.online = true;
+            s.lastSeen = (uint32_t)time(nullptr);
+            std::lock_guard<std::mutex> lock(d->statusMutex);
+            d->status = s;
+        }
+        close(d);
+        schedule(d);
+    }
+};
+
+// -------------------------------------------------------------------------
+// Query server (Grafana JSON datasource + /devices)
+// -------------------------------------------------------------------------
+class QueryServer {
+public:
+    QueryServer(FleetStore& store, std::vector<Device*>& devices) : store(store), devices(devices) {}
+
+    bool listenOn(uint16_t port) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 64) != 0) return false;
+        epfd = epoll_create1(0);
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, listenFd, &ev);
+        return true;
+    }
+
+    void run() {
+        epoll_event events[64];
+        while (running) {
+            int n = epoll_wait(epfd, events, 64, 200);
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) accept();
+                else onEvent(fd, events[i].events);
+            }
+        }
+    }
+
+private:
+    struct Conn {
+        std::string in;
+        std::string out;
+        size_t sent = 0;
+    };
+    FleetStore& store;
+    std::vector<Device*>& devices;
+    int listenFd = -1;
+    int epfd = -1;
+    std::map<int, Conn> conns;
+
+    void accept() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            conns[fd] = Conn();
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+        }
+    }
+
+    void drop(int fd) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        conns.erase(fd);
+    }
+
+    void onEvent(int fd, uint32_t events) {
+        auto it = conns.find(fd);
+        if (it == conns.end()) return;
+        Conn& c = it->second;
+        if (c.out.empty()) {
+            char buf[8192];
+            for (;;) {
+                ssize_t n = recv(fd, buf, sizeof(buf), 0);
+                if (n > 0) {
+                    c.in.append(buf, n);
+                    continue;
+                }
+                if (n < 0 && errno == EAGAIN) break;
+                drop(fd);
+                return;
+            }
+            HttpRequest req;
+            long used = parseHttpRequest(c.in, req);
+            if (used == 0) return;
+            if (used < 0) c.out = response(400, "text/plain", "bad request\n");
+            else c.out = handle(req);
+            epoll_event ev = {};
+            ev.events = EPOLLOUT;
+            ev.data.fd = fd;
+            epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+        }
+        while (c.sent < c.out.size()) {
+            ssize_t n = send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN) return;
+                break;
+            }
+            c.sent += n;
+        }
+        drop(fd); // Connection: close
+    }
+
+    static std::string response(int status, const char* type, const std::string& body) {
+        char head[256];
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                 "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n",
+                 status, status == 200 ? "OK" : (status == 404 ? "Not Found" : "Bad Request"), type, body.size());
+        return head + body;
+    }
+
+    static void appendNumber(std::string& out, double v, const char* fmt = "%.2f") {
+        if (isnan(v)) {
+            out += "null";
+            return;
+        }
+        char buf[32];
+        snprintf(buf, sizeof(buf), fmt, v);
+        out += buf;
+    }
+
+    std::string handle(const HttpRequest& req) {
+        if (req.path == "/") return response(200, "text/plain", "ACM-1 fleet collector\n");
+        if (req.path == "/search" || req.path == "/metrics") return response(200, "application/json", search());
+        if (req.path == "/query") return response(200, "application/json", query(req.body));
+        if (req.path == "/devices") return response(200, "application/json", deviceList());
+        if (req.path == "/export") return exportSeries(req);
+        return response(404, "text/plain", "not found\n");
+    }
+
+    // Metric names: "<device>:t", "<device>:h", plus "*:t" / "*:h" (every device)
+    std::string search() {
+        std::string out = "[\"*:t\",\"*:h\"";
+        for (size_t i = 0; i < store.count(); i++) {
+            out += ",\"" + store.name(i) + ":t\",\"" + store.name(i) + ":h\"";
+        }
+        return out + "]";
+    }
+
+    // {"range":{"from":"...","to":"..."},"maxDataPoints":N,"targets":[{"target":"dev:t"},...]}
+    // -> [{"target":"dev:t","datapoints":[[value, ms], ...]}, ...]
+    std::string query(const std::string& body) {
+        std::string fromStr, toStr;
+        FleetJson::findString(body.data(), body.size(), "from", fromStr);
+        FleetJson::findString(body.data(), body.size(), "to", toStr);
+        uint32_t from = FleetJson::parseIsoTime(fromStr);
+        uint32_t to = FleetJson::parseIsoTime(toStr);
+        if (to == 0) to = UINT32_MAX;
+        double maxPoints = 0;
+        FleetJson::findNumber(body.data(), body.size(), "maxDataPoints", maxPoints);
+        std::vector<std::string> targets;
+        FleetJson::findTargets(body.data(), body.size(), targets);
+
+        std::string out = "[";
+        std::vector<std::pair<float, uint32_t>> points;
+        bool firstSeries = true;
+        for (const std::string& target : targets) {
+            size_t colon = target.rfind(':');
+            if (colon == std::string::npos) continue;
+            std::string dev = target.substr(0, colon);
+            DeviceSeries::Column column = (target.substr(colon + 1) == "t") ? DeviceSeries::TEMP : DeviceSeries::HUM;
+            for (size_t i = 0; i < store.count(); i++) {
+                if (dev != "*" && dev != store.name(i)) continue;
+                points.clear();
+                store.get(i)->range(column, from, to, (size_t)maxPoints, points);
+                if (!firstSeries) out += ",";
+                firstSeries = false;
+                out += "{\"target\":\"" + store.name(i) + target.substr(colon) + "\",\"datapoints\":[";
+                char buf[48];
+                for (size_t k = 0; k < points.size(); k++) {
+                    int n = isnan(points[k].first)
+                        ? snprintf(buf, sizeof(buf), "%s[null,%llu]", k ? "," : "", points[k].second * 1000ULL)
+                        : snprintf(buf, sizeof(buf), "%s[%.2f,%llu]", k ? "," : "", points[k].first, points[k].second * 1000ULL);
+                    out.append(buf, n);
+                }
+                out += "]}";
+            }
+        }
+        return out + "]";
+    }
+
+    std::string exportSeries(const HttpRequest& req) {
+        int index = store.find(queryParam(req.query, "device"));
+        if (index < 0) return response(404, "text/plain", "unknown device\n");
+        std::string from = queryParam(req.query, "from");
+        std::string to = queryParam(req.query, "to");
+        std::vector<FleetRecord> records;
+        store.get(index)->snapshot(from.empty() ? 0 : strtoul(from.c_str(), nullptr, 10),
+                                   to.empty() ? UINT32_MAX : strtoul(to.c_str(), nullptr, 10), records);
+
+        SeriesWriter writer(SeriesFormat::COL_T | SeriesFormat::COL_H, (uint32_t)time(nullptr));
+        std::string body;
+        uint8_t buf[4096];
+        size_t n;
+        for (const FleetRecord& r : records) {
+            while (!writer.append(r.ts, r.t, r.h)) {
+                while ((n = writer.read(buf, sizeof(buf))) > 0) body.append((const char*)buf, n);
+            }
+        }
+        writer.finish();
+        while ((n = writer.read(buf, sizeof(buf))) > 0) body.append((const char*)buf, n);
+        return response(200, "application/octet-stream", body);
+    }
+
+    std::string deviceList() {
+        std::string out = "[";
+        for (size_t i = 0; i < devices.size(); i++) {
+            Device* d = devices[i];
+            DeviceStatus s;
+            {
+                std::lock_guard<std::mutex> lock(d->statusMutex);
+                s = d->status;
+            }
+            DeviceSeries* series = store.get(d->series);
+            char head[160];
+            snprintf(head, sizeof(head), "%s{\"name\":\"%s\",\"online\":%s,\"last_seen\":%u,\"failures\":%u,\"points\":%zu,\"last_ts\":%u",
+                     i ? "," : "", d->name.c_str(), s.online ? "true" : "false", s.lastSeen, s.failures,
+                     series->size(), series->lastTs());
+            out += head;
+            out += ",\"t\":";
+            appendNumber(out, s.t);
+            out += ",\"h\":";
+            appendNumber(out, s.h);
+            out += ",\"t_rate\":";
+            appendNumber(out, s.tRate, "%.3f");
+            out += ",\"ah_rate\":";
+            appendNumber(out, s.ahRate, "%.3f");
+            out += ",\"code\":" + std::to_string(s.code);
+            out += ",\"uptime_s\":";
+            appendNumber(out, s.uptime, "%.0f");
+            out += ",\"heap_free\":";
+            appendNumber(out, s.heapFree, "%.0f");
+            out += "}";
+        }
+        return out + "]";
+    }
+};
+
+// -------------------------------------------------------------------------
+// Setup
+// -------------------------------------------------------------------------
+static bool loadDevices(const char* path, FleetStore& store, std::vector<Device*>& devices) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char* hash = strchr(line, '#');
+        if (hash) *hash = 0;
+        char name[128], hostPort[256];
+        if (sscanf(line, "%127s %255s", name, hostPort) != 2) continue;
+        std::string host = hostPort;
+        std::string port = "80";
+        size_t colon = host.rfind(':');
+        if (colon != std::string::npos) {
+            port = host.substr(colon + 1);
+            host.resize(colon);
+        }
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* res = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) {
+            fprintf(stderr, "cannot resolve %s\n", hostPort);
+            continue;
+        }
+        Device* d = new Device();
+        d->name = name;
+        d->host = hostPort;
+        memcpy(&d->addr, res->ai_addr, sizeof(d->addr));
+        freeaddrinfo(res);
+        d->series = store.add(name);
+        if (d->series < 0) {
+            fprintf(stderr, "cannot open store for %s\n", name);
+            delete d;
+            continue;
+        }
+        devices.push_back(d);
+    }
+    fclose(f);
+    return !devices.empty();
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        const char* v = argv[i + 1];
+        if (key == "--devices") opt.devicesFile = v;
+        else if (key == "--data") opt.dataDir = v;
+        else if (key == "--listen") opt.listenPort = (uint16_t)atoi(v);
+        else if (key == "--history-interval") opt.historyIntervalMs = atoi(v) * 1000;
+        else if (key == "--status-interval") opt.statusIntervalMs = atoi(v) * 1000;
+        else if (key == "--max-inflight") opt.maxInflight = atoi(v);
+        else if (key == "--timeout") opt.timeoutMs = atoi(v);
+        else if (key == "--stats") opt.statsMs = atoi(v) * 1000;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (!opt.devicesFile) {
+        fprintf(stderr, "usage: collector --devices devices.txt [--data dir] [--listen port] ...\n");
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, [](int) { running = false; });
+    signal(SIGTERM, [](int) { running = false; });
+
+    FleetStore store(opt.dataDir);
+    std::vector<Device*> devices;
+    if (!loadDevices(opt.devicesFile, store, devices)) return 1;
+
+    QueryServer server(store, devices);
+    if (!server.listenOn(opt.listenPort)) {
+        fprintf(stderr, "cannot listen on %u\n", opt.listenPort);
+        return 1;
+    }
+    printf("[collector] %zu devices, data in %s, queries on :%u\n", devices.size(), opt.dataDir.c_str(), opt.listenPort);
+    fflush(stdout);
+
+    std::thread queries([&]() { server.run(); });
+    Poller poller(opt, store, devices);
+    poller.run();
+    queries.join();
+    for (Device* d : devices) delete d;
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Load generator for the fleet collector: N fake ACM-1 devices on
+// consecutive ports of one host, all served from one epoll loop.
+//
+//   fakedev --count 500 [--port 20000] [--speed 60] [--write-list devices.txt]
+//
+// Each device keeps a 500-point ring like the firmware (one point per
+// logging interval of the device clock; --speed multiplies that clock so a
+// load test does not have to wait 5 minutes per point) and answers
+//   GET /api/history[?since=ts]  chunked, same JSON as HistoryJsonWriter
+//   GET /api/status              Content-Length, the fields the collector reads
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "HttpParser.h"
+
+static const size_t RING = 500;            // HISTORY_SIZE of the firmware
+static const uint32_t LOG_INTERVAL_S = 300; // History point every 5 min
+
+static volatile bool running = true;
+
+struct FakeDevice {
+    int listenFd;
+    uint32_t seed;
+    uint32_t bootTs;
+};
+
+struct Conn {
+    FakeDevice* dev;
+    std::string in;
+    std::string out;
+    size_t sent = 0;
+};
+
+static double speed = 60.0;
+static time_t startWall;
+
+// Device clock (accelerated wall clock)
+static uint32_t deviceNow() {
+    return (uint32_t)(startWall + (time(nullptr) - startWall) * speed);
+}
+
+// Deterministic synthetic climate: daily cycle plus a per-device offset
+static void sample(const FakeDevice* d, uint32_t ts, float& t, float& h) {
+    double day = (ts % 86400) / 86400.0 * 2 * M_PI;
+    t = (float)(20.0 + (d->seed % 50) / 10.0 + 2.0 * sin(day));
+    h = (float)(45.0 + (d->seed % 30) - 8.0 * sin(day));
+}
+
+static void appendChunk(std::string& out, const char* data, size_t len) {
+    char head[24];
+    snprintf(head, sizeof(head), "%zx\r\n", len);
+    out += head;
+    out.append(data, len);
+    out += "\r\n";
+}
+
+static std::string history(const FakeDevice* d, uint32_t since) {
+    uint32_t now = deviceNow();
+    uint32_t last = now - now % LOG_INTERVAL_S;
+    uint32_t first = last - (RING - 1) * LOG_INTERVAL_S;
+    if (first < d->bootTs) first = d->bootTs - d->bootTs % LOG_INTERVAL_S + LOG_INTERVAL_S;
+    if (since >= first) first = since - since % LOG_INTERVAL_S + LOG_INTERVAL_S;
+
+    std::string out = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n"
+                      "Connection: close\r\n\r\n";
+    // Same framing as the firmware: ~1 KB chunks of whole records
+    std::string chunk = "[";
+    bool firstRecord = true;
+    char rec[64];
+    for (uint32_t ts = first; ts <= last; ts += LOG_INTERVAL_S) {
+        float t, h;
+        sample(d, ts, t, h);
+        int n = snprintf(rec, sizeof(rec), "%s{\"t\":%.1f,\"h\":%.1f,\"time\":%u}", firstRecord ? "" : ",", t, h, ts);
+        firstRecord = false;
+        chunk.append(rec, n);
+        if (chunk.size() > 1000) {
+            appendChunk(out, chunk.data(), chunk.size());
+            chunk.clear();
+        }
+    }
+    chunk += "]";
+    appendChunk(out, chunk.data(), chunk.size());
+    out += "0\r\n\r\n";
+    return out;
+}
+
+static std::string status(const FakeDevice* d) {
+    uint32_t now = deviceNow();
+    float t, h;
+    sample(d, now, t, h);
+    char body[512];
+    int n = snprintf(body, sizeof(body),
+                     "{\"t\":%.2f,\"h\":%.2f,\"dp\":%.2f,\"advice\":\"OK\",\"code\":0,\"t_rate\":0.010,\"ah_rate\":-0.002,"
+                     "\"debug\":{\"heap\":{\"free\":%u,\"min_free\":180000,\"largest\":110000,\"frag\":12},"
+                     "\"sched\":{\"wakeups\":1000,\"idle\":10,\"runs\":990,\"uptime_s\":%u}}}",
+                     t, h, t - (100 - h) / 5, 200000 + d->seed % 4096, now - d->bootTs);
+    char head[160];
+    snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\nConnection: close\r\n\r\n", n);
+    return std::string(head) + std::string(body, n);
+}
+
+int main(int argc, char** argv) {
+    int count = 100;
+    int basePort = 20000;
+    const char* listFile = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        if (key == "--count") count = atoi(argv[i + 1]);
+        else if (key == "--port") basePort = atoi(argv[i + 1]);
+        else if (key == "--speed") speed = atof(argv[i + 1]);
+        else if (key == "--write-list") listFile = argv[i + 1];
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, [](int) { running = false; });
+    signal(SIGTERM, [](int) { running = false; });
+    startWall = time(nullptr);
+
+    int epfd = epoll_create1(0);
+    std::vector<FakeDevice> devices(count);
+    std::unordered_map<int, Conn> conns;
+    FILE* list = listFile ? fopen(listFile, "w") : nullptr;
+    for (int i = 0; i < count; i++) {
+        FakeDevice& d = devices[i];
+        d.seed = (uint32_t)i * 2654435761u;
+        // Devices "booted" up to two days ago: some have a full ring, some not
+        d.bootTs = (uint32_t)startWall - (d.seed % (2 * 86400));
+        d.listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(d.listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(basePort + i);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(d.listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(d.listenFd, 16) != 0) {
+            fprintf(stderr, "cannot listen on %d\n", basePort + i);
+            return 1;
+        }
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = (uint64_t)1 << 32 | (uint32_t)i; // High bit: listening socket
+        epoll_ctl(epfd, EPOLL_CTL_ADD, d.listenFd, &ev);
+        if (list) fprintf(list, "dev%04d 127.0.0.1:%d\n", i, basePort + i);
+    }
+    if (list) fclose(list);
+    printf("[fakedev] %d devices on 127.0.0.1:%d-%d, clock x%.0f\n", count, basePort, basePort + count - 1, speed);
+    fflush(stdout);
+
+    uint64_t served = 0;
+    epoll_event events[256];
+    while (running) {
+        int n = epoll_wait(epfd, events, 256, 200);
+        for (int e = 0; e < n; e++) {
+            uint64_t tag = events[e].data.u64;
+            if (tag >> 32) {
+                FakeDevice* d = &devices[(uint32_t)tag];
+                for (;;) {
+                    int fd = accept4(d->listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (fd < 0) break;
+                    conns[fd].dev = d;
+                    epoll_event ev = {};
+                    ev.events = EPOLLIN;
+                    ev.data.u64 = (uint32_t)fd;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+                }
+                continue;
+            }
+            int fd = (int)(uint32_t)tag;
+            auto it = conns.find(fd);
+            if (it == conns.end()) continue;
+            Conn& c = it->second;
+            bool closeIt = false;
+            if (c.out.empty()) {
+                char buf[4096];
+                ssize_t r;
+                while ((r = recv(fd, buf, sizeof(buf), 0)) > 0) c.in.append(buf, r);
+                if (r == 0 || (r < 0 && errno != EAGAIN)) closeIt = true;
+                HttpRequest req;
+                long used = closeIt ? -1 : parseHttpRequest(c.in, req);
+                if (used == 0) continue;
+                if (used > 0 && req.path == "/api/history") {
+                    c.out = history(c.dev, strtoul(queryParam(req.query, "since").c_str(), nullptr, 10));
+                } else if (used > 0 && req.path == "/api/status") {
+                    c.out = status(c.dev);
+                } else if (used > 0) {
+                    c.out = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                }
+                if (!c.out.empty()) {
+                    served++;
+                    epoll_event ev = {};
+                    ev.events = EPOLLOUT;
+                    ev.data.u64 = (uint32_t)fd;
+                    epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+                }
+            }
+            while (!closeIt && c.sent < c.out.size()) {
+                ssize_t w = send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+                if (w < 0) {
+                    if (errno != EAGAIN) closeIt = true;
+                    break;
+                }
+                c.sent += w;
+            }
+            if (closeIt || (!c.out.empty() && c.sent == c.out.size())) {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+                conns.erase(it);
+            }
+        }
+    }
+    printf("[fakedev] served %llu requests\n", (unsigned long long)served);
+    return 0;
+}
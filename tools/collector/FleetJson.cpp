@@ -0,0 +1,109 @@
+#include "FleetJson.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* skipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+// Position right after "key": (or nullptr)
+static const char* findKey(const char* json, size_t len, const char* key, size_t from = 0) {
+    size_t keyLen = strlen(key);
+    const char* end = json + len;
+    for (const char* p = json + from; p + keyLen + 2 <= end; p++) {
+        if (*p != '"' || memcmp(p + 1, key, keyLen) != 0 || p[keyLen + 1] != '"') continue;
+        const char* q = skipSpace(p + keyLen + 2, end);
+        if (q < end && *q == ':') return skipSpace(q + 1, end);
+    }
+    return nullptr;
+}
+
+size_t FleetJson::parseHistory(const char* json, size_t len, std::vector<FleetRecord>& out) {
+    const char* p = json;
+    const char* end = json + len;
+    size_t added = 0;
+    while (p < end) {
+        const char* open = (const char*)memchr(p, '{', end - p);
+        if (!open) break;
+        const char* close = (const char*)memchr(open, '}', end - open);
+        if (!close) break;
+
+        FleetRecord r = {0, NAN, NAN};
+        bool hasTime = false;
+        const char* q = open + 1;
+        while (q < close) {
+            q = (const char*)memchr(q, '"', close - q);
+            if (!q) break;
+            const char* keyEnd = (const char*)memchr(q + 1, '"', close - q - 1);
+            if (!keyEnd) break;
+            size_t keyLen = keyEnd - q - 1;
+            const char* v = skipSpace(keyEnd + 1, close);
+            if (v >= close || *v != ':') break;
+            v = skipSpace(v + 1, close);
+            char* numEnd;
+            double value = strtod(v, &numEnd);
+            bool isNumber = numEnd != v;
+            if (keyLen == 1 && q[1] == 't' && isNumber) r.t = (float)value;
+            else if (keyLen == 1 && q[1] == 'h' && isNumber) r.h = (float)value;
+            else if (keyLen == 4 && memcmp(q + 1, "time", 4) == 0 && isNumber) {
+                r.ts = (uint32_t)value;
+                hasTime = true;
+            }
+            q = isNumber ? numEnd : v + 1;
+            // Skip to the next pair
+            while (q < close && *q != ',') q++;
+        }
+        if (hasTime) {
+            out.push_back(r);
+            added++;
+        }
+        p = close + 1;
+    }
+    return added;
+}
+
+bool FleetJson::findNumber(const char* json, size_t len, const char* key, double& out) {
+    const char* v = findKey(json, len, key);
+    if (!v) return false;
+    char* numEnd;
+    double value = strtod(v, &numEnd);
+    if (numEnd == v) return false; // null, string, object
+    out = value;
+    return true;
+}
+
+bool FleetJson::findString(const char* json, size_t len, const char* key, std::string& out, size_t from) {
+    const char* v = findKey(json, len, key, from);
+    const char* end = json + len;
+    if (!v || v >= end || *v != '"') return false;
+    const char* close = (const char*)memchr(v + 1, '"', end - v - 1);
+    if (!close) return false;
+    out.assign(v + 1, close - v - 1);
+    return true;
+}
+
+void FleetJson::findTargets(const char* json, size_t len, std::vector<std::string>& out) {
+    size_t from = 0;
+    while (const char* v = findKey(json, len, "target", from)) {
+        from = v - json;
+        if (from >= len || *v != '"') continue;
+        const char* close = (const char*)memchr(v + 1, '"', json + len - v - 1);
+        if (!close) break;
+        out.emplace_back(v + 1, close - v - 1);
+        from = close - json + 1;
+    }
+}
+
+uint32_t FleetJson::parseIsoTime(const std::string& s) {
+    struct tm tm = {};
+    if (sscanf(s.c_str(), "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) return 0;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    time_t t = timegm(&tm);
+    return t < 0 ? 0 : (uint32_t)t;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// One history point as served by the firmware's /api/history
+struct FleetRecord {
+    uint32_t ts;
+    float t;
+    float h;
+};
+
+// Minimal scanners for the few fixed JSON shapes the collector handles
+// (firmware responses and Grafana requests). No DOM, no allocation per value.
+namespace FleetJson {
+    // [{"t":22.5,"h":45.0,"time":1700000000},...] -> appends to out, returns count.
+    // Key order does not matter; objects without "time" are skipped.
+    size_t parseHistory(const char* json, size_t len, std::vector<FleetRecord>& out);
+
+    // Value of the first "key": number (anywhere in the document). false if absent or null.
+    bool findNumber(const char* json, size_t len, const char* key, double& out);
+
+    // Value of the first "key": "string"
+    bool findString(const char* json, size_t len, const char* key, std::string& out, size_t from = 0);
+
+    // Every "target": "..." value (Grafana /query)
+    void findTargets(const char* json, size_t len, std::vector<std::string>& out);
+
+    // "2026-10-18T10:00:00.000Z" -> unix seconds (0 on error)
+    uint32_t parseIsoTime(const std::string& s);
+}
@@ -0,0 +1,134 @@
+#include "FleetStore.h"
+#include <algorithm>
+#include <math.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char* COLUMN_FILES[3] = {"ts.u32", "t.f32", "h.f32"};
+
+template <typename T>
+static bool loadColumn(const std::string& path, std::vector<T>& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return true; // New device
+    fseek(f, 0, SEEK_END);
+    long bytes = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize(bytes / sizeof(T));
+    size_t n = fread(out.data(), sizeof(T), out.size(), f);
+    fclose(f);
+    out.resize(n);
+    return true;
+}
+
+DeviceSeries::~DeviceSeries() {
+    for (FILE*& f : files) {
+        if (f) fclose(f);
+        f = nullptr;
+    }
+}
+
+bool DeviceSeries::open(const std::string& dir) {
+    mkdir(dir.c_str(), 0755);
+    loadColumn(dir + "/" + COLUMN_FILES[0], ts);
+    loadColumn(dir + "/" + COLUMN_FILES[1], temp);
+    loadColumn(dir + "/" + COLUMN_FILES[2], hum);
+
+    // Torn append (crash between the three writes): keep complete rows only
+    size_t rows = std::min(ts.size(), std::min(temp.size(), hum.size()));
+    ts.resize(rows);
+    temp.resize(rows);
+    hum.resize(rows);
+    const size_t widths[3] = {sizeof(uint32_t), sizeof(float), sizeof(float)};
+    for (int c = 0; c < 3; c++) {
+        std::string path = dir + "/" + COLUMN_FILES[c];
+        files[c] = fopen(path.c_str(), "ab");
+        if (!files[c]) return false;
+        if (truncate(path.c_str(), rows * widths[c]) != 0) return false;
+    }
+    return true;
+}
+
+size_t DeviceSeries::append(const std::vector<FleetRecord>& records) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    uint32_t last = ts.empty() ? 0 : ts.back();
+    size_t added = 0;
+    for (const FleetRecord& r : records) {
+        if (r.ts <= last) continue; // Already stored (overlapping ring snapshot)
+        ts.push_back(r.ts);
+        temp.push_back(r.t);
+        hum.push_back(r.h);
+        last = r.ts;
+        added++;
+    }
+    if (added == 0) return 0;
+
+    size_t first = ts.size() - added;
+    fwrite(&ts[first], sizeof(uint32_t), added, files[0]);
+    fwrite(&temp[first], sizeof(float), added, files[1]);
+    fwrite(&hum[first], sizeof(float), added, files[2]);
+    for (FILE* f : files) fflush(f);
+    return added;
+}
+
+uint32_t DeviceSeries::lastTs() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return ts.empty() ? 0 : ts.back();
+}
+
+size_t DeviceSeries::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return ts.size();
+}
+
+void DeviceSeries::range(Column column, uint32_t from, uint32_t to, size_t maxPoints,
+                         std::vector<std::pair<float, uint32_t>>& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t begin = std::lower_bound(ts.begin(), ts.end(), from) - ts.begin();
+    size_t end = std::upper_bound(ts.begin(), ts.end(), to) - ts.begin();
+    if (begin >= end) return;
+    const std::vector<float>& values = (column == TEMP) ? temp : hum;
+
+    if (maxPoints == 0 || end - begin <= maxPoints) {
+        for (size_t i = begin; i < end; i++) out.push_back({values[i], ts[i]});
+        return;
+    }
+    // Downsample: mean value and mean time per bucket
+    double width = (double)(to - from + 1) / maxPoints;
+    size_t i = begin;
+    while (i < end) {
+        size_t bucket = (size_t)((ts[i] - from) / width);
+        double sum = 0, sumTs = 0;
+        size_t n = 0;
+        for (; i < end && (size_t)((ts[i] - from) / width) == bucket; i++) {
+            if (isnan(values[i])) continue;
+            sum += values[i];
+            sumTs += ts[i];
+            n++;
+        }
+        if (n > 0) out.push_back({(float)(sum / n), (uint32_t)(sumTs / n)});
+    }
+}
+
+void DeviceSeries::snapshot(uint32_t from, uint32_t to, std::vector<FleetRecord>& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t begin = std::lower_bound(ts.begin(), ts.end(), from) - ts.begin();
+    size_t end = std::upper_bound(ts.begin(), ts.end(), to) - ts.begin();
+    for (size_t i = begin; i < end; i++) out.push_back({ts[i], temp[i], hum[i]});
+}
+
+int FleetStore::add(const std::string& name) {
+    std::unique_ptr<DeviceSeries> s(new DeviceSeries());
+    mkdir(root.c_str(), 0755);
+    if (!s->open(root + "/" + name)) return -1;
+    names.push_back(name);
+    series.push_back(std::move(s));
+    return (int)names.size() - 1;
+}
+
+int FleetStore::find(const std::string& name) const {
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) return (int)i;
+    }
+    return -1;
+}
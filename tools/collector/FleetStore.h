@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include "FleetJson.h"
+
+// Columnar, append-only series of one device on disk:
+//   <dir>/ts.u32   uint32 unix seconds, strictly increasing
+//   <dir>/t.f32    float temperature
+//   <dir>/h.f32    float humidity
+// The columns are also kept in memory (12 bytes per point, ~2 MB per
+// device-year at the firmware's logging rate), so range queries are two
+// binary searches and a linear copy. On open, a torn tail from a crash is
+// cut to the shortest column.
+//
+// Thread-safety: one writer (poller thread), many readers (query threads).
+class DeviceSeries {
+public:
+    enum Column { TEMP, HUM };
+
+    ~DeviceSeries();
+    bool open(const std::string& dir);
+
+    // Appends the records newer than the last stored one (ring snapshots
+    // overlap; the firmware ring is time-ordered). Returns the number added.
+    size_t append(const std::vector<FleetRecord>& records);
+
+    uint32_t lastTs() const;
+    size_t size() const;
+
+    // Points with from <= ts <= to as [value, ts]. With more than
+    // maxPoints points, consecutive points are averaged into maxPoints
+    // equal time buckets.
+    void range(Column column, uint32_t from, uint32_t to, size_t maxPoints,
+               std::vector<std::pair<float, uint32_t>>& out) const;
+
+    // All records with from <= ts <= to (export)
+    void snapshot(uint32_t from, uint32_t to, std::vector<FleetRecord>& out) const;
+
+private:
+    mutable std::shared_mutex mutex;
+    std::vector<uint32_t> ts;
+    std::vector<float> temp;
+    std::vector<float> hum;
+    FILE* files[3] = {nullptr, nullptr, nullptr};
+};
+
+// All devices under one data directory (<root>/<device name>/...)
+class FleetStore {
+public:
+    explicit FleetStore(const std::string& root) : root(root) {}
+    // Index is stable for the lifetime of the store
+    int add(const std::string& name);
+    DeviceSeries* get(int index) { return series[index].get(); }
+    size_t count() const { return names.size(); }
+    const std::string& name(int index) const { return names[index]; }
+    int find(const std::string& name) const;
+
+private:
+    std::string root;
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<DeviceSeries>> series;
+};
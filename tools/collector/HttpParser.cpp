@@ -0,0 +1,147 @@
+#include "HttpParser.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+void HttpResponseParser::reset() {
+    state = STATUS_LINE;
+    status = 0;
+    retryAfter = -1;
+    chunked = false;
+    contentLength = -1;
+    chunkLeft = 0;
+    line.clear();
+    body.clear();
+}
+
+// A complete line (without CRLF) in 'line'
+bool HttpResponseParser::onLine() {
+    switch (state) {
+        case STATUS_LINE:
+            if (strncmp(line.c_str(), "HTTP/1.", 7) != 0 || line.size() < 12) return false;
+            status = atoi(line.c_str() + 9);
+            state = HEADERS;
+            return true;
+        case HEADERS:
+            if (line.empty()) {
+                if (chunked) state = CHUNK_SIZE;
+                else if (contentLength == 0) state = DONE;
+                else state = BODY;
+                if (contentLength > (long)MAX_BODY) return false;
+                return true;
+            }
+            if (strncasecmp(line.c_str(), "Transfer-Encoding:", 18) == 0) {
+                chunked = strcasestr(line.c_str() + 18, "chunked") != nullptr;
+            } else if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) {
+                contentLength = atol(line.c_str() + 15);
+            } else if (strncasecmp(line.c_str(), "Retry-After:", 12) == 0) {
+                retryAfter = atoi(line.c_str() + 12); // Seconds form only (the device sends that)
+            }
+            return true;
+        case CHUNK_SIZE: {
+            char* end;
+            chunkLeft = strtoul(line.c_str(), &end, 16); // Extensions after ';' are ignored
+            if (end == line.c_str()) return false;
+            state = chunkLeft == 0 ? TRAILER : CHUNK_DATA;
+            return body.size() + chunkLeft <= MAX_BODY;
+        }
+        case CHUNK_END:
+            if (!line.empty()) return false;
+            state = CHUNK_SIZE;
+            return true;
+        case TRAILER:
+            if (line.empty()) state = DONE;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool HttpResponseParser::feed(const char* data, size_t len) {
+    const char* p = data;
+    const char* end = data + len;
+    while (p < end && state != DONE && state != ERROR) {
+        if (state == BODY) {
+            size_t n = end - p;
+            if (contentLength >= 0) n = std::min(n, (size_t)contentLength - body.size());
+            if (body.size() + n > MAX_BODY) {
+                state = ERROR;
+                break;
+            }
+            body.append(p, n);
+            p += n;
+            if (contentLength >= 0 && body.size() == (size_t)contentLength) state = DONE;
+            continue;
+        }
+        if (state == CHUNK_DATA) {
+            size_t n = std::min((size_t)(end - p), chunkLeft);
+            body.append(p, n);
+            p += n;
+            chunkLeft -= n;
+            if (chunkLeft == 0) state = CHUNK_END;
+            continue;
+        }
+        // Line-oriented states
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        size_t n = (nl ? nl : end) - p;
+        if (line.size() + n > 8192) {
+            state = ERROR;
+            break;
+        }
+        line.append(p, n);
+        p += n;
+        if (!nl) break;
+        p++; // '\n'
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!onLine()) state = ERROR;
+        line.clear();
+    }
+    return state != ERROR;
+}
+
+void HttpResponseParser::finish() {
+    if (state == BODY && contentLength < 0) state = DONE;
+    else if (state != DONE) state = ERROR;
+}
+
+long parseHttpRequest(const std::string& buf, HttpRequest& req) {
+    size_t headerEnd = buf.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return buf.size() > 16384 ? -1 : 0;
+
+    size_t sp1 = buf.find(' ');
+    size_t sp2 = buf.find(' ', sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos || sp2 > headerEnd) return -1;
+    req.method = buf.substr(0, sp1);
+    std::string target = buf.substr(sp1 + 1, sp2 - sp1 - 1);
+    size_t q = target.find('?');
+    req.path = target.substr(0, q);
+    req.query = (q == std::string::npos) ? "" : target.substr(q + 1);
+
+    long contentLength = 0;
+    size_t pos = buf.find("\r\n") + 2;
+    while (pos < headerEnd) {
+        size_t eol = buf.find("\r\n", pos);
+        if (strncasecmp(buf.c_str() + pos, "Content-Length:", 15) == 0) contentLength = atol(buf.c_str() + pos + 15);
+        pos = eol + 2;
+    }
+    if (contentLength < 0 || contentLength > (1 << 20)) return -1;
+    size_t total = headerEnd + 4 + contentLength;
+    if (buf.size() < total) return 0;
+    req.body = buf.substr(headerEnd + 4, contentLength);
+    return (long)total;
+}
+
+std::string queryParam(const std::string& query, const char* name) {
+    size_t nameLen = strlen(name);
+    size_t pos = 0;
+    while (pos < query.size()) {
+        size_t amp = query.find('&', pos);
+        if (amp == std::string::npos) amp = query.size();
+        if (amp - pos > nameLen && query.compare(pos, nameLen, name) == 0 && query[pos + nameLen] == '=') {
+            return query.substr(pos + nameLen + 1, amp - pos - nameLen - 1);
+        }
+        pos = amp + 1;
+    }
+    return "";
+}
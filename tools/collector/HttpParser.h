@@ -0,0 +1,54 @@
+#pragma once
+#include <stddef.h>
+#include <string>
+
+// Incremental HTTP/1.1 response parser for the device API: status line,
+// headers, then a body framed by Content-Length, chunked encoding
+// (ESPAsyncWebServer streams /api/history that way) or connection close.
+// Bytes can be fed in any split, as they come from a non-blocking socket.
+class HttpResponseParser {
+public:
+    HttpResponseParser() { reset(); }
+    void reset();
+
+    // false on a malformed response
+    bool feed(const char* data, size_t len);
+    // The peer closed the connection (completes a close-delimited body)
+    void finish();
+
+    bool isDone() const { return state == DONE; }
+    bool isError() const { return state == ERROR; }
+    int getStatus() const { return status; }
+    int getRetryAfter() const { return retryAfter; } // Seconds, -1 if absent
+    const std::string& getBody() const { return body; }
+
+    static const size_t MAX_BODY = 4 << 20; // A full device ring is ~20 KB
+
+private:
+    enum State { STATUS_LINE, HEADERS, BODY, CHUNK_SIZE, CHUNK_DATA, CHUNK_END, TRAILER, DONE, ERROR };
+    State state;
+    int status;
+    int retryAfter;
+    bool chunked;
+    long contentLength; // -1 = until close
+    size_t chunkLeft;
+    std::string line;   // Current header / chunk-size line
+    std::string body;
+
+    bool onLine();
+};
+
+// Request side of the query server: request line, Content-Length body.
+struct HttpRequest {
+    std::string method;
+    std::string path;   // Without the query string
+    std::string query;
+    std::string body;
+};
+
+// Complete request in buf? Fills req and returns the consumed length, 0 if
+// more bytes are needed, -1 on a malformed request.
+long parseHttpRequest(const std::string& buf, HttpRequest& req);
+
+// Value of name in a query string ("a=1&b=2"), empty if absent
+std::string queryParam(const std::string& query, const char* name);